@@ -1,5 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0
 
+#include <cmath>
+
 #define GLM_FORCE_RADIANS
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -10,6 +12,9 @@ namespace ZH {
 
 uint64_t Battlefield::ScorchData::nextID = 0;
 
+// finest cell of the spatial indices, in game units
+static constexpr float INDEX_CELL_SIZE = 32.0f;
+
 Battlefield::ScorchData::ScorchData() : id(nextID++) {}
 
 Battlefield::Battlefield(
@@ -22,6 +27,8 @@ Battlefield::Battlefield(
       , map->getSize().y * Map::GRID_TO_GAME_SCALE
     }
   , instanceFactory(instanceFactory)
+  , instanceIndex {glm::vec2 {0.0f}, mapGameSize, INDEX_CELL_SIZE}
+  , scorchIndex {glm::vec2 {0.0f}, mapGameSize, INDEX_CELL_SIZE}
 {
   TRACY(ZoneScoped);
 
@@ -56,7 +63,15 @@ const GFX::Camera& Battlefield::getCamera() const {
 }
 
 glm::mat4 Battlefield::getWorldMatrix(const glm::vec3& pos, float radAngle) const {
-  auto height = getWorldHeight(pos) * Map::TERRAIN_HEIGHT_SCALE;
+  return getWorldMatrix(pos, radAngle, getWorldHeight(pos));
+}
+
+glm::mat4 Battlefield::getWorldMatrix(
+    const glm::vec3& pos
+  , float radAngle
+  , float worldHeight
+) const {
+  auto height = worldHeight * Map::TERRAIN_HEIGHT_SCALE;
 
   auto rotation =
     glm::rotate(
@@ -93,6 +108,47 @@ std::list<std::shared_ptr<Objects::Instance>>& Battlefield::getObjectInstances()
   return instances;
 }
 
+const Battlefield::InstanceIndex& Battlefield::getInstanceIndex() const {
+  return instanceIndex;
+}
+
+void Battlefield::getInstancesInRadius(
+    const glm::vec3& center
+  , float radius
+  , std::vector<Objects::Instance*>& results
+) const {
+  instanceIndex.query(center, radius, results);
+}
+
+void Battlefield::getInstancesOnRay(
+    const glm::vec3& origin
+  , const glm::vec3& direction
+  , std::vector<InstanceIndex::Hit>& results
+) const {
+  instanceIndex.intersect(origin, direction, results);
+}
+
+// center of the geometry cylinder in model space, on the vertical
+// axis, so distances to it do not change with the angle
+glm::vec3 Battlefield::getInstanceCenter(const Objects::Instance& instance) const {
+  return glm::vec3 {0.0f, instance.getBase()->geometry.height * 0.5f, 0.0f};
+}
+
+std::pair<glm::vec3, float> Battlefield::getInstanceBounds(
+    const Objects::Instance& instance
+  , float drawRadius
+) const {
+  auto& geometry = instance.getBase()->geometry;
+  auto localCenter = getInstanceCenter(instance);
+  auto radius = std::max(geometry.majorRadius, geometry.minorRadius);
+
+  // sphere around the geometry cylinder
+  auto center = getWorldMatrix(instance.getPosition(), 0.0f) * glm::vec4 {localCenter, 1.0f};
+  auto geometryRadius = std::sqrt(radius * radius + localCenter.y * localCenter.y);
+
+  return {glm::vec3 {center}, std::max(geometryRadius, drawRadius)};
+}
+
 void Battlefield::loadInstances(MapBuilder& mapBuilder) {
   for (auto& mapObject : mapBuilder.objects) {
     auto instance = instanceFactory.getInstance(mapObject);
@@ -100,6 +156,12 @@ void Battlefield::loadInstances(MapBuilder& mapBuilder) {
       continue;
     }
 
+    auto [center, radius] = getInstanceBounds(*instance, 0.0f);
+    instanceEntries.emplace(
+        instance->getID()
+      , IndexEntry {instanceIndex.insert(instance.get(), center, radius)}
+    );
+
     instances.emplace_back(std::move(instance));
   }
 }
@@ -119,7 +181,11 @@ void Battlefield::loadScorches(MapBuilder& mapBuilder) {
     auto typeOpt = dict.getInt("scorchType");
     data.type = typeOpt.value_or(0);
 
-    scorches.emplace_back(std::move(data));
+    auto& entry = scorches.emplace_back(std::move(data));
+
+    // the decal square spans the radius to each side
+    auto center = getWorldMatrix(entry.location, 0.0f) * glm::vec4 {0.0f, 0.0f, 0.0f, 1.0f};
+    scorchIndex.insert(&entry, glm::vec3 {center}, entry.radius * std::sqrt(2.0f));
   }
 }
 
@@ -127,11 +193,105 @@ const std::list<Battlefield::ScorchData>& Battlefield::getScorches() const {
   return scorches;
 }
 
+const Battlefield::ScorchIndex& Battlefield::getScorchIndex() const {
+  return scorchIndex;
+}
+
+std::optional<glm::vec3> Battlefield::getTerrainPosition(const glm::vec2& screenPos) const {
+  std::optional<glm::vec3> position;
+  getTerrainPositions(std::span {&screenPos, 1}, std::span {&position, 1});
+
+  return position;
+}
+
+void Battlefield::getTerrainPositions(
+    std::span<const glm::vec2> screenPos
+  , std::span<std::optional<glm::vec3>> positions
+) const {
+  TRACY(ZoneScoped);
+
+  auto& origin = camera.getPosition();
+
+  // world X/Z match the height field, only Y is scaled
+  std::vector<glm::vec3> directions;
+  directions.reserve(screenPos.size());
+  std::vector<HeightField::Ray> rays;
+  rays.reserve(screenPos.size());
+  for (auto& pos : screenPos) {
+    auto& direction = directions.emplace_back(camera.getRayDirection(pos));
+    rays.push_back(HeightField::Ray {
+        glm::vec3 {origin.x, origin.y / Map::TERRAIN_HEIGHT_SCALE, origin.z}
+      , glm::vec3 {direction.x, direction.y / Map::TERRAIN_HEIGHT_SCALE, direction.z}
+    });
+  }
+
+  std::vector<std::optional<float>> hits;
+  hits.resize(rays.size());
+  map->getHeightField().intersect(rays, hits);
+
+  // back from the padded world to the game's map coordinates
+  auto gameMatrix = glm::inverse(map->getWorldOffsetMatrix());
+  for (size_t i = 0; i < std::min(hits.size(), positions.size()); ++i) {
+    if (hits[i]) {
+      auto worldPosition = origin + directions[i] * *hits[i];
+      positions[i] = glm::vec3 {gameMatrix * glm::vec4 {worldPosition, 1.0f}};
+    } else {
+      positions[i].reset();
+    }
+  }
+}
+
 float Battlefield::getWorldHeight(const glm::vec3& pos) const {
   auto offPos = map->getWorldOffsetMatrix() * glm::vec4 {pos, 1.0f};
   return map->getHeight(glm::vec2 {offPos.x, offPos.z}) + pos.y * (1.0f/Map::TERRAIN_HEIGHT_SCALE);
 }
 
+void Battlefield::getWorldHeights(
+    std::span<const glm::vec3> positions
+  , std::span<float> heights
+) const {
+  TRACY(ZoneScoped);
+
+  std::vector<glm::vec2> offPositions;
+  offPositions.reserve(positions.size());
+
+  auto& offsetMatrix = map->getWorldOffsetMatrix();
+  for (auto& pos : positions) {
+    auto offPos = offsetMatrix * glm::vec4 {pos, 1.0f};
+    offPositions.emplace_back(offPos.x, offPos.z);
+  }
+
+  map->getHeights(offPositions, heights);
+
+  for (size_t i = 0; i < std::min(positions.size(), heights.size()); ++i) {
+    heights[i] += positions[i].y * (1.0f/Map::TERRAIN_HEIGHT_SCALE);
+  }
+}
+
+void Battlefield::updateInstanceBounds(const Objects::Instance& instance) {
+  auto lookup = instanceEntries.find(instance.getID());
+  if (lookup == instanceEntries.cend()) {
+    return;
+  }
+
+  auto [center, radius] = getInstanceBounds(instance, lookup->second.drawRadius);
+  instanceIndex.update(lookup->second.handle, center, radius);
+}
+
+void Battlefield::setInstanceDrawBounds(
+    const Objects::Instance& instance
+  , const glm::vec3& center
+  , float radius
+) {
+  auto lookup = instanceEntries.find(instance.getID());
+  if (lookup == instanceEntries.cend()) {
+    return;
+  }
+
+  lookup->second.drawRadius = glm::length(center - getInstanceCenter(instance)) + radius;
+  updateInstanceBounds(instance);
+}
+
 void Battlefield::moveCameraAxially(float x, float y) {
   camera.moveAxially(x, y);
   newMatrices = true;
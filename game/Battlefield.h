@@ -3,7 +3,11 @@
 #ifndef H_GAME_BATTLEFIELD
 #define H_GAME_BATTLEFIELD
 
+#include <optional>
+#include <span>
+
 #include "common.h"
+#include "LooseQuadtree.h"
 #include "Map.h"
 #include "objects/InstanceFactory.h"
 #include "gfx/Camera.h"
@@ -27,6 +31,10 @@ class Battlefield {
         ScorchData();
     };
 
+    // world space bounds, for proximity, visibility and picking
+    using InstanceIndex = LooseQuadtree<Objects::Instance*>;
+    using ScorchIndex = LooseQuadtree<const ScorchData*>;
+
     Battlefield(
         std::shared_ptr<Map>
       , MapBuilder& mapBuilder
@@ -41,9 +49,37 @@ class Battlefield {
     std::shared_ptr<Map> getMap() const;
     const glm::vec2& getMapGameSize() const;
     std::list<std::shared_ptr<Objects::Instance>>& getObjectInstances();
+    const InstanceIndex& getInstanceIndex() const;
+    void getInstancesInRadius(
+        const glm::vec3& center
+      , float radius
+      , std::vector<Objects::Instance*>&
+    ) const;
+    // sorted by distance along the ray
+    void getInstancesOnRay(
+        const glm::vec3& origin
+      , const glm::vec3& direction
+      , std::vector<InstanceIndex::Hit>&
+    ) const;
     const std::list<ScorchData>& getScorches() const;
+    const ScorchIndex& getScorchIndex() const;
+    // terrain under a pixel, X/Z in game coordinates like instance
+    // positions, Y the height of the terrain as rendered
+    std::optional<glm::vec3> getTerrainPosition(const glm::vec2& screenPos) const;
+    void getTerrainPositions(
+        std::span<const glm::vec2> screenPos
+      , std::span<std::optional<glm::vec3>>
+    ) const;
     float getWorldHeight(const glm::vec3&) const;
+    void getWorldHeights(std::span<const glm::vec3>, std::span<float>) const;
     glm::mat4 getWorldMatrix(const glm::vec3& pos, float radAngle) const;
+    glm::mat4 getWorldMatrix(const glm::vec3& pos, float radAngle, float worldHeight) const;
+
+    // to be called once an instance has moved
+    void updateInstanceBounds(const Objects::Instance&);
+    // bounds of what is drawn of an instance in its model space, the
+    // index covers them along with its geometry from then on
+    void setInstanceDrawBounds(const Objects::Instance&, const glm::vec3& center, float radius);
 
     void moveCameraAxially(float x, float y);
     void moveCameraDirectionally(float x, float y);
@@ -56,6 +92,12 @@ class Battlefield {
     );
     void zoomCamera(float in);
   private:
+    struct IndexEntry {
+      InstanceIndex::Handle handle;
+      // around the center of the geometry
+      float drawRadius = 0.0f;
+    };
+
     std::shared_ptr<Map> map;
     glm::vec2 mapGameSize;
     Objects::InstanceFactory& instanceFactory;
@@ -64,7 +106,12 @@ class Battlefield {
 
     std::list<std::shared_ptr<Objects::Instance>> instances;
     std::list<ScorchData> scorches;
+    InstanceIndex instanceIndex;
+    std::unordered_map<uint64_t, IndexEntry> instanceEntries;
+    ScorchIndex scorchIndex;
 
+    std::pair<glm::vec3, float> getInstanceBounds(const Objects::Instance&, float drawRadius) const;
+    glm::vec3 getInstanceCenter(const Objects::Instance&) const;
     void loadInstances(MapBuilder& mapBuilder);
     void loadScorches(MapBuilder& mapBuilder);
 };
@@ -3,69 +3,133 @@
 #ifndef H_GAME_CACHE
 #define H_GAME_CACHE
 
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
 #include "common.h"
-#include "MurmurHash.h"
 
 namespace ZH {
 
+// Keeps entries up to a budget of bytes, dropping the least recently
+// used ones first. Entries still held outside of the cache are pinned
+// and skipped, so the budget may be exceeded until they are released.
 template<typename T>
 class Cache {
   public:
-    Cache(size_t capacity = 128) : capacity(capacity) {}
+    static constexpr size_t DEFAULT_BUDGET = 256 * 1024 * 1024;
+
+    struct Stats {
+      size_t hits = 0;
+      size_t misses = 0;
+      size_t evictions = 0;
+      size_t entries = 0;
+      size_t bytes = 0;
+    };
 
-  private:
-    size_t capacity;
+    Cache(size_t budget = DEFAULT_BUDGET) : budget(budget) {}
 
-    std::unordered_map<uint32_t, std::shared_ptr<T>> cacheEntries;
+    std::shared_ptr<T> get(const std::string& key) {
+      std::lock_guard lock {mutex};
 
-    using CacheIt = decltype(cacheEntries)::const_iterator;
-    struct QueueSort {
-      bool operator()(const CacheIt& a, const CacheIt& b) {
-        return a->second.use_count() < b->second.use_count();
+      auto lookup = entries.find(key);
+      if (lookup == entries.cend()) {
+        stats.misses += 1;
+        return {};
       }
-    };
 
-    std::priority_queue<CacheIt, std::vector<CacheIt>, QueueSort> usage;
+      stats.hits += 1;
+      usage.splice(usage.begin(), usage, lookup->second);
 
-  public:
-    std::shared_ptr<T> get(const std::string& key) {
-      auto hash = getCacheKey(key);
+      return lookup->second->value;
+    }
 
-      auto lookup = cacheEntries.find(hash);
-      if (lookup == cacheEntries.cend()) {
+    // like `get`, but neither counted nor marked as used, for polling
+    std::shared_ptr<T> peek(const std::string& key) const {
+      std::lock_guard lock {mutex};
+
+      auto lookup = entries.find(key);
+      if (lookup == entries.cend()) {
         return {};
       }
 
-      return lookup->second;
+      return lookup->second->value;
     }
 
-    void put(std::string key, std::shared_ptr<T> ptr) {
-      auto hash = getCacheKey(key);
-      auto result = cacheEntries.emplace(hash, ptr);
+    // bytes of host or device memory the entry holds on to
+    void put(const std::string& key, std::shared_ptr<T> value, size_t bytes) {
+      std::lock_guard lock {mutex};
 
-      if (result.second) {
-        usage.push(result.first);
+      auto lookup = entries.find(key);
+      if (lookup != entries.cend()) {
+        stats.bytes -= lookup->second->bytes;
+        usage.erase(lookup->second);
+        entries.erase(lookup);
       }
+
+      usage.push_front({key, std::move(value), bytes});
+      entries.emplace(key, usage.begin());
+      stats.bytes += bytes;
+
+      evictUnused();
     }
 
-  private:
-    void tryCleanUpCache() {
-      if (cacheEntries.size() < capacity) {
-        return;
-      }
+    // for when pinned entries got released
+    void evict() {
+      std::lock_guard lock {mutex};
 
-      auto& top = usage.top();
-      if (top->second.use_count() == 1) {
-        usage.pop();
-        cacheEntries.erase(top);
-      }
+      evictUnused();
+    }
+
+    size_t getBudget() const {
+      return budget;
     }
 
-    uint32_t getCacheKey(const std::string& value) {
-      MurmurHash3_32 hasher;
-      hasher.feed(value);
+    void setBudget(size_t budget) {
+      std::lock_guard lock {mutex};
+
+      this->budget = budget;
+      evictUnused();
+    }
+
+    Stats getStats() const {
+      std::lock_guard lock {mutex};
+
+      auto current = stats;
+      current.entries = entries.size();
 
-      return hasher.getHash();
+      return current;
+    }
+
+  private:
+    struct Entry {
+      std::string key;
+      std::shared_ptr<T> value;
+      size_t bytes;
+    };
+
+    size_t budget;
+    Stats stats;
+    // most recently used first
+    std::list<Entry> usage;
+    std::unordered_map<std::string, typename std::list<Entry>::iterator> entries;
+    mutable std::mutex mutex;
+
+    void evictUnused() {
+      auto it = usage.end();
+      while (stats.bytes > budget && it != usage.begin()) {
+        --it;
+        if (it->value.use_count() > 1) {
+          continue;
+        }
+
+        stats.bytes -= it->bytes;
+        stats.evictions += 1;
+        entries.erase(it->key);
+        it = usage.erase(it);
+      }
     }
 };
 
@@ -14,6 +14,16 @@ namespace ZH {
 struct Config {
   Size resolution = {1600, 900};
   std::optional<uint16_t> refreshRate;
+  // bytes, evicted least recently used first
+  size_t textureCacheBudget = 512 * 1024 * 1024;
+  size_t modelCacheBudget = 128 * 1024 * 1024;
+  // decoded textures, relative to the working directory
+  std::filesystem::path textureCacheDir = "cache/textures";
+  size_t textureDiskCacheBudget = 1024 * 1024 * 1024;
+  // converted models, ditto
+  std::filesystem::path modelCacheDir = "cache/models";
+  // screen space error of model LODs tolerated, in pixels
+  float modelLODPixelError = 2.0f;
 #if WIN32
   std::filesystem::path baseDir = "D:/Games/Steam/steamapps/common/Command & Conquer Generals - Zero Hour";
 #else
@@ -15,6 +15,17 @@ static_cast<typename std::underlying_type<ImageIndex>::type>(imageIndex)
 
 namespace ZH::GUI::Drawing {
 
+static std::string getImageKey(const INIImage& image) {
+  return fmt::format(
+      "{}:{},{}:{},{}"
+    , image.texture
+    , image.topLeft.x
+    , image.topLeft.y
+    , image.bottomRight.x
+    , image.bottomRight.y
+  );
+}
+
 TextCacheKey::TextCacheKey(
     const std::u16string& text
   , uint8_t size
@@ -261,48 +272,31 @@ void RenderListFactory::createRectangularRenderList(
     commandBuffer.beginDebugLabel(component.getName());
   }
 
-  if (texture && !textureBundle.texture) {
-    textureBundle.texture = textureCache.getTextureSampler(texture->texture);
-    textureBundle.position = texture->topLeft;
-    textureBundle.size = Size (
-        static_cast<Size::value_type>(texture->bottomRight.x - texture->topLeft.x)
-      , static_cast<Size::value_type>(texture->bottomRight.y - texture->topLeft.y)
-    );
+  if (texture && !textureBundle.region) {
+    textureBundle.region = findImageRegion(*texture);
   }
 
-  if (!textureBundle.descriptorSet) {
-    textureBundle.matrices =
-      std::make_shared<Vugl::UniformBuffer>(vuglContext.createUniformBuffer(sizeof(UIMatrices)));
+  auto matrices = getPositionMatrices(renderComponent, textureBundle);
+  auto offset = vuglContext.getFrameArena().push(matrices, frameIndex);
 
-    if (textureBundle.texture) {
-      textureBundle.descriptorSet = std::make_shared<Vugl::DescriptorSet>(uiTexturePipeline->createDescriptorSet());
+  if (offset) {
+    if (textureBundle.region) {
+      switchToPipeline(Pipeline::TEXTURE, commandBuffer);
+      commandBuffer.bindResource(
+          *texturePages[textureBundle.region->page].descriptorSet
+        , std::span<const uint32_t> {&*offset, 1}
+      );
     } else {
-      textureBundle.descriptorSet = std::make_shared<Vugl::DescriptorSet>(uiPipeline->createDescriptorSet());
+      switchToPipeline(Pipeline::DEFAULT, commandBuffer);
+      commandBuffer.bindResource(*uiDescriptorSet, std::span<const uint32_t> {&*offset, 1});
     }
 
-    textureBundle.descriptorSet->assignUniformBuffer(*textureBundle.matrices);
-    if (textureBundle.texture) {
-      textureBundle.descriptorSet->assignCombinedSampler(*textureBundle.texture);
-      vuglContext.uploadResource(*textureBundle.texture);
-    }
-
-    textureBundle.descriptorSet->updateDevice();
+    commandBuffer.draw([this](VkCommandBuffer vkCommandBuffer, uint32_t) {
+      vkCmdDraw(vkCommandBuffer, 6, 1, 0, 0);
+      return VK_SUCCESS;
+    });
   }
 
-  if (textureBundle.texture) {
-    switchToPipeline(Pipeline::TEXTURE, commandBuffer);
-  } else {
-    switchToPipeline(Pipeline::DEFAULT, commandBuffer);
-  }
-
-  commandBuffer.bindResource(*textureBundle.descriptorSet);
-  commandBuffer.draw([this](VkCommandBuffer vkCommandBuffer, uint32_t) {
-    vkCmdDraw(vkCommandBuffer, 6, 1, 0, 0);
-    return VK_SUCCESS;
-  });
-
-  writePositionMatrices(renderComponent, textureBundle, frameIndex);
-
   if (vuglContext.isDebuggingAllowed()) {
     commandBuffer.endDebugLabel();
   }
@@ -354,6 +348,101 @@ void RenderListFactory::createWindowRenderList(
   );
 }
 
+void RenderListFactory::buildAtlas() {
+  atlas.build();
+
+  auto& pages = atlas.getPages();
+  for (size_t i = atlasPages.size(); i < pages.size(); ++i) {
+    auto texture = textureCache.createTextureSampler(*pages[i]);
+    if (!texture) {
+      WARN_ZH("RenderListFactory", "Failed to create atlas page");
+      atlasPages.emplace_back();
+      continue;
+    }
+
+    atlasPages.push_back(createTexturePage(std::move(texture)));
+  }
+}
+
+void RenderListFactory::collectImages(
+    Component& component
+  , std::unordered_map<std::string, std::shared_ptr<GFX::HostTexture>>& hostTextures
+) {
+  auto addImages = [this, &hostTextures](const Component::ImagesContainer& images) {
+    for (auto& image : images) {
+      if (!image) {
+        continue;
+      }
+
+      auto lookup = hostTextures.find(image->texture);
+      if (lookup == hostTextures.cend()) {
+        lookup = hostTextures.emplace(image->texture, textureCache.getHostTexture(image->texture)).first;
+      }
+
+      atlas.add(getImageKey(*image), lookup->second, image->topLeft, image->effectiveSize());
+    }
+  };
+
+  addImages(component.getEnabledImages());
+  addImages(component.getHighlightImages());
+
+  for (auto& child : component.getChildren()) {
+    collectImages(*child, hostTextures);
+  }
+}
+
+std::optional<size_t> RenderListFactory::createTexturePage(std::shared_ptr<Vugl::CombinedSampler> texture) {
+  auto descriptorSet = uiTexturePipeline->createDescriptorSet();
+  descriptorSet.assignFrameArena(vuglContext.getFrameArena(), sizeof(UIMatrices));
+  descriptorSet.assignCombinedSampler(*texture);
+  vuglContext.uploadResource(*texture);
+
+  auto sharedSet = vuglContext.shareDescriptorSet(std::move(descriptorSet));
+  if (sharedSet->getLastResult() != VK_SUCCESS) {
+    return {};
+  }
+
+  texturePages.push_back({std::move(texture), std::move(sharedSet)});
+
+  return texturePages.size() - 1;
+}
+
+std::optional<ImageRegion> RenderListFactory::findImageRegion(const INIImage& image) {
+  auto key = getImageKey(image);
+
+  auto region = atlas.getRegion(key);
+  // components created after the first frame
+  if (!region && atlas.add(key, textureCache.getHostTexture(image.texture), image.topLeft, image.effectiveSize())) {
+    buildAtlas();
+    region = atlas.getRegion(key);
+  }
+
+  if (region && atlasPages[region->get().page]) {
+    return ImageRegion {*atlasPages[region->get().page], region->get().position, region->get().size};
+  }
+
+  size_t page;
+  auto lookup = fallbackPages.find(image.texture);
+  if (lookup == fallbackPages.cend()) {
+    auto texture = textureCache.getTextureSampler(image.texture);
+    if (!texture) {
+      return {};
+    }
+
+    auto created = createTexturePage(std::move(texture));
+    if (!created) {
+      return {};
+    }
+
+    page = *created;
+    fallbackPages.emplace(image.texture, page);
+  } else {
+    page = lookup->second;
+  }
+
+  return ImageRegion {page, image.topLeft, image.effectiveSize()};
+}
+
 ResourceBundle& RenderListFactory::findOrCreateResourceBundle(const Component& component) {
   auto resource = resourceMap.find(component.getID());
   if (resource == resourceMap.cend()) {
@@ -422,7 +511,7 @@ bool RenderListFactory::preparePipelines(Vugl::RenderPass& renderPass) {
   pipelineSetup.vkPipelineColorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
   pipelineSetup.setVSCode(readFile("shaders/ui.vert.spv"));
   pipelineSetup.setFSCode(readFile("shaders/ui.frag.spv"));
-  pipelineSetup.reserveUniformBuffer(VK_SHADER_STAGE_VERTEX_BIT);
+  pipelineSetup.reserveUniformBuffer(VK_SHADER_STAGE_VERTEX_BIT, true);
   pipelineSetup.addVertexInput(VK_FORMAT_R32G32B32_SFLOAT, 0, 12, 0);
   pipelineSetup.addVertexInput(VK_FORMAT_R32G32_SFLOAT, 12, 8, 0);
 
@@ -440,7 +529,7 @@ bool RenderListFactory::preparePipelines(Vugl::RenderPass& renderPass) {
   texturePipelineSetup.vkPipelineColorBlendAttachmentState.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
   texturePipelineSetup.setVSCode(readFile("shaders/ui.vert.spv"));
   texturePipelineSetup.setFSCode(readFile("shaders/ui_texture.frag.spv"));
-  texturePipelineSetup.reserveUniformBuffer(VK_SHADER_STAGE_VERTEX_BIT);
+  texturePipelineSetup.reserveUniformBuffer(VK_SHADER_STAGE_VERTEX_BIT, true);
   texturePipelineSetup.reserveCombinedSampler(VK_SHADER_STAGE_FRAGMENT_BIT);
   texturePipelineSetup.addVertexInput(VK_FORMAT_R32G32B32_SFLOAT, 0, 12, 0);
   texturePipelineSetup.addVertexInput(VK_FORMAT_R32G32_SFLOAT, 12, 8, 0);
@@ -451,6 +540,14 @@ bool RenderListFactory::preparePipelines(Vugl::RenderPass& renderPass) {
     return false;
   }
 
+  auto descriptorSet = uiPipeline->createDescriptorSet();
+  descriptorSet.assignFrameArena(vuglContext.getFrameArena(), sizeof(UIMatrices));
+  uiDescriptorSet = vuglContext.shareDescriptorSet(std::move(descriptorSet));
+
+  std::unordered_map<std::string, std::shared_ptr<GFX::HostTexture>> hostTextures;
+  collectImages(rootComponent, hostTextures);
+  buildAtlas();
+
   rectangleVertUV =
     std::make_unique<Vugl::ElementBuffer>(vuglContext.createElementBuffer(0));
   fillRectVertexData();
@@ -750,30 +847,30 @@ void RenderListFactory::switchToPipeline(Pipeline nextPipeline, Vugl::CommandBuf
   currentPipeline = nextPipeline;
 }
 
-void RenderListFactory::writePositionMatrices(
+UIMatrices RenderListFactory::getPositionMatrices(
     const RenderComponent& component
   , const TextureBundle& bundle
-  , size_t frameIndex
 ) {
   UIMatrices matrices;
 
   auto size = component.size;
   auto position = component.position;
 
-  if (bundle.texture) {
-    auto extent = bundle.texture->getExtent();
+  if (bundle.region) {
+    auto& region = *bundle.region;
+    auto extent = texturePages[region.page].texture->getExtent();
     // there is a 0 alpha at the border of some images, so when stretching, discard borders
     uint8_t stretchOffset = bundle.stretchedX ? 1 : 0;
 
     matrices.uv =
       glm::translate(glm::mat4 {1.0f}, glm::vec3 {
-          (bundle.position.x + stretchOffset) / (extent.width * 1.0f)
-        , bundle.position.y / (extent.height * 1.0f)
+          (region.position.x + stretchOffset) / (extent.width * 1.0f)
+        , region.position.y / (extent.height * 1.0f)
         , 1.0f
       })
       * glm::scale(glm::mat4 {1.0f}, glm::vec3 {
-          (bundle.size.x - 2 * stretchOffset) / (extent.width * 1.0f)
-        , bundle.size.y / (extent.height * 1.0f)
+          (region.size.x - 2 * stretchOffset) / (extent.width * 1.0f)
+        , region.size.y / (extent.height * 1.0f)
         , 1.0f
       });
   }
@@ -784,7 +881,7 @@ void RenderListFactory::writePositionMatrices(
 
   matrices.mvp = viewportMatrix * modelMatrix;
 
-  bundle.matrices->writeData(matrices, frameIndex);
+  return matrices;
 }
 
 }
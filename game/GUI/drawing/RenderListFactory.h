@@ -14,6 +14,7 @@
 #include "../Label.h"
 #include "../Window.h"
 #include "../../gfx/FrameDisposable.h"
+#include "../../gfx/TextureAtlas.h"
 #include "../../gfx/TextureCache.h"
 #include "../../gfx/font/FontManager.h"
 #include "../../MurmurHash.h"
@@ -65,13 +66,20 @@ struct UIFontMatrix {
   alignas(16) glm::mat4 viewport;
 };
 
-struct TextureBundle {
+// texels of an image inside one of the texture pages
+struct ImageRegion {
+  size_t page;
+  Point position;
+  Size size;
+};
+
+struct TexturePage {
   std::shared_ptr<Vugl::CombinedSampler> texture;
-  std::shared_ptr<Vugl::UniformBuffer> matrices;
   std::shared_ptr<Vugl::DescriptorSet> descriptorSet;
+};
 
-  Point position;
-  Size size;
+struct TextureBundle {
+  std::optional<ImageRegion> region;
   bool stretchedX = false;
 };
 
@@ -140,6 +148,14 @@ class RenderListFactory {
     std::shared_ptr<Vugl::ElementBuffer> rectangleVertUV;
     std::shared_ptr<Vugl::Pipeline> uiPipeline;
     std::shared_ptr<Vugl::Pipeline> uiTexturePipeline;
+    std::shared_ptr<Vugl::DescriptorSet> uiDescriptorSet;
+
+    // images share atlas pages, those that do not fit in use their
+    // whole texture as a page
+    GFX::TextureAtlas atlas;
+    std::vector<TexturePage> texturePages;
+    std::vector<std::optional<size_t>> atlasPages;
+    std::unordered_map<std::string, size_t> fallbackPages;
 
     std::shared_ptr<Vugl::Pipeline> fontPipeline;
     std::unordered_map<
@@ -176,6 +192,11 @@ class RenderListFactory {
       , size_t
     );
 
+    void buildAtlas();
+    void collectImages(Component&, std::unordered_map<std::string, std::shared_ptr<GFX::HostTexture>>&);
+    std::optional<size_t> createTexturePage(std::shared_ptr<Vugl::CombinedSampler>);
+    std::optional<ImageRegion> findImageRegion(const INIImage&);
+
     ResourceBundle& findOrCreateResourceBundle(const Component&);
     TextHolderBundle& findOrCreateTextHolderBundle(const Component&);
     bool fillRectVertexData();
@@ -189,11 +210,7 @@ class RenderListFactory {
     bool switchToFont(uint8_t size, bool bold);
     void switchToPipeline(Pipeline, Vugl::CommandBuffer&);
 
-    void writePositionMatrices(
-        const RenderComponent&
-      , const TextureBundle&
-      , size_t
-    );
+    UIMatrices getPositionMatrices(const RenderComponent&, const TextureBundle&);
 };
 
 }
@@ -1,5 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0
 
+#include <algorithm>
+
 #include "Game.h"
 #include "Logging.h"
 
@@ -7,6 +9,8 @@ namespace ZH {
 
 Game::Game(Config& config, Window& window)
   : config(config)
+  // the draw thread takes part in the jobs, too
+  , jobSystem(std::clamp(std::thread::hardware_concurrency(), 2u, 8u) - 1)
   , window(window)
 {}
 
@@ -60,7 +64,23 @@ bool Game::init() {
       }
     );
 
-  textureLoader = std::make_shared<GFX::TextureLoader>(*texturesResourceLoader);
+  auto& vuglContext = window.getVuglContext();
+  auto compressedTextures =
+    vuglContext.getVkEnabledDeviceFeatures().textureCompressionBC
+      && vuglContext.isFormatSampleable(VK_FORMAT_BC1_RGBA_UNORM_BLOCK)
+      && vuglContext.isFormatSampleable(VK_FORMAT_BC3_UNORM_BLOCK);
+  if (!compressedTextures) {
+    LOG_ZH("Game", "No BC texture support, decoding DDS files");
+  }
+
+  textureDiskCache =
+    std::make_shared<GFX::TextureDiskCache>(config.textureCacheDir, config.textureDiskCacheBudget);
+  textureLoader =
+    std::make_shared<GFX::TextureLoader>(
+        *texturesResourceLoader
+      , compressedTextures
+      , std::make_optional(std::ref(*textureDiskCache))
+    );
 
   mapsLoader =
     std::shared_ptr<ResourceLoader>(
@@ -71,7 +91,12 @@ bool Game::init() {
     std::shared_ptr<ResourceLoader>(
       new ResourceLoader {{"W3DZH.big", "ZH_Generals/W3D.big"} , config.baseDir}
     );
-  modelCache = std::make_shared<GFX::ModelCache>(*modelLoader);
+  modelCache =
+    std::make_shared<GFX::ModelCache>(
+        *modelLoader
+      , config.modelCacheBudget
+      , std::make_optional(config.modelCacheDir)
+    );
 
   objectLoader = std::make_shared<ObjectLoader>(*iniResourceLoader);
   if (!objectLoader->init()) {
@@ -95,6 +120,7 @@ bool Game::init() {
         window.getVuglContext()
       , *textureLoader
       , *fontManager
+      , config.textureCacheBudget
     );
   windowFactory = std::make_shared<WindowFactory>(config);
 
@@ -179,6 +205,34 @@ bool Game::init() {
 Game::~Game() {
   terminate = true;
   drawThread.join();
+
+  if (textureCache) {
+    textureCache->stopLoading();
+
+    auto stats = textureCache->getStats();
+    LOG_ZH(
+        "Game"
+      , "Texture cache: {} hits, {} misses, {} evictions, {} entries, {} bytes"
+      , stats.hits
+      , stats.misses
+      , stats.evictions
+      , stats.entries
+      , stats.bytes
+    );
+  }
+
+  if (modelCache) {
+    auto stats = modelCache->getStats();
+    LOG_ZH(
+        "Game"
+      , "Model cache: {} hits, {} misses, {} evictions, {} entries, {} bytes"
+      , stats.hits
+      , stats.misses
+      , stats.evictions
+      , stats.entries
+      , stats.bytes
+    );
+  }
 }
 
 void Game::loop() {
@@ -230,20 +284,32 @@ void Game::draw(void *obj) {
     WARN_ZH("Game", "Failed to prepare map rendering");
   }
 
+  {
+    auto lock = game->overlay->getLock();
+
+    // until there is a loading screen
+    size_t lastTenth = 0;
+    game->mapRenderer->prewarm(game->jobSystem, [&lastTenth](size_t done, size_t total) {
+      auto tenth = total > 0 ? done * 10 / total : 10;
+      if (tenth > lastTenth) {
+        lastTenth = tenth;
+        LOG_ZH("Game", "Loading map: {}/{}", done, total);
+      }
+    });
+  }
+
   std::array<VkClearValue, 2> clearColors{};
   clearColors[0].color = {0.0f, 0.0f, 0.0f, 1.0f};
   clearColors[1].depthStencil = {1.0f, 0};
 
   auto guiCommandPool = vuglContext.createCommandPool();
-  auto gameCommandPool = vuglContext.createCommandPool();
 
   std::vector<Vugl::CommandBuffer> commandBuffers;
   auto numSwapchainImages = vuglContext.getSwapchainImages().size();
 
   for (size_t i = 0; i < numSwapchainImages; ++i) {
-    // primary + game + GUI
+    // primary + GUI, the battlefield has its own
     commandBuffers.emplace_back(vuglContext.createCommandBuffer(i));
-    commandBuffers.emplace_back(vuglContext.createCommandBuffer(i, gameCommandPool));
     commandBuffers.emplace_back(vuglContext.createCommandBuffer(i, guiCommandPool));
   }
 
@@ -251,27 +317,28 @@ void Game::draw(void *obj) {
     auto& frame = vuglContext.getNextFrame();
     auto frameIndex = frame.getImageIndex();
 
-    for (size_t i = 0; i < 3; ++i) {
-      commandBuffers[frameIndex * 3 + i].reset();
+    for (size_t i = 0; i < 2; ++i) {
+      commandBuffers[frameIndex * 2 + i].reset();
     }
 
-    auto& primary = commandBuffers[frameIndex * 3];
-    auto& battlefieldSecondary = commandBuffers[frameIndex * 3 + 1];
-    auto& guiSecondary = commandBuffers[frameIndex * 3 + 2];
+    auto& primary = commandBuffers[frameIndex * 2];
+    auto& guiSecondary = commandBuffers[frameIndex * 2 + 1];
 
     {
       auto lock = game->overlay->getLock();
-      #pragma omp parallel sections num_threads(2)
-      {
-        #pragma omp section
-        {
-          game->mapRenderer->createRenderList(battlefieldSecondary, frameIndex, renderPass);
-        }
-        #pragma omp section
-        {
-          game->renderListFactory->createRenderList(guiSecondary, frameIndex, renderPass);
-        }
-      }
+
+      // finished background loads, before anything gets recorded
+      game->textureCache->update();
+
+      std::vector<JobSystem::Job> jobs;
+      jobs.emplace_back([&]() {
+        game->mapRenderer->createRenderList(game->jobSystem, frameIndex, renderPass);
+      });
+      jobs.emplace_back([&]() {
+        game->renderListFactory->createRenderList(guiSecondary, frameIndex, renderPass);
+      });
+      game->jobSystem.run(jobs);
+
       game->overlay->frameDoneTick();
     }
 
@@ -280,7 +347,7 @@ void Game::draw(void *obj) {
     }
 
     primary.beginRendering(renderPass, clearColors);
-    primary.executeSecondary(battlefieldSecondary);
+    primary.executeSecondary(game->mapRenderer->getRenderLists(frameIndex));
     primary.executeSecondary(guiSecondary);
     primary.closeRendering();
 
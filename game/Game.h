@@ -14,6 +14,7 @@
 #include "common.h"
 #include "Config.h"
 #include "EventDispatcher.h"
+#include "JobSystem.h"
 #include "inis/TerrainINI.h"
 #include "inis/WaterINI.h"
 #include "ObjectLoader.h"
@@ -48,6 +49,7 @@ class Game {
     Config& config;
 
     std::thread drawThread;
+    JobSystem jobSystem;
 
     EventDispatcher eventDispatcher;
     Audio::Backend audioBackend;
@@ -68,6 +70,7 @@ class Game {
     std::shared_ptr<ResourceLoader> texturesResourceLoader;
     std::shared_ptr<WindowFactory> windowFactory;
     std::shared_ptr<GFX::TextureCache> textureCache;
+    std::shared_ptr<GFX::TextureDiskCache> textureDiskCache;
     std::shared_ptr<GFX::TextureLoader> textureLoader;
     std::shared_ptr<GFX::TextureLookup> textureLookup;
 
@@ -3,6 +3,8 @@
 #ifndef H_GAME_GEOMETRY
 #define H_GAME_GEOMETRY
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include <glm/gtc/matrix_transform.hpp>
@@ -12,120 +14,178 @@
 
 namespace ZH {
 
+// covered cells [x0, x1) of row y
+struct Span {
+  int32_t y = 0;
+  int32_t x0 = 0;
+  int32_t x1 = 0;
+};
+
+enum class FillRule {
+    EVEN_ODD
+  , NON_ZERO
+};
+
+// Cells whose corner point lies inside or on the border of the polygon,
+// sorted by row and column.
 template <typename T>
-std::vector<uint8_t> getPointsInPolygon(
+std::vector<Span> getPolygonSpans(
     Size size
   , const std::vector<T>& polygonVertices
   , const glm::mat4& conversionMatrix
+  , FillRule fillRule = FillRule::NON_ZERO
 ) {
   TRACY(ZoneScoped);
 
-  std::vector<uint8_t> field;
-  field.resize(size.x * size.y);
+  constexpr float EPSILON = 0.0001f;
 
-  // borders
-  for (size_t i = 0; i < polygonVertices.size(); ++i) {
-    auto& pt1 = polygonVertices[i == 0 ? polygonVertices.size() - 1 : i - 1];
-    auto& pt2 = polygonVertices[i];
+  std::vector<Span> spans;
+  if (polygonVertices.empty() || size.x == 0 || size.y == 0) {
+    return spans;
+  }
 
-    auto ptC1 = conversionMatrix * glm::vec4 {pt1.x, pt1.y, 1.0f, 1.0f};
-    auto ptC2 = conversionMatrix * glm::vec4 {pt2.x, pt2.y, 1.0f, 1.0f};
+  std::vector<glm::vec2> points;
+  points.reserve(polygonVertices.size());
+  for (auto& pt : polygonVertices) {
+    auto ptC = conversionMatrix * glm::vec4 {pt.x, pt.y, 1.0f, 1.0f};
+    points.emplace_back(ptC.x, ptC.y);
+  }
 
-    auto drawBorder = [&field, size](int32_t a1, int32_t a2, int32_t b1, int32_t b2, bool switchAxis) {
-      float m = (b2 - b1) / (1.0f * (a2 - a1));
+  float minY = points[0].y, maxY = points[0].y;
+  for (auto& pt : points) {
+    minY = std::min(minY, pt.y);
+    maxY = std::max(maxY, pt.y);
+  }
 
-      auto op = [a1, a2](int32_t x) -> int32_t {
-        if (a2 < a1) {
-          return x - 1;
-        } else {
-          return x + 1;
-        }
-      };
+  auto firstRow = std::max(0, static_cast<int32_t>(std::ceil(minY - EPSILON)));
+  auto lastRow =
+    std::min(
+        static_cast<int32_t>(size.y) - 1
+      , static_cast<int32_t>(std::floor(maxY + EPSILON))
+    );
+
+  struct Crossing {
+    float x;
+    int8_t winding;
+  };
+
+  std::vector<Crossing> crossings;
+  std::vector<std::pair<float, float>> intervals;
+
+  for (int32_t y = firstRow; y <= lastRow; ++y) {
+    float fy = static_cast<float>(y);
+    crossings.clear();
+    intervals.clear();
+
+    for (size_t i = 0; i < points.size(); ++i) {
+      auto& a = points[i == 0 ? points.size() - 1 : i - 1];
+      auto& b = points[i];
+      auto edgeMinY = std::min(a.y, b.y);
+      auto edgeMaxY = std::max(a.y, b.y);
+
+      if (fy < edgeMinY - EPSILON || fy > edgeMaxY + EPSILON) {
+        continue;
+      }
 
-      auto check = [a1, a2](int32_t x) -> bool {
-        if (a2 < a1) {
-          return x >= (a2 - a1);
-        } else {
-          return x <= (a2 - a1);
-        }
-      };
+      // borders belong to the polygon, including horizontal ones and tips
+      if (edgeMaxY - edgeMinY < EPSILON) {
+        intervals.emplace_back(std::min(a.x, b.x), std::max(a.x, b.x));
+        continue;
+      }
 
-      T pt;
-      for (int32_t x = 0; check(x); x = op(x)) {
-        pt.x = a1 + x;
-        pt.y = b1 + static_cast<T::value_type>(std::round(m * x));
+      float x = a.x + (fy - a.y) * (b.x - a.x) / (b.y - a.y);
+      intervals.emplace_back(x, x);
 
-        if (switchAxis) {
-          auto t = pt.x;
-          pt.x = pt.y;
-          pt.y = t;
-        }
+      // half-open, so shared vertices are counted once
+      if (fy >= edgeMinY && fy < edgeMaxY) {
+        crossings.push_back(Crossing {x, static_cast<int8_t>(b.y > a.y ? 1 : -1)});
+      }
+    }
 
-        if (pt.y >= 0 && pt.y < static_cast<decltype(pt.x)>(size.y)
-            && pt.x >= 0 && pt.x < static_cast<decltype(pt.x)>(size.x)) {
-          field[pt.y * size.x + pt.x] = 2;
-        }
+    std::sort(
+        crossings.begin()
+      , crossings.end()
+      , [](const Crossing& a, const Crossing& b) { return a.x < b.x; }
+    );
+
+    int32_t winding = 0;
+    for (size_t i = 0; i + 1 < crossings.size(); ++i) {
+      winding += fillRule == FillRule::EVEN_ODD ? 1 : crossings[i].winding;
+
+      bool inside =
+        fillRule == FillRule::EVEN_ODD
+          ? (winding & 1) != 0
+          : winding != 0;
+      if (inside) {
+        intervals.emplace_back(crossings[i].x, crossings[i + 1].x);
       }
-    };
+    }
 
-    auto ptC1x = static_cast<int32_t>(ptC1.x);
-    auto ptC1y = static_cast<int32_t>(ptC1.y);
-    auto ptC2x = static_cast<int32_t>(ptC2.x);
-    auto ptC2y = static_cast<int32_t>(ptC2.y);
+    std::sort(intervals.begin(), intervals.end());
 
-    auto dy = std::abs(ptC2y - ptC1y);
-    auto dx = std::abs(ptC2x - ptC1x);
+    auto rowStart = spans.size();
+    for (auto& interval : intervals) {
+      auto x0 = std::max(0, static_cast<int32_t>(std::ceil(interval.first - EPSILON)));
+      auto x1 =
+        std::min(
+            static_cast<int32_t>(size.x)
+          , static_cast<int32_t>(std::floor(interval.second + EPSILON)) + 1
+        );
 
-    if (dy > dx) {
-      drawBorder(ptC1y, ptC2y, ptC1x, ptC2x, true);
-    } else {
-      drawBorder(ptC1x, ptC2x, ptC1y, ptC2y, false);
+      if (x0 >= x1) {
+        continue;
+      }
+
+      if (spans.size() > rowStart && spans.back().x1 >= x0) {
+        spans.back().x1 = std::max(spans.back().x1, x1);
+      } else {
+        spans.push_back(Span {y, x0, x1});
+      }
     }
   }
 
-  // scan line
-#pragma omp parallel num_threads(2)
-  {
-    TRACY(ZoneScoped);
-#pragma omp for
-    for (size_t y = 0; y < size.y; ++y) {
-      uint8_t lastValue = 0;
-      size_t startX = 0;
-
-      for (size_t x = 0; x < size.x; ++x) {
-        auto value = field[y * size.x + x];
-        if (lastValue == 2 && value == 0 && startX == 0) {
-          startX = x;
-        } else if (lastValue == 2 && value == 0 && startX > 0) {
-          for (size_t xb = startX; xb < x; ++xb) {
-            field[y * size.x + xb] = 1;
-          }
-          startX = 0;
+  return spans;
+}
+
+inline bool isPointInSpans(const std::vector<Span>& spans, Point pt) {
+  auto it =
+    std::upper_bound(
+        spans.cbegin()
+      , spans.cend()
+      , pt
+      , [](const Point& pt, const Span& span) {
+          return pt.y < span.y || (pt.y == span.y && pt.x < span.x0);
         }
+    );
 
-        lastValue = value;
-      }
-    }
+  if (it == spans.cbegin()) {
+    return false;
   }
 
-  return field;
+  --it;
+  return it->y == pt.y && pt.x >= it->x0 && pt.x < it->x1;
 }
 
-float interpolateVertexTriangle(
-    const glm::vec3& v1
-  , const glm::vec3& v2
-  , const glm::vec3& v3
-  , const glm::vec2& pos
+template <typename T>
+std::vector<uint8_t> getPointsInPolygon(
+    Size size
+  , const std::vector<T>& polygonVertices
+  , const glm::mat4& conversionMatrix
 ) {
-  glm::vec3 u {v2.x - v1.x, v2.y - v1.y, v2.z - v1.z};
-  glm::vec3 v {v3.x - v1.x, v3.y - v1.y, v3.z - v1.z};
+  TRACY(ZoneScoped);
 
-  auto c = glm::cross(u, v);
-  if (c.y == 0.0f) {
-    return v1.y;
+  std::vector<uint8_t> field;
+  field.resize(size.x * size.y);
+
+  for (auto& span : getPolygonSpans(size, polygonVertices, conversionMatrix)) {
+    std::fill(
+        field.begin() + span.y * size.x + span.x0
+      , field.begin() + span.y * size.x + span.x1
+      , 1
+    );
   }
 
-  return v1.y - (c.x * (pos.x - v1.x) + c.z * (pos.y - v1.z)) / c.y;
+  return field;
 }
 
 }
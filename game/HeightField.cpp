@@ -0,0 +1,497 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "HeightField.h"
+
+namespace ZH {
+
+// Tile corners are
+//   0 1
+//   2 3
+// with the diagonal 0-3, or 1-2 for flipped tiles.
+static float interpolateTile(const glm::vec4& h, bool flipped, float fx, float fy) {
+  if (flipped) {
+    if (fx + fy < 1.0f) {
+      return h[0] + fx * (h[1] - h[0]) + fy * (h[2] - h[0]);
+    } else {
+      return h[3] - (1.0f - fx) * (h[3] - h[2]) - (1.0f - fy) * (h[3] - h[1]);
+    }
+  } else {
+    if (fx > fy) {
+      return h[0] + fx * (h[1] - h[0]) + fy * (h[3] - h[1]);
+    } else {
+      return h[0] + fy * (h[2] - h[0]) + fx * (h[3] - h[2]);
+    }
+  }
+}
+
+static std::optional<float> intersectTriangle(
+    const glm::vec3& origin
+  , const glm::vec3& direction
+  , const glm::vec3& v0
+  , const glm::vec3& v1
+  , const glm::vec3& v2
+) {
+  // tolerance for rays hitting shared edges
+  constexpr float EDGE_EPSILON = 0.00001f;
+
+  auto e1 = v1 - v0;
+  auto e2 = v2 - v0;
+  auto p = glm::cross(direction, e2);
+  auto det = glm::dot(e1, p);
+  if (std::abs(det) < 1e-12f) {
+    return {};
+  }
+
+  auto invDet = 1.0f / det;
+  auto s = origin - v0;
+  auto u = glm::dot(s, p) * invDet;
+  if (u < -EDGE_EPSILON || u > 1.0f + EDGE_EPSILON) {
+    return {};
+  }
+
+  auto q = glm::cross(s, e1);
+  auto v = glm::dot(direction, q) * invDet;
+  if (v < -EDGE_EPSILON || u + v > 1.0f + EDGE_EPSILON) {
+    return {};
+  }
+
+  auto t = glm::dot(e2, q) * invDet;
+  if (t < 0.0f) {
+    return {};
+  }
+
+  return t;
+}
+
+HeightField::HeightField(
+    Size size
+  , float gridScale
+  , std::vector<glm::vec4>&& tileHeights
+  , std::vector<uint8_t>&& flippedTiles
+) : size(size)
+  , gridScale(gridScale)
+  , tileHeights(std::move(tileHeights))
+  , flippedTiles(std::move(flippedTiles))
+{
+  TRACY(ZoneScoped);
+
+  preparePyramid();
+}
+
+float HeightField::getHeight(const glm::vec2& pos) const {
+  if (tileHeights.empty()) {
+    return 0.0f;
+  }
+
+  size_t tile = 0;
+  float fx = 0.0f, fy = 0.0f;
+  prepareLookup(pos.x, pos.y, tile, fx, fy);
+
+  return interpolateTile(tileHeights[tile], flippedTiles[tile], fx, fy);
+}
+
+void HeightField::getHeights(
+    std::span<const glm::vec2> positions
+  , std::span<float> heights
+) const {
+  TRACY(ZoneScoped);
+
+  size_t n = std::min(positions.size(), heights.size());
+  if (tileHeights.empty()) {
+    std::fill(heights.begin(), heights.begin() + n, 0.0f);
+    return;
+  }
+
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  auto invScale = _mm_set1_ps(1.0f / gridScale);
+  auto zero = _mm_setzero_ps();
+  auto one = _mm_set1_ps(1.0f);
+  auto maxX = _mm_set1_ps(static_cast<float>(size.x));
+  auto maxY = _mm_set1_ps(static_cast<float>(size.y));
+  auto lastX = _mm_set1_ps(static_cast<float>(size.x - 1));
+  auto lastY = _mm_set1_ps(static_cast<float>(size.y - 1));
+  auto width = _mm_set1_epi32(static_cast<int32_t>(size.x));
+
+  for (; i + 4 <= n; i += 4) {
+    auto src = reinterpret_cast<const float*>(positions.data() + i);
+    auto p01 = _mm_loadu_ps(src);
+    auto p23 = _mm_loadu_ps(src + 4);
+
+    auto gx = _mm_mul_ps(_mm_shuffle_ps(p01, p23, _MM_SHUFFLE(2, 0, 2, 0)), invScale);
+    auto gy = _mm_mul_ps(_mm_shuffle_ps(p01, p23, _MM_SHUFFLE(3, 1, 3, 1)), invScale);
+    gx = _mm_min_ps(_mm_max_ps(gx, zero), maxX);
+    gy = _mm_min_ps(_mm_max_ps(gy, zero), maxY);
+
+    // truncation is floor for non-negative values
+    auto tx = _mm_cvttps_epi32(_mm_min_ps(gx, lastX));
+    auto ty = _mm_cvttps_epi32(_mm_min_ps(gy, lastY));
+    auto fx = _mm_sub_ps(gx, _mm_cvtepi32_ps(tx));
+    auto fy = _mm_sub_ps(gy, _mm_cvtepi32_ps(ty));
+
+    // no 32 bit multiplication in SSE2, but the product fits 16 bit operands
+    auto tile = _mm_add_epi32(_mm_madd_epi16(ty, width), tx);
+    alignas(16) int32_t tiles[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(tiles), tile);
+
+    auto h0 = _mm_loadu_ps(&tileHeights[tiles[0]].x);
+    auto h1 = _mm_loadu_ps(&tileHeights[tiles[1]].x);
+    auto h2 = _mm_loadu_ps(&tileHeights[tiles[2]].x);
+    auto h3 = _mm_loadu_ps(&tileHeights[tiles[3]].x);
+    _MM_TRANSPOSE4_PS(h0, h1, h2, h3);
+
+    auto flipped =
+      _mm_castsi128_ps(
+        _mm_set_epi32(
+            -static_cast<int32_t>(flippedTiles[tiles[3]] != 0)
+          , -static_cast<int32_t>(flippedTiles[tiles[2]] != 0)
+          , -static_cast<int32_t>(flippedTiles[tiles[1]] != 0)
+          , -static_cast<int32_t>(flippedTiles[tiles[0]] != 0)
+        )
+      );
+
+    auto d10 = _mm_sub_ps(h1, h0);
+    auto d20 = _mm_sub_ps(h2, h0);
+    auto d31 = _mm_sub_ps(h3, h1);
+    auto d32 = _mm_sub_ps(h3, h2);
+    auto rx = _mm_sub_ps(one, fx);
+    auto ry = _mm_sub_ps(one, fy);
+
+    // both triangles of both diagonals, then select
+    auto lowerRight = _mm_add_ps(h0, _mm_add_ps(_mm_mul_ps(fx, d10), _mm_mul_ps(fy, d31)));
+    auto upperLeft = _mm_add_ps(h0, _mm_add_ps(_mm_mul_ps(fy, d20), _mm_mul_ps(fx, d32)));
+    auto lowerLeft = _mm_add_ps(h0, _mm_add_ps(_mm_mul_ps(fx, d10), _mm_mul_ps(fy, d20)));
+    auto upperRight = _mm_sub_ps(h3, _mm_add_ps(_mm_mul_ps(rx, d32), _mm_mul_ps(ry, d31)));
+
+    auto isLowerRight = _mm_cmpgt_ps(fx, fy);
+    auto regular =
+      _mm_or_ps(
+          _mm_and_ps(isLowerRight, lowerRight)
+        , _mm_andnot_ps(isLowerRight, upperLeft)
+      );
+
+    auto isLowerLeft = _mm_cmplt_ps(_mm_add_ps(fx, fy), one);
+    auto flippedResult =
+      _mm_or_ps(
+          _mm_and_ps(isLowerLeft, lowerLeft)
+        , _mm_andnot_ps(isLowerLeft, upperRight)
+      );
+
+    auto result =
+      _mm_or_ps(
+          _mm_and_ps(flipped, flippedResult)
+        , _mm_andnot_ps(flipped, regular)
+      );
+
+    _mm_storeu_ps(heights.data() + i, result);
+  }
+#endif
+
+  getHeightsScalar(positions.subspan(i, n - i), heights.subspan(i, n - i));
+}
+
+void HeightField::getHeightsScalar(
+    std::span<const glm::vec2> positions
+  , std::span<float> heights
+) const {
+  for (size_t i = 0; i < positions.size(); ++i) {
+    size_t tile = 0;
+    float fx = 0.0f, fy = 0.0f;
+    prepareLookup(positions[i].x, positions[i].y, tile, fx, fy);
+
+    heights[i] = interpolateTile(tileHeights[tile], flippedTiles[tile], fx, fy);
+  }
+}
+
+std::pair<float, float> HeightField::getHeightRange(
+    const glm::vec2& min
+  , const glm::vec2& max
+) const {
+  // include the neighbours of tile edges hit exactly
+  auto tileMin =
+    Point {
+        static_cast<int32_t>(std::ceil(min.x / gridScale)) - 1
+      , static_cast<int32_t>(std::ceil(min.y / gridScale)) - 1
+    };
+  auto tileMax =
+    Point {
+        static_cast<int32_t>(std::floor(max.x / gridScale)) + 1
+      , static_cast<int32_t>(std::floor(max.y / gridScale)) + 1
+    };
+
+  return getTileHeightRange(tileMin, tileMax);
+}
+
+std::pair<float, float> HeightField::getTileHeightRange(Point min, Point max) const {
+  if (pyramid.empty()) {
+    return std::make_pair(0.0f, 0.0f);
+  }
+
+  auto width = static_cast<int32_t>(size.x);
+  auto height = static_cast<int32_t>(size.y);
+  min.x = std::clamp(min.x, 0, width - 1);
+  min.y = std::clamp(min.y, 0, height - 1);
+  max.x = std::clamp(max.x, min.x + 1, width);
+  max.y = std::clamp(max.y, min.y + 1, height);
+
+  // coarsest level covering the area with at most 4x4 cells
+  auto span = std::max(max.x - min.x, max.y - min.y);
+  size_t level = 0;
+  while (level + 1 < pyramid.size() && (span >> level) > 2) {
+    level += 1;
+  }
+
+  auto& cells = pyramid[level];
+  auto levelWidth = pyramidSizes[level].x;
+
+  float low = std::numeric_limits<float>::max();
+  float high = std::numeric_limits<float>::lowest();
+
+  for (int32_t y = min.y >> level; y <= (max.y - 1) >> level; ++y) {
+    for (int32_t x = min.x >> level; x <= (max.x - 1) >> level; ++x) {
+      auto& cell = cells[y * levelWidth + x];
+      low = std::min(low, cell.x);
+      high = std::max(high, cell.y);
+    }
+  }
+
+  return std::make_pair(low, high);
+}
+
+size_t HeightField::getNumLevels() const {
+  return pyramid.size();
+}
+
+Size HeightField::getSize() const {
+  return size;
+}
+
+std::optional<float> HeightField::intersect(const Ray& ray) const {
+  if (pyramid.empty()) {
+    return {};
+  }
+
+  // in grid units, the ray parameter does not change
+  glm::vec3 origin {ray.origin.x / gridScale, ray.origin.y, ray.origin.z / gridScale};
+  glm::vec3 direction {ray.direction.x / gridScale, ray.direction.y, ray.direction.z / gridScale};
+
+  glm::vec3 invDirection;
+  for (uint8_t i = 0; i < 3; ++i) {
+    invDirection[i] =
+      direction[i] != 0.0f
+        ? 1.0f / direction[i]
+        : std::numeric_limits<float>::max();
+  }
+
+  auto enterCell = [&](size_t level, uint32_t x, uint32_t y) -> std::optional<float> {
+    constexpr float BOX_EPSILON = 0.001f;
+
+    auto& cell = pyramid[level][y * pyramidSizes[level].x + x];
+    glm::vec3 min {
+        static_cast<float>(x << level) - BOX_EPSILON
+      , cell.x - BOX_EPSILON
+      , static_cast<float>(y << level) - BOX_EPSILON
+    };
+    glm::vec3 max {
+        static_cast<float>(std::min((x + 1) << level, size.x)) + BOX_EPSILON
+      , cell.y + BOX_EPSILON
+      , static_cast<float>(std::min((y + 1) << level, size.y)) + BOX_EPSILON
+    };
+
+    float tEnter = 0.0f;
+    float tExit = std::numeric_limits<float>::max();
+    for (uint8_t i = 0; i < 3; ++i) {
+      auto t0 = (min[i] - origin[i]) * invDirection[i];
+      auto t1 = (max[i] - origin[i]) * invDirection[i];
+      tEnter = std::max(tEnter, std::min(t0, t1));
+      tExit = std::min(tExit, std::max(t0, t1));
+    }
+
+    if (tEnter > tExit) {
+      return {};
+    }
+
+    return tEnter;
+  };
+
+  struct Cell {
+    size_t level;
+    uint32_t x;
+    uint32_t y;
+    float tEnter;
+  };
+
+  // every level pushes at most four cells while taking one
+  std::array<Cell, 4 * 32> stack;
+  size_t stackSize = 0;
+  float closest = std::numeric_limits<float>::max();
+
+  auto top = pyramid.size() - 1;
+  if (auto tEnter = enterCell(top, 0, 0)) {
+    stack[stackSize++] = Cell {top, 0, 0, *tEnter};
+  }
+
+  while (stackSize > 0) {
+    auto cell = stack[--stackSize];
+    if (cell.tEnter > closest) {
+      continue;
+    }
+
+    if (cell.level == 0) {
+      auto t = intersectTile(origin, direction, cell.x, cell.y);
+      if (t && *t < closest) {
+        closest = *t;
+      }
+      continue;
+    }
+
+    auto level = cell.level - 1;
+    auto& levelSize = pyramidSizes[level];
+    std::array<Cell, 4> children;
+    size_t numChildren = 0;
+
+    for (uint32_t y = cell.y * 2; y < std::min(cell.y * 2 + 2, levelSize.y); ++y) {
+      for (uint32_t x = cell.x * 2; x < std::min(cell.x * 2 + 2, levelSize.x); ++x) {
+        auto tEnter = enterCell(level, x, y);
+        if (tEnter && *tEnter <= closest) {
+          children[numChildren++] = Cell {level, x, y, *tEnter};
+        }
+      }
+    }
+
+    // far to near, so the nearest is taken first
+    std::sort(
+        children.begin()
+      , children.begin() + numChildren
+      , [](const Cell& a, const Cell& b) { return a.tEnter > b.tEnter; }
+    );
+
+    for (size_t i = 0; i < numChildren; ++i) {
+      stack[stackSize++] = children[i];
+    }
+  }
+
+  if (closest == std::numeric_limits<float>::max()) {
+    return {};
+  }
+
+  return closest;
+}
+
+void HeightField::intersect(
+    std::span<const Ray> rays
+  , std::span<std::optional<float>> results
+) const {
+  TRACY(ZoneScoped);
+
+  int64_t n = std::min(rays.size(), results.size());
+
+#pragma omp parallel for if (n > 64)
+  for (int64_t i = 0; i < n; ++i) {
+    results[i] = intersect(rays[i]);
+  }
+}
+
+std::optional<float> HeightField::intersectTile(
+    const glm::vec3& origin
+  , const glm::vec3& direction
+  , uint32_t x
+  , uint32_t y
+) const {
+  auto tile = y * size.x + x;
+  auto& h = tileHeights[tile];
+
+  glm::vec3 c0 {x,        h[0], y};
+  glm::vec3 c1 {x + 1.0f, h[1], y};
+  glm::vec3 c2 {x,        h[2], y + 1.0f};
+  glm::vec3 c3 {x + 1.0f, h[3], y + 1.0f};
+
+  std::optional<float> t1, t2;
+  if (flippedTiles[tile]) {
+    t1 = intersectTriangle(origin, direction, c0, c1, c2);
+    t2 = intersectTriangle(origin, direction, c2, c1, c3);
+  } else {
+    t1 = intersectTriangle(origin, direction, c0, c1, c3);
+    t2 = intersectTriangle(origin, direction, c0, c3, c2);
+  }
+
+  if (t1 && t2) {
+    return std::min(*t1, *t2);
+  }
+
+  return t1 ? t1 : t2;
+}
+
+void HeightField::prepareLookup(float x, float y, size_t& tile, float& fx, float& fy) const {
+  float gx = std::clamp(x * (1.0f / gridScale), 0.0f, static_cast<float>(size.x));
+  float gy = std::clamp(y * (1.0f / gridScale), 0.0f, static_cast<float>(size.y));
+
+  auto tx = std::min(static_cast<uint32_t>(gx), size.x - 1);
+  auto ty = std::min(static_cast<uint32_t>(gy), size.y - 1);
+
+  tile = ty * size.x + tx;
+  fx = gx - tx;
+  fy = gy - ty;
+}
+
+void HeightField::preparePyramid() {
+  if (size.x == 0 || size.y == 0) {
+    return;
+  }
+
+  auto& base = pyramid.emplace_back();
+  pyramidSizes.push_back(size);
+  base.resize(tileHeights.size());
+
+  for (size_t i = 0; i < tileHeights.size(); ++i) {
+    auto& h = tileHeights[i];
+    base[i] =
+      glm::vec2 {
+          std::min(std::min(h[0], h[1]), std::min(h[2], h[3]))
+        , std::max(std::max(h[0], h[1]), std::max(h[2], h[3]))
+      };
+  }
+
+  while (pyramidSizes.back().x > 1 || pyramidSizes.back().y > 1) {
+    auto previousSize = pyramidSizes.back();
+    auto levelSize = Size {(previousSize.x + 1) / 2, (previousSize.y + 1) / 2};
+
+    std::vector<glm::vec2> level;
+    level.resize(levelSize.x * levelSize.y);
+
+    auto& previous = pyramid.back();
+    for (uint32_t y = 0; y < levelSize.y; ++y) {
+      for (uint32_t x = 0; x < levelSize.x; ++x) {
+        auto& cell = level[y * levelSize.x + x];
+        cell =
+          glm::vec2 {
+              std::numeric_limits<float>::max()
+            , std::numeric_limits<float>::lowest()
+          };
+
+        for (uint32_t sy = y * 2; sy < std::min(y * 2 + 2, previousSize.y); ++sy) {
+          for (uint32_t sx = x * 2; sx < std::min(x * 2 + 2, previousSize.x); ++sx) {
+            auto& source = previous[sy * previousSize.x + sx];
+            cell.x = std::min(cell.x, source.x);
+            cell.y = std::max(cell.y, source.y);
+          }
+        }
+      }
+    }
+
+    pyramid.emplace_back(std::move(level));
+    pyramidSizes.push_back(levelSize);
+  }
+}
+
+}
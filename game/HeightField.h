@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_GAME_HEIGHT_FIELD
+#define H_GAME_HEIGHT_FIELD
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+#include "Dimensions.h"
+
+namespace ZH {
+
+// Resolved corner heights of the tessellated terrain, for lookups
+// without the cliff heuristics. Positions are in game units, heights
+// in height map units, both without the map border offset.
+class HeightField {
+  public:
+    struct Ray {
+      glm::vec3 origin;
+      glm::vec3 direction;
+    };
+
+    HeightField() = default;
+    HeightField(
+        Size size
+      , float gridScale
+      // corners 0..3 of each tile, row-major
+      , std::vector<glm::vec4>&& tileHeights
+      , std::vector<uint8_t>&& flippedTiles
+    );
+
+    float getHeight(const glm::vec2&) const;
+    void getHeights(std::span<const glm::vec2>, std::span<float>) const;
+    // conservative min./max. height of the tiles touching the area
+    std::pair<float, float> getHeightRange(const glm::vec2& min, const glm::vec2& max) const;
+    // same in grid units, max. is exclusive
+    std::pair<float, float> getTileHeightRange(Point min, Point max) const;
+    size_t getNumLevels() const;
+    Size getSize() const;
+    // ray parameter of the closest terrain hit
+    std::optional<float> intersect(const Ray&) const;
+    void intersect(std::span<const Ray>, std::span<std::optional<float>>) const;
+  private:
+    Size size {0, 0};
+    float gridScale = 1.0f;
+    std::vector<glm::vec4> tileHeights;
+    std::vector<uint8_t> flippedTiles;
+
+    // level 0 is per tile, every further level covers 2x2 cells
+    std::vector<std::vector<glm::vec2>> pyramid;
+    std::vector<Size> pyramidSizes;
+
+    void getHeightsScalar(std::span<const glm::vec2>, std::span<float>) const;
+    std::optional<float> intersectTile(
+        const glm::vec3& origin
+      , const glm::vec3& direction
+      , uint32_t x
+      , uint32_t y
+    ) const;
+    void prepareLookup(float x, float y, size_t& tile, float& fx, float& fy) const;
+    void preparePyramid();
+};
+
+}
+
+#endif
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include "JobSystem.h"
+
+namespace ZH {
+
+JobSystem::JobSystem(size_t numWorkers) {
+  workers.reserve(numWorkers);
+
+  for (size_t i = 0; i < numWorkers; ++i) {
+    workers.emplace_back(&JobSystem::work, this);
+  }
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard lock {mutex};
+    stopping = true;
+  }
+  wakeup.notify_all();
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+size_t JobSystem::getNumWorkers() const {
+  return workers.size();
+}
+
+void JobSystem::run(std::vector<Job>& jobs) {
+  if (jobs.empty()) {
+    return;
+  }
+
+  Batch batch;
+  batch.numPending = jobs.size();
+
+  {
+    std::lock_guard lock {mutex};
+    for (auto& job : jobs) {
+      tasks.push_back({&job, &batch});
+    }
+  }
+  wakeup.notify_all();
+
+  std::unique_lock lock {mutex};
+  while (batch.numPending > 0) {
+    if (!tasks.empty()) {
+      auto task = tasks.front();
+      tasks.pop_front();
+
+      lock.unlock();
+      execute(task);
+      lock.lock();
+    } else {
+      done.wait(lock);
+    }
+  }
+}
+
+void JobSystem::execute(Task& task) {
+  (*task.job)();
+
+  if (task.batch->numPending.fetch_sub(1) == 1) {
+    // under the lock, so the waiter cannot miss it or leave early
+    std::lock_guard lock {mutex};
+    done.notify_all();
+  }
+}
+
+void JobSystem::work() {
+  std::unique_lock lock {mutex};
+
+  while (true) {
+    wakeup.wait(lock, [this]() { return stopping || !tasks.empty(); });
+    if (stopping) {
+      return;
+    }
+
+    auto task = tasks.front();
+    tasks.pop_front();
+
+    lock.unlock();
+    execute(task);
+    lock.lock();
+  }
+}
+
+}
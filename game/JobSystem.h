@@ -0,0 +1,53 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_GAME_JOB_SYSTEM
+#define H_GAME_JOB_SYSTEM
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ZH {
+
+// Persistent worker threads for per-frame work. The caller of `run`
+// takes part in the pending jobs until its own batch is done, so
+// jobs may run further batches themselves.
+class JobSystem {
+  public:
+    using Job = std::function<void()>;
+
+    JobSystem(size_t numWorkers);
+    JobSystem(const JobSystem&) = delete;
+    ~JobSystem();
+
+    size_t getNumWorkers() const;
+    // blocks until all jobs have finished
+    void run(std::vector<Job>&);
+  private:
+    struct Batch {
+      std::atomic<size_t> numPending = 0;
+    };
+
+    struct Task {
+      Job* job;
+      Batch* batch;
+    };
+
+    std::vector<std::thread> workers;
+    std::deque<Task> tasks;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable done;
+    bool stopping = false;
+
+    void execute(Task&);
+    void work();
+};
+
+}
+
+#endif
@@ -0,0 +1,336 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_GAME_LOOSE_QUADTREE
+#define H_GAME_LOOSE_QUADTREE
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "common.h"
+#include "gfx/Frustum.h"
+
+namespace ZH {
+
+// Bounding spheres bucketed on the X/Z plane. Every node is loose by
+// half a cell on each side, so an item is stored in the deepest cell
+// of its center the sphere still fits in, and moving it is O(levels).
+// Items outside of the area are kept in the root and always tested.
+template<typename T>
+class LooseQuadtree {
+  public:
+    using Handle = uint32_t;
+
+    struct Hit {
+      T value;
+      float distance;
+    };
+
+    LooseQuadtree() : nodes(1) {}
+    LooseQuadtree(const glm::vec2& min, const glm::vec2& max, float minCellSize)
+      : origin(min)
+      , size(std::max(max.x - min.x, max.y - min.y))
+    {
+      while (numLevels < MAX_LEVELS && size / (1 << numLevels) >= minCellSize) {
+        numLevels += 1;
+      }
+
+      nodes.resize(getLevelOffset(numLevels));
+    }
+
+    Handle insert(T value, const glm::vec3& center, float radius) {
+      Handle handle;
+      if (freeHandles.empty()) {
+        handle = items.size();
+        items.emplace_back();
+      } else {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+      }
+
+      auto& item = items[handle];
+      item.value = value;
+      setSphere(item, center, radius);
+      link(handle, locate(center, radius));
+
+      return handle;
+    }
+
+    void update(Handle handle, const glm::vec3& center, float radius) {
+      auto& item = items[handle];
+      setSphere(item, center, radius);
+
+      auto node = locate(center, radius);
+      if (node != item.node) {
+        unlink(handle);
+        link(handle, node);
+      }
+    }
+
+    void remove(Handle handle) {
+      unlink(handle);
+      freeHandles.push_back(handle);
+    }
+
+    void clear() {
+      for (auto& node : nodes) {
+        node.items.clear();
+        node.numSubtreeItems = 0;
+      }
+
+      items.clear();
+      freeHandles.clear();
+      minY = std::numeric_limits<float>::max();
+      maxY = std::numeric_limits<float>::lowest();
+    }
+
+    size_t getSize() const {
+      return items.size() - freeHandles.size();
+    }
+
+    // items of the cells in view, then their spheres four at a time
+    void query(const GFX::Frustum& frustum, std::vector<T>& results) const {
+      TRACY(ZoneScoped);
+
+      std::vector<const Item*> candidates;
+      std::vector<float> xs, ys, zs, radii;
+      visit(
+          [&frustum](const glm::vec3& min, const glm::vec3& max) {
+            return frustum.isBoxInside(min, max);
+          }
+        , [&](const Item& item) {
+            candidates.push_back(&item);
+            xs.push_back(item.center.x);
+            ys.push_back(item.center.y);
+            zs.push_back(item.center.z);
+            radii.push_back(item.radius);
+          }
+      );
+
+      std::vector<uint8_t> inside(candidates.size());
+      frustum.areSpheresInside(xs, ys, zs, radii, inside);
+
+      for (size_t i = 0; i < candidates.size(); ++i) {
+        if (inside[i]) {
+          results.push_back(candidates[i]->value);
+        }
+      }
+    }
+
+    void query(const glm::vec3& center, float radius, std::vector<T>& results) const {
+      TRACY(ZoneScoped);
+
+      visit(
+          [&center, radius](const glm::vec3& min, const glm::vec3& max) {
+            return glm::length(center - glm::clamp(center, min, max)) <= radius;
+          }
+        , [&center, radius, &results](const Item& item) {
+            if (glm::length(center - item.center) <= radius + item.radius) {
+              results.push_back(item.value);
+            }
+          }
+      );
+    }
+
+    // hits sorted by distance along the normalized direction
+    void intersect(
+        const glm::vec3& rayOrigin
+      , const glm::vec3& direction
+      , std::vector<Hit>& results
+    ) const {
+      TRACY(ZoneScoped);
+
+      auto dir = glm::normalize(direction);
+      auto invDir = 1.0f / dir;
+      auto numBefore = results.size();
+
+      visit(
+          [&rayOrigin, &invDir](const glm::vec3& min, const glm::vec3& max) {
+            // slabs, IEEE infinities handle axis-parallel rays
+            auto t0 = (min - rayOrigin) * invDir;
+            auto t1 = (max - rayOrigin) * invDir;
+            auto tMin = glm::min(t0, t1);
+            auto tMax = glm::max(t0, t1);
+            auto enter = std::max(std::max(tMin.x, tMin.y), tMin.z);
+            auto leave = std::min(std::min(tMax.x, tMax.y), tMax.z);
+
+            return leave >= std::max(enter, 0.0f);
+          }
+        , [&rayOrigin, &dir, &results](const Item& item) {
+            auto toCenter = item.center - rayOrigin;
+            auto along = glm::dot(toCenter, dir);
+            auto distSq = glm::dot(toCenter, toCenter) - along * along;
+            auto radiusSq = item.radius * item.radius;
+            if (distSq > radiusSq) {
+              return;
+            }
+
+            auto halfChord = std::sqrt(radiusSq - distSq);
+            if (along + halfChord < 0.0f) {
+              return;
+            }
+
+            results.push_back({item.value, std::max(along - halfChord, 0.0f)});
+          }
+      );
+
+      std::sort(
+          results.begin() + numBefore
+        , results.end()
+        , [](const Hit& a, const Hit& b) { return a.distance < b.distance; }
+      );
+    }
+  private:
+    static constexpr uint32_t MAX_LEVELS = 10;
+
+    struct Item {
+      T value {};
+      glm::vec3 center {0.0f};
+      float radius = 0.0f;
+      uint32_t node = 0;
+      uint32_t slot = 0;
+    };
+
+    struct Node {
+      std::vector<Handle> items;
+      uint32_t numSubtreeItems = 0;
+    };
+
+    glm::vec2 origin {0.0f};
+    float size = 0.0f;
+    uint32_t numLevels = 1;
+    // level by level, rows of 2^level cells
+    std::vector<Node> nodes;
+    std::vector<Item> items;
+    std::vector<Handle> freeHandles;
+    float minY = std::numeric_limits<float>::max();
+    float maxY = std::numeric_limits<float>::lowest();
+
+    static uint32_t getLevelOffset(uint32_t level) {
+      return ((1u << (2 * level)) - 1) / 3;
+    }
+
+    uint32_t locate(const glm::vec3& center, float radius) const {
+      if (size <= 0.0f) {
+        return 0;
+      }
+
+      auto rel = (glm::vec2 {center.x, center.z} - origin) / size;
+      // also catches NaN
+      if (!(rel.x >= 0.0f && rel.x < 1.0f && rel.y >= 0.0f && rel.y < 1.0f)) {
+        return 0;
+      }
+
+      auto level = numLevels - 1;
+      while (level > 0 && size / (1 << level) < 2.0f * radius) {
+        level -= 1;
+      }
+
+      uint32_t cells = 1 << level;
+      auto x = std::min(static_cast<uint32_t>(rel.x * cells), cells - 1);
+      auto y = std::min(static_cast<uint32_t>(rel.y * cells), cells - 1);
+
+      return getLevelOffset(level) + y * cells + x;
+    }
+
+    void setSphere(Item& item, const glm::vec3& center, float radius) {
+      item.center = center;
+      item.radius = radius;
+
+      // only grows, node boxes stay conservative
+      minY = std::min(minY, center.y - radius);
+      maxY = std::max(maxY, center.y + radius);
+    }
+
+    void link(Handle handle, uint32_t node) {
+      auto& item = items[handle];
+      item.node = node;
+      item.slot = nodes[node].items.size();
+      nodes[node].items.push_back(handle);
+
+      forEachAncestor(node, [this](uint32_t n) { nodes[n].numSubtreeItems += 1; });
+    }
+
+    void unlink(Handle handle) {
+      auto& item = items[handle];
+      auto& nodeItems = nodes[item.node].items;
+
+      auto moved = nodeItems.back();
+      nodeItems[item.slot] = moved;
+      items[moved].slot = item.slot;
+      nodeItems.pop_back();
+
+      forEachAncestor(item.node, [this](uint32_t n) { nodes[n].numSubtreeItems -= 1; });
+    }
+
+    template<typename Fn>
+    void forEachAncestor(uint32_t node, Fn fn) const {
+      uint32_t level = 0;
+      while (getLevelOffset(level + 1) <= node) {
+        level += 1;
+      }
+
+      auto index = node - getLevelOffset(level);
+      auto x = index % (1 << level);
+      auto y = index / (1 << level);
+
+      while (true) {
+        fn(getLevelOffset(level) + y * (1 << level) + x);
+        if (level == 0) {
+          break;
+        }
+
+        level -= 1;
+        x /= 2;
+        y /= 2;
+      }
+    }
+
+    template<typename NodeTest, typename ItemFn>
+    void visit(NodeTest nodeTest, ItemFn itemFn) const {
+      struct Cell {
+        uint32_t level;
+        uint32_t x;
+        uint32_t y;
+      };
+
+      std::vector<Cell> stack {{0, 0, 0}};
+      while (!stack.empty()) {
+        auto cell = stack.back();
+        stack.pop_back();
+
+        auto cells = 1u << cell.level;
+        auto& node = nodes[getLevelOffset(cell.level) + cell.y * cells + cell.x];
+        if (node.numSubtreeItems == 0) {
+          continue;
+        }
+
+        // the root also holds everything outside, so it is never skipped
+        if (cell.level > 0) {
+          auto cellSize = size / cells;
+          auto min = origin + glm::vec2 {cell.x, cell.y} * cellSize - cellSize * 0.5f;
+          auto max = min + cellSize * 2.0f;
+
+          if (!nodeTest(glm::vec3 {min.x, minY, min.y}, glm::vec3 {max.x, maxY, max.y})) {
+            continue;
+          }
+        }
+
+        for (auto handle : node.items) {
+          itemFn(items[handle]);
+        }
+
+        if (cell.level + 1 < numLevels) {
+          for (uint32_t i = 0; i < 4; ++i) {
+            stack.push_back({cell.level + 1, cell.x * 2 + (i & 1), cell.y * 2 + (i >> 1)});
+          }
+        }
+      }
+    }
+};
+
+}
+
+#endif
@@ -32,16 +32,96 @@ Map::Map(MapBuilder& builder)
     );
 
   prepareTextureIndex(builder.textureClasses);
+  prepareChunks();
   tesselateHeightMap(
       builder.textureClasses
     , builder.tileIndices
     , builder.blendTileIndices
     , builder.blendTileInfo
   );
-  prepareWaters(builder.polygonTriggers);
+  prepareHeightField();
+  prepareChunkBounds();
+  prepareTriggerAreas(builder.polygonTriggers);
+  prepareWaters();
 }
 
-void Map::prepareWaters(const std::vector<PolygonTrigger>& polygonTriggers) {
+void Map::prepareChunks() {
+  auto chunksX = (size.x + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  auto chunksY = (size.y + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  chunks.resize(chunksX * chunksY);
+
+  uint32_t firstIndex = 0;
+  for (uint32_t cy = 0; cy < chunksY; ++cy) {
+    for (uint32_t cx = 0; cx < chunksX; ++cx) {
+      auto& chunk = chunks[cy * chunksX + cx];
+      chunk.origin = Point {cx * CHUNK_SIZE, cy * CHUNK_SIZE};
+      chunk.size =
+        Size {
+            std::min(CHUNK_SIZE, size.x - chunk.origin.x)
+          , std::min(CHUNK_SIZE, size.y - chunk.origin.y)
+        };
+      chunk.firstIndex = firstIndex;
+      chunk.numIndices = chunk.size.x * chunk.size.y * 6;
+
+      firstIndex += chunk.numIndices;
+    }
+  }
+}
+
+void Map::prepareChunkBounds() {
+  TRACY(ZoneScoped);
+
+  for (auto& chunk : chunks) {
+    auto range =
+      heightField.getTileHeightRange(
+          chunk.origin
+        , chunk.origin + Point {chunk.size}
+      );
+
+    chunk.boundsMin = glm::vec3 {chunk.origin.x, range.first, chunk.origin.y};
+    chunk.boundsMax =
+      glm::vec3 {
+          chunk.origin.x + chunk.size.x
+        , range.second
+        , chunk.origin.y + chunk.size.y
+      };
+  }
+}
+
+void Map::prepareHeightField() {
+  TRACY(ZoneScoped);
+
+  std::vector<glm::vec4> tileHeights;
+  tileHeights.resize(size.x * size.y);
+  std::vector<uint8_t> flippedTiles;
+  flippedTiles.resize(size.x * size.y);
+
+  auto statesWidthBytes = (size.x + 7) / 8;
+
+  for (size_t y = 0; y < size.y; ++y) {
+    for (size_t x = 0; x < size.x; ++x) {
+      size_t tileIdx = y * size.x + x;
+      size_t baseIdx = tileIdx * 4;
+
+      for (uint8_t i = 0; i < 4; ++i) {
+        tileHeights[tileIdx][i] = verticesAndNormals[baseIdx + i].position.y;
+      }
+
+      flippedTiles[tileIdx] =
+        (flipStates[y * statesWidthBytes + (x >> 3)] & (1 << (x & 0x7))) != 0;
+    }
+  }
+
+  heightField =
+    HeightField {
+        size
+      , GRID_TO_GAME_SCALE
+      , std::move(tileHeights)
+      , std::move(flippedTiles)
+    };
+}
+
+void Map::prepareTriggerAreas(const std::vector<PolygonTrigger>& polygonTriggers) {
   TRACY(ZoneScoped);
 
   glm::mat4 axisFlip {1.0f};
@@ -56,15 +136,32 @@ void Map::prepareWaters(const std::vector<PolygonTrigger>& polygonTriggers) {
       , glm::vec3 {1.0f/GRID_TO_GAME_SCALE, 1.0f, 1.0f/GRID_TO_GAME_SCALE}
     );
 
-  auto waterMatrix =
+  auto triggerMatrix =
     axisFlip
     * scaleMatrix
     * worldOffsetMatrix
     * axisFlip;
 
-  size_t numWaterTiles = 0;
+  triggerAreas.reserve(polygonTriggers.size());
   for (auto& pt : polygonTriggers) {
-    if (!pt.water || pt.points.empty()) {
+    auto& area = triggerAreas.emplace_back();
+    area.id = pt.id;
+    area.name = pt.name;
+    area.water = pt.water;
+    area.spans = getPolygonSpans(size, pt.points, triggerMatrix);
+
+    if (!pt.points.empty()) {
+      area.waterHeight = static_cast<uint16_t>(pt.points[0].z);
+    }
+  }
+}
+
+void Map::prepareWaters() {
+  TRACY(ZoneScoped);
+
+  size_t numWaterTiles = 0;
+  for (auto& area : triggerAreas) {
+    if (!area.water || area.spans.empty()) {
       continue;
     }
 
@@ -72,13 +169,12 @@ void Map::prepareWaters(const std::vector<PolygonTrigger>& polygonTriggers) {
       waterState.resize(size.x * size.y);
     }
 
-    auto waterPoints = getPointsInPolygon(size, pt.points, waterMatrix);
-    auto waterHeight = static_cast<uint16_t>(pt.points[0].z);
+    auto waterHeight = area.waterHeight;
 
-    for (size_t y = 0; y < size.y; ++y) {
-      for (size_t x = 0; x < size.x; ++x) {
-        auto idx = y * size.x + x;
-        if (waterState[idx].depth == 0 && waterPoints[idx] > 0) {
+    for (auto& span : area.spans) {
+      for (int32_t x = span.x0; x < span.x1; ++x) {
+        auto idx = span.y * size.x + x;
+        if (waterState[idx].depth == 0) {
           waterState[idx].depth =
             waterHeight
               - std::min(static_cast<float>(waterHeight), heightMap[idx] * TERRAIN_HEIGHT_SCALE);
@@ -216,6 +312,10 @@ void Map::prepareTextureIndex(std::vector<TextureClass>& textureClasses) {
   }
 }
 
+const std::vector<Map::TerrainChunk>& Map::getChunks() const {
+  return chunks;
+}
+
 const std::vector<uint8_t>& Map::getHeightMap() const {
   return heightMap;
 }
@@ -244,6 +344,20 @@ const glm::mat4& Map::getWorldOffsetMatrix() const {
   return worldOffsetMatrix;
 }
 
+const std::vector<Map::TriggerArea>& Map::getTriggerAreas() const {
+  return triggerAreas;
+}
+
+bool Map::isInTriggerArea(const TriggerArea& area, const glm::vec2& pos) const {
+  auto cell =
+    Point {
+        static_cast<int32_t>(std::floor(pos.x / GRID_TO_GAME_SCALE)) + static_cast<int32_t>(padding)
+      , static_cast<int32_t>(std::floor(pos.y / GRID_TO_GAME_SCALE)) + static_cast<int32_t>(padding)
+    };
+
+  return isPointInSpans(area.spans, cell);
+}
+
 Size Map::getSize() const {
   return size;
 }
@@ -266,6 +380,8 @@ void Map::tesselateHeightMap(
   auto statesLength = statesWidthBytes * size.y;
   flipStates.resize(statesLength);
 
+  auto chunksX = (size.x + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
   auto terrainScaleMatrix =
     glm::scale(
         glm::mat4 {1.0f}
@@ -359,7 +475,10 @@ void Map::tesselateHeightMap(
           flipStates[y * statesWidthBytes + (x >> 3)] |= (1 << (x & 0x7));
         }
 
-        size_t vertexIdx = (y * size.x + x) * 6;
+        auto& chunk = chunks[(y / CHUNK_SIZE) * chunksX + x / CHUNK_SIZE];
+        size_t vertexIdx =
+          chunk.firstIndex
+            + ((y - chunk.origin.y) * chunk.size.x + (x - chunk.origin.x)) * 6;
         vertexIndices[vertexIdx] = baseIdx;
         vertexIndices[vertexIdx + 1] = baseIdx + 1;
 
@@ -485,58 +604,16 @@ void Map::tesselateHeightMap(
   }
 }
 
-float Map::getHeight(const glm::vec2& pos) {
-  size_t x = static_cast<size_t>(pos.x / 10);
-  size_t y = static_cast<size_t>(pos.y / 10);
+float Map::getHeight(const glm::vec2& pos) const {
+  return heightField.getHeight(pos);
+}
 
-  auto statesWidthBytes = (size.x + 7) / 8;
-  auto flipped = flipStates[y * statesWidthBytes + (x >> 3)] & (1 << (x & 0x7));
-
-  auto h0 = getHeight(x, y, 0).first;
-  auto h1 = getHeight(x, y, 1).first;
-  auto h2 = getHeight(x, y, 2).first;
-  auto h3 = getHeight(x, y, 3).first;
-
-  float subX = pos.x - (x * 10.0f);
-  float subY = pos.y - (y * 10.0f);
-
-  if (flipped) {
-    // lower left
-    if (subY < 1.0f - subX) {
-      return interpolateVertexTriangle(
-          glm::vec3 { 0.0f, h0,  0.0f}
-        , glm::vec3 {10.0f, h1,  0.0f}
-        , glm::vec3 { 0.0f, h2, 10.0f}
-        , glm::vec2 {subX, subY}
-      );
-    // upper right
-    } else {
-      return interpolateVertexTriangle(
-          glm::vec3 {10.0f, h1,  0.0f}
-        , glm::vec3 {10.0f, h3, 10.0f}
-        , glm::vec3 { 0.0f, h2, 10.0f}
-        , glm::vec2 {subX, subY}
-      );
-    }
-  } else {
-    // lower right
-    if (subX > subY) {
-      return interpolateVertexTriangle(
-          glm::vec3 { 0.0f, h0,  0.0f}
-        , glm::vec3 {10.0f, h1,  0.0f}
-        , glm::vec3 {10.0f, h3, 10.0f}
-        , glm::vec2 {subX, subY}
-      );
-    // upper left
-    } else {
-      return interpolateVertexTriangle(
-          glm::vec3 { 0.0f, h0,  0.0f}
-        , glm::vec3 { 0.0f, h2, 10.0f}
-        , glm::vec3 {10.0f, h3, 10.0f}
-        , glm::vec2 {subX, subY}
-      );
-    }
-  }
+void Map::getHeights(std::span<const glm::vec2> positions, std::span<float> heights) const {
+  heightField.getHeights(positions, heights);
+}
+
+const HeightField& Map::getHeightField() const {
+  return heightField;
 }
 
 // fields
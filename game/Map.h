@@ -5,6 +5,7 @@
 
 #include <cstdint>
 #include <list>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -12,7 +13,9 @@
 #include "common.h"
 #include "Color.h"
 #include "Dimensions.h"
+#include "Geometry.h"
 #include "formats/Dict.h"
+#include "HeightField.h"
 #include "ResourceLoader.h"
 #include "Script.h"
 #include "inis/TerrainINI.h"
@@ -220,22 +223,48 @@ class Map {
       float surfaceHeight = 0;
     };
 
+    // tiles of a chunk are continuous in the index list,
+    // bounds are in grid coordinates
+    struct TerrainChunk {
+      Point origin;
+      Size size;
+      uint32_t firstIndex = 0;
+      uint32_t numIndices = 0;
+      glm::vec3 boundsMin;
+      glm::vec3 boundsMax;
+    };
+
+    struct TriggerArea {
+      uint32_t id = 0;
+      std::string name;
+      bool water = false;
+      uint16_t waterHeight = 0;
+      std::vector<Span> spans;
+    };
+
     Map(MapBuilder&);
 
-    float getHeight(const glm::vec2&);
+    float getHeight(const glm::vec2&) const;
     std::pair<float, bool> getHeight(size_t, size_t, uint8_t);
+    void getHeights(std::span<const glm::vec2>, std::span<float>) const;
+    const HeightField& getHeightField() const;
     const std::vector<uint8_t>& getHeightMap() const;
+    const std::vector<TerrainChunk>& getChunks() const;
     Size getSize() const;
     const std::vector<std::string>& getTexturesIndex() const;
+    const std::vector<TriggerArea>& getTriggerAreas() const;
     const std::vector<VertexData>& getVertexData() const;
     const std::vector<uint32_t>& getVertexIndices() const;
     const std::vector<WaterState>& getWater() const;
     const std::vector<WaterVertexData>& getWaterVertices() const;
     const glm::mat4& getWorldOffsetMatrix() const;
+    // in map coordinates, as the trigger points
+    bool isInTriggerArea(const TriggerArea&, const glm::vec2&) const;
 
     static constexpr float TERRAIN_HEIGHT_SCALE = 0.625;
     static constexpr float GRID_TO_GAME_SCALE = 10.0f;
     static constexpr float CLIFF_SLOPE = 9.8f;
+    static constexpr uint32_t CHUNK_SIZE = 32;
   private:
     Size size;
     uint32_t padding;
@@ -248,9 +277,16 @@ class Map {
     std::vector<uint32_t> vertexIndices;
     std::vector<WaterState> waterState;
     std::vector<uint8_t> flipStates;
+    std::vector<TerrainChunk> chunks;
+    HeightField heightField;
+    std::vector<TriggerArea> triggerAreas;
 
+    void prepareChunkBounds();
+    void prepareChunks();
+    void prepareHeightField();
     void prepareTextureIndex(std::vector<TextureClass>&);
-    void prepareWaters(const std::vector<PolygonTrigger>&);
+    void prepareTriggerAreas(const std::vector<PolygonTrigger>&);
+    void prepareWaters();
     bool setVertexUV(
         VertexData&
       , uint16_t tileIdx
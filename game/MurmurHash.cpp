@@ -30,14 +30,17 @@ void MurmurHash3_32::feed(uint32_t value) {
 }
 
 void MurmurHash3_32::feed(const std::string& value) {
-  const char* c = value.c_str();
-  size_t b = value.size() / 4;
+  feed(value.c_str(), value.size());
+}
+
+void MurmurHash3_32::feed(const char* c, size_t size) {
+  size_t b = size / 4;
 
   for (size_t i = 0; i < b; ++i) {
     feed(*reinterpret_cast<const uint32_t*>(&c[i * 4]));
   }
 
-  size_t r = value.size() % 4;
+  size_t r = size % 4;
   if (r != 0) {
     uint32_t v = 0;
 
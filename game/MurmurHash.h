@@ -26,6 +26,7 @@ public:
 
   void feed(uint32_t value);
   void feed(const std::string& value);
+  void feed(const char* data, size_t size);
   MurmurHash getHash() const;
 
 private:
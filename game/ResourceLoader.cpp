@@ -104,6 +104,10 @@ MemoryViewStream ResourceLoader::MemoryStream::getStream() const {
   return MemoryViewStream(buffer.data(), buffer.size());
 }
 
+const std::vector<char>& ResourceLoader::MemoryStream::getBuffer() const {
+  return buffer;
+}
+
 size_t ResourceLoader::MemoryStream::size() const {
   return buffer.size();
 }
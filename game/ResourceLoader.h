@@ -32,6 +32,7 @@ class ResourceLoader {
 
       public:
         MemoryViewStream getStream() const;
+        const std::vector<char>& getBuffer() const;
         size_t size() const;
 
       private:
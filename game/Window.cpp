@@ -77,6 +77,10 @@ bool Window::init(Config& config) {
   VkPhysicalDeviceFeatures vkDeviceFeatures = {};
   vkDeviceFeatures.fillModeNonSolid = true;
   vkDeviceFeatures.samplerAnisotropy = true;
+  vkDeviceFeatures.multiDrawIndirect =
+    vuglContext->getVkPhysicalDeviceFeatures().multiDrawIndirect;
+  vkDeviceFeatures.textureCompressionBC =
+    vuglContext->getVkPhysicalDeviceFeatures().textureCompressionBC;
 
   VkPhysicalDeviceExtendedDynamicStateFeaturesEXT dynamicStateFeatures = {};
   dynamicStateFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_FEATURES_EXT;
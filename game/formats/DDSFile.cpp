@@ -1,6 +1,13 @@
 // SPDX-License-Identifier: GPL-2.0
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "../common.h"
 #include "../Logging.h"
@@ -8,7 +15,10 @@
 
 namespace ZH {
 
-DDSFile::DDSFile(std::istream& stream) : stream(stream) {}
+DDSFile::DDSFile(std::istream& stream, bool keepBlocks)
+  : stream(stream)
+  , keepBlocks(keepBlocks)
+{}
 
 #define read4() \
   stream.read(reinterpret_cast<char*>(&buffer4), 4); \
@@ -108,20 +118,48 @@ std::shared_ptr<GFX::HostTexture> DDSFile::getTexture() {
 
   Size size {width, height};
 
+  // DDSD_MIPMAPCOUNT, no more levels than down to 1x1
+  uint32_t numLevels = (flags & 0x20000) ? std::max(mipmaps, 1u) : 1;
+  numLevels = std::min(numLevels, static_cast<uint32_t>(std::bit_width(std::max(width, height))));
+
+  if (keepBlocks) {
+    return readBlocks(size, numLevels, encoding == Encoding::DXT5);
+  }
+
   std::vector<char> data;
-  if (encoding == Encoding::DXT1) {
-    data = decodeDXT1(size);
-  } else if (encoding == Encoding::DXT5) {
-    auto result = decodeDXT5(size);
-    data = std::move(result.first);
-
-    // EVAL Some DDS files (cbsandbw) are technically fully transparent
-    // until the handling of this case has been found, invert the alpha
-    // in such a case
-    if (result.second) {
-      for (size_t i = 3; i < data.size(); i += 4) {
-        data[i] = 0xFF;
+  std::vector<GFX::HostTexture::MipLevel> mipLevels;
+  bool transparent = false;
+
+  auto levelSize = size;
+  for (uint32_t i = 0; i < numLevels; ++i) {
+    std::vector<char> levelData;
+    if (encoding == Encoding::DXT1) {
+      levelData = decodeDXT1(levelSize);
+    } else if (encoding == Encoding::DXT5) {
+      auto result = decodeDXT5(levelSize);
+      levelData = std::move(result.first);
+      transparent = i == 0 ? result.second : transparent;
+    }
+
+    // some files announce more levels than they have
+    if (levelData.empty()) {
+      if (i == 0) {
+        return {};
       }
+      break;
+    }
+
+    mipLevels.push_back({levelSize, data.size()});
+    data.insert(data.end(), levelData.cbegin(), levelData.cend());
+    levelSize = glm::max(levelSize / 2u, Size {1, 1});
+  }
+
+  // EVAL Some DDS files (cbsandbw) are technically fully transparent
+  // until the handling of this case has been found, invert the alpha
+  // in such a case
+  if (transparent) {
+    for (size_t i = 3; i < data.size(); i += 4) {
+      data[i] = 0xFF;
     }
   }
 
@@ -129,6 +167,95 @@ std::shared_ptr<GFX::HostTexture> DDSFile::getTexture() {
       Size {size.x, size.y}
     , ZH::GFX::HostTexture::Format::BGRA8888
     , std::move(data)
+    , std::move(mipLevels)
+  );
+}
+
+static void expandAlpha(std::array<uint8_t, 8>& alpha) {
+  if (alpha[0] > alpha[1]) {
+    alpha[2] = (6 * alpha[0] + alpha[1]) / 7;
+    alpha[3] = (5 * alpha[0] + 2 * alpha[1]) / 7;
+    alpha[4] = (4 * alpha[0] + 3 * alpha[1]) / 7;
+    alpha[5] = (3 * alpha[0] + 4 * alpha[1]) / 7;
+    alpha[6] = (2 * alpha[0] + 5 * alpha[1]) / 7;
+    alpha[7] = (alpha[0] + 6 * alpha[1]) / 7;
+  } else {
+    alpha[2] = (4 * alpha[0] + alpha[1]) / 5;
+    alpha[3] = (3 * alpha[0] + 2 * alpha[1]) / 5;
+    alpha[4] = (2 * alpha[0] + 3 * alpha[1]) / 5;
+    alpha[5] = (alpha[0] + 4 * alpha[1]) / 5;
+    alpha[6] = 0;
+    alpha[7] = 255;
+  }
+}
+
+std::shared_ptr<GFX::HostTexture> DDSFile::readBlocks(Size size, uint32_t numLevels, bool alpha) {
+  size_t blockSize = alpha ? 16 : 8;
+
+  std::vector<char> data;
+  std::vector<GFX::HostTexture::MipLevel> mipLevels;
+
+  auto levelSize = size;
+  for (uint32_t i = 0; i < numLevels; ++i) {
+    size_t numBlocks = ((levelSize.x + 3) / 4) * ((levelSize.y + 3) / 4);
+    size_t offset = data.size();
+    data.resize(offset + numBlocks * blockSize);
+
+    stream.read(data.data() + offset, numBlocks * blockSize);
+    auto numRead = stream.gcount();
+    if (numRead < 0 || static_cast<size_t>(numRead) != numBlocks * blockSize) {
+      if (i == 0) {
+        return {};
+      }
+
+      data.resize(offset);
+      break;
+    }
+
+    mipLevels.push_back({levelSize, offset});
+    levelSize = glm::max(levelSize / 2u, Size {1, 1});
+  }
+
+  if (!alpha) {
+    return std::make_shared<GFX::HostTexture>(
+        size
+      , ZH::GFX::HostTexture::Format::BC1
+      , std::move(data)
+      , std::move(mipLevels)
+    );
+  }
+
+  // same transparency workaround as the decoded path: if no texel
+  // of the top level has any alpha, make every alpha block opaque
+  auto levelEnd = mipLevels.size() > 1 ? mipLevels[1].offset : data.size();
+  uint8_t maxAlphaBits = 0;
+  std::array<uint8_t, 8> palette;
+  for (size_t i = 0; i < levelEnd && maxAlphaBits == 0; i += blockSize) {
+    auto block = reinterpret_cast<const uint8_t*>(data.data() + i);
+    palette[0] = block[0];
+    palette[1] = block[1];
+    expandAlpha(palette);
+
+    uint64_t alphaBytes = 0;
+    std::memcpy(&alphaBytes, block + 2, 6);
+    for (uint8_t j = 0; j < 16; ++j) {
+      maxAlphaBits |= palette[(alphaBytes >> (3 * j)) & 0x7];
+    }
+  }
+
+  if (maxAlphaBits == 0) {
+    for (size_t i = 0; i < data.size(); i += blockSize) {
+      data[i] = 0xFF;
+      data[i + 1] = 0xFF;
+      std::fill(data.begin() + i + 2, data.begin() + i + 8, 0);
+    }
+  }
+
+  return std::make_shared<GFX::HostTexture>(
+      size
+    , ZH::GFX::HostTexture::Format::BC3
+    , std::move(data)
+    , std::move(mipLevels)
   );
 }
 
@@ -144,153 +271,379 @@ std::array<uint8_t, 6> extractColors(const std::array<uint16_t, 2>& borderColors
   return colors;
 }
 
-std::vector<char> DDSFile::decodeDXT1(Size size) {
-  std::vector<char> data;
-  data.resize(size.x * size.y * 4, 0);
+static void writeTexel(uint32_t* destination, Size size, uint32_t x, uint32_t y, uint32_t color) {
+  // levels below 4x4 only use part of the block
+  if (y >= size.y || x >= size.x) {
+    return;
+  }
+
+  destination[size.x * y + x] = color;
+}
 
+// the reference implementation, one block after the other
+static uint8_t decodeRowScalar(
+    const uint8_t* blocks
+  , uint32_t blockY
+  , Size size
+  , bool dxt5
+  , uint32_t* destination
+) {
+  std::array<uint8_t, 8> alpha;
   std::array<uint16_t, 2> borderColors;
-  std::array<uint8_t, 4> block;
   std::array<uint8_t, 6> colors;
+  std::array<uint8_t, 4> block;
+  uint64_t alphaBytes = 0;
+  uint8_t maxAlphaBits = 0;
 
-  for (decltype(size.y) y = 0; y < std::max(size.y / 4, 1u); ++y) {
-    for (decltype(size.x) x = 0; x < std::max(size.x / 4, 1u); ++x) {
-      stream.read(reinterpret_cast<char*>(borderColors.data()), 4);
-      if (stream.gcount() != 4) {
-        return {};
-      }
-
-      stream.read(reinterpret_cast<char*>(block.data()), block.size());
-      if (stream.gcount() != block.size()) {
-        return {};
-      }
+  for (decltype(size.x) x = 0; x < (size.x + 3) / 4; ++x) {
+    if (dxt5) {
+      std::memcpy(alpha.data(), blocks, 2);
+      std::memcpy(&alphaBytes, blocks + 2, 6);
+      expandAlpha(alpha);
+      blocks += 8;
+    }
 
-      colors = extractColors(borderColors);
-      bool col1IsGreater = borderColors[0] > borderColors[1];
-
-      for (uint8_t i = 0; i < 16; ++i) {
-        uint32_t color = 0xFF000000;
-        uint8_t byte = i / 4;
-        uint8_t offset = (i % 4) * 2;
-        uint8_t value = (block[byte] & (0x3 << offset)) >> offset;
-
-        if (value == 0) {
-          color |= (colors[2] << 16) | (colors[1] << 8) | colors[0];
-        } else if (value == 1) {
-          color |= (colors[5] << 16) | (colors[4] << 8) | colors[3];
-        } else if (value == 2) {
-          if (col1IsGreater) {
-            color |= ((colors[2] * 2 + colors[5]) / 3) << 16;
-            color |= ((colors[1] * 2 + colors[4]) / 3) << 8;
-            color |= ((colors[0] * 2 + colors[3]) / 3);
-          } else {
-            color |= ((colors[2] + colors[5]) / 2) << 16;
-            color |= ((colors[1] + colors[4]) / 2) << 8;
-            color |= ((colors[0] + colors[3]) / 2);
-          }
+    std::memcpy(borderColors.data(), blocks, 4);
+    std::memcpy(block.data(), blocks + 4, 4);
+    blocks += 8;
+
+    colors = extractColors(borderColors);
+    bool col1IsGreater = dxt5 || borderColors[0] > borderColors[1];
+
+    for (uint8_t i = 0; i < 16; ++i) {
+      uint32_t color = dxt5 ? 0 : 0xFF000000;
+      uint8_t byte = i / 4;
+      uint8_t offset = (i % 4) * 2;
+      uint8_t value = (block[byte] & (0x3 << offset)) >> offset;
+
+      if (value == 0) {
+        color |= (colors[2] << 16) | (colors[1] << 8) | colors[0];
+      } else if (value == 1) {
+        color |= (colors[5] << 16) | (colors[4] << 8) | colors[3];
+      } else if (value == 2) {
+        if (col1IsGreater) {
+          color |= ((colors[2] * 2 + colors[5]) / 3) << 16;
+          color |= ((colors[1] * 2 + colors[4]) / 3) << 8;
+          color |= ((colors[0] * 2 + colors[3]) / 3);
         } else {
-          if (col1IsGreater) {
-            color |= ((colors[2] + colors[5] * 2) / 3) << 16;
-            color |= ((colors[1] + colors[4] * 2) / 3) << 8;
-            color |= ((colors[0] + colors[3] * 2) / 3);
-          } else {
-            color = 0;
-          }
+          color |= ((colors[2] + colors[5]) / 2) << 16;
+          color |= ((colors[1] + colors[4]) / 2) << 8;
+          color |= ((colors[0] + colors[3]) / 2);
         }
+      } else {
+        if (col1IsGreater) {
+          color |= ((colors[2] + colors[5] * 2) / 3) << 16;
+          color |= ((colors[1] + colors[4] * 2) / 3) << 8;
+          color |= ((colors[0] + colors[3] * 2) / 3);
+        } else {
+          color = 0;
+        }
+      }
 
-        uint8_t row = byte;
-        uint8_t column = i % 4;
-        size_t destination = size.x * (y * 4 + row) + (x * 4 + column);
-        *(reinterpret_cast<uint32_t*>(data.data()) + destination) = color;
+      if (dxt5) {
+        auto alphaValue = alpha[(alphaBytes >> (3 * i)) & 0x7];
+        color |= alphaValue << 24;
+        maxAlphaBits |= alphaValue;
       }
+
+      writeTexel(destination, size, x * 4 + i % 4, blockY * 4 + byte, color);
     }
   }
 
-  return data;
+  return maxAlphaBits;
 }
 
-std::pair<std::vector<char>, bool> DDSFile::decodeDXT5(Size size) {
-  std::vector<char> data;
-  data.resize(size.x * size.y * 4, 0);
+#if defined(__SSE2__)
+static constexpr uint32_t GROUP_SIZE = 8;
 
-  std::array<uint8_t, 8> alpha;
-  std::array<uint16_t, 2> borderColors;
-  std::array<uint8_t, 6> colors;
-  std::array<uint8_t, 4> block;
-  std::array<uint8_t, 6> alphaBlock;
-  uint8_t maxAlphaBits = 0;
+// x / 3 for x < 2^16, as (x * 0xAAAB) >> 17
+static inline __m128i divideBy3(__m128i x) {
+  return _mm_srli_epi16(_mm_mulhi_epu16(x, _mm_set1_epi16(static_cast<short>(0xAAAB))), 1);
+}
 
-  for (decltype(size.y) y = 0; y < std::max(size.y / 4, 1u); ++y) {
-    for (decltype(size.x) x = 0; x < std::max(size.x / 4, 1u); ++x) {
-      stream.read(reinterpret_cast<char*>(alpha.data()), 2);
-      if (stream.gcount() != 2) {
-        return {};
-      }
+// palettes of up to 8 blocks at once, entry k of block b at [k * 8 + b]
+static void buildPalettesSSE2(
+    const uint8_t* blocks
+  , uint32_t numBlocks
+  , bool dxt5
+  , uint32_t* colorPalettes
+  , uint16_t* alphaPalettes
+) {
+  size_t stride = dxt5 ? 16 : 8;
+  size_t colorOffset = dxt5 ? 8 : 0;
+
+  alignas(16) std::array<uint16_t, GROUP_SIZE> ends0 {};
+  alignas(16) std::array<uint16_t, GROUP_SIZE> ends1 {};
+  alignas(16) std::array<uint16_t, GROUP_SIZE> alphas0 {};
+  alignas(16) std::array<uint16_t, GROUP_SIZE> alphas1 {};
+  for (uint32_t b = 0; b < numBlocks; ++b) {
+    auto block = blocks + b * stride;
+    std::memcpy(&ends0[b], block + colorOffset, 2);
+    std::memcpy(&ends1[b], block + colorOffset + 2, 2);
+    alphas0[b] = block[0];
+    alphas1[b] = block[1];
+  }
 
-      stream.read(reinterpret_cast<char*>(alphaBlock.data()), 6);
-      if (stream.gcount() != 6) {
-        return {};
-      }
+  auto c0 = _mm_load_si128(reinterpret_cast<const __m128i*>(ends0.data()));
+  auto c1 = _mm_load_si128(reinterpret_cast<const __m128i*>(ends1.data()));
+  auto mask5 = _mm_set1_epi16(0x1F);
+  auto mask6 = _mm_set1_epi16(0x3F);
 
-      stream.read(reinterpret_cast<char*>(borderColors.data()), 4);
-      if (stream.gcount() != 4) {
-        return {};
-      }
+  __m128i from[3] {
+      _mm_slli_epi16(_mm_and_si128(c0, mask5), 3)
+    , _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(c0, 5), mask6), 2)
+    , _mm_slli_epi16(_mm_srli_epi16(c0, 11), 3)
+  };
+  __m128i to[3] {
+      _mm_slli_epi16(_mm_and_si128(c1, mask5), 3)
+    , _mm_slli_epi16(_mm_and_si128(_mm_srli_epi16(c1, 5), mask6), 2)
+    , _mm_slli_epi16(_mm_srli_epi16(c1, 11), 3)
+  };
 
-      stream.read(reinterpret_cast<char*>(block.data()), block.size());
-      if (stream.gcount() != block.size()) {
-        return {};
-      }
+  // unsigned c0 > c1 picks the four color mode, always on for DXT5
+  auto sign = _mm_set1_epi16(static_cast<short>(0x8000));
+  auto fourColors =
+    dxt5
+      ? _mm_set1_epi16(-1)
+      : _mm_cmpgt_epi16(_mm_xor_si128(c0, sign), _mm_xor_si128(c1, sign));
+
+  __m128i channels[4][3];
+  for (uint8_t c = 0; c < 3; ++c) {
+    auto sum = _mm_add_epi16(from[c], to[c]);
+    auto third2 = divideBy3(_mm_add_epi16(sum, from[c]));
+    auto third3 = divideBy3(_mm_add_epi16(sum, to[c]));
+    auto half = _mm_srli_epi16(sum, 1);
+
+    channels[0][c] = from[c];
+    channels[1][c] = to[c];
+    channels[2][c] =
+      _mm_or_si128(_mm_and_si128(fourColors, third2), _mm_andnot_si128(fourColors, half));
+    channels[3][c] = _mm_and_si128(fourColors, third3);
+  }
 
-      colors = extractColors(borderColors);
-      if (alpha[0] > alpha[1]) {
-        alpha[2] = (6 * alpha[0] + alpha[1]) / 7;
-        alpha[3] = (5 * alpha[0] + 2 * alpha[1]) / 7;
-        alpha[4] = (4 * alpha[0] + 3 * alpha[1]) / 7;
-        alpha[5] = (3 * alpha[0] + 4 * alpha[1]) / 7;
-        alpha[6] = (2 * alpha[0] + 5 * alpha[1]) / 7;
-        alpha[7] = (alpha[0] + 6 * alpha[1]) / 7;
-      } else {
-        alpha[2] = (4 * alpha[0] + alpha[1]) / 5;
-        alpha[3] = (3 * alpha[0] + 2 * alpha[1]) / 5;
-        alpha[4] = (2 * alpha[0] + 3 * alpha[1]) / 5;
-        alpha[5] = (alpha[0] + 4 * alpha[1]) / 5;
-        alpha[6] = 0;
-        alpha[7] = 255;
+  // DXT1 is opaque besides the transparent entry, DXT5 adds its own
+  auto opaque = dxt5 ? _mm_setzero_si128() : _mm_set1_epi16(0xFF);
+  for (uint8_t k = 0; k < 4; ++k) {
+    auto a = k == 3 ? _mm_and_si128(fourColors, opaque) : opaque;
+    auto bg = _mm_or_si128(channels[k][0], _mm_slli_epi16(channels[k][1], 8));
+    auto ra = _mm_or_si128(channels[k][2], _mm_slli_epi16(a, 8));
+
+    auto target = reinterpret_cast<__m128i*>(colorPalettes + k * GROUP_SIZE);
+    _mm_store_si128(target, _mm_unpacklo_epi16(bg, ra));
+    _mm_store_si128(target + 1, _mm_unpackhi_epi16(bg, ra));
+  }
+
+  if (!dxt5) {
+    return;
+  }
+
+  auto a0 = _mm_load_si128(reinterpret_cast<const __m128i*>(alphas0.data()));
+  auto a1 = _mm_load_si128(reinterpret_cast<const __m128i*>(alphas1.data()));
+  auto eightAlphas = _mm_cmpgt_epi16(a0, a1);
+  // x / 7 for x < 1786, x / 5 for x < 1276
+  auto by7 = _mm_set1_epi16(9363);
+  auto by5 = _mm_set1_epi16(13108);
+
+  auto target = reinterpret_cast<__m128i*>(alphaPalettes);
+  _mm_store_si128(target, a0);
+  _mm_store_si128(target + 1, a1);
+  for (int16_t j = 2; j < 8; ++j) {
+    auto seventh =
+      _mm_mulhi_epu16(
+          _mm_add_epi16(
+              _mm_mullo_epi16(a0, _mm_set1_epi16(8 - j))
+            , _mm_mullo_epi16(a1, _mm_set1_epi16(j - 1))
+          )
+        , by7
+      );
+
+    __m128i fifth;
+    if (j < 6) {
+      fifth =
+        _mm_mulhi_epu16(
+            _mm_add_epi16(
+                _mm_mullo_epi16(a0, _mm_set1_epi16(6 - j))
+              , _mm_mullo_epi16(a1, _mm_set1_epi16(j - 1))
+            )
+          , by5
+        );
+    } else {
+      fifth = _mm_set1_epi16(j == 6 ? 0 : 255);
+    }
+
+    _mm_store_si128(
+        target + j
+      , _mm_or_si128(_mm_and_si128(eightAlphas, seventh), _mm_andnot_si128(eightAlphas, fifth))
+    );
+  }
+}
+
+// palette lookups by comparing the indices of a block row against
+// every entry, four texels per register
+static uint8_t decodeRowSSE2(
+    const uint8_t* blocks
+  , uint32_t blockY
+  , Size size
+  , bool dxt5
+  , uint32_t* destination
+) {
+  size_t stride = dxt5 ? 16 : 8;
+  size_t colorOffset = dxt5 ? 8 : 0;
+  uint32_t numBlocks = (size.x + 3) / 4;
+
+  alignas(16) std::array<uint32_t, 4 * GROUP_SIZE> colorPalettes;
+  alignas(16) std::array<uint16_t, 8 * GROUP_SIZE> alphaPalettes;
+
+  __m128i colorKeys[4];
+  for (int32_t k = 0; k < 4; ++k) {
+    colorKeys[k] = _mm_setr_epi32(k, k << 2, k << 4, k << 6);
+  }
+
+  __m128i alphaKeys[8];
+  for (int32_t j = 0; j < 8; ++j) {
+    alphaKeys[j] = _mm_setr_epi32(j, j << 3, j << 6, j << 9);
+  }
+
+  auto colorMask = _mm_setr_epi32(0x3, 0x3 << 2, 0x3 << 4, 0x3 << 6);
+  auto alphaMask = _mm_setr_epi32(0x7, 0x7 << 3, 0x7 << 6, 0x7 << 9);
+  auto alphaBits = _mm_setzero_si128();
+
+  for (uint32_t first = 0; first < numBlocks; first += GROUP_SIZE) {
+    auto numGroupBlocks = std::min(GROUP_SIZE, numBlocks - first);
+    auto group = blocks + first * stride;
+    buildPalettesSSE2(group, numGroupBlocks, dxt5, colorPalettes.data(), alphaPalettes.data());
+
+    for (uint32_t b = 0; b < numGroupBlocks; ++b) {
+      auto block = group + b * stride;
+
+      uint32_t indices = 0;
+      std::memcpy(&indices, block + colorOffset + 4, 4);
+      uint64_t alphaIndices = 0;
+      if (dxt5) {
+        std::memcpy(&alphaIndices, block + 2, 6);
       }
 
-      uint64_t alphaBytes = *reinterpret_cast<uint64_t*>(alphaBlock.data());
-      for (uint8_t i = 0; i < 16; ++i) {
-        uint32_t color = 0;
-        uint8_t byte = i / 4;
-        uint8_t offset = (i % 4) * 2;
-        uint8_t value = (block[byte] & (0x3 << offset)) >> offset;
-
-        if (value == 0) {
-          color |= (colors[2] << 16) | (colors[1] << 8) | colors[0];
-        } else if (value == 1) {
-          color |= (colors[5] << 16) | (colors[4] << 8) | colors[3];
-        } else if (value == 2) {
-          color |= ((colors[2] * 2 + colors[5]) / 3) << 16;
-          color |= ((colors[1] * 2 + colors[4]) / 3) << 8;
-          color |= ((colors[0] * 2 + colors[3]) / 3);
-        } else {
-          color |= ((colors[2] + colors[5] * 2) / 3) << 16;
-          color |= ((colors[1] + colors[4] * 2) / 3) << 8;
-          color |= ((colors[0] + colors[3] * 2) / 3);
+      for (uint32_t row = 0; row < 4; ++row) {
+        auto rowIndices = _mm_set1_epi32((indices >> (8 * row)) & 0xFF);
+        rowIndices = _mm_and_si128(rowIndices, colorMask);
+
+        auto texels = _mm_setzero_si128();
+        for (uint8_t k = 0; k < 4; ++k) {
+          auto match = _mm_cmpeq_epi32(rowIndices, colorKeys[k]);
+          auto color = _mm_set1_epi32(colorPalettes[k * GROUP_SIZE + b]);
+          texels = _mm_or_si128(texels, _mm_and_si128(match, color));
         }
 
-        auto alphaValue = alpha[((alphaBytes & (uint64_t(7) << (3 * i))) >> (3 * i))];
-        color |= alphaValue << 24;
-        maxAlphaBits |= alphaValue;
+        if (dxt5) {
+          auto rowAlphas = _mm_set1_epi32((alphaIndices >> (12 * row)) & 0xFFF);
+          rowAlphas = _mm_and_si128(rowAlphas, alphaMask);
+
+          auto alphas = _mm_setzero_si128();
+          for (uint8_t j = 0; j < 8; ++j) {
+            auto match = _mm_cmpeq_epi32(rowAlphas, alphaKeys[j]);
+            auto alpha = _mm_set1_epi32(alphaPalettes[j * GROUP_SIZE + b]);
+            alphas = _mm_or_si128(alphas, _mm_and_si128(match, alpha));
+          }
+
+          alphaBits = _mm_or_si128(alphaBits, alphas);
+          texels = _mm_or_si128(texels, _mm_slli_epi32(alphas, 24));
+        }
 
-        uint8_t row = byte;
-        uint8_t column = i % 4;
-        size_t destination = size.x * (y * 4 + row) + (x * 4 + column);
-        *(reinterpret_cast<uint32_t*>(data.data()) + destination) = color;
+        auto y = blockY * 4 + row;
+        auto x = (first + b) * 4;
+        if (y >= size.y) {
+          continue;
+        }
+
+        if (x + 4 <= size.x) {
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + size.x * y + x), texels);
+        } else {
+          alignas(16) std::array<uint32_t, 4> partial;
+          _mm_store_si128(reinterpret_cast<__m128i*>(partial.data()), texels);
+          std::copy(partial.cbegin(), partial.cbegin() + (size.x - x), destination + size.x * y + x);
+        }
       }
     }
   }
 
+  alignas(16) std::array<uint32_t, 4> lanes;
+  _mm_store_si128(reinterpret_cast<__m128i*>(lanes.data()), alphaBits);
+
+  return lanes[0] | lanes[1] | lanes[2] | lanes[3];
+}
+#endif
+
+uint8_t DDSFile::decodeBlocks(
+    const char* blocks
+  , Size size
+  , bool dxt5
+  , char* destination
+  , Decoder decoder
+) {
+  TRACY(ZoneScoped);
+
+  auto source = reinterpret_cast<const uint8_t*>(blocks);
+  auto target = reinterpret_cast<uint32_t*>(destination);
+  size_t rowSize = ((size.x + 3) / 4) * (dxt5 ? 16 : 8);
+  int64_t numRows = (size.y + 3) / 4;
+  uint8_t alphaBits = 0;
+
+  if (decoder == Decoder::SCALAR) {
+    for (int64_t y = 0; y < numRows; ++y) {
+      alphaBits |= decodeRowScalar(source + y * rowSize, y, size, dxt5, target);
+    }
+
+    return alphaBits;
+  }
+
+#pragma omp parallel for if (numRows >= 32) reduction(|:alphaBits)
+  for (int64_t y = 0; y < numRows; ++y) {
+#if defined(__SSE2__)
+    alphaBits |= decodeRowSSE2(source + y * rowSize, y, size, dxt5, target);
+#else
+    alphaBits |= decodeRowScalar(source + y * rowSize, y, size, dxt5, target);
+#endif
+  }
+
+  return alphaBits;
+}
+
+std::vector<char> DDSFile::readLevelBlocks(Size size, bool dxt5) {
+  std::vector<char> blocks;
+  blocks.resize(((size.x + 3) / 4) * ((size.y + 3) / 4) * (dxt5 ? 16 : 8));
+
+  stream.read(blocks.data(), blocks.size());
+  auto numRead = stream.gcount();
+  if (numRead < 0 || static_cast<size_t>(numRead) != blocks.size()) {
+    return {};
+  }
+
+  return blocks;
+}
+
+std::vector<char> DDSFile::decodeDXT1(Size size) {
+  auto blocks = readLevelBlocks(size, false);
+  if (blocks.empty()) {
+    return {};
+  }
+
+  std::vector<char> data;
+  data.resize(size.x * size.y * 4, 0);
+  decodeBlocks(blocks.data(), size, false, data.data());
+
+  return data;
+}
+
+std::pair<std::vector<char>, bool> DDSFile::decodeDXT5(Size size) {
+  auto blocks = readLevelBlocks(size, true);
+  if (blocks.empty()) {
+    return {};
+  }
+
+  std::vector<char> data;
+  data.resize(size.x * size.y * 4, 0);
+  auto maxAlphaBits = decodeBlocks(blocks.data(), size, true, data.data());
+
   return {data, maxAlphaBits == 0};
 }
 
@@ -6,6 +6,7 @@
 #include <istream>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "../common.h"
 #include "../gfx/HostTexture.h"
@@ -14,12 +15,32 @@ namespace ZH {
 
 class DDSFile {
   public:
-    DDSFile(std::istream&);
+    // keepBlocks passes DXT data through for GPUs sampling BC formats
+    DDSFile(std::istream&, bool keepBlocks = false);
 
     std::shared_ptr<GFX::HostTexture> getTexture();
+
+    enum class Decoder {
+        SCALAR // one block after the other, for reference
+      , VECTORIZED // SSE2 if available, block rows in parallel
+    };
+
+    // one level of DXT1/DXT5 blocks into BGRA8888, returns all DXT5
+    // alpha values or'ed together
+    static uint8_t decodeBlocks(
+        const char* blocks
+      , Size
+      , bool dxt5
+      , char* destination
+      , Decoder = Decoder::VECTORIZED
+    );
   private:
     std::istream& stream;
+    bool keepBlocks;
+
+    std::shared_ptr<GFX::HostTexture> readBlocks(Size, uint32_t numLevels, bool alpha);
 
+    std::vector<char> readLevelBlocks(Size, bool dxt5);
     std::vector<char> decodeDXT1(Size);
     // if bool is true, the image looks fully transparent
     std::pair<std::vector<char>, bool> decodeDXT5(Size);
@@ -1,6 +1,8 @@
 // SPDX-License-Identifier: GPL-2.0
 
+#include <algorithm>
 #include <array>
+#include <cctype>
 #include <cstdint>
 
 #include <glm/gtc/quaternion.hpp>
@@ -42,9 +44,50 @@ std::vector<std::shared_ptr<W3DModel>> W3DFile::parse() {
     return {};
   }
 
+  assignScreenSizes(models);
+
   return models;
 }
 
+// Each level is shown up to its size, from the size of the next
+// lower one on. Meshes in several levels span all of them.
+void W3DFile::assignScreenSizes(std::vector<std::shared_ptr<W3DModel>>& models) {
+  if (lodArrays.size() < 2) {
+    return;
+  }
+
+  auto toUpper = [](std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), ::toupper);
+    return str;
+  };
+
+  for (auto& model : models) {
+    auto name = toUpper(model->containerName + "." + model->name);
+    bool found = false;
+
+    for (size_t i = 0; i < lodArrays.size(); ++i) {
+      auto& subObjects = lodArrays[i].subObjects;
+      auto lookup =
+        std::find_if(subObjects.cbegin(), subObjects.cend(), [&](const std::string& subObject) {
+          return toUpper(subObject) == name;
+        });
+      if (lookup == subObjects.cend()) {
+        continue;
+      }
+
+      auto minScreenSize = i > 0 ? lodArrays[i - 1].maxScreenSize : 0.0f;
+      if (!found) {
+        model->minScreenSize = minScreenSize;
+        model->maxScreenSize = lodArrays[i].maxScreenSize;
+        found = true;
+      } else {
+        model->minScreenSize = std::min(model->minScreenSize, minScreenSize);
+        model->maxScreenSize = std::max(model->maxScreenSize, lodArrays[i].maxScreenSize);
+      }
+    }
+  }
+}
+
 // TODO: prevent a potential memory overkill over some non-plausible num values
 
 size_t W3DFile::parseNextChunk(std::vector<std::shared_ptr<W3DModel>>& models) {
@@ -94,13 +137,20 @@ size_t W3DFile::parseNextChunk(std::vector<std::shared_ptr<W3DModel>>& models) {
         currentTextureIdx = std::nullopt;
         currentMaterialPassIdx = std::nullopt;
         break;
+      case 0x702: // HLOD level
+        lodArrays.emplace_back();
+        inLODArray = true;
+        break;
+      case 0x705: // HLOD aggregates
+      case 0x706: // HLOD proxies
+        inLODArray = false;
+        break;
       case 0x2A: // vertex materials (subs)
       case 0x30: // textures (subs)
       case 0x48: // texture stage
       case 0x100: // hierarchy tree
       case 0x200: // animations
-      case 0x700: // LOD ff
-      case 0x702:
+      case 0x700: // HLOD
         break;
       default:
         WARN_ZH("W3DFile", "Unknown chunk type 0x{:x}", chunkType);
@@ -130,12 +180,54 @@ size_t W3DFile::parseNextChunk(std::vector<std::shared_ptr<W3DModel>>& models) {
       case 0x202:
       case 0x203:
       case 0x701:
-      case 0x703:
-      case 0x704:
       case 0x740:
         stream.seekg(chunkSize, std::ios::cur);
         totalBytes += chunkSize;
         break;
+      case 0x703: { // HLOD level header
+        if (!inLODArray || lodArrays.empty() || chunkSize < 8) {
+          stream.seekg(chunkSize, std::ios::cur);
+          totalBytes += chunkSize;
+          break;
+        }
+
+        read4()
+        float bufferf = 0.0f;
+        readf()
+        lodArrays.back().maxScreenSize = bufferf;
+
+        stream.seekg(chunkSize - 8, std::ios::cur);
+        totalBytes += chunkSize - 8;
+        break;
+      }
+      case 0x704: { // HLOD level mesh
+        if (!inLODArray || lodArrays.empty() || chunkSize < 36) {
+          stream.seekg(chunkSize, std::ios::cur);
+          totalBytes += chunkSize;
+          break;
+        }
+
+        // bone index
+        read4()
+
+        std::string name(32, '\0');
+        stream.read(name.data(), 32);
+        bytesRead = stream.gcount();
+        totalBytes += bytesRead;
+        if (bytesRead != 32) {
+          return totalBytes;
+        }
+
+        auto nullPos = name.find('\0');
+        if (nullPos != std::string::npos) {
+          name.resize(nullPos);
+        }
+        lodArrays.back().subObjects.emplace_back(std::move(name));
+
+        stream.seekg(chunkSize - 36, std::ios::cur);
+        totalBytes += chunkSize - 36;
+        break;
+      }
       case 0x2:  // vertices
         totalBytes += parseContiguous(model->vertices, chunkSize);
         break;
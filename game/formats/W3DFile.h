@@ -4,6 +4,7 @@
 #define H_W3D_FILE
 
 #include <istream>
+#include <limits>
 #include <optional>
 #include <vector>
 
@@ -44,6 +45,9 @@ struct W3DModel {
   float boundingSphereRadius = 1.0f;
   glm::mat4 transformation {1.0f};
   uint32_t flags = 0;
+  // normalized screen area the HLOD shows the mesh in
+  float minScreenSize = 0.0f;
+  float maxScreenSize = std::numeric_limits<float>::max();
 };
 
 class W3DFile {
@@ -54,6 +58,12 @@ class W3DFile {
       glm::mat4 transformation {1.0f};
     };
 
+    // meshes of one HLOD level, by "CONTAINER.MESH"
+    struct LODArray {
+      float maxScreenSize = std::numeric_limits<float>::max();
+      std::vector<std::string> subObjects;
+    };
+
     W3DFile(std::istream&);
     std::vector<std::shared_ptr<W3DModel>> parse();
   private:
@@ -65,6 +75,11 @@ class W3DFile {
 
     glm::vec3 hierarchyCenter {0.0f, 0.0f, 0.0f};
     std::vector<Pivot> pivots;
+    // lowest detail first
+    std::vector<LODArray> lodArrays;
+    bool inLODArray = false;
+
+    void assignScreenSizes(std::vector<std::shared_ptr<W3DModel>>&);
 
     size_t parseHeader(W3DModel&);
     size_t parseMaterialInfo(W3DModel&);
@@ -29,6 +29,25 @@ const glm::vec3& Camera::getPosition() const {
   return position;
 }
 
+glm::vec3 Camera::getRayDirection(const glm::vec2& screenPos) const {
+  auto inverse = glm::inverse(projectionMatrix * cameraMatrix);
+  auto ndc =
+    glm::vec2 {
+        screenPos.x / settings.width * 2.0f - 1.0f
+      , screenPos.y / settings.height * 2.0f - 1.0f
+    };
+
+  // two depths inside the frustum, independent of the depth range
+  glm::vec4 p0 = inverse * glm::vec4 {ndc.x, ndc.y, 0.0f, 1.0f};
+  glm::vec4 p1 = inverse * glm::vec4 {ndc.x, ndc.y, 1.0f, 1.0f};
+
+  return
+    glm::normalize(
+        glm::vec3 {p1.x, p1.y, p1.z} / p1.w
+      - glm::vec3 {p0.x, p0.y, p0.z} / p0.w
+    );
+}
+
 const glm::vec3& Camera::getUpVector() const {
   return up;
 }
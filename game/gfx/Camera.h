@@ -22,6 +22,8 @@ class Camera {
     const Settings& getPerspectiveSettings() const;
     const glm::mat4& getProjectionMatrix() const;
     const glm::vec3& getPosition() const;
+    // through a pixel of the viewport, starting at the camera position
+    glm::vec3 getRayDirection(const glm::vec2& screenPos) const;
     const glm::vec3& getUpVector() const;
 
     void moveAround(float x, float y, const glm::vec3&);
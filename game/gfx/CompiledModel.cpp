@@ -0,0 +1,297 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <cstring>
+#include <type_traits>
+
+#include "CompiledModel.h"
+
+namespace ZH::GFX {
+
+static const char MAGIC[4] = {'Z', 'H', 'M', 'D'};
+static const uint64_t ALIGNMENT = 16;
+// anything larger is broken
+static const uint64_t MAX_SIZE = 256 * 1024 * 1024;
+
+static_assert(std::is_trivially_copyable_v<Model::VertexData>);
+static_assert(std::is_trivially_copyable_v<CompiledModel::ModelRecord>);
+static_assert(sizeof(CompiledModel::LODRecord) == 16);
+
+static uint64_t align(uint64_t offset) {
+  return (offset + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+template <typename T>
+static bool fits(uint64_t offset, uint64_t count, uint64_t size) {
+  return offset <= size && count <= (size - offset) / sizeof(T);
+}
+
+std::optional<CompiledModel::Models> CompiledModel::read(std::istream& stream, uint32_t sourceHash) {
+  TRACY(ZoneScoped);
+
+  auto header = readHeader(stream);
+  if (!header || header->sourceHash != sourceHash) {
+    return {};
+  }
+
+  std::vector<char> data(header->size);
+  std::memcpy(data.data(), &*header, sizeof(Header));
+  stream.read(data.data() + sizeof(Header), data.size() - sizeof(Header));
+  if (!stream) {
+    return {};
+  }
+
+  uint64_t size = data.size();
+  uint64_t recordsOffset = sizeof(Header);
+  uint64_t texturesOffset = recordsOffset + header->numModels * sizeof(ModelRecord);
+  uint64_t lodsOffset = texturesOffset + header->numTextures * sizeof(TextureRecord);
+  if (!fits<ModelRecord>(recordsOffset, header->numModels, size)
+      || !fits<TextureRecord>(texturesOffset, header->numTextures, size)
+      || !fits<LODRecord>(lodsOffset, header->numLODs, size)) {
+    return {};
+  }
+
+  std::vector<ModelRecord> records(header->numModels);
+  std::memcpy(records.data(), data.data() + recordsOffset, records.size() * sizeof(ModelRecord));
+
+  std::vector<TextureRecord> textureRecords(header->numTextures);
+  std::memcpy(
+      textureRecords.data()
+    , data.data() + texturesOffset
+    , textureRecords.size() * sizeof(TextureRecord)
+  );
+
+  std::vector<LODRecord> lodRecords(header->numLODs);
+  std::memcpy(lodRecords.data(), data.data() + lodsOffset, lodRecords.size() * sizeof(LODRecord));
+
+  std::vector<std::string> textures;
+  textures.reserve(textureRecords.size());
+  for (auto& record : textureRecords) {
+    if (!fits<char>(record.offset, record.length, size)) {
+      return {};
+    }
+
+    textures.emplace_back(data.data() + record.offset, record.length);
+  }
+
+  Models models;
+  models.reserve(records.size());
+
+  for (auto& record : records) {
+    if (!fits<Model::VertexData>(record.vertexOffset, record.numVertices, size)
+        || !fits<uint32_t>(record.indexOffset, record.numIndices, size)
+        || !fits<uint32_t>(record.textureIndexOffset, record.numTextureIndices, size)
+        || record.firstTexture > textures.size()
+        || record.numTextures > textures.size() - record.firstTexture
+        || record.firstLOD > lodRecords.size()
+        || record.numLODs > lodRecords.size() - record.firstLOD) {
+      return {};
+    }
+
+    auto model = std::make_shared<Model>();
+    model->transformation = record.transformation;
+    model->boundingBoxFrom = record.boundingBoxFrom;
+    model->boundingBoxTo = record.boundingBoxTo;
+    model->boundingSphere = record.boundingSphere;
+    model->boundingSphereRadius = record.boundingSphereRadius;
+    model->backfaceCulling = record.flags & FLAG_BACKFACE_CULLING;
+    model->transparent = record.flags & FLAG_TRANSPARENT;
+    model->minScreenSize = record.minScreenSize;
+    model->maxScreenSize = record.maxScreenSize;
+
+    model->vertexData.resize(record.numVertices);
+    std::memcpy(
+        model->vertexData.data()
+      , data.data() + record.vertexOffset
+      , record.numVertices * sizeof(Model::VertexData)
+    );
+
+    model->vertexIndices.resize(record.numIndices);
+    std::memcpy(
+        model->vertexIndices.data()
+      , data.data() + record.indexOffset
+      , record.numIndices * sizeof(uint32_t)
+    );
+
+    model->textureIndices.resize(record.numTextureIndices);
+    std::memcpy(
+        model->textureIndices.data()
+      , data.data() + record.textureIndexOffset
+      , record.numTextureIndices * sizeof(uint32_t)
+    );
+
+    model->textures.assign(
+        textures.cbegin() + record.firstTexture
+      , textures.cbegin() + record.firstTexture + record.numTextures
+    );
+
+    for (uint32_t l = record.firstLOD; l < record.firstLOD + record.numLODs; ++l) {
+      auto& lodRecord = lodRecords[l];
+      if (!fits<uint32_t>(lodRecord.indexOffset, lodRecord.numIndices, size)) {
+        return {};
+      }
+
+      auto& lod = model->lods.emplace_back();
+      lod.error = lodRecord.error;
+      lod.vertexIndices.resize(lodRecord.numIndices);
+      std::memcpy(
+          lod.vertexIndices.data()
+        , data.data() + lodRecord.indexOffset
+        , lodRecord.numIndices * sizeof(uint32_t)
+      );
+    }
+
+    models.emplace_back(std::move(model));
+  }
+
+  return models;
+}
+
+bool CompiledModel::write(std::ostream& stream, uint32_t sourceHash, const Models& models) {
+  TRACY(ZoneScoped);
+
+  uint32_t numTextures = 0;
+  uint32_t numLODs = 0;
+  for (auto& model : models) {
+    numTextures += model->textures.size();
+    numLODs += model->lods.size();
+  }
+
+  // records first, then names, then the aligned arrays
+  uint64_t offset =
+    sizeof(Header)
+      + models.size() * sizeof(ModelRecord)
+      + numTextures * sizeof(TextureRecord)
+      + numLODs * sizeof(LODRecord);
+
+  std::vector<TextureRecord> textureRecords;
+  textureRecords.reserve(numTextures);
+  for (auto& model : models) {
+    for (auto& texture : model->textures) {
+      textureRecords.push_back({offset, static_cast<uint32_t>(texture.size()), 0});
+      offset += texture.size();
+    }
+  }
+
+  std::vector<ModelRecord> records;
+  records.reserve(models.size());
+  std::vector<LODRecord> lodRecords;
+  lodRecords.reserve(numLODs);
+  uint32_t firstTexture = 0;
+
+  for (auto& model : models) {
+    auto& record = records.emplace_back();
+    record.transformation = model->transformation;
+    record.boundingBoxFrom = model->boundingBoxFrom;
+    record.boundingBoxTo = model->boundingBoxTo;
+    record.boundingSphere = model->boundingSphere;
+    record.boundingSphereRadius = model->boundingSphereRadius;
+    record.flags =
+      (model->backfaceCulling ? FLAG_BACKFACE_CULLING : 0)
+        | (model->transparent ? FLAG_TRANSPARENT : 0);
+    record.numVertices = model->vertexData.size();
+    record.numIndices = model->vertexIndices.size();
+    record.numTextureIndices = model->textureIndices.size();
+    record.firstTexture = firstTexture;
+    record.numTextures = model->textures.size();
+    firstTexture += record.numTextures;
+    record.minScreenSize = model->minScreenSize;
+    record.maxScreenSize = model->maxScreenSize;
+    record.firstLOD = lodRecords.size();
+    record.numLODs = model->lods.size();
+
+    record.vertexOffset = offset = align(offset);
+    offset += record.numVertices * sizeof(Model::VertexData);
+    record.indexOffset = offset = align(offset);
+    offset += record.numIndices * sizeof(uint32_t);
+    record.textureIndexOffset = offset = align(offset);
+    offset += record.numTextureIndices * sizeof(uint32_t);
+
+    for (auto& lod : model->lods) {
+      auto& lodRecord = lodRecords.emplace_back();
+      lodRecord.indexOffset = offset = align(offset);
+      lodRecord.numIndices = lod.vertexIndices.size();
+      lodRecord.error = lod.error;
+      offset += lodRecord.numIndices * sizeof(uint32_t);
+    }
+  }
+
+  Header header {};
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.version = VERSION;
+  header.sourceHash = sourceHash;
+  header.numModels = models.size();
+  header.numTextures = numTextures;
+  header.numLODs = numLODs;
+  header.size = offset;
+
+  std::vector<char> data(header.size, 0);
+  auto copy = [&data](uint64_t offset, const void* source, size_t size) {
+    if (size > 0) {
+      std::memcpy(data.data() + offset, source, size);
+    }
+  };
+
+  copy(0, &header, sizeof(Header));
+  copy(sizeof(Header), records.data(), records.size() * sizeof(ModelRecord));
+  copy(
+      sizeof(Header) + records.size() * sizeof(ModelRecord)
+    , textureRecords.data()
+    , textureRecords.size() * sizeof(TextureRecord)
+  );
+  copy(
+      sizeof(Header) + records.size() * sizeof(ModelRecord) + textureRecords.size() * sizeof(TextureRecord)
+    , lodRecords.data()
+    , lodRecords.size() * sizeof(LODRecord)
+  );
+
+  size_t t = 0;
+  for (size_t i = 0; i < models.size(); ++i) {
+    auto& model = models[i];
+    auto& record = records[i];
+
+    for (auto& texture : model->textures) {
+      copy(textureRecords[t++].offset, texture.data(), texture.size());
+    }
+
+    copy(record.vertexOffset, model->vertexData.data(), record.numVertices * sizeof(Model::VertexData));
+    copy(record.indexOffset, model->vertexIndices.data(), record.numIndices * sizeof(uint32_t));
+    copy(record.textureIndexOffset, model->textureIndices.data(), record.numTextureIndices * sizeof(uint32_t));
+
+    for (uint32_t l = 0; l < record.numLODs; ++l) {
+      auto& lodRecord = lodRecords[record.firstLOD + l];
+      copy(lodRecord.indexOffset, model->lods[l].vertexIndices.data(), lodRecord.numIndices * sizeof(uint32_t));
+    }
+  }
+
+  stream.write(data.data(), data.size());
+
+  return static_cast<bool>(stream);
+}
+
+std::optional<CompiledModel::Header> CompiledModel::readHeader(std::istream& stream) {
+  Header header;
+  stream.read(reinterpret_cast<char*>(&header), sizeof(Header));
+
+  if (!stream
+      || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0
+      || header.version != VERSION
+      || header.size < sizeof(Header)
+      || header.size > MAX_SIZE) {
+    return {};
+  }
+
+  return header;
+}
+
+std::vector<CompiledModel::ModelRecord> CompiledModel::readRecords(std::istream& stream, const Header& header) {
+  std::vector<ModelRecord> records(header.numModels);
+  stream.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(ModelRecord));
+
+  if (!stream) {
+    return {};
+  }
+
+  return records;
+}
+
+}
@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_GFX_COMPILED_MODEL
+#define H_GFX_COMPILED_MODEL
+
+#include <istream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+#include "../common.h"
+#include "Model.h"
+
+namespace ZH::GFX {
+
+// Models of one W3D file after conversion and optimization, as flat
+// arrays at aligned offsets behind fixed records, so reading them is
+// copying. Files match their source by a hash of the W3D bytes.
+class CompiledModel {
+  public:
+    // bump on any change of the layout or of the conversion
+    static constexpr uint32_t VERSION = 2;
+    static constexpr const char* EXTENSION = ".zhm";
+
+    using Models = std::vector<std::shared_ptr<Model>>;
+
+    struct Header {
+      char magic[4];
+      uint32_t version;
+      uint32_t sourceHash;
+      uint32_t numModels;
+      uint32_t numTextures;
+      uint32_t numLODs;
+      uint64_t size;
+    };
+
+    struct ModelRecord {
+      glm::mat4 transformation;
+      glm::vec3 boundingBoxFrom;
+      glm::vec3 boundingBoxTo;
+      glm::vec3 boundingSphere;
+      float boundingSphereRadius;
+      uint32_t flags;
+      uint32_t numVertices;
+      uint32_t numIndices;
+      uint32_t numTextureIndices;
+      // range in the texture records
+      uint32_t firstTexture;
+      uint32_t numTextures;
+      float minScreenSize;
+      float maxScreenSize;
+      // range in the LOD records
+      uint32_t firstLOD;
+      uint32_t numLODs;
+      uint64_t vertexOffset;
+      uint64_t indexOffset;
+      uint64_t textureIndexOffset;
+    };
+
+    struct TextureRecord {
+      uint64_t offset;
+      uint32_t length;
+      uint32_t reserved;
+    };
+
+    struct LODRecord {
+      uint64_t indexOffset;
+      uint32_t numIndices;
+      float error;
+    };
+
+    static constexpr uint32_t FLAG_BACKFACE_CULLING = 1;
+    static constexpr uint32_t FLAG_TRANSPARENT = 2;
+
+    // empty for any other version or source
+    static std::optional<Models> read(std::istream&, uint32_t sourceHash);
+    static bool write(std::ostream&, uint32_t sourceHash, const Models&);
+
+    // for inspection, empty if not a compiled model
+    static std::optional<Header> readHeader(std::istream&);
+    static std::vector<ModelRecord> readRecords(std::istream&, const Header&);
+};
+
+}
+
+#endif
@@ -1,5 +1,11 @@
 // SPDX-License-Identifier: GPL-2.0
 
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 #include "Frustum.h"
 #include "../Logging.h"
 
@@ -25,6 +31,74 @@ Frustum::Frustum(const Camera& camera) {
   }
 }
 
+void Frustum::areSpheresInside(
+    std::span<const float> xs
+  , std::span<const float> ys
+  , std::span<const float> zs
+  , std::span<const float> radii
+  , std::span<uint8_t> inside
+) const {
+  size_t n =
+    std::min({xs.size(), ys.size(), zs.size(), radii.size(), inside.size()});
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  __m128 nx[6], ny[6], nz[6], dist[6];
+  for (size_t p = 0; p < 6; ++p) {
+    nx[p] = _mm_set1_ps(planes[p].normal.x);
+    ny[p] = _mm_set1_ps(planes[p].normal.y);
+    nz[p] = _mm_set1_ps(planes[p].normal.z);
+    dist[p] = _mm_set1_ps(planes[p].distance);
+  }
+  auto zero = _mm_setzero_ps();
+
+  for (; i + 4 <= n; i += 4) {
+    auto x = _mm_loadu_ps(xs.data() + i);
+    auto y = _mm_loadu_ps(ys.data() + i);
+    auto z = _mm_loadu_ps(zs.data() + i);
+    auto negRadius = _mm_sub_ps(zero, _mm_loadu_ps(radii.data() + i));
+
+    auto outside = _mm_setzero_ps();
+    for (size_t p = 0; p < 6; ++p) {
+      auto d =
+        _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(nx[p], x), _mm_mul_ps(ny[p], y))
+          , _mm_add_ps(_mm_mul_ps(nz[p], z), dist[p])
+        );
+      outside = _mm_or_ps(outside, _mm_cmplt_ps(d, negRadius));
+    }
+
+    auto mask = _mm_movemask_ps(outside);
+    for (size_t j = 0; j < 4; ++j) {
+      inside[i + j] = (mask & (1 << j)) == 0;
+    }
+  }
+#endif
+
+  for (; i < n; ++i) {
+    inside[i] = isSphereInside(glm::vec3 {xs[i], ys[i], zs[i]}, radii[i]);
+  }
+}
+
+bool Frustum::isBoxInside(const glm::vec3& min, const glm::vec3& max) const {
+  for (size_t i = 0; i < 6; ++i) {
+    auto& normal = planes[i].normal;
+
+    // corner furthest along the plane normal
+    glm::vec3 corner {
+        normal.x >= 0.0f ? max.x : min.x
+      , normal.y >= 0.0f ? max.y : min.y
+      , normal.z >= 0.0f ? max.z : min.z
+    };
+
+    if (glm::dot(normal, corner) + planes[i].distance < 0.0f) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 bool Frustum::isSphereInside(const glm::vec3& position, float radius) const {
   for (size_t i = 0; i < 6; ++i) {
     if (glm::dot(planes[i].normal, position) + planes[i].distance < -radius) {
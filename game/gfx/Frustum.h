@@ -4,6 +4,8 @@
 #define H_GFX_FRUSTRUM
 
 #include <array>
+#include <cstdint>
+#include <span>
 
 #include "Camera.h"
 
@@ -13,7 +15,16 @@ class Frustum {
   public:
     Frustum(const Camera& camera);
 
+    bool isBoxInside(const glm::vec3& min, const glm::vec3& max) const;
     bool isSphereInside(const glm::vec3&, float) const;
+    // spheres as separate coordinate arrays, inside gets 1 or 0
+    void areSpheresInside(
+        std::span<const float> xs
+      , std::span<const float> ys
+      , std::span<const float> zs
+      , std::span<const float> radii
+      , std::span<uint8_t> inside
+    ) const;
   private:
     struct Plane {
       glm::vec3 normal;
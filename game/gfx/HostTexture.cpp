@@ -1,5 +1,8 @@
 // SPDX-License-Identifier: GPL-2.0
 
+#include <algorithm>
+#include <cmath>
+
 #include "HostTexture.h"
 
 namespace ZH::GFX {
@@ -8,6 +11,18 @@ HostTexture::HostTexture (Size size, Format format, std::vector<char>&& data)
   : size(size)
   , format(format)
   , data(std::move(data))
+  , mipLevels({{size, 0}})
+{}
+
+HostTexture::HostTexture (
+    Size size
+  , Format format
+  , std::vector<char>&& data
+  , std::vector<MipLevel>&& mipLevels
+) : size(size)
+  , format(format)
+  , data(std::move(data))
+  , mipLevels(std::move(mipLevels))
 {}
 
 const std::vector<char>& HostTexture::getData() const {
@@ -18,8 +33,115 @@ HostTexture::Format HostTexture::getFormat() const {
   return format;
 }
 
+const std::vector<HostTexture::MipLevel>& HostTexture::getMipLevels() const {
+  return mipLevels;
+}
+
 Size HostTexture::getSize() const {
   return size;
 }
 
+void HostTexture::generateMipLevels() {
+  TRACY(ZoneScoped);
+
+  if (mipLevels.size() != 1
+      || (format != Format::BGRA8888 && format != Format::RGBA8888)) {
+    return;
+  }
+
+  auto levelSize = size;
+  size_t total = 0;
+  while (true) {
+    mipLevels.back().size = levelSize;
+    total += levelSize.x * levelSize.y * 4;
+    if (levelSize.x == 1 && levelSize.y == 1) {
+      break;
+    }
+
+    levelSize = glm::max(levelSize / 2u, Size {1, 1});
+    mipLevels.push_back({levelSize, total});
+  }
+
+  data.resize(total);
+
+  for (size_t i = 1; i < mipLevels.size(); ++i) {
+    auto& src = mipLevels[i - 1];
+    auto& dst = mipLevels[i];
+    auto srcData = reinterpret_cast<const uint8_t*>(data.data() + src.offset);
+    auto dstData = reinterpret_cast<uint8_t*>(data.data() + dst.offset);
+    int64_t dstHeight = dst.size.y;
+
+    // each level depends on the one before, rows of a level do not
+#pragma omp parallel for if (dst.size.x * dst.size.y >= 128 * 128)
+    for (int64_t y = 0; y < dstHeight; ++y) {
+      // odd sizes clamp at the last texel
+      auto y0 = std::min<uint32_t>(y * 2, src.size.y - 1);
+      auto y1 = std::min<uint32_t>(y * 2 + 1, src.size.y - 1);
+
+      for (uint32_t x = 0; x < dst.size.x; ++x) {
+        auto x0 = std::min<uint32_t>(x * 2, src.size.x - 1);
+        auto x1 = std::min<uint32_t>(x * 2 + 1, src.size.x - 1);
+
+        for (uint8_t c = 0; c < 4; ++c) {
+          uint32_t sum =
+              srcData[(y0 * src.size.x + x0) * 4 + c]
+            + srcData[(y0 * src.size.x + x1) * 4 + c]
+            + srcData[(y1 * src.size.x + x0) * 4 + c]
+            + srcData[(y1 * src.size.x + x1) * 4 + c];
+          dstData[(y * dst.size.x + x) * 4 + c] = (sum + 2) / 4;
+        }
+      }
+    }
+  }
+}
+
+std::shared_ptr<HostTexture> HostTexture::resampled(Size targetSize) const {
+  TRACY(ZoneScoped);
+
+  if (format != Format::BGRA8888 && format != Format::RGBA8888) {
+    return {};
+  }
+
+  if (targetSize == size) {
+    std::vector<char> copy {data.cbegin(), data.cbegin() + size.x * size.y * 4};
+    return std::make_shared<HostTexture>(size, format, std::move(copy));
+  }
+
+  std::vector<char> target(targetSize.x * targetSize.y * 4);
+  auto srcData = reinterpret_cast<const uint8_t*>(data.data());
+  auto dstData = reinterpret_cast<uint8_t*>(target.data());
+  auto scaleX = size.x / static_cast<float>(targetSize.x);
+  auto scaleY = size.y / static_cast<float>(targetSize.y);
+  int64_t dstHeight = targetSize.y;
+
+#pragma omp parallel for if (targetSize.x * targetSize.y >= 128 * 128)
+  for (int64_t y = 0; y < dstHeight; ++y) {
+    // texel centers, clamped at the edges
+    auto srcY = std::clamp((y + 0.5f) * scaleY - 0.5f, 0.0f, size.y - 1.0f);
+    auto y0 = static_cast<uint32_t>(srcY);
+    auto y1 = std::min(y0 + 1, size.y - 1);
+    auto fy = srcY - y0;
+
+    for (uint32_t x = 0; x < targetSize.x; ++x) {
+      auto srcX = std::clamp((x + 0.5f) * scaleX - 0.5f, 0.0f, size.x - 1.0f);
+      auto x0 = static_cast<uint32_t>(srcX);
+      auto x1 = std::min(x0 + 1, size.x - 1);
+      auto fx = srcX - x0;
+
+      for (uint8_t c = 0; c < 4; ++c) {
+        auto top =
+          srcData[(y0 * size.x + x0) * 4 + c] * (1.0f - fx)
+            + srcData[(y0 * size.x + x1) * 4 + c] * fx;
+        auto bottom =
+          srcData[(y1 * size.x + x0) * 4 + c] * (1.0f - fx)
+            + srcData[(y1 * size.x + x1) * 4 + c] * fx;
+        dstData[(y * targetSize.x + x) * 4 + c] =
+          static_cast<uint8_t>(std::lround(top * (1.0f - fy) + bottom * fy));
+      }
+    }
+  }
+
+  return std::make_shared<HostTexture>(targetSize, format, std::move(target));
+}
+
 }
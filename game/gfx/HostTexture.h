@@ -3,6 +3,7 @@
 #ifndef H_GFX_HOST_TEXTURE
 #define H_GFX_HOST_TEXTURE
 
+#include <memory>
 #include <vector>
 
 #include "../common.h"
@@ -15,17 +16,34 @@ class HostTexture {
     enum class Format {
         BGRA8888
       , RGBA8888
+      // raw 4x4 blocks, DXT1 and DXT5
+      , BC1
+      , BC3
+    };
+
+    // byte offset into data, levels stored largest first
+    struct MipLevel {
+      Size size;
+      size_t offset;
     };
 
     HostTexture (Size, Format, std::vector<char>&&);
+    HostTexture (Size, Format, std::vector<char>&&, std::vector<MipLevel>&&);
 
     Size getSize() const;
     Format getFormat() const;
     const std::vector<char>& getData() const;
+    const std::vector<MipLevel>& getMipLevels() const;
+
+    // box filtered down to 1x1, uncompressed single level textures only
+    void generateMipLevels();
+    // bilinear copy of the top level, empty for compressed textures
+    std::shared_ptr<HostTexture> resampled(Size) const;
   private:
     Size size;
     Format format;
     std::vector<char> data;
+    std::vector<MipLevel> mipLevels;
 };
 
 }
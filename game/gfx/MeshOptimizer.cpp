@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <unordered_map>
+
+#include "../common.h"
+#include "MeshOptimizer.h"
+
+namespace ZH::GFX {
+
+static constexpr size_t CACHE_SIZE = 32;
+static constexpr float CACHE_DECAY_POWER = 1.5f;
+static constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+static constexpr float VALENCE_BOOST_SCALE = 2.0f;
+static constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+static float getVertexScore(int32_t cachePosition, uint32_t numRemaining) {
+  if (numRemaining == 0) {
+    return -1.0f;
+  }
+
+  float score = 0.0f;
+  if (cachePosition >= 0) {
+    // the last triangle's vertices get the same fixed score, so
+    // its direct neighbors are not preferred over others
+    if (cachePosition < 3) {
+      score = LAST_TRIANGLE_SCORE;
+    } else {
+      auto scaler = 1.0f / (CACHE_SIZE - 3);
+      score = std::pow(1.0f - (cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+    }
+  }
+
+  // few remaining triangles are worth finishing off
+  score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(numRemaining), -VALENCE_BOOST_POWER);
+
+  return score;
+}
+
+std::vector<uint32_t> getVertexCacheOrder(const std::vector<uint32_t>& indices, size_t numVertices) {
+  TRACY(ZoneScoped);
+
+  auto numTriangles = indices.size() / 3;
+  std::vector<uint32_t> order(numTriangles);
+  std::iota(order.begin(), order.end(), 0);
+
+  for (size_t i = 0; i < numTriangles * 3; ++i) {
+    if (indices[i] >= numVertices) {
+      return order;
+    }
+  }
+
+  // triangles still to emit per vertex, as ranges into one list
+  std::vector<uint32_t> numRemaining(numVertices, 0);
+  for (size_t i = 0; i < numTriangles * 3; ++i) {
+    numRemaining[indices[i]] += 1;
+  }
+
+  std::vector<uint32_t> offsets(numVertices + 1, 0);
+  for (size_t v = 0; v < numVertices; ++v) {
+    offsets[v + 1] = offsets[v] + numRemaining[v];
+  }
+
+  std::vector<uint32_t> triangleLists(numTriangles * 3);
+  {
+    auto cursors = offsets;
+    for (size_t i = 0; i < numTriangles * 3; ++i) {
+      triangleLists[cursors[indices[i]]++] = i / 3;
+    }
+  }
+
+  std::vector<int32_t> cachePositions(numVertices, -1);
+  std::vector<float> vertexScores(numVertices);
+  for (size_t v = 0; v < numVertices; ++v) {
+    vertexScores[v] = getVertexScore(-1, numRemaining[v]);
+  }
+
+  std::vector<float> triangleScores(numTriangles);
+  std::vector<bool> emitted(numTriangles, false);
+  int64_t bestTriangle = -1;
+  float bestScore = -1.0f;
+
+  for (size_t t = 0; t < numTriangles; ++t) {
+    triangleScores[t] =
+      vertexScores[indices[t * 3]]
+        + vertexScores[indices[t * 3 + 1]]
+        + vertexScores[indices[t * 3 + 2]];
+
+    if (triangleScores[t] > bestScore) {
+      bestScore = triangleScores[t];
+      bestTriangle = t;
+    }
+  }
+
+  std::vector<uint32_t> cache;
+  std::vector<uint32_t> newCache;
+  cache.reserve(CACHE_SIZE + 3);
+  newCache.reserve(CACHE_SIZE + 3);
+  size_t nextCandidate = 0;
+
+  for (size_t n = 0; n < numTriangles; ++n) {
+    // nothing left in the cache, continue anywhere
+    if (bestTriangle < 0) {
+      while (emitted[nextCandidate]) {
+        nextCandidate += 1;
+      }
+      bestTriangle = nextCandidate;
+    }
+
+    auto triangle = static_cast<uint32_t>(bestTriangle);
+    order[n] = triangle;
+    emitted[triangle] = true;
+
+    newCache.clear();
+    for (size_t j = 0; j < 3; ++j) {
+      auto vertex = indices[triangle * 3 + j];
+      // degenerate triangles list a vertex more than once
+      if (std::find(newCache.cbegin(), newCache.cend(), vertex) == newCache.cend()) {
+        newCache.push_back(vertex);
+      }
+
+      auto begin = triangleLists.begin() + offsets[vertex];
+      auto end = begin + numRemaining[vertex];
+      auto found = std::find(begin, end, triangle);
+      std::iter_swap(found, end - 1);
+      numRemaining[vertex] -= 1;
+    }
+
+    auto numNew = newCache.size();
+    for (auto vertex : cache) {
+      if (std::find(newCache.cbegin(), newCache.cbegin() + numNew, vertex) == newCache.cbegin() + numNew) {
+        newCache.push_back(vertex);
+      }
+    }
+
+    for (size_t i = 0; i < newCache.size(); ++i) {
+      auto vertex = newCache[i];
+      cachePositions[vertex] = i < CACHE_SIZE ? static_cast<int32_t>(i) : -1;
+      vertexScores[vertex] = getVertexScore(cachePositions[vertex], numRemaining[vertex]);
+    }
+
+    // only triangles around cached vertices change their score
+    bestTriangle = -1;
+    bestScore = -1.0f;
+    for (auto vertex : newCache) {
+      auto begin = triangleLists.begin() + offsets[vertex];
+      auto end = begin + numRemaining[vertex];
+
+      for (auto it = begin; it != end; ++it) {
+        auto t = *it;
+        triangleScores[t] =
+          vertexScores[indices[t * 3]]
+            + vertexScores[indices[t * 3 + 1]]
+            + vertexScores[indices[t * 3 + 2]];
+
+        if (triangleScores[t] > bestScore) {
+          bestScore = triangleScores[t];
+          bestTriangle = t;
+        }
+      }
+    }
+
+    if (newCache.size() > CACHE_SIZE) {
+      newCache.resize(CACHE_SIZE);
+    }
+    std::swap(cache, newCache);
+  }
+
+  return order;
+}
+
+std::vector<uint32_t> getVertexFetchRemap(const std::vector<uint32_t>& indices, size_t numVertices) {
+  constexpr uint32_t UNUSED = UINT32_MAX;
+
+  std::vector<uint32_t> remap(numVertices, UNUSED);
+  uint32_t next = 0;
+
+  for (auto index : indices) {
+    if (index < numVertices && remap[index] == UNUSED) {
+      remap[index] = next++;
+    }
+  }
+
+  for (auto& entry : remap) {
+    if (entry == UNUSED) {
+      entry = next++;
+    }
+  }
+
+  return remap;
+}
+
+float getAverageCacheMissRatio(const std::vector<uint32_t>& indices, size_t cacheSize) {
+  auto numTriangles = indices.size() / 3;
+  if (numTriangles == 0) {
+    return 0.0f;
+  }
+
+  // the time of entering the cache, in cache misses
+  std::unordered_map<uint32_t, size_t> entered;
+  size_t numMisses = 0;
+
+  for (size_t i = 0; i < numTriangles * 3; ++i) {
+    auto lookup = entered.find(indices[i]);
+    if (lookup != entered.cend() && numMisses - lookup->second <= cacheSize) {
+      continue;
+    }
+
+    entered[indices[i]] = numMisses;
+    numMisses += 1;
+  }
+
+  return static_cast<float>(numMisses) / numTriangles;
+}
+
+}
@@ -0,0 +1,25 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_GFX_MESH_OPTIMIZER
+#define H_GFX_MESH_OPTIMIZER
+
+#include <cstdint>
+#include <vector>
+
+namespace ZH::GFX {
+
+// Triangle order for hits in the post-transform vertex cache, after
+// Forsyth's "Linear-Speed Vertex Cache Optimisation". Returns the
+// original triangle indices in their new order.
+std::vector<uint32_t> getVertexCacheOrder(const std::vector<uint32_t>& indices, size_t numVertices);
+
+// Vertex order by first use in the indices, for fetching sequential
+// memory. Returns the new index of each old vertex, unused ones last.
+std::vector<uint32_t> getVertexFetchRemap(const std::vector<uint32_t>& indices, size_t numVertices);
+
+// average transformed vertices per triangle on a FIFO cache, 0.5 to 3
+float getAverageCacheMissRatio(const std::vector<uint32_t>& indices, size_t cacheSize = 16);
+
+}
+
+#endif
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <algorithm>
+#include <limits>
+
+#include "../Logging.h"
+#include "MeshPool.h"
+
+namespace ZH::GFX {
+
+static_assert(sizeof(MeshPool::PackedVertex) == 20);
+
+MeshPool::MeshPool(Vugl::Context& vuglContext, uint32_t binding)
+  : vuglContext(vuglContext)
+  , binding(binding)
+{}
+
+std::vector<MeshPool::Mesh> MeshPool::add(const Model& model) {
+  TRACY(ZoneScoped);
+
+  if (model.vertexData.empty() || model.vertexIndices.empty()) {
+    return {};
+  }
+
+  std::vector<PackedVertex> vertices;
+  vertices.reserve(model.vertexData.size());
+  for (auto& vertex : model.vertexData) {
+    vertices.push_back({
+        vertex.position
+      , glm::packSnorm4x8(glm::vec4 {vertex.normal, 0.0f})
+      , glm::packHalf2x16(vertex.uv)
+    });
+  }
+
+  // all levels one after another
+  std::vector<uint32_t> indices {model.vertexIndices};
+  for (auto& lod : model.lods) {
+    indices.insert(indices.end(), lod.vertexIndices.cbegin(), lod.vertexIndices.cend());
+  }
+
+  // indices are relative to the vertex offset of the mesh
+  bool bigIndex = vertices.size() > std::numeric_limits<uint16_t>::max() + 1u;
+  std::vector<uint16_t> smallIndices;
+  if (!bigIndex) {
+    smallIndices.assign(indices.cbegin(), indices.cend());
+  }
+
+  auto indexBytes = bigIndex ? sizeof(uint32_t) : sizeof(uint16_t);
+  VkDeviceSize vertexSize = vertices.size() * sizeof(PackedVertex);
+  VkDeviceSize indexSize = indices.size() * indexBytes;
+
+  auto block = findBlock(vertexSize, indexSize, bigIndex);
+  if (!block) {
+    return {};
+  }
+
+  auto result =
+    block->pool->write(
+        block->vertexSize
+      , vertices.data()
+      , vertexSize
+      , block->indexSize
+      , bigIndex
+          ? static_cast<const void*>(indices.data())
+          : static_cast<const void*>(smallIndices.data())
+      , indexSize
+    );
+  if (result != VK_SUCCESS || !vuglContext.uploadResource(*block->pool)) {
+    WARN_ZH("MeshPool", "Could not upload mesh");
+    return {};
+  }
+
+  std::vector<Mesh> meshes;
+  meshes.reserve(1 + model.lods.size());
+
+  auto& mesh = meshes.emplace_back();
+  mesh.pool = block->pool.get();
+  mesh.firstIndex = block->indexSize / indexBytes;
+  mesh.numIndices = model.vertexIndices.size();
+  mesh.vertexOffset = block->vertexSize / sizeof(PackedVertex);
+
+  for (auto& lod : model.lods) {
+    auto lodMesh = meshes.back();
+    lodMesh.firstIndex += lodMesh.numIndices;
+    lodMesh.numIndices = lod.vertexIndices.size();
+    lodMesh.error = lod.error;
+    meshes.push_back(lodMesh);
+  }
+
+  block->vertexSize += vertexSize;
+  block->indexSize += indexSize;
+
+  return meshes;
+}
+
+MeshPool::Block* MeshPool::findBlock(VkDeviceSize vertexSize, VkDeviceSize indexSize, bool bigIndex) {
+  for (auto& block : blocks) {
+    if (block.pool->isBigIndex() == bigIndex
+        && block.vertexSize + vertexSize <= block.pool->getVertexCapacity()
+        && block.indexSize + indexSize <= block.pool->getIndexCapacity()) {
+      return &block;
+    }
+  }
+
+  // larger meshes get a block of their own size, the indices
+  // following the vertices need to stay aligned
+  auto& block = blocks.emplace_back();
+  block.pool =
+    std::make_unique<Vugl::ElementPool>(vuglContext.createElementPool(
+        binding
+      , std::max(VERTEX_CAPACITY, (vertexSize + 3) & ~VkDeviceSize {3})
+      , std::max(INDEX_CAPACITY, indexSize)
+      , bigIndex
+    ));
+
+  if (block.pool->getLastResult() != VK_SUCCESS) {
+    blocks.pop_back();
+    return nullptr;
+  }
+
+  return &block;
+}
+
+}
@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_GFX_MESH_POOL
+#define H_GFX_MESH_POOL
+
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "../common.h"
+#include "../vugl/vugl_context.h"
+#include "Model.h"
+
+namespace ZH::GFX {
+
+// Meshes of all models in a few large element pools, with quantized
+// vertices and 16 bit indices where they fit. Like the buffers per
+// mesh before, they are kept until the pool goes away.
+class MeshPool {
+  public:
+    static constexpr VkDeviceSize VERTEX_CAPACITY = 32 * 1024 * 1024;
+    static constexpr VkDeviceSize INDEX_CAPACITY = 16 * 1024 * 1024;
+
+    struct PackedVertex {
+      glm::vec3 position;
+      // xyz as 8 bit snorm
+      uint32_t normal;
+      // two half floats, UVs repeat beyond [0, 1]
+      uint32_t uv;
+    };
+
+    struct Mesh {
+      Vugl::ElementPool* pool = nullptr;
+      uint32_t firstIndex = 0;
+      uint32_t numIndices = 0;
+      int32_t vertexOffset = 0;
+      // of the LOD, in model units
+      float error = 0.0f;
+    };
+
+    MeshPool(Vugl::Context&, uint32_t binding = 0);
+
+    // the full mesh and its LODs, sharing the vertices, empty on failure
+    std::vector<Mesh> add(const Model&);
+  private:
+    struct Block {
+      std::unique_ptr<Vugl::ElementPool> pool;
+      VkDeviceSize vertexSize = 0;
+      VkDeviceSize indexSize = 0;
+    };
+
+    Vugl::Context& vuglContext;
+    uint32_t binding;
+    std::vector<Block> blocks;
+
+    Block* findBlock(VkDeviceSize vertexSize, VkDeviceSize indexSize, bool bigIndex);
+};
+
+}
+
+#endif
@@ -0,0 +1,311 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+#include "../common.h"
+#include "MeshSimplifier.h"
+
+namespace ZH::GFX {
+
+// symmetric 4x4, sum of squared distances to planes
+struct Quadric {
+  double a2 = 0.0, ab = 0.0, ac = 0.0, ad = 0.0;
+  double b2 = 0.0, bc = 0.0, bd = 0.0;
+  double c2 = 0.0, cd = 0.0;
+  double d2 = 0.0;
+
+  void addPlane(const glm::dvec3& n, double d) {
+    a2 += n.x * n.x; ab += n.x * n.y; ac += n.x * n.z; ad += n.x * d;
+    b2 += n.y * n.y; bc += n.y * n.z; bd += n.y * d;
+    c2 += n.z * n.z; cd += n.z * d;
+    d2 += d * d;
+  }
+
+  void add(const Quadric& q) {
+    a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+    b2 += q.b2; bc += q.bc; bd += q.bd;
+    c2 += q.c2; cd += q.cd;
+    d2 += q.d2;
+  }
+
+  double evaluate(const glm::dvec3& p) const {
+    auto result =
+      a2 * p.x * p.x + 2.0 * ab * p.x * p.y + 2.0 * ac * p.x * p.z + 2.0 * ad * p.x
+        + b2 * p.y * p.y + 2.0 * bc * p.y * p.z + 2.0 * bd * p.y
+        + c2 * p.z * p.z + 2.0 * cd * p.z
+        + d2;
+
+    // rounding may drop below
+    return std::max(result, 0.0);
+  }
+};
+
+// same positions get the same group, for seams of split attributes
+static std::vector<uint32_t> getPositionGroups(const std::vector<glm::vec3>& positions, uint32_t& numGroups) {
+  std::vector<uint32_t> order(positions.size());
+  std::iota(order.begin(), order.end(), 0);
+
+  auto less = [&positions](uint32_t a, uint32_t b) {
+    auto& pa = positions[a];
+    auto& pb = positions[b];
+    return pa.x < pb.x || (pa.x == pb.x && (pa.y < pb.y || (pa.y == pb.y && pa.z < pb.z)));
+  };
+  std::sort(order.begin(), order.end(), less);
+
+  std::vector<uint32_t> groups(positions.size());
+  numGroups = 0;
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (i > 0 && less(order[i - 1], order[i])) {
+      numGroups += 1;
+    }
+    groups[order[i]] = numGroups;
+  }
+
+  if (!order.empty()) {
+    numGroups += 1;
+  }
+
+  return groups;
+}
+
+static std::vector<bool> getLockedVertices(
+    const std::vector<glm::vec3>& positions
+  , const std::vector<uint32_t>& indices
+) {
+  uint32_t numGroups = 0;
+  auto groups = getPositionGroups(positions, numGroups);
+
+  std::vector<uint32_t> groupSizes(numGroups, 0);
+  for (auto group : groups) {
+    groupSizes[group] += 1;
+  }
+
+  // edges between positions used once are on a border, more
+  // than twice is not a manifold, both better stay as they are
+  std::unordered_map<uint64_t, uint32_t> edgeUses;
+  for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+    for (size_t j = 0; j < 3; ++j) {
+      auto a = groups[indices[t + j]];
+      auto b = groups[indices[t + (j + 1) % 3]];
+      if (a == b) {
+        continue;
+      }
+
+      edgeUses[(static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b)] += 1;
+    }
+  }
+
+  std::vector<bool> lockedGroups(numGroups, false);
+  for (auto& pair : edgeUses) {
+    if (pair.second != 2) {
+      lockedGroups[pair.first >> 32] = true;
+      lockedGroups[pair.first & 0xFFFFFFFF] = true;
+    }
+  }
+
+  std::vector<bool> locked(positions.size());
+  for (size_t v = 0; v < positions.size(); ++v) {
+    locked[v] = groupSizes[groups[v]] > 1 || lockedGroups[groups[v]];
+  }
+
+  return locked;
+}
+
+// collapsed triangles have two equal corners
+static void removeDegenerate(std::vector<uint32_t>& indices) {
+  size_t end = 0;
+  for (size_t t = 0; t < indices.size(); t += 3) {
+    auto a = indices[t];
+    auto b = indices[t + 1];
+    auto c = indices[t + 2];
+    if (a == b || b == c || a == c) {
+      continue;
+    }
+
+    indices[end++] = a;
+    indices[end++] = b;
+    indices[end++] = c;
+  }
+  indices.resize(end);
+}
+
+static glm::dvec3 getNormal(const glm::dvec3& a, const glm::dvec3& b, const glm::dvec3& c) {
+  return glm::cross(b - a, c - a);
+}
+
+SimplifiedMesh simplifyMesh(
+    const std::vector<glm::vec3>& positions
+  , const std::vector<uint32_t>& indices
+  , size_t targetIndexCount
+  , float maxError
+) {
+  TRACY(ZoneScoped);
+
+  SimplifiedMesh result;
+  result.indices = indices;
+
+  auto numVertices = positions.size();
+  if (indices.size() % 3 != 0
+      || std::any_of(indices.cbegin(), indices.cend(), [numVertices](uint32_t i) { return i >= numVertices; })) {
+    return result;
+  }
+
+  auto locked = getLockedVertices(positions, indices);
+
+  std::vector<Quadric> quadrics(numVertices);
+  for (size_t t = 0; t < indices.size(); t += 3) {
+    glm::dvec3 a {positions[indices[t]]};
+    glm::dvec3 b {positions[indices[t + 1]]};
+    glm::dvec3 c {positions[indices[t + 2]]};
+
+    auto normal = getNormal(a, b, c);
+    auto length = glm::length(normal);
+    if (length == 0.0) {
+      continue;
+    }
+
+    normal /= length;
+    auto d = -glm::dot(normal, a);
+    for (size_t j = 0; j < 3; ++j) {
+      quadrics[indices[t + j]].addPlane(normal, d);
+    }
+  }
+
+  double maxCost = static_cast<double>(maxError) * maxError;
+  double reachedCost = 0.0;
+  auto& current = result.indices;
+  removeDegenerate(current);
+
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> adjacent;
+  std::vector<uint32_t> targets(numVertices);
+  std::vector<double> costs(numVertices);
+  std::vector<uint32_t> candidates;
+  std::vector<bool> touched;
+
+  bool limitReached = false;
+  while (current.size() > targetIndexCount && !limitReached) {
+    // triangles per vertex, rebuilt per pass
+    offsets.assign(numVertices + 1, 0);
+    for (auto index : current) {
+      offsets[index + 1] += 1;
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    adjacent.resize(current.size());
+    {
+      auto fill = offsets;
+      for (size_t i = 0; i < current.size(); ++i) {
+        adjacent[fill[current[i]]++] = i / 3;
+      }
+    }
+
+    // cheapest collapse per vertex
+    costs.assign(numVertices, std::numeric_limits<double>::max());
+    for (size_t t = 0; t < current.size(); t += 3) {
+      for (size_t j = 0; j < 3; ++j) {
+        auto from = current[t + j];
+        if (locked[from]) {
+          continue;
+        }
+
+        for (size_t k = 1; k < 3; ++k) {
+          auto to = current[t + (j + k) % 3];
+
+          Quadric quadric = quadrics[from];
+          quadric.add(quadrics[to]);
+          auto cost = quadric.evaluate(glm::dvec3 {positions[to]});
+          if (cost < costs[from]) {
+            costs[from] = cost;
+            targets[from] = to;
+          }
+        }
+      }
+    }
+
+    candidates.clear();
+    for (uint32_t v = 0; v < numVertices; ++v) {
+      if (costs[v] <= maxCost) {
+        candidates.push_back(v);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end(), [&costs](uint32_t a, uint32_t b) {
+      return costs[a] < costs[b];
+    });
+
+    // vertices near a collapse wait for the next pass, so
+    // the adjacency of all others stays valid
+    touched.assign(numVertices, false);
+    size_t numRemoved = 0;
+    size_t numCollapses = 0;
+
+    for (auto from : candidates) {
+      auto to = targets[from];
+      if (touched[from] || touched[to]) {
+        continue;
+      }
+
+      // no triangle may turn over
+      bool flips = false;
+      for (auto i = offsets[from]; i < offsets[from + 1] && !flips; ++i) {
+        auto t = adjacent[i] * 3;
+        if (current[t] == to || current[t + 1] == to || current[t + 2] == to) {
+          continue;
+        }
+
+        std::array<glm::dvec3, 3> before;
+        std::array<glm::dvec3, 3> after;
+        for (size_t j = 0; j < 3; ++j) {
+          before[j] = glm::dvec3 {positions[current[t + j]]};
+          after[j] = current[t + j] == from ? glm::dvec3 {positions[to]} : before[j];
+        }
+
+        auto normalBefore = getNormal(before[0], before[1], before[2]);
+        auto normalAfter = getNormal(after[0], after[1], after[2]);
+        flips = glm::dot(normalBefore, normalAfter) <= 0.0;
+      }
+
+      if (flips) {
+        continue;
+      }
+
+      for (auto i = offsets[from]; i < offsets[from + 1]; ++i) {
+        auto t = adjacent[i] * 3;
+        bool degenerate = false;
+
+        for (size_t j = 0; j < 3; ++j) {
+          touched[current[t + j]] = true;
+          degenerate |= current[t + j] == to;
+        }
+        for (size_t j = 0; j < 3; ++j) {
+          if (current[t + j] == from) {
+            current[t + j] = to;
+          }
+        }
+
+        numRemoved += degenerate ? 1 : 0;
+      }
+
+      quadrics[to].add(quadrics[from]);
+      reachedCost = std::max(reachedCost, costs[from]);
+      numCollapses += 1;
+
+      if (current.size() - numRemoved * 3 <= targetIndexCount) {
+        break;
+      }
+    }
+
+    removeDegenerate(current);
+    limitReached = numCollapses == 0;
+  }
+
+  result.error = static_cast<float>(std::sqrt(reachedCost));
+
+  return result;
+}
+
+}
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_GFX_MESH_SIMPLIFIER
+#define H_GFX_MESH_SIMPLIFIER
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace ZH::GFX {
+
+struct SimplifiedMesh {
+  std::vector<uint32_t> indices;
+  // largest distance from the original surface, in object units
+  float error = 0.0f;
+};
+
+// Fewer triangles over the same vertices by edge collapses ordered by
+// quadric error metrics, after Garland and Heckbert's "Surface
+// Simplification Using Quadric Error Metrics". Vertices only move onto
+// a neighbor, and those on open borders or seams of split attributes
+// stay, so no cracks open. Stops at targetIndexCount or before a
+// collapse exceeding maxError.
+SimplifiedMesh simplifyMesh(
+    const std::vector<glm::vec3>& positions
+  , const std::vector<uint32_t>& indices
+  , size_t targetIndexCount
+  , float maxError = std::numeric_limits<float>::max()
+);
+
+}
+
+#endif
@@ -40,11 +40,21 @@ Model Model::fromW3D(const W3DModel& w3d) {
   model.boundingBoxTo = w3d.boundingBoxTo;
   model.boundingSphere = w3d.boundingSphere;
   model.boundingSphereRadius = w3d.boundingSphereRadius;
+  model.minScreenSize = w3d.minScreenSize;
+  model.maxScreenSize = w3d.maxScreenSize;
 
   if (w3d.flags & 0x2000) {
     model.backfaceCulling = false;
   }
 
+  // any destination blend but ZERO
+  for (auto& shader : w3d.shaderValues) {
+    if (shader[3] != 0) {
+      model.transparent = true;
+      break;
+    }
+  }
+
   return model;
 }
 
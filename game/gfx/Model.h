@@ -4,6 +4,7 @@
 #define H_GAME_GFX_MODEL
 
 #include <array>
+#include <limits>
 #include <vector>
 
 #include <glm/glm.hpp>
@@ -20,10 +21,19 @@ struct Model {
     glm::vec2 uv;
   };
 
+  // coarser triangles over the same vertices
+  struct LOD {
+    std::vector<uint32_t> vertexIndices;
+    // distance from the full mesh, in model units
+    float error = 0.0f;
+  };
+
   std::vector<VertexData> vertexData;
   std::vector<uint32_t> vertexIndices;
   std::vector<std::string> textures;
   std::vector<uint32_t> textureIndices;
+  // finer ones first, for vertexIndices only
+  std::vector<LOD> lods;
   glm::mat4 transformation {1.0f};
 
   glm::vec3 boundingBoxFrom;
@@ -32,6 +42,12 @@ struct Model {
   float boundingSphereRadius = 1.0f;
 
   bool backfaceCulling = true;
+  // blended, needs drawing back to front
+  bool transparent = false;
+  // normalized screen area of the bounding sphere to show it in,
+  // from the HLOD levels of the W3D file if there are several
+  float minScreenSize = 0.0f;
+  float maxScreenSize = std::numeric_limits<float>::max();
 
   static Model fromW3D(const W3DModel&);
   std::array<glm::vec3, 2> getExtremes() const;
@@ -1,17 +1,114 @@
 // SPDX-License-Identifier: GPL-2.0
 
+#include <fstream>
+#include <thread>
+
 #include "fmt/core.h"
 
 #include "../common.h"
 #include "../formats/W3DFile.h"
+#include "../Logging.h"
+#include "../MurmurHash.h"
+#include "CompiledModel.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
 #include "ModelCache.h"
 
 namespace ZH::GFX {
 
+static constexpr size_t MAX_LODS = 3;
+// smaller meshes are drawn in full
+static constexpr size_t MIN_LOD_TRIANGLES = 64;
+
+// triangles for the vertex cache, then vertices in order of first use
+static void optimizeModel(Model& model) {
+  auto numTriangles = model.vertexIndices.size() / 3;
+  auto order = getVertexCacheOrder(model.vertexIndices, model.vertexData.size());
+
+  std::vector<uint32_t> indices(numTriangles * 3);
+  for (size_t t = 0; t < numTriangles; ++t) {
+    for (size_t j = 0; j < 3; ++j) {
+      indices[t * 3 + j] = model.vertexIndices[order[t] * 3 + j];
+    }
+  }
+
+  // per triangle, unless one for all
+  if (model.textureIndices.size() == numTriangles) {
+    std::vector<uint32_t> textureIndices(numTriangles);
+    for (size_t t = 0; t < numTriangles; ++t) {
+      textureIndices[t] = model.textureIndices[order[t]];
+    }
+    model.textureIndices = std::move(textureIndices);
+  }
+
+  auto remap = getVertexFetchRemap(indices, model.vertexData.size());
+  std::vector<Model::VertexData> vertexData(model.vertexData.size());
+  for (size_t v = 0; v < remap.size(); ++v) {
+    vertexData[remap[v]] = model.vertexData[v];
+  }
+
+  for (auto& index : indices) {
+    if (index < remap.size()) {
+      index = remap[index];
+    }
+  }
+
+  model.vertexData = std::move(vertexData);
+  model.vertexIndices = std::move(indices);
+}
+
+// about half the triangles of the one before each, all simplified
+// from the full mesh for errors against it, in cache order
+static void generateLODs(Model& model) {
+  if (model.vertexIndices.size() / 3 < MIN_LOD_TRIANGLES) {
+    return;
+  }
+
+  std::vector<glm::vec3> positions;
+  positions.reserve(model.vertexData.size());
+  for (auto& vertex : model.vertexData) {
+    positions.push_back(vertex.position);
+  }
+
+  auto numIndices = model.vertexIndices.size();
+  while (model.lods.size() < MAX_LODS && numIndices / 3 >= MIN_LOD_TRIANGLES) {
+    auto simplified = simplifyMesh(positions, model.vertexIndices, numIndices / 6 * 3);
+
+    // not worth a level of its own
+    if (simplified.indices.size() > numIndices * 3 / 4) {
+      break;
+    }
+    numIndices = simplified.indices.size();
+
+    auto order = getVertexCacheOrder(simplified.indices, positions.size());
+    auto& lod = model.lods.emplace_back();
+    lod.vertexIndices.reserve(simplified.indices.size());
+    for (auto t : order) {
+      for (size_t j = 0; j < 3; ++j) {
+        lod.vertexIndices.push_back(simplified.indices[t * 3 + j]);
+      }
+    }
+    lod.error = simplified.error;
+  }
+}
+
 ModelCache::ModelCache(
     ResourceLoader& resourceLoader
+  , size_t budget
+  , std::optional<std::filesystem::path> compiledDir
 ) : resourceLoader(resourceLoader)
-{}
+  , modelCache(budget)
+  , compiledDir(std::move(compiledDir))
+{
+  if (this->compiledDir) {
+    std::error_code error;
+    std::filesystem::create_directories(*this->compiledDir, error);
+    if (error) {
+      WARN_ZH("ModelCache", "Could not create {}: {}", this->compiledDir->string(), error.message());
+      this->compiledDir.reset();
+    }
+  }
+}
 
 ModelCache::Models ModelCache::getModels(const std::string& key) {
   TRACY(ZoneScoped);
@@ -22,29 +119,114 @@ ModelCache::Models ModelCache::getModels(const std::string& key) {
     return cacheLookup;
   }
 
-  auto lookup = resourceLoader.getFileStream(path, true);
+  std::optional<ResourceLoader::MemoryStream> lookup;
+  {
+    std::lock_guard lock {resourceMutex};
+    lookup = resourceLoader.getFileStream(path, true);
+  }
   if (!lookup) {
     return {};
   }
 
-  auto stream = lookup->getStream();
-  auto w3d = W3DFile(stream);
+  uint32_t sourceHash = 0;
+  Models models;
 
-  auto w3dModels = w3d.parse();
-  if (w3dModels.empty()) {
-    return {};
+  if (compiledDir) {
+    MurmurHash3_32 hasher;
+    hasher.feed(lookup->getBuffer().data(), lookup->size());
+    sourceHash = hasher.getHash();
+
+    models = readCompiled(key, sourceHash);
   }
 
-  Models models = std::make_shared<std::vector<std::shared_ptr<Model>>>();
+  if (!models) {
+    auto stream = lookup->getStream();
+    auto w3d = W3DFile(stream);
+
+    auto w3dModels = w3d.parse();
+    if (w3dModels.empty()) {
+      return {};
+    }
+
+    models = std::make_shared<std::vector<std::shared_ptr<Model>>>();
+    for (auto& w3dModel : w3dModels) {
+      auto model =
+        std::make_shared<Model>(std::move(Model::fromW3D(*w3dModel)));
+      optimizeModel(*model);
+      generateLODs(*model);
+
+      models->emplace_back(std::move(model));
+    }
 
-  for (auto& w3dModel : w3dModels) {
-    auto model =
-      std::make_shared<Model>(std::move(Model::fromW3D(*w3dModel)));
-    models->emplace_back(std::move(model));
+    if (compiledDir) {
+      writeCompiled(key, sourceHash, models);
+    }
   }
-  modelCache.put(path, models);
+
+  size_t bytes = 0;
+  for (auto& model : *models) {
+    bytes +=
+      model->vertexData.size() * sizeof(Model::VertexData)
+        + model->vertexIndices.size() * sizeof(uint32_t)
+        + model->textureIndices.size() * sizeof(uint32_t);
+    for (auto& lod : model->lods) {
+      bytes += lod.vertexIndices.size() * sizeof(uint32_t);
+    }
+  }
+  modelCache.put(path, models, bytes);
 
   return models;
 }
 
+Cache<std::vector<std::shared_ptr<Model>>>::Stats ModelCache::getStats() const {
+  return modelCache.getStats();
+}
+
+std::filesystem::path ModelCache::getCompiledPath(const std::string& key) const {
+  auto name = key;
+  for (auto& c : name) {
+    if (c == '\\' || c == '/' || c == ':') {
+      c = '_';
+    }
+  }
+
+  return *compiledDir / (name + CompiledModel::EXTENSION);
+}
+
+ModelCache::Models ModelCache::readCompiled(const std::string& key, uint32_t sourceHash) const {
+  std::ifstream file {getCompiledPath(key), std::ios::binary};
+  if (!file) {
+    return {};
+  }
+
+  // outdated or broken ones get compiled again
+  auto models = CompiledModel::read(file, sourceHash);
+  if (!models) {
+    return {};
+  }
+
+  return std::make_shared<std::vector<std::shared_ptr<Model>>>(std::move(*models));
+}
+
+void ModelCache::writeCompiled(const std::string& key, uint32_t sourceHash, const Models& models) const {
+  auto path = getCompiledPath(key);
+  // unique per thread, the same file may be compiled twice at once
+  auto tempPath = path;
+  tempPath += fmt::format(".{}.tmp", std::hash<std::thread::id> {}(std::this_thread::get_id()));
+
+  {
+    std::ofstream file {tempPath, std::ios::binary | std::ios::trunc};
+    if (!CompiledModel::write(file, sourceHash, *models)) {
+      WARN_ZH("ModelCache", "Could not write {}", tempPath.string());
+      return;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tempPath, path, error);
+  if (error) {
+    WARN_ZH("ModelCache", "Could not replace {}: {}", path.string(), error.message());
+  }
+}
+
 }
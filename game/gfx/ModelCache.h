@@ -3,8 +3,11 @@
 #ifndef H_GAME_GFX_MODEL_CACHE
 #define H_GAME_GFX_MODEL_CACHE
 
+#include <filesystem>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <queue>
 #include <unordered_map>
 
@@ -18,12 +21,25 @@ namespace ZH::GFX {
 class ModelCache {
   public:
     using Models = std::shared_ptr<std::vector<std::shared_ptr<Model>>>;
-    ModelCache(ResourceLoader& resourceLoader);
-
+    // converted models are compiled into compiledDir if there is one
+    ModelCache(
+        ResourceLoader& resourceLoader
+      , size_t budget = Cache<std::vector<std::shared_ptr<Model>>>::DEFAULT_BUDGET
+      , std::optional<std::filesystem::path> compiledDir = {}
+    );
+
+    // from several threads at once for different keys
     Models getModels(const std::string&);
+    Cache<std::vector<std::shared_ptr<Model>>>::Stats getStats() const;
   private:
     ResourceLoader& resourceLoader;
+    std::mutex resourceMutex;
     Cache<std::vector<std::shared_ptr<Model>>> modelCache;
+    std::optional<std::filesystem::path> compiledDir;
+
+    std::filesystem::path getCompiledPath(const std::string& key) const;
+    Models readCompiled(const std::string& key, uint32_t sourceHash) const;
+    void writeCompiled(const std::string& key, uint32_t sourceHash, const Models&) const;
 };
 
 }
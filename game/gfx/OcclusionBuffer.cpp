@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "../common.h"
+#include "OcclusionBuffer.h"
+
+namespace ZH::GFX {
+
+static constexpr float FAR_DEPTH = std::numeric_limits<float>::max();
+
+OcclusionBuffer::OcclusionBuffer(uint32_t width, uint32_t height)
+  : width(std::max(width, 1u))
+  , height(std::max(height, 1u))
+  , stride((this->width + 3) & ~3u)
+{
+  levels.emplace_back(stride * this->height, FAR_DEPTH);
+  levelSizes.emplace_back(this->width, this->height);
+
+  while (levelSizes.back().x > 1 || levelSizes.back().y > 1) {
+    auto size = (levelSizes.back() + 1u) / 2u;
+    levels.emplace_back(size.x * size.y, FAR_DEPTH);
+    levelSizes.push_back(size);
+  }
+}
+
+void OcclusionBuffer::begin(const Camera& camera) {
+  viewProjection = camera.getProjectionMatrix() * camera.getCameraMatrix();
+  near = camera.getPerspectiveSettings().near;
+
+  for (auto& level : levels) {
+    std::fill(level.begin(), level.end(), FAR_DEPTH);
+  }
+}
+
+void OcclusionBuffer::rasterize(
+    std::span<const glm::vec3> vertices
+  , std::span<const uint32_t> indices
+) {
+  TRACY(ZoneScoped);
+
+  std::vector<glm::vec4> clipped;
+  clipped.reserve(vertices.size());
+  for (auto& vertex : vertices) {
+    clipped.push_back(viewProjection * glm::vec4 {vertex, 1.0f});
+  }
+
+  auto toScreen = [this](const glm::vec4& clip) {
+    return glm::vec3 {
+        (clip.x / clip.w * 0.5f + 0.5f) * width
+      , (clip.y / clip.w * 0.5f + 0.5f) * height
+      , clip.w
+    };
+  };
+
+  for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+    auto& a = clipped[indices[i]];
+    auto& b = clipped[indices[i + 1]];
+    auto& c = clipped[indices[i + 2]];
+
+    // no clipping, occluders touching the near plane are left out
+    if (a.w < near || b.w < near || c.w < near) {
+      continue;
+    }
+
+    rasterizeTriangle(toScreen(a), toScreen(b), toScreen(c), std::max({a.w, b.w, c.w}));
+  }
+}
+
+void OcclusionBuffer::rasterizeTriangle(
+    const glm::vec3& a
+  , const glm::vec3& b
+  , const glm::vec3& c
+  , float depth
+) {
+  auto area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+  if (area == 0.0f || !std::isfinite(area)) {
+    return;
+  }
+
+  // counter-clockwise, so all edge functions are positive inside
+  std::array<glm::vec2, 3> v {glm::vec2 {a}, glm::vec2 {b}, glm::vec2 {c}};
+  if (area < 0.0f) {
+    std::swap(v[1], v[2]);
+  }
+
+  auto minX = std::max(0.0f, std::floor(std::min({v[0].x, v[1].x, v[2].x})));
+  auto maxX = std::min(width - 1.0f, std::ceil(std::max({v[0].x, v[1].x, v[2].x})));
+  auto minY = std::max(0.0f, std::floor(std::min({v[0].y, v[1].y, v[2].y})));
+  auto maxY = std::min(height - 1.0f, std::ceil(std::max({v[0].y, v[1].y, v[2].y})));
+  if (minX > maxX || minY > maxY) {
+    return;
+  }
+
+  // E(x, y) = A * x + B * y + C per edge, sampled at pixel centers
+  std::array<float, 3> edgeA, edgeB, edgeC;
+  for (size_t e = 0; e < 3; ++e) {
+    auto& from = v[e];
+    auto& to = v[(e + 1) % 3];
+    edgeA[e] = from.y - to.y;
+    edgeB[e] = to.x - from.x;
+    edgeC[e] = -(edgeA[e] * from.x + edgeB[e] * from.y);
+  }
+
+  auto x0 = static_cast<uint32_t>(minX);
+  auto x1 = static_cast<uint32_t>(maxX);
+  auto& depths = levels[0];
+
+  for (auto y = static_cast<uint32_t>(minY); y <= static_cast<uint32_t>(maxY); ++y) {
+    auto row = depths.data() + y * stride;
+    auto py = y + 0.5f;
+    uint32_t x = x0;
+
+#if defined(__SSE2__)
+    auto lane = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+    auto zero = _mm_setzero_ps();
+    auto lastX = _mm_set1_ps(x1 + 0.5f);
+    auto triDepth = _mm_set1_ps(depth);
+
+    __m128 a4[3], rowC4[3];
+    for (size_t e = 0; e < 3; ++e) {
+      a4[e] = _mm_set1_ps(edgeA[e]);
+      rowC4[e] = _mm_set1_ps(edgeB[e] * py + edgeC[e]);
+    }
+
+    // rows are padded, lanes past x1 are masked off
+    for (x = x0 & ~3u; x <= x1; x += 4) {
+      auto px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane);
+
+      auto inside = _mm_cmple_ps(px, lastX);
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(px, _mm_set1_ps(x0 + 0.0f)));
+      for (size_t e = 0; e < 3; ++e) {
+        auto value = _mm_add_ps(_mm_mul_ps(a4[e], px), rowC4[e]);
+        inside = _mm_and_ps(inside, _mm_cmpge_ps(value, zero));
+      }
+
+      if (_mm_movemask_ps(inside) == 0) {
+        continue;
+      }
+
+      auto current = _mm_loadu_ps(row + x);
+      auto nearer = _mm_min_ps(current, triDepth);
+      _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearer), _mm_andnot_ps(inside, current)));
+    }
+#endif
+
+    for (; x <= x1; ++x) {
+      auto px = x + 0.5f;
+      bool inside = true;
+      for (size_t e = 0; e < 3; ++e) {
+        inside = inside && edgeA[e] * px + edgeB[e] * py + edgeC[e] >= 0.0f;
+      }
+
+      if (inside) {
+        row[x] = std::min(row[x], depth);
+      }
+    }
+  }
+}
+
+void OcclusionBuffer::finish() {
+  TRACY(ZoneScoped);
+
+  for (size_t l = 1; l < levels.size(); ++l) {
+    auto& source = levels[l - 1];
+    auto sourceSize = levelSizes[l - 1];
+    auto sourceStride = l == 1 ? stride : sourceSize.x;
+    auto& target = levels[l];
+    auto targetSize = levelSizes[l];
+
+    for (uint32_t y = 0; y < targetSize.y; ++y) {
+      auto sy0 = y * 2;
+      auto sy1 = std::min(sy0 + 1, sourceSize.y - 1);
+
+      for (uint32_t x = 0; x < targetSize.x; ++x) {
+        auto sx0 = x * 2;
+        auto sx1 = std::min(sx0 + 1, sourceSize.x - 1);
+
+        target[y * targetSize.x + x] =
+          std::max({
+              source[sy0 * sourceStride + sx0]
+            , source[sy0 * sourceStride + sx1]
+            , source[sy1 * sourceStride + sx0]
+            , source[sy1 * sourceStride + sx1]
+          });
+      }
+    }
+  }
+}
+
+float OcclusionBuffer::getDepth(uint32_t x, uint32_t y) const {
+  if (x >= width || y >= height) {
+    return FAR_DEPTH;
+  }
+
+  return levels[0][y * stride + x];
+}
+
+bool OcclusionBuffer::isSphereOccluded(const glm::vec3& center, float radius) const {
+  // w is the view depth, so the nearest point is just the radius closer
+  auto nearest = (viewProjection * glm::vec4 {center, 1.0f}).w - radius;
+  if (nearest < near) {
+    return false;
+  }
+
+  glm::vec2 min {std::numeric_limits<float>::max()};
+  glm::vec2 max {std::numeric_limits<float>::lowest()};
+  for (uint32_t i = 0; i < 8; ++i) {
+    auto corner =
+      center + glm::vec3 {
+          (i & 1) ? radius : -radius
+        , (i & 2) ? radius : -radius
+        , (i & 4) ? radius : -radius
+      };
+    auto clip = viewProjection * glm::vec4 {corner, 1.0f};
+    auto screen =
+      glm::vec2 {
+          (clip.x / clip.w * 0.5f + 0.5f) * width
+        , (clip.y / clip.w * 0.5f + 0.5f) * height
+      };
+
+    min = glm::min(min, screen);
+    max = glm::max(max, screen);
+  }
+
+  // one more pixel, as coverage is only sampled at the centers
+  auto x0 = static_cast<int32_t>(std::floor(min.x)) - 1;
+  auto y0 = static_cast<int32_t>(std::floor(min.y)) - 1;
+  auto x1 = static_cast<int32_t>(std::floor(max.x)) + 1;
+  auto y1 = static_cast<int32_t>(std::floor(max.y)) + 1;
+
+  // anything off screen is up to the frustum
+  if (x0 < 0 || y0 < 0 || x1 >= static_cast<int32_t>(width) || y1 >= static_cast<int32_t>(height)) {
+    return false;
+  }
+
+  // level where the rectangle covers at most 2x2 texels
+  size_t level = 0;
+  while (level + 1 < levels.size()
+      && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)
+  ) {
+    level += 1;
+  }
+
+  auto& depths = levels[level];
+  auto levelStride = level == 0 ? stride : levelSizes[level].x;
+  for (auto y = y0 >> level; y <= y1 >> level; ++y) {
+    for (auto x = x0 >> level; x <= x1 >> level; ++x) {
+      if (depths[y * levelStride + x] >= nearest) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+}
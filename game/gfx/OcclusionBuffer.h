@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_GFX_OCCLUSION_BUFFER
+#define H_GFX_OCCLUSION_BUFFER
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Camera.h"
+
+namespace ZH::GFX {
+
+// Low resolution software depth buffer for occlusion culling. Stores
+// linear view depths, every covered pixel takes the farthest depth of
+// its triangle, and tests read a pyramid of the farthest depths.
+class OcclusionBuffer {
+  public:
+    OcclusionBuffer(uint32_t width, uint32_t height);
+
+    // clears, the camera applies to all occluders and tests until the next call
+    void begin(const Camera&);
+    // occluder triangles, both faces
+    void rasterize(std::span<const glm::vec3> vertices, std::span<const uint32_t> indices);
+    // builds the pyramid, needed before testing
+    void finish();
+
+    float getDepth(uint32_t x, uint32_t y) const;
+    bool isSphereOccluded(const glm::vec3& center, float radius) const;
+  private:
+    uint32_t width;
+    uint32_t height;
+    // level 0 rows are padded to whole SIMD lanes
+    uint32_t stride;
+    glm::mat4 viewProjection {1.0f};
+    float near = 0.0f;
+
+    std::vector<std::vector<float>> levels;
+    std::vector<glm::uvec2> levelSizes;
+
+    void rasterizeTriangle(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float depth);
+};
+
+}
+
+#endif
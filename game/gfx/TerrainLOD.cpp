@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <algorithm>
+
+#include "../Logging.h"
+#include "TerrainLOD.h"
+
+namespace ZH::GFX {
+
+static constexpr float UV_EPSILON = 0.0001f;
+
+TerrainLOD::TerrainLOD(
+    Size size
+  , const std::vector<Map::VertexData>& vertices
+  , const std::vector<uint32_t>& baseIndices
+  , const std::vector<Map::TerrainChunk>& chunks
+) : size(size)
+  , vertices(vertices)
+  , indices(baseIndices)
+{
+  TRACY(ZoneScoped);
+
+  prepareMergeableTiles();
+  chunkLevels.resize(chunks.size());
+
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    auto& level = chunkLevels[i][0];
+    level.firstIndex = chunks[i].firstIndex;
+    level.numIndices = chunks[i].numIndices;
+  }
+
+  // level-major, so neighbouring chunks of the same level stay continuous
+  for (size_t l = 1; l < NUM_LEVELS; ++l) {
+    uint32_t blockSize = 2u << l;
+
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      auto& chunk = chunks[i];
+      auto& previous = chunkLevels[i][l - 1];
+      auto& level = chunkLevels[i][l];
+      level.firstIndex = indices.size();
+
+      uint32_t endX = chunk.origin.x + chunk.size.x;
+      uint32_t endY = chunk.origin.y + chunk.size.y;
+      float error = 0.0f;
+
+      for (uint32_t y0 = chunk.origin.y; y0 < endY; y0 += blockSize) {
+        for (uint32_t x0 = chunk.origin.x; x0 < endX; x0 += blockSize) {
+          emitBlock(chunk, baseIndices, x0, y0, blockSize, error);
+        }
+      }
+
+      level.numIndices = indices.size() - level.firstIndex;
+      level.error = std::max(error, previous.error);
+
+      // nothing more to merge, share the range of the previous level
+      if (level.numIndices >= previous.numIndices) {
+        indices.resize(level.firstIndex);
+        level = previous;
+      }
+    }
+  }
+}
+
+bool TerrainLOD::canMerge(uint32_t x0, uint32_t y0, uint32_t blockSize) const {
+  auto baseIdx = (y0 * size.x + x0) * 4;
+  auto& reference = vertices[baseIdx];
+  auto du = vertices[baseIdx + 1].uv - reference.uv;
+  auto dv = vertices[baseIdx + 2].uv - reference.uv;
+
+  for (uint32_t ty = y0; ty < y0 + blockSize; ++ty) {
+    for (uint32_t tx = x0; tx < x0 + blockSize; ++tx) {
+      auto tileIdx = ty * size.x + tx;
+      if (!mergeableTiles[tileIdx]) {
+        return false;
+      }
+
+      for (uint8_t corner = 0; corner < 4; ++corner) {
+        auto& vertex = vertices[tileIdx * 4 + corner];
+        if (vertex.textureIdx != reference.textureIdx
+            || vertex.textureIdx2 != reference.textureIdx2) {
+          return false;
+        }
+
+        // the merged quad interpolates UVs linearly, atlas jumps would smear
+        float gx = (tx - x0) + (corner & 1);
+        float gy = (ty - y0) + (corner >> 1);
+        auto expected = reference.uv + du * gx + dv * gy;
+
+        if (std::abs(vertex.uv.x - expected.x) > UV_EPSILON
+            || std::abs(vertex.uv.y - expected.y) > UV_EPSILON) {
+          return false;
+        }
+      }
+    }
+  }
+
+  return true;
+}
+
+void TerrainLOD::emitBlock(
+    const Map::TerrainChunk& chunk
+  , const std::vector<uint32_t>& baseIndices
+  , uint32_t x0
+  , uint32_t y0
+  , uint32_t blockSize
+  , float& error
+) {
+  uint32_t endX = chunk.origin.x + chunk.size.x;
+  uint32_t endY = chunk.origin.y + chunk.size.y;
+
+  if (blockSize >= 4
+      && x0 + blockSize <= endX
+      && y0 + blockSize <= endY
+      && canMerge(x0, y0, blockSize)) {
+    error = std::max(error, emitFan(x0, y0, blockSize));
+    return;
+  }
+
+  if (blockSize > 1) {
+    auto half = blockSize / 2;
+
+    for (uint32_t y = y0; y < y0 + blockSize && y < endY; y += half) {
+      for (uint32_t x = x0; x < x0 + blockSize && x < endX; x += half) {
+        emitBlock(chunk, baseIndices, x, y, half, error);
+      }
+    }
+
+    return;
+  }
+
+  auto offset =
+    chunk.firstIndex
+      + ((y0 - chunk.origin.y) * chunk.size.x + (x0 - chunk.origin.x)) * 6;
+  indices.insert(
+      indices.end()
+    , baseIndices.cbegin() + offset
+    , baseIndices.cbegin() + offset + 6
+  );
+}
+
+float TerrainLOD::emitFan(uint32_t x0, uint32_t y0, uint32_t blockSize) {
+  std::vector<uint32_t> perimeter;
+  perimeter.reserve(blockSize * 4);
+
+  for (uint32_t i = 0; i < blockSize; ++i) {
+    perimeter.push_back(vertexAt(x0, y0, blockSize, x0 + i, y0));
+  }
+  for (uint32_t i = 0; i < blockSize; ++i) {
+    perimeter.push_back(vertexAt(x0, y0, blockSize, x0 + blockSize, y0 + i));
+  }
+  for (uint32_t i = 0; i < blockSize; ++i) {
+    perimeter.push_back(vertexAt(x0, y0, blockSize, x0 + blockSize - i, y0 + blockSize));
+  }
+  for (uint32_t i = 0; i < blockSize; ++i) {
+    perimeter.push_back(vertexAt(x0, y0, blockSize, x0, y0 + blockSize - i));
+  }
+
+  auto center = vertexAt(x0, y0, blockSize, x0 + blockSize / 2, y0 + blockSize / 2);
+
+  // same winding as the tile triangles
+  for (size_t k = 0; k < perimeter.size(); ++k) {
+    indices.push_back(center);
+    indices.push_back(perimeter[k]);
+    indices.push_back(perimeter[(k + 1) % perimeter.size()]);
+  }
+
+  auto& a = vertices[center].position;
+  float error = 0.0f;
+
+  for (uint32_t gy = y0 + 1; gy < y0 + blockSize; ++gy) {
+    for (uint32_t gx = x0 + 1; gx < x0 + blockSize; ++gx) {
+      auto& p = vertices[vertexAt(x0, y0, blockSize, gx, gy)].position;
+
+      for (size_t k = 0; k < perimeter.size(); ++k) {
+        auto& b = vertices[perimeter[k]].position;
+        auto& c = vertices[perimeter[(k + 1) % perimeter.size()]].position;
+
+        float d = (b.x - a.x) * (c.z - a.z) - (c.x - a.x) * (b.z - a.z);
+        float u = ((p.x - a.x) * (c.z - a.z) - (c.x - a.x) * (p.z - a.z)) / d;
+        float v = ((b.x - a.x) * (p.z - a.z) - (p.x - a.x) * (b.z - a.z)) / d;
+
+        if (u < -UV_EPSILON || v < -UV_EPSILON || u + v > 1.0f + UV_EPSILON) {
+          continue;
+        }
+
+        float height = a.y + u * (b.y - a.y) + v * (c.y - a.y);
+        error = std::max(error, std::abs(p.y - height));
+        break;
+      }
+    }
+  }
+
+  return error;
+}
+
+const std::vector<TerrainLOD::ChunkLevels>& TerrainLOD::getChunkLevels() const {
+  return chunkLevels;
+}
+
+const std::vector<uint32_t>& TerrainLOD::getIndices() const {
+  return indices;
+}
+
+void TerrainLOD::prepareMergeableTiles() {
+  mergeableTiles.resize(size.x * size.y);
+
+  for (size_t i = 0; i < mergeableTiles.size(); ++i) {
+    float minHeight = vertices[i * 4].position.y;
+    float maxHeight = minHeight;
+    bool blended = false;
+
+    for (uint8_t corner = 0; corner < 4; ++corner) {
+      auto& vertex = vertices[i * 4 + corner];
+      minHeight = std::min(minHeight, vertex.position.y);
+      maxHeight = std::max(maxHeight, vertex.position.y);
+      blended |= vertex.uvAlpha != 0.0f;
+    }
+
+    mergeableTiles[i] = !blended && maxHeight - minHeight <= Map::CLIFF_SLOPE;
+  }
+}
+
+size_t TerrainLOD::selectLevel(size_t chunk, float maxError) const {
+  auto& levels = chunkLevels[chunk];
+
+  for (size_t l = NUM_LEVELS - 1; l > 0; --l) {
+    if (levels[l].error <= maxError) {
+      return l;
+    }
+  }
+
+  return 0;
+}
+
+uint32_t TerrainLOD::vertexAt(
+    uint32_t x0
+  , uint32_t y0
+  , uint32_t blockSize
+  , uint32_t gx
+  , uint32_t gy
+) const {
+  // any tile of the block touching the grid point will do
+  auto tx = std::min(gx, x0 + blockSize - 1);
+  auto ty = std::min(gy, y0 + blockSize - 1);
+  uint32_t corner = (gx - tx) + (gy - ty) * 2;
+
+  return (ty * size.x + tx) * 4 + corner;
+}
+
+}
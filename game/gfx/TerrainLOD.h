@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_GFX_TERRAIN_LOD
+#define H_GFX_TERRAIN_LOD
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "../Map.h"
+
+namespace ZH::GFX {
+
+// Decimates terrain chunks into blocks of 4 to 32 tiles, each drawn as
+// a fan around its center. Block borders keep every vertex, so chunks
+// and blocks of any level meet without cracks. Tiles with cliffs,
+// blending or texture seams are never merged.
+class TerrainLOD {
+  public:
+    struct Level {
+      uint32_t firstIndex = 0;
+      uint32_t numIndices = 0;
+      // max. height deviation from full detail, in grid units
+      float error = 0.0f;
+    };
+
+    static constexpr size_t NUM_LEVELS = 5;
+    using ChunkLevels = std::array<Level, NUM_LEVELS>;
+
+    TerrainLOD(
+        Size size
+      , const std::vector<Map::VertexData>&
+      , const std::vector<uint32_t>& baseIndices
+      , const std::vector<Map::TerrainChunk>&
+    );
+
+    const std::vector<ChunkLevels>& getChunkLevels() const;
+    const std::vector<uint32_t>& getIndices() const;
+    size_t selectLevel(size_t chunk, float maxError) const;
+  private:
+    Size size;
+    const std::vector<Map::VertexData>& vertices;
+    std::vector<uint32_t> indices;
+    std::vector<ChunkLevels> chunkLevels;
+    std::vector<uint8_t> mergeableTiles;
+
+    bool canMerge(uint32_t x0, uint32_t y0, uint32_t blockSize) const;
+    void emitBlock(
+        const Map::TerrainChunk&
+      , const std::vector<uint32_t>& baseIndices
+      , uint32_t x0
+      , uint32_t y0
+      , uint32_t blockSize
+      , float& error
+    );
+    float emitFan(uint32_t x0, uint32_t y0, uint32_t blockSize);
+    void prepareMergeableTiles();
+    uint32_t vertexAt(uint32_t x0, uint32_t y0, uint32_t blockSize, uint32_t gx, uint32_t gy) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <algorithm>
+#include <cstring>
+
+#include "TextureAtlas.h"
+
+namespace ZH::GFX {
+
+TextureAtlas::TextureAtlas(Size pageSize, uint32_t padding)
+  : pageSize(pageSize)
+  , padding(padding)
+{}
+
+bool TextureAtlas::add(
+    const std::string& key
+  , std::shared_ptr<HostTexture> source
+  , Point topLeft
+  , Size size
+) {
+  if (!source || source->getFormat() != HostTexture::Format::BGRA8888) {
+    return false;
+  }
+
+  if (regions.contains(key)
+      || std::any_of(pending.cbegin(), pending.cend(), [&key](auto& entry) { return entry.key == key; })) {
+    return true;
+  }
+
+  auto sourceSize = source->getSize();
+  if (topLeft.x < 0 || topLeft.y < 0
+      || static_cast<uint32_t>(topLeft.x) >= sourceSize.x
+      || static_cast<uint32_t>(topLeft.y) >= sourceSize.y) {
+    return false;
+  }
+
+  // some INI rectangles reach over the texture
+  size = glm::min(size, sourceSize - Size {topLeft});
+  if (size.x == 0 || size.y == 0) {
+    return false;
+  }
+
+  pending.push_back({key, std::move(source), topLeft, size});
+
+  return true;
+}
+
+void TextureAtlas::build() {
+  TRACY(ZoneScoped);
+
+  if (pending.empty()) {
+    return;
+  }
+
+  std::stable_sort(pending.begin(), pending.end(), [](const Entry& a, const Entry& b) {
+    return a.size.y > b.size.y || (a.size.y == b.size.y && a.size.x > b.size.x);
+  });
+
+  auto firstPage = static_cast<uint32_t>(pages.size());
+  std::vector<PageLayout> layouts;
+  std::vector<Region> placed;
+  placed.reserve(pending.size());
+
+  for (auto& entry : pending) {
+    auto paddedSize = entry.size + Size {2 * padding, 2 * padding};
+    Point position;
+
+    uint32_t layout = 0;
+    while (layout < layouts.size() && !place(layouts[layout], paddedSize, position)) {
+      layout += 1;
+    }
+
+    if (layout == layouts.size()) {
+      auto& fresh = layouts.emplace_back();
+      // larger than a page, gets one of its own size
+      if (!place(fresh, paddedSize, position)) {
+        fresh.shelves.push_back({0, paddedSize.y, paddedSize.x});
+        fresh.used = paddedSize;
+        position = {0, 0};
+      }
+    }
+
+    placed.push_back({
+        firstPage + layout
+      , position + Point {padding, padding}
+      , entry.size
+    });
+  }
+
+  std::vector<std::vector<char>> pageData(layouts.size());
+  for (size_t i = 0; i < layouts.size(); ++i) {
+    pageData[i].resize(layouts[i].used.x * layouts[i].used.y * 4);
+  }
+
+  for (size_t i = 0; i < pending.size(); ++i) {
+    auto& region = placed[i];
+    auto layout = region.page - firstPage;
+    blit(pending[i], pageData[layout], layouts[layout].used, region);
+
+    regions.emplace(pending[i].key, region);
+  }
+
+  for (size_t i = 0; i < layouts.size(); ++i) {
+    pages.emplace_back(std::make_shared<HostTexture>(
+        layouts[i].used
+      , HostTexture::Format::BGRA8888
+      , std::move(pageData[i])
+    ));
+  }
+
+  pending.clear();
+}
+
+OptionalCRef<TextureAtlas::Region> TextureAtlas::getRegion(const std::string& key) const {
+  auto lookup = regions.find(key);
+  if (lookup == regions.cend()) {
+    return {};
+  }
+
+  return std::make_optional(std::cref(lookup->second));
+}
+
+const std::vector<std::shared_ptr<HostTexture>>& TextureAtlas::getPages() const {
+  return pages;
+}
+
+bool TextureAtlas::place(PageLayout& layout, Size size, Point& position) const {
+  if (size.x > pageSize.x) {
+    return false;
+  }
+
+  auto fit = [&layout, &position](Shelf& shelf, Size size) {
+    position = Point {shelf.width, shelf.y};
+    shelf.width += size.x;
+    layout.used = glm::max(layout.used, Size {shelf.width, shelf.y + size.y});
+  };
+
+  for (auto& shelf : layout.shelves) {
+    if (size.y <= shelf.height && shelf.width + size.x <= pageSize.x) {
+      fit(shelf, size);
+      return true;
+    }
+  }
+
+  uint32_t y = 0;
+  if (!layout.shelves.empty()) {
+    y = layout.shelves.back().y + layout.shelves.back().height;
+  }
+
+  if (y + size.y > pageSize.y) {
+    return false;
+  }
+
+  fit(layout.shelves.emplace_back(Shelf {y, size.y, 0}), size);
+
+  return true;
+}
+
+void TextureAtlas::blit(
+    const Entry& entry
+  , std::vector<char>& pageData
+  , Size pageExtent
+  , const Region& region
+) const {
+  auto& source = entry.source->getData();
+  auto sourceWidth = entry.source->getSize().x;
+  int32_t pad = padding;
+
+  for (int32_t y = -pad; y < static_cast<int32_t>(entry.size.y) + pad; ++y) {
+    // the gutter repeats the outermost texels
+    auto srcY = entry.topLeft.y + std::clamp<int32_t>(y, 0, entry.size.y - 1);
+    auto dstY = region.position.y + y;
+
+    for (int32_t x = -pad; x < static_cast<int32_t>(entry.size.x) + pad; ++x) {
+      auto srcX = entry.topLeft.x + std::clamp<int32_t>(x, 0, entry.size.x - 1);
+      auto dstX = region.position.x + x;
+
+      std::memcpy(
+          pageData.data() + (dstY * pageExtent.x + dstX) * 4
+        , source.data() + (srcY * sourceWidth + srcX) * 4
+        , 4
+      );
+    }
+  }
+}
+
+}
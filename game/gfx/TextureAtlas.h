@@ -0,0 +1,68 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_GFX_TEXTURE_ATLAS
+#define H_GFX_TEXTURE_ATLAS
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../common.h"
+#include "../Dimensions.h"
+#include "HostTexture.h"
+
+namespace ZH::GFX {
+
+// Packs sub rectangles of BGRA8888 textures into shared pages on
+// shelves, tallest first. Each region gets a gutter of its repeated
+// border texels, so filtering at the edges does not bleed.
+class TextureAtlas {
+  public:
+    struct Region {
+      uint32_t page;
+      Point position;
+      Size size;
+    };
+
+    TextureAtlas(Size pageSize = {2048, 2048}, uint32_t padding = 1);
+
+    // false if the texture cannot go into a page
+    bool add(const std::string& key, std::shared_ptr<HostTexture>, Point topLeft, Size size);
+    // packs everything added since the last call into new pages
+    void build();
+
+    OptionalCRef<Region> getRegion(const std::string& key) const;
+    const std::vector<std::shared_ptr<HostTexture>>& getPages() const;
+  private:
+    struct Entry {
+      std::string key;
+      std::shared_ptr<HostTexture> source;
+      Point topLeft;
+      Size size;
+    };
+
+    struct Shelf {
+      uint32_t y;
+      uint32_t height;
+      uint32_t width;
+    };
+
+    struct PageLayout {
+      std::vector<Shelf> shelves;
+      Size used {0, 0};
+    };
+
+    Size pageSize;
+    uint32_t padding;
+    std::vector<Entry> pending;
+    std::unordered_map<std::string, Region> regions;
+    std::vector<std::shared_ptr<HostTexture>> pages;
+
+    bool place(PageLayout&, Size, Point&) const;
+    void blit(const Entry&, std::vector<char>&, Size, const Region&) const;
+};
+
+}
+
+#endif
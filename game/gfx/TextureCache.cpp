@@ -13,10 +13,31 @@ TextureCache::TextureCache(
     Vugl::Context& vuglContext
   , TextureLoader& textureLoader
   , Font::FontManager& fontManager
-) : vuglContext(vuglContext)
+  , size_t budget
+  , size_t numStreamWorkers
+) : textureCache(budget)
+  , vuglContext(vuglContext)
   , textureLoader(textureLoader)
   , fontManager(fontManager)
-{ }
+  , streamer(
+        [&textureLoader](const std::string& key) { return textureLoader.getTexture(key); }
+      , numStreamWorkers
+    )
+{
+  // neutral grey, blends in until the real texture is there
+  HostTexture placeholder {
+      Size {1, 1}
+    , HostTexture::Format::BGRA8888
+    , std::vector<char> {'\x80', '\x80', '\x80', '\xFF'}
+  };
+
+  placeholderSampler = createTextureSampler(placeholder);
+  if (placeholderSampler) {
+    vuglContext.uploadResource(*placeholderSampler);
+  } else {
+    WARN_ZH("TextureCache", "Failed to create placeholder texture");
+  }
+}
 
 std::shared_ptr<Vugl::CombinedSampler> TextureCache::getFontTextureSampler(uint8_t size, bool bold) {
   Font::FontKey key {size, bold};
@@ -63,6 +84,7 @@ std::shared_ptr<Vugl::Texture> TextureCache::getTexture(const std::string& key)
       hostTexture->getData()
     , VkExtent2D {size.x, size.y}
     , mappedFormat(hostTexture->getFormat())
+    , mipOffsets(*hostTexture)
   );
 
   if (texture.getLastResult() != VK_SUCCESS) {
@@ -86,25 +108,189 @@ std::shared_ptr<Vugl::CombinedSampler> TextureCache::getTextureSampler(const std
     return {};
   }
 
+  auto cachedSampler = createTextureSampler(*hostTexture);
+  if (!cachedSampler) {
+    WARN_ZH("TextureCache", "Failed to create Vk texture: {}", key);
+    return {};
+  }
+
+  textureCache.put(key, cachedSampler, hostTexture->getData().size());
+
+  return cachedSampler;
+}
+
+std::shared_ptr<Vugl::CombinedSampler> TextureCache::requestTextureSampler(const std::string& key) {
+  TRACY(ZoneScoped);
+
+  auto lookup = textureCache.get(key);
+  if (lookup) {
+    return lookup;
+  }
+
+  {
+    std::lock_guard lock {failedMutex};
+    if (failedTextures.contains(key)) {
+      return {};
+    }
+  }
+
+  streamer.request(key);
+
+  return {};
+}
+
+std::shared_ptr<Vugl::CombinedSampler> TextureCache::pollTextureSampler(const std::string& key) {
+  TRACY(ZoneScoped);
+
+  {
+    std::lock_guard lock {readyMutex};
+
+    auto lookup = readySamplers.find(key);
+    if (lookup != readySamplers.cend()) {
+      auto sampler = std::move(lookup->second);
+      readySamplers.erase(lookup);
+
+      return sampler;
+    }
+  }
+
+  return textureCache.peek(key);
+}
+
+bool TextureCache::isLoading(const std::string& key) const {
+  return streamer.isPending(key);
+}
+
+std::shared_ptr<Vugl::CombinedSampler> TextureCache::getPlaceholderSampler() const {
+  return placeholderSampler;
+}
+
+void TextureCache::update() {
+  TRACY(ZoneScoped);
+
+  std::lock_guard lock {readyMutex};
+  readySamplers.clear();
+
+  for (auto& result : streamer.takeFinished(FRAME_UPLOAD_BUDGET)) {
+    std::shared_ptr<Vugl::CombinedSampler> sampler;
+    if (result.texture) {
+      sampler = createTextureSampler(*result.texture);
+    }
+
+    if (!sampler) {
+      WARN_ZH("TextureCache", "Failed to stream texture: {}", result.key);
+
+      std::lock_guard lock {failedMutex};
+      failedTextures.insert(result.key);
+      continue;
+    }
+
+    // recorded into the current upload batch, submitted with the frame
+    vuglContext.uploadResource(*sampler);
+    readySamplers.insert_or_assign(result.key, sampler);
+    textureCache.put(result.key, std::move(sampler), result.texture->getData().size());
+  }
+}
+
+void TextureCache::waitForLoads() {
+  TRACY(ZoneScoped);
+
+  streamer.waitFinished();
+}
+
+void TextureCache::stopLoading() {
+  streamer.stop();
+}
+
+std::shared_ptr<Vugl::Texture> TextureCache::getTextureArray(const std::vector<std::string>& keys) {
+  TRACY(ZoneScoped);
+
+  if (keys.empty()) {
+    return {};
+  }
+
+  std::vector<std::shared_ptr<HostTexture>> hostTextures;
+  hostTextures.reserve(keys.size());
+
+  Size layerSize {1, 1};
+  for (auto& key : keys) {
+    auto& hostTexture = hostTextures.emplace_back(textureLoader.getTexture(key, true));
+    if (hostTexture) {
+      layerSize = glm::max(layerSize, hostTexture->getSize());
+    }
+  }
+
+  std::vector<char> data;
+  std::vector<VkDeviceSize> offsets;
+
+  for (auto& hostTexture : hostTextures) {
+    auto layer = hostTexture ? hostTexture->resampled(layerSize) : nullptr;
+    if (!layer) {
+      layer = std::make_shared<HostTexture>(
+          layerSize
+        , HostTexture::Format::BGRA8888
+        , std::vector<char>(layerSize.x * layerSize.y * 4)
+      );
+    }
+
+    layer->generateMipLevels();
+    if (offsets.empty()) {
+      offsets = mipOffsets(*layer);
+    }
+
+    data.insert(data.end(), layer->getData().cbegin(), layer->getData().cend());
+  }
+
+  auto texture = vuglContext.createTexture();
+  texture.createTextureArray(
+      data
+    , VkExtent2D {layerSize.x, layerSize.y}
+    , mappedFormat(HostTexture::Format::BGRA8888)
+    , hostTextures.size()
+    , offsets
+  );
+
+  if (texture.getLastResult() != VK_SUCCESS) {
+    WARN_ZH("TextureCache", "Failed to create Vk texture array");
+    return {};
+  }
+
+  return std::make_shared<Vugl::Texture>(std::move(texture));
+}
+
+std::shared_ptr<HostTexture> TextureCache::getHostTexture(const std::string& key) {
+  return textureLoader.getTexture(key, true);
+}
+
+std::shared_ptr<Vugl::CombinedSampler> TextureCache::createTextureSampler(const HostTexture& hostTexture) {
   auto uploadSampler = vuglContext.createCombinedSampler();
-  auto size = hostTexture->getSize();
+  auto size = hostTexture.getSize();
 
   uploadSampler.createTexture(
-      hostTexture->getData()
+      hostTexture.getData()
     , VkExtent2D {size.x, size.y}
-    , mappedFormat(hostTexture->getFormat())
+    , mappedFormat(hostTexture.getFormat())
+    , mipOffsets(hostTexture)
   );
 
   if (uploadSampler.getLastResult() != VK_SUCCESS) {
-    WARN_ZH("TextureCache", "Failed to create Vk texture: {}", key);
     return {};
   }
 
-  auto cachedSampler =
-    std::make_shared<Vugl::CombinedSampler>(std::move(uploadSampler));
-  textureCache.put(key, cachedSampler);
+  return std::make_shared<Vugl::CombinedSampler>(std::move(uploadSampler));
+}
 
-  return cachedSampler;
+Cache<Vugl::CombinedSampler>::Stats TextureCache::getStats() const {
+  return textureCache.getStats();
+}
+
+std::vector<VkDeviceSize> TextureCache::mipOffsets(const HostTexture& texture) {
+  std::vector<VkDeviceSize> offsets;
+  for (auto& level : texture.getMipLevels()) {
+    offsets.push_back(level.offset);
+  }
+
+  return offsets;
 }
 
 VkFormat TextureCache::mappedFormat(HostTexture::Format format) {
@@ -113,6 +299,10 @@ VkFormat TextureCache::mappedFormat(HostTexture::Format format) {
       return VK_FORMAT_B8G8R8A8_UNORM;
     case ZH::GFX::HostTexture::Format::RGBA8888:
       return VK_FORMAT_R8G8B8A8_UNORM;
+    case ZH::GFX::HostTexture::Format::BC1:
+      return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+    case ZH::GFX::HostTexture::Format::BC3:
+      return VK_FORMAT_BC3_UNORM_BLOCK;
     default:
       WARN_ZH("TextureCache", "Unmapped format, falling back");
       return VK_FORMAT_R8G8B8A8_UNORM;
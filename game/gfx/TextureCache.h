@@ -5,7 +5,9 @@
 
 #include <functional>
 #include <map>
+#include <mutex>
 #include <queue>
+#include <unordered_set>
 #include <vector>
 
 #include "../common.h"
@@ -14,22 +16,55 @@
 #include "HostTexture.h"
 #include "TextureCache.h"
 #include "TextureLoader.h"
+#include "TextureStreamer.h"
 #include "font/FontManager.h"
 
 namespace ZH::GFX {
 
 class TextureCache {
   public:
+    // texture data turned into samplers per call of `update`
+    static constexpr size_t FRAME_UPLOAD_BUDGET = 16 * 1024 * 1024;
+
     TextureCache(
         Vugl::Context& vuglContext
       , TextureLoader& textureLoader
       , Font::FontManager& fontManager
+      , size_t budget = Cache<Vugl::CombinedSampler>::DEFAULT_BUDGET
+      , size_t numStreamWorkers = 2
     );
 
     std::shared_ptr<Vugl::CombinedSampler> getFontTextureSampler(uint8_t, bool bold = false);
     // not cached right now, to be done by the user
     std::shared_ptr<Vugl::Texture> getTexture(const std::string& key);
     std::shared_ptr<Vugl::CombinedSampler> getTextureSampler(const std::string&);
+    // never blocks, empty while loading in the background and for
+    // textures failing to load, tell them apart by `isLoading`
+    std::shared_ptr<Vugl::CombinedSampler> requestTextureSampler(const std::string&);
+    // for keys requested before, without counting a cache miss, and
+    // with samplers finished by the last `update` handed over for sure
+    std::shared_ptr<Vugl::CombinedSampler> pollTextureSampler(const std::string&);
+    bool isLoading(const std::string&) const;
+    // stands in for textures still loading
+    std::shared_ptr<Vugl::CombinedSampler> getPlaceholderSampler() const;
+    // on the render thread once per frame: creates the samplers of
+    // finished loads and queues them for upload in one batch, each
+    // is kept until polled or the next call, as pinned entries might
+    // get it evicted from the cache right away
+    void update();
+    // blocks until `update` has something to take or nothing is loading
+    void waitForLoads();
+    // for shutdown, before the loader goes away
+    void stopLoading();
+    // one layer per key at the largest size of them, missing ones blank
+    std::shared_ptr<Vugl::Texture> getTextureArray(const std::vector<std::string>& keys);
+
+    // uncompressed, for packing on the host
+    std::shared_ptr<HostTexture> getHostTexture(const std::string&);
+    // not cached
+    std::shared_ptr<Vugl::CombinedSampler> createTextureSampler(const HostTexture&);
+
+    Cache<Vugl::CombinedSampler>::Stats getStats() const;
 
   private:
     Cache<Vugl::CombinedSampler> textureCache;
@@ -37,8 +72,16 @@ class TextureCache {
     Vugl::Context& vuglContext;
     TextureLoader& textureLoader;
     Font::FontManager& fontManager;
+    std::shared_ptr<Vugl::CombinedSampler> placeholderSampler;
+    std::unordered_map<std::string, std::shared_ptr<Vugl::CombinedSampler>> readySamplers;
+    std::mutex readyMutex;
+    // not requested again
+    std::unordered_set<std::string> failedTextures;
+    mutable std::mutex failedMutex;
+    TextureStreamer streamer;
 
     VkFormat mappedFormat(HostTexture::Format format);
+    std::vector<VkDeviceSize> mipOffsets(const HostTexture&);
 };
 
 }
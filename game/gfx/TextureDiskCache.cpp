@@ -0,0 +1,380 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <algorithm>
+#include <cstring>
+
+#include "../Logging.h"
+#include "../MurmurHash.h"
+#include "TextureDiskCache.h"
+
+namespace ZH::GFX {
+
+static const char INDEX_MAGIC[4] = {'Z', 'H', 'T', 'C'};
+static const uint32_t MAX_LEVELS = 32;
+
+static uint32_t getKeyHash(const std::string& key) {
+  MurmurHash3_32 hasher;
+  hasher.feed(key);
+
+  return hasher.getHash();
+}
+
+TextureDiskCache::TextureDiskCache(const std::filesystem::path& directory, size_t budget)
+  : indexPath(directory / "textures.idx")
+  , dataPath(directory / "textures.bin")
+  , budget(budget)
+{
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error) {
+    WARN_ZH("TextureDiskCache", "Could not create {}: {}", directory.string(), error.message());
+    return;
+  }
+
+  enabled = open();
+  if (!enabled) {
+    WARN_ZH("TextureDiskCache", "Could not open cache in {}", directory.string());
+  }
+}
+
+TextureDiskCache::~TextureDiskCache() {
+  flush();
+}
+
+std::shared_ptr<HostTexture> TextureDiskCache::get(const std::string& key, uint32_t sourceHash) {
+  TRACY(ZoneScoped);
+  std::lock_guard lock {mutex};
+
+  if (!enabled) {
+    return {};
+  }
+
+  auto range = records.equal_range(getKeyHash(key));
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second.sourceHash != sourceHash) {
+      continue;
+    }
+
+    auto texture = readEntry(key, it->second);
+    if (texture) {
+      it->second.lastUse = ++useCounter;
+      this->dirty = true;
+
+      return texture;
+    }
+  }
+
+  return {};
+}
+
+void TextureDiskCache::put(const std::string& key, uint32_t sourceHash, const HostTexture& texture) {
+  TRACY(ZoneScoped);
+  std::lock_guard lock {mutex};
+
+  if (!enabled) {
+    return;
+  }
+
+  auto& levels = texture.getMipLevels();
+  auto& textureData = texture.getData();
+
+  EntryHeader header {};
+  header.keyLength = key.size();
+  header.format = static_cast<uint32_t>(texture.getFormat());
+  header.width = texture.getSize().x;
+  header.height = texture.getSize().y;
+  header.numLevels = levels.size();
+  header.dataSize = textureData.size();
+
+  uint64_t size =
+    sizeof(EntryHeader)
+      + key.size()
+      + levels.size() * sizeof(EntryLevel)
+      + textureData.size();
+  if (size > budget) {
+    return;
+  }
+
+  if (dataSize + size > budget && !compact(std::min(budget * 3 / 4, budget - size))) {
+    return;
+  }
+
+  data.clear();
+  data.seekp(dataSize);
+  data.write(reinterpret_cast<const char*>(&header), sizeof(EntryHeader));
+  data.write(key.data(), key.size());
+  for (auto& level : levels) {
+    EntryLevel entryLevel {level.size.x, level.size.y, level.offset};
+    data.write(reinterpret_cast<const char*>(&entryLevel), sizeof(EntryLevel));
+  }
+  data.write(textureData.data(), textureData.size());
+  data.flush();
+
+  if (!data) {
+    WARN_ZH("TextureDiskCache", "Could not write entry {}", key);
+    return;
+  }
+
+  auto keyHash = getKeyHash(key);
+  auto range = records.equal_range(keyHash);
+  for (auto it = range.first; it != range.second;) {
+    if (it->second.sourceHash == sourceHash) {
+      it = records.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  records.emplace(keyHash, IndexRecord {keyHash, sourceHash, dataSize, size, ++useCounter});
+  this->dataSize += size;
+  this->dirty = true;
+}
+
+void TextureDiskCache::flush() {
+  std::lock_guard lock {mutex};
+
+  if (!enabled || !dirty) {
+    return;
+  }
+
+  writeIndex();
+}
+
+size_t TextureDiskCache::getDataSize() const {
+  std::lock_guard lock {mutex};
+  return dataSize;
+}
+
+size_t TextureDiskCache::getNumEntries() const {
+  std::lock_guard lock {mutex};
+  return records.size();
+}
+
+bool TextureDiskCache::open() {
+  if (!readIndex()) {
+    records.clear();
+    this->dataSize = 0;
+    this->useCounter = 0;
+
+    std::ofstream truncated {dataPath, std::ios::binary | std::ios::trunc};
+    if (!truncated) {
+      return false;
+    }
+    this->dirty = true;
+  }
+
+  data.open(dataPath, std::ios::in | std::ios::out | std::ios::binary);
+  if (!data) {
+    return false;
+  }
+
+  // anything past the indexed size was never indexed and gets overwritten
+  data.seekg(0, std::ios::end);
+  if (static_cast<uint64_t>(data.tellg()) < dataSize) {
+    WARN_ZH("TextureDiskCache", "Data file shorter than its index, dropping entries");
+    records.clear();
+    this->dataSize = 0;
+    this->dirty = true;
+  }
+
+  if (dataSize > budget) {
+    return compact(budget * 3 / 4);
+  }
+
+  return true;
+}
+
+bool TextureDiskCache::readIndex() {
+  std::ifstream index {indexPath, std::ios::binary};
+  if (!index) {
+    return false;
+  }
+
+  IndexHeader header;
+  index.read(reinterpret_cast<char*>(&header), sizeof(IndexHeader));
+  if (!index
+      || std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0
+      || header.version != VERSION) {
+    return false;
+  }
+
+  std::vector<IndexRecord> indexRecords(header.numRecords);
+  index.read(reinterpret_cast<char*>(indexRecords.data()), indexRecords.size() * sizeof(IndexRecord));
+  if (!index) {
+    return false;
+  }
+
+  records.clear();
+  for (auto& record : indexRecords) {
+    if (record.offset + record.size > header.dataSize) {
+      return false;
+    }
+
+    records.emplace(record.keyHash, record);
+  }
+
+  this->dataSize = header.dataSize;
+  this->useCounter = header.useCounter;
+
+  return true;
+}
+
+bool TextureDiskCache::writeIndex() {
+  auto tempPath = indexPath;
+  tempPath += ".tmp";
+
+  {
+    std::ofstream index {tempPath, std::ios::binary | std::ios::trunc};
+
+    IndexHeader header {};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = VERSION;
+    header.numRecords = records.size();
+    header.dataSize = dataSize;
+    header.useCounter = useCounter;
+    index.write(reinterpret_cast<const char*>(&header), sizeof(IndexHeader));
+
+    for (auto& pair : records) {
+      index.write(reinterpret_cast<const char*>(&pair.second), sizeof(IndexRecord));
+    }
+
+    if (!index) {
+      WARN_ZH("TextureDiskCache", "Could not write index");
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tempPath, indexPath, error);
+  if (error) {
+    WARN_ZH("TextureDiskCache", "Could not replace index: {}", error.message());
+    return false;
+  }
+
+  this->dirty = false;
+
+  return true;
+}
+
+bool TextureDiskCache::compact(uint64_t targetSize) {
+  TRACY(ZoneScoped);
+
+  std::vector<IndexRecord> kept;
+  kept.reserve(records.size());
+  for (auto& pair : records) {
+    kept.push_back(pair.second);
+  }
+
+  std::sort(kept.begin(), kept.end(), [](const IndexRecord& a, const IndexRecord& b) {
+    return a.lastUse > b.lastUse;
+  });
+
+  uint64_t keptSize = 0;
+  size_t numKept = 0;
+  while (numKept < kept.size() && keptSize + kept[numKept].size <= targetSize) {
+    keptSize += kept[numKept].size;
+    numKept += 1;
+  }
+  kept.resize(numKept);
+
+  // sequential reads from the old file
+  std::sort(kept.begin(), kept.end(), [](const IndexRecord& a, const IndexRecord& b) {
+    return a.offset < b.offset;
+  });
+
+  auto tempPath = dataPath;
+  tempPath += ".tmp";
+
+  {
+    std::ofstream compacted {tempPath, std::ios::binary | std::ios::trunc};
+    std::vector<char> buffer;
+    uint64_t offset = 0;
+
+    data.clear();
+    for (auto& record : kept) {
+      buffer.resize(record.size);
+      data.seekg(record.offset);
+      data.read(buffer.data(), buffer.size());
+      compacted.write(buffer.data(), buffer.size());
+
+      record.offset = offset;
+      offset += record.size;
+    }
+
+    if (!data || !compacted) {
+      WARN_ZH("TextureDiskCache", "Could not compact data file");
+      this->enabled = false;
+      return false;
+    }
+  }
+
+  data.close();
+
+  std::error_code error;
+  std::filesystem::rename(tempPath, dataPath, error);
+  data.open(dataPath, std::ios::in | std::ios::out | std::ios::binary);
+  if (error || !data) {
+    WARN_ZH("TextureDiskCache", "Could not replace data file");
+    this->enabled = false;
+    return false;
+  }
+
+  records.clear();
+  for (auto& record : kept) {
+    records.emplace(record.keyHash, record);
+  }
+  this->dataSize = keptSize;
+
+  return writeIndex();
+}
+
+std::shared_ptr<HostTexture> TextureDiskCache::readEntry(const std::string& key, const IndexRecord& record) {
+  EntryHeader header;
+
+  data.clear();
+  data.seekg(record.offset);
+  data.read(reinterpret_cast<char*>(&header), sizeof(EntryHeader));
+  if (!data
+      || header.keyLength != key.size()
+      || header.numLevels == 0
+      || header.numLevels > MAX_LEVELS
+      || header.format > static_cast<uint32_t>(HostTexture::Format::BC3)
+      || sizeof(EntryHeader) + key.size() + header.numLevels * sizeof(EntryLevel) + header.dataSize != record.size) {
+    return {};
+  }
+
+  std::string storedKey(header.keyLength, '\0');
+  data.read(storedKey.data(), storedKey.size());
+  if (!data || storedKey != key) {
+    return {};
+  }
+
+  std::vector<EntryLevel> entryLevels(header.numLevels);
+  data.read(reinterpret_cast<char*>(entryLevels.data()), entryLevels.size() * sizeof(EntryLevel));
+
+  std::vector<HostTexture::MipLevel> levels;
+  levels.reserve(entryLevels.size());
+  for (auto& level : entryLevels) {
+    if (level.offset >= header.dataSize) {
+      return {};
+    }
+
+    levels.push_back({Size {level.width, level.height}, level.offset});
+  }
+
+  // read in place, no decoding left to do
+  std::vector<char> textureData(header.dataSize);
+  data.read(textureData.data(), textureData.size());
+  if (!data) {
+    return {};
+  }
+
+  return std::make_shared<HostTexture>(
+      Size {header.width, header.height}
+    , static_cast<HostTexture::Format>(header.format)
+    , std::move(textureData)
+    , std::move(levels)
+  );
+}
+
+}
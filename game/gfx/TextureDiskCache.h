@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_GFX_TEXTURE_DISK_CACHE
+#define H_GFX_TEXTURE_DISK_CACHE
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../common.h"
+#include "HostTexture.h"
+
+namespace ZH::GFX {
+
+// Decoded textures with their mip levels, appended to one data file
+// and located through an index of fixed size records. Entries match
+// by key and a hash of the source bytes, so anything changed in the
+// archives just misses. Over budget, the least recently used entries
+// are dropped by rewriting the data file.
+class TextureDiskCache {
+  public:
+    // bump on any change of the layout or of the decoders
+    static constexpr uint32_t VERSION = 1;
+
+    TextureDiskCache(const std::filesystem::path& directory, size_t budget);
+    ~TextureDiskCache();
+
+    TextureDiskCache(const TextureDiskCache&) = delete;
+    TextureDiskCache& operator=(const TextureDiskCache&) = delete;
+
+    std::shared_ptr<HostTexture> get(const std::string& key, uint32_t sourceHash);
+    void put(const std::string& key, uint32_t sourceHash, const HostTexture&);
+    // writes the index, also done on destruction
+    void flush();
+
+    size_t getDataSize() const;
+    size_t getNumEntries() const;
+  private:
+    struct IndexHeader {
+      char magic[4];
+      uint32_t version;
+      uint32_t numRecords;
+      uint32_t reserved;
+      uint64_t dataSize;
+      uint64_t useCounter;
+    };
+
+    struct IndexRecord {
+      uint32_t keyHash;
+      uint32_t sourceHash;
+      uint64_t offset;
+      uint64_t size;
+      uint64_t lastUse;
+    };
+
+    struct EntryHeader {
+      uint32_t keyLength;
+      uint32_t format;
+      uint32_t width;
+      uint32_t height;
+      uint32_t numLevels;
+      uint32_t reserved;
+      uint64_t dataSize;
+    };
+
+    struct EntryLevel {
+      uint32_t width;
+      uint32_t height;
+      uint64_t offset;
+    };
+
+    std::filesystem::path indexPath;
+    std::filesystem::path dataPath;
+    size_t budget;
+    bool enabled = false;
+    bool dirty = false;
+
+    std::fstream data;
+    uint64_t dataSize = 0;
+    uint64_t useCounter = 0;
+    // by key hash, the key itself is stored and checked in the entry
+    std::unordered_multimap<uint32_t, IndexRecord> records;
+    mutable std::mutex mutex;
+
+    bool open();
+    bool readIndex();
+    bool writeIndex();
+    bool compact(uint64_t targetSize);
+    std::shared_ptr<HostTexture> readEntry(const std::string& key, const IndexRecord&);
+};
+
+}
+
+#endif
@@ -4,6 +4,7 @@
 
 #include "../common.h"
 #include "../Logging.h"
+#include "../MurmurHash.h"
 #include "../formats/DDSFile.h"
 #include "../formats/TGAFile.h"
 #include "TextureLoader.h"
@@ -17,33 +18,44 @@ static std::vector<std::string> texturePrefixes {{
   , "art\\terrain\\"
 }};
 
-TextureLoader::TextureLoader(ResourceLoader& resourceLoader)
-  : resourceLoader(resourceLoader)
+TextureLoader::TextureLoader(
+    ResourceLoader& resourceLoader
+  , bool compressedTextures
+  , OptionalRef<TextureDiskCache> diskCache
+) : resourceLoader(resourceLoader)
+  , compressedTextures(compressedTextures)
+  , diskCache(diskCache)
 {}
 
-std::shared_ptr<HostTexture> TextureLoader::getTexture(std::string key) {
+std::shared_ptr<HostTexture> TextureLoader::getTexture(std::string key, bool decoded) {
   TRACY(ZoneScoped);
 
   std::optional<ResourceLoader::MemoryStream> lookup;
+  std::string path;
 
-  for (auto& prefix : texturePrefixes) {
-    std::string path {prefix};
-    path.append(key);
+  {
+    // ResourceLoader is not thread-safe, the streams are copies
+    std::lock_guard lock {resourceMutex};
 
-    lookup = resourceLoader.getFileStream(path, true);
-    if (lookup) {
-      break;
-    }
+    for (auto& prefix : texturePrefixes) {
+      path = prefix;
+      path.append(key);
 
-    // Some tga files are actually dds
-    if (path.ends_with(".tga")) {
-      path.replace(path.size() - 3, 3, "dds");
       lookup = resourceLoader.getFileStream(path, true);
-
       if (lookup) {
-        key.replace(key.size() - 3, 3, "dds");
         break;
       }
+
+      // Some tga files are actually dds
+      if (path.ends_with(".tga")) {
+        path.replace(path.size() - 3, 3, "dds");
+        lookup = resourceLoader.getFileStream(path, true);
+
+        if (lookup) {
+          key.replace(key.size() - 3, 3, "dds");
+          break;
+        }
+      }
     }
   }
 
@@ -52,6 +64,20 @@ std::shared_ptr<HostTexture> TextureLoader::getTexture(std::string key) {
     return {};
   }
 
+  // BC blocks are passed through as they are, nothing to save
+  bool keepBlocks = compressedTextures && !decoded;
+  uint32_t sourceHash = 0;
+  if (diskCache && !keepBlocks) {
+    MurmurHash3_32 hasher;
+    hasher.feed(lookup->getBuffer().data(), lookup->size());
+    sourceHash = hasher.getHash();
+
+    auto cached = diskCache->get().get(path, sourceHash);
+    if (cached) {
+      return cached;
+    }
+  }
+
   std::shared_ptr<HostTexture> hostTexture;
   auto stream = lookup->getStream();
 
@@ -60,7 +86,7 @@ std::shared_ptr<HostTexture> TextureLoader::getTexture(std::string key) {
 
     hostTexture = tga.getTexture();
   } else if (key.ends_with(".dds")) {
-    DDSFile dds {stream};
+    DDSFile dds {stream, keepBlocks};
 
     hostTexture = dds.getTexture();
   } else {
@@ -73,6 +99,15 @@ std::shared_ptr<HostTexture> TextureLoader::getTexture(std::string key) {
     return {};
   }
 
+  // TGA and files without stored levels, not possible for BC blocks
+  if (hostTexture->getMipLevels().size() == 1) {
+    hostTexture->generateMipLevels();
+  }
+
+  if (diskCache && !keepBlocks) {
+    diskCache->get().put(path, sourceHash, *hostTexture);
+  }
+
   return hostTexture;
 }
 
@@ -4,20 +4,33 @@
 #define H_GFX_TEXTURE_LOADER
 
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "../ResourceLoader.h"
 #include "HostTexture.h"
+#include "TextureDiskCache.h"
 
 namespace ZH::GFX {
 
 class TextureLoader {
   public:
-    TextureLoader(ResourceLoader& resourceLoader);
-    std::shared_ptr<HostTexture> getTexture(std::string key);
+    // compressedTextures keeps DDS files in BC1/BC3, decoded
+    // textures go through the disk cache if there is one
+    TextureLoader(
+        ResourceLoader& resourceLoader
+      , bool compressedTextures = false
+      , OptionalRef<TextureDiskCache> diskCache = {}
+    );
+    // decoded ignores compressedTextures, for copying texels on the host,
+    // callable from several threads with only the archive reads serialized
+    std::shared_ptr<HostTexture> getTexture(std::string key, bool decoded = false);
 
   private:
     ResourceLoader& resourceLoader;
+    bool compressedTextures;
+    OptionalRef<TextureDiskCache> diskCache;
+    std::mutex resourceMutex;
 };
 
 }
@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include "TextureStreamer.h"
+
+namespace ZH::GFX {
+
+TextureStreamer::TextureStreamer(Loader&& loader, size_t numWorkers)
+  : loader(std::move(loader))
+{
+  workers.reserve(numWorkers);
+
+  for (size_t i = 0; i < numWorkers; ++i) {
+    workers.emplace_back(&TextureStreamer::work, this);
+  }
+}
+
+TextureStreamer::~TextureStreamer() {
+  stop();
+}
+
+bool TextureStreamer::request(const std::string& key) {
+  {
+    std::lock_guard lock {mutex};
+
+    if (stopping || !pending.insert(key).second) {
+      return false;
+    }
+
+    queue.push_back(key);
+  }
+  wakeup.notify_one();
+
+  return true;
+}
+
+bool TextureStreamer::isPending(const std::string& key) const {
+  std::lock_guard lock {mutex};
+
+  return pending.contains(key);
+}
+
+std::vector<TextureStreamer::Result> TextureStreamer::takeFinished(size_t maxBytes) {
+  std::lock_guard lock {mutex};
+
+  std::vector<Result> results;
+  size_t bytes = 0;
+
+  while (!finished.empty() && (results.empty() || bytes < maxBytes)) {
+    auto& result = finished.front();
+    if (result.texture) {
+      bytes += result.texture->getData().size();
+    }
+
+    pending.erase(result.key);
+    results.push_back(std::move(result));
+    finished.pop_front();
+  }
+
+  return results;
+}
+
+void TextureStreamer::waitFinished() {
+  std::unique_lock lock {mutex};
+
+  // finished ones stay pending until taken
+  finishedSignal.wait(lock, [this]() { return !finished.empty() || pending.empty(); });
+}
+
+void TextureStreamer::stop() {
+  {
+    std::lock_guard lock {mutex};
+
+    if (stopping) {
+      return;
+    }
+
+    stopping = true;
+    for (auto& key : queue) {
+      pending.erase(key);
+    }
+    queue.clear();
+  }
+  wakeup.notify_all();
+  finishedSignal.notify_all();
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+void TextureStreamer::work() {
+  std::unique_lock lock {mutex};
+
+  while (true) {
+    wakeup.wait(lock, [this]() { return stopping || !queue.empty(); });
+    if (stopping) {
+      return;
+    }
+
+    auto key = std::move(queue.front());
+    queue.pop_front();
+
+    lock.unlock();
+    auto texture = loader(key);
+    lock.lock();
+
+    finished.push_back({std::move(key), std::move(texture)});
+    finishedSignal.notify_all();
+  }
+}
+
+}
@@ -0,0 +1,65 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_GFX_TEXTURE_STREAMER
+#define H_GFX_TEXTURE_STREAMER
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "HostTexture.h"
+
+namespace ZH::GFX {
+
+// Loads textures on threads of its own, apart from the JobSystem, so
+// long decodes never hold up a frame. Requests for a key that is
+// still on its way are merged, results are collected by the owner.
+class TextureStreamer {
+  public:
+    using Loader = std::function<std::shared_ptr<HostTexture>(const std::string&)>;
+
+    struct Result {
+      std::string key;
+      // empty if loading failed
+      std::shared_ptr<HostTexture> texture;
+    };
+
+    TextureStreamer(Loader&& loader, size_t numWorkers);
+    TextureStreamer(const TextureStreamer&) = delete;
+    ~TextureStreamer();
+
+    // false if the key is pending already
+    bool request(const std::string& key);
+    // queued, loading, or finished but not taken yet
+    bool isPending(const std::string& key) const;
+    // in order of completion, up to maxBytes of texture data but at
+    // least one, the rest stays for the next call
+    std::vector<Result> takeFinished(size_t maxBytes = SIZE_MAX);
+    // blocks until a result can be taken or nothing is left to load
+    void waitFinished();
+    // drops queued requests and waits for the running ones
+    void stop();
+  private:
+    Loader loader;
+    std::vector<std::thread> workers;
+    std::deque<std::string> queue;
+    std::deque<Result> finished;
+    std::unordered_set<std::string> pending;
+    mutable std::mutex mutex;
+    std::condition_variable wakeup;
+    std::condition_variable finishedSignal;
+    bool stopping = false;
+
+    void work();
+};
+
+}
+
+#endif
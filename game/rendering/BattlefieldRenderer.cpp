@@ -1,5 +1,12 @@
 // SPDX-License-Identifier: GPL-2.0
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <span>
+#include <unordered_set>
+
 #define GLM_FORCE_RADIANS
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -18,6 +25,13 @@ struct WaterScene {
   alignas(16) glm::mat4 mvp;
 };
 
+// screen space height error tolerated before picking a finer terrain LOD
+static constexpr float TERRAIN_PIXEL_ERROR = 1.5f;
+static constexpr uint32_t OCCLUSION_WIDTH = 256;
+static constexpr uint32_t OCCLUSION_HEIGHT = 144;
+// max. terrain occluder blocks along one side of the map
+static constexpr uint32_t OCCLUDER_GRID = 64;
+
 BattlefieldRenderer::BattlefieldRenderer(
     Vugl::Context& vuglContext
   , const Config& config
@@ -28,10 +42,12 @@ BattlefieldRenderer::BattlefieldRenderer(
   , const WaterINI::WaterSettings& waterSettings
 ) : vuglContext(vuglContext)
   , textureCache(textureCache)
+  , modelCache(modelCache)
   , battlefield(battlefield)
   , instanceRenderer {vuglContext, config, textureCache, modelCache}
   , terrains(terrains)
   , waterSettings(waterSettings)
+  , occlusionBuffer {OCCLUSION_WIDTH, OCCLUSION_HEIGHT}
 {}
 
 bool BattlefieldRenderer::init(Vugl::RenderPass& renderPass) {
@@ -39,6 +55,11 @@ bool BattlefieldRenderer::init(Vugl::RenderPass& renderPass) {
 
   auto& size = battlefield.getMapGameSize();
 
+  if (!prepareRenderLists()) {
+    WARN_ZH("BattlefieldRenderer", "Could not set up render lists");
+    return false;
+  }
+
   auto vp = vuglContext.getViewport();
   battlefield.setPerspectiveProjection(
       10.0f
@@ -80,6 +101,7 @@ bool BattlefieldRenderer::init(Vugl::RenderPass& renderPass) {
     WARN_ZH("BattlefieldRenderer", "Could not set up terrain");
     return false;
   }
+  prepareOccluders();
 
   auto map = battlefield.getMap();
   if (!prepareTerrainPipeline(renderPass, map->getTexturesIndex())) {
@@ -115,23 +137,220 @@ bool BattlefieldRenderer::init(Vugl::RenderPass& renderPass) {
   return true;
 }
 
-void BattlefieldRenderer::createRenderList(Vugl::CommandBuffer& commandBuffer, size_t frameIdx, Vugl::RenderPass& renderPass) {
+void BattlefieldRenderer::prewarm(JobSystem& jobSystem, const Progress& progress) {
   TRACY(ZoneScoped);
 
+  auto& instances = battlefield.getObjectInstances();
+
+  std::unordered_set<std::string> nameSet;
+  for (auto& instance : instances) {
+    InstanceRenderer::collectModelNames(*instance, nameSet);
+  }
+  std::vector<std::string> names {nameSet.cbegin(), nameSet.cend()};
+
+  size_t done = 0;
+  size_t total = names.size() + instances.size();
+  auto report = [&]() {
+    if (progress) {
+      progress(done, total);
+    }
+  };
+  report();
+
+  // held until the instances are prepared, so none is evicted before
+  std::vector<GFX::ModelCache::Models> models(names.size());
+
+  // in rounds to report progress from this thread
+  size_t roundSize = (jobSystem.getNumWorkers() + 1) * 4;
+  std::vector<JobSystem::Job> jobs;
+
+  for (size_t begin = 0; begin < names.size(); begin += roundSize) {
+    auto end = std::min(begin + roundSize, names.size());
+
+    jobs.clear();
+    for (size_t i = begin; i < end; ++i) {
+      jobs.emplace_back([this, &names, &models, i]() {
+        models[i] = modelCache.getModels(names[i]);
+      });
+    }
+    jobSystem.run(jobs);
+
+    done = end;
+    report();
+  }
+
+  // uploads the meshes and requests the textures
+  for (auto& instance : instances) {
+    instanceRenderer.prepareInstance(*instance);
+  }
+  done += instances.size();
+
+  // no frame recycles the uploads yet, their staging is reused anyway
+  vuglContext.flushUploads();
+
+  auto numTextures = instanceRenderer.getNumPendingTextures();
+  total += numTextures;
+  report();
+
+  while (true) {
+    instanceRenderer.updatePendingTextures();
+
+    auto numPending = instanceRenderer.getNumPendingTextures();
+    done = total - std::min(numPending, numTextures);
+    report();
+
+    if (numPending == 0) {
+      break;
+    }
+
+    textureCache.waitForLoads();
+    textureCache.update();
+    vuglContext.flushUploads();
+  }
+}
+
+void BattlefieldRenderer::createRenderList(
+    JobSystem& jobSystem
+  , size_t frameIdx
+  , Vugl::RenderPass& renderPass
+) {
+  TRACY(ZoneScoped);
+
+  if ((frameIdx + 1) * NUM_RENDER_LISTS > renderLists.size()) {
+    return;
+  }
+
   auto newMatrices = battlefield.cameraHasMoved();
+  auto commandBuffers = &renderLists[frameIdx * NUM_RENDER_LISTS];
+  for (size_t i = 0; i < NUM_RENDER_LISTS; ++i) {
+    commandBuffers[i].reset();
+  }
+
+  // shared by all object lists, so before recording
+  queueObjectInstances(jobSystem, frameIdx, newMatrices);
 
   std::array<VkClearValue, 2> clearColors{};
   clearColors[0].color = {0.0f, 0.0f, 0.0f, 1.0f};
   clearColors[1].depthStencil = {1.0f, 0};
-  commandBuffer.beginRendering(renderPass, clearColors);
 
-  renderTerrain(commandBuffer, frameIdx);
-  renderPatches(commandBuffer, frameIdx, newMatrices);
-  renderObjectInstances(commandBuffer, frameIdx, newMatrices);
+  std::vector<JobSystem::Job> jobs;
+  jobs.reserve(NUM_RENDER_LISTS);
+
+  auto addJob = [&](std::function<void(Vugl::CommandBuffer&)>&& record) {
+    auto& commandBuffer = commandBuffers[jobs.size()];
+    jobs.emplace_back([&commandBuffer, &renderPass, &clearColors, record = std::move(record)]() {
+      commandBuffer.beginRendering(renderPass, clearColors);
+      record(commandBuffer);
+      commandBuffer.closeRendering();
+    });
+  };
+
+  addJob([this, frameIdx](Vugl::CommandBuffer& commandBuffer) {
+    renderTerrain(commandBuffer, frameIdx);
+  });
+  addJob([this, frameIdx, newMatrices](Vugl::CommandBuffer& commandBuffer) {
+    renderPatches(commandBuffer, frameIdx, newMatrices);
+  });
+  for (size_t part = 0; part < NUM_OBJECT_LISTS; ++part) {
+    addJob([this, part](Vugl::CommandBuffer& commandBuffer) {
+      renderObjectInstances(commandBuffer, part);
+    });
+  }
   // TODO this still needs better Z ordering
-  renderWater(commandBuffer, frameIdx);
+  addJob([this, frameIdx](Vugl::CommandBuffer& commandBuffer) {
+    renderWater(commandBuffer, frameIdx);
+  });
+
+  jobSystem.run(jobs);
+
+  instanceRenderer.clearQueuedInstances();
+  instanceRenderer.finishResourceCounting();
+}
+
+std::span<const Vugl::CommandBuffer> BattlefieldRenderer::getRenderLists(size_t frameIdx) const {
+  if ((frameIdx + 1) * NUM_RENDER_LISTS > renderLists.size()) {
+    return {};
+  }
+
+  return std::span<const Vugl::CommandBuffer> {renderLists}.subspan(frameIdx * NUM_RENDER_LISTS, NUM_RENDER_LISTS);
+}
 
-  commandBuffer.closeRendering();
+void BattlefieldRenderer::prepareOccluders() {
+  TRACY(ZoneScoped);
+
+  auto& heightField = battlefield.getMap()->getHeightField();
+  auto size = heightField.getSize();
+  if (size.x == 0 || size.y == 0) {
+    return;
+  }
+
+  // the terrain is solid below the lowest point of a block,
+  // so its top and the steps between blocks hide what is behind
+  auto blockSize = (std::max(size.x, size.y) + OCCLUDER_GRID - 1) / OCCLUDER_GRID;
+  Size blocks {(size.x + blockSize - 1) / blockSize, (size.y + blockSize - 1) / blockSize};
+
+  std::vector<float> heights;
+  heights.reserve(blocks.x * blocks.y);
+  for (uint32_t by = 0; by < blocks.y; ++by) {
+    for (uint32_t bx = 0; bx < blocks.x; ++bx) {
+      auto origin = Point {bx * blockSize, by * blockSize};
+      auto range = heightField.getTileHeightRange(origin, origin + static_cast<int32_t>(blockSize));
+      heights.push_back(range.first * Map::TERRAIN_HEIGHT_SCALE);
+    }
+  }
+
+  auto toWorld = [&size](uint32_t x, float height, uint32_t y) {
+    return glm::vec3 {
+        std::min(x, size.x) * Map::GRID_TO_GAME_SCALE
+      , height
+      , std::min(y, size.y) * Map::GRID_TO_GAME_SCALE
+    };
+  };
+
+  auto addQuad = [this](glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 d) {
+    auto base = static_cast<uint32_t>(occluderVertices.size());
+    occluderVertices.insert(occluderVertices.end(), {a, b, c, d});
+    occluderIndices.insert(occluderIndices.end(), {base, base + 1, base + 2, base, base + 2, base + 3});
+  };
+
+  for (uint32_t by = 0; by < blocks.y; ++by) {
+    for (uint32_t bx = 0; bx < blocks.x; ++bx) {
+      auto height = heights[by * blocks.x + bx];
+      auto x0 = bx * blockSize, x1 = x0 + blockSize;
+      auto y0 = by * blockSize, y1 = y0 + blockSize;
+
+      addQuad(
+          toWorld(x0, height, y0)
+        , toWorld(x1, height, y0)
+        , toWorld(x1, height, y1)
+        , toWorld(x0, height, y1)
+      );
+
+      if (bx + 1 < blocks.x) {
+        auto next = heights[by * blocks.x + bx + 1];
+        if (next != height) {
+          addQuad(
+              toWorld(x1, height, y0)
+            , toWorld(x1, height, y1)
+            , toWorld(x1, next, y1)
+            , toWorld(x1, next, y0)
+          );
+        }
+      }
+
+      if (by + 1 < blocks.y) {
+        auto next = heights[(by + 1) * blocks.x + bx];
+        if (next != height) {
+          addQuad(
+              toWorld(x0, height, y1)
+            , toWorld(x1, height, y1)
+            , toWorld(x1, next, y1)
+            , toWorld(x0, next, y1)
+          );
+        }
+      }
+    }
+  }
 }
 
 bool BattlefieldRenderer::preparePatches(Vugl::RenderPass& renderPass) {
@@ -146,7 +365,7 @@ bool BattlefieldRenderer::preparePatches(Vugl::RenderPass& renderPass) {
   pipelineSetup.setVSCode(readFile("shaders/patch.vert.spv"));
   pipelineSetup.setFSCode(readFile("shaders/patch.frag.spv"));
 
-  pipelineSetup.reserveUniformBuffer(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+  pipelineSetup.reserveUniformBuffer(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, true);
   pipelineSetup.reserveCombinedSampler(VK_SHADER_STAGE_FRAGMENT_BIT);
 
   pipelineSetup.addVertexInput(VK_FORMAT_R32G32B32_SFLOAT, 0, 12, 0);
@@ -181,6 +400,30 @@ bool BattlefieldRenderer::preparePatches(Vugl::RenderPass& renderPass) {
   return true;
 }
 
+bool BattlefieldRenderer::prepareRenderLists() {
+  auto numSwapchainImages = vuglContext.getSwapchainImages().size();
+
+  commandPools.reserve(NUM_RENDER_LISTS);
+  for (size_t i = 0; i < NUM_RENDER_LISTS; ++i) {
+    auto& commandPool = commandPools.emplace_back(vuglContext.createCommandPool());
+    if (commandPool.getLastResult() != VK_SUCCESS) {
+      return false;
+    }
+  }
+
+  renderLists.reserve(numSwapchainImages * NUM_RENDER_LISTS);
+  for (size_t frameIdx = 0; frameIdx < numSwapchainImages; ++frameIdx) {
+    for (auto& commandPool : commandPools) {
+      auto& commandBuffer = renderLists.emplace_back(vuglContext.createCommandBuffer(frameIdx, commandPool));
+      if (commandBuffer.getLastResult() != VK_SUCCESS) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 bool BattlefieldRenderer::prepareScorches() {
   scorchTextureSampler = textureCache.getTextureSampler("exscorch01.dds");
   if (!scorchTextureSampler) {
@@ -188,13 +431,24 @@ bool BattlefieldRenderer::prepareScorches() {
   }
   vuglContext.uploadResource(*scorchTextureSampler);
 
+  // shared by all scorches, their data is passed by offsets
+  scorchDescriptorSet =
+    std::make_shared<Vugl::DescriptorSet>(patchPipeline->createDescriptorSet());
+  scorchDescriptorSet->assignFrameArena(vuglContext.getFrameArena(), sizeof(ScorchUBData));
+  scorchDescriptorSet->assignCombinedSampler(*scorchTextureSampler);
+  scorchDescriptorSet->updateDevice();
+
   return true;
 }
 
-bool BattlefieldRenderer::prepareScorchData(const Battlefield::ScorchData& scorch) {
+BattlefieldRenderer::ScorchData* BattlefieldRenderer::prepareScorchData(const Battlefield::ScorchData& scorch) {
   auto lookup = scorchData.find(scorch.id);
-  if (lookup != scorchData.cend()) {
-    return true;
+  if (lookup != scorchData.end()) {
+    return &lookup->second;
+  }
+
+  if (!scorchDescriptorSet) {
+    return nullptr;
   }
 
   auto entry = scorchData.emplace(std::make_pair(scorch.id, ScorchData {}));
@@ -214,17 +468,8 @@ bool BattlefieldRenderer::prepareScorchData(const Battlefield::ScorchData& scorc
   renderData.uv =
     glm::translate(glm::mat4 {1.0f}, translation)
       * glm::scale(glm::mat4 {1.0f}, glm::vec3 {1.0f/4.0f, 1.0f/4.0f, 1.0f});
-  renderData.descriptorSet =
-    std::make_shared<Vugl::DescriptorSet>(patchPipeline->createDescriptorSet());
-  renderData.uniformBuffer =
-    std::make_shared<Vugl::UniformBuffer>(vuglContext.createUniformBuffer(sizeof(ScorchUBData)));
-
-  renderData.descriptorSet->assignUniformBuffer(*renderData.uniformBuffer);
-  renderData.descriptorSet->assignCombinedSampler(*scorchTextureSampler);
 
-  renderData.descriptorSet->updateDevice();
-
-  return true;
+  return &renderData;
 }
 
 bool BattlefieldRenderer::prepareTerrainPipeline(
@@ -239,7 +484,7 @@ bool BattlefieldRenderer::prepareTerrainPipeline(
 
   pipelineSetup.reserveUniformBuffer(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
   pipelineSetup.reserveSampler(VK_SHADER_STAGE_FRAGMENT_BIT);
-  pipelineSetup.reserveTexture(VK_SHADER_STAGE_FRAGMENT_BIT, texturesIndex.size());
+  pipelineSetup.reserveTexture(VK_SHADER_STAGE_FRAGMENT_BIT);
   pipelineSetup.reserveTexture(VK_SHADER_STAGE_FRAGMENT_BIT);
 
   pipelineSetup.addVertexInput(VK_FORMAT_R32G32B32_SFLOAT, 0, 12, 0);
@@ -270,23 +515,28 @@ bool BattlefieldRenderer::prepareTerrainPipeline(
   terrainDescriptorSet->assignUniformBuffer(*terrainUniformBuffer);
   terrainDescriptorSet->assignSampler(*terrainTextureSampler);
 
-  terrainTextures.reserve(texturesIndex.size());
+  // one array layer per index, so vertex texture indices stay valid
+  std::vector<std::string> textureNames;
+  textureNames.reserve(texturesIndex.size());
   for (auto& keyName : texturesIndex) {
     auto terrainLookup = terrains.find(keyName);
     if (terrainLookup == terrains.cend()) {
       WARN_ZH("BattlefieldRenderer", "Terrain not found");
-      continue;
+      textureNames.emplace_back();
+    } else {
+      textureNames.push_back(terrainLookup->second.textureName);
     }
+  }
 
-    auto texture = terrainTextures.emplace_back(textureCache.getTexture(terrainLookup->second.textureName));
-    if (!texture) {
-      WARN_ZH("BattlefieldRenderer", "Terrain texture not found");
-      continue;
-    }
-    terrainDescriptorSet->assignTexture(*texture, 2);
-    vuglContext.uploadResource(*texture);
+  terrainTextures = textureCache.getTextureArray(textureNames);
+  if (!terrainTextures) {
+    WARN_ZH("BattlefieldRenderer", "Terrain textures not created");
+    return false;
   }
 
+  terrainDescriptorSet->assignTexture(*terrainTextures);
+  vuglContext.uploadResource(*terrainTextures);
+
   cloudTexture = textureCache.getTexture("tscloudmed.dds");
   if (!cloudTexture) {
     return false;
@@ -305,14 +555,30 @@ bool BattlefieldRenderer::prepareTerrainVertices() {
     std::make_shared<Vugl::ElementBuffer>(vuglContext.createElementBuffer(0));
   auto map = battlefield.getMap();
 
+  terrainLOD =
+    std::make_shared<GFX::TerrainLOD>(
+        map->getSize()
+      , map->getVertexData()
+      , map->getVertexIndices()
+      , map->getChunks()
+    );
+
   terrainVertices->setBigIndexBuffer(true);
-  terrainVertices->writeData(map->getVertexData(), map->getVertexIndices());
+  terrainVertices->writeData(map->getVertexData(), terrainLOD->getIndices());
   if (terrainVertices->getLastResult() != VK_SUCCESS) {
     return false;
   }
 
   vuglContext.uploadResource(*terrainVertices);
 
+  auto numChunks = static_cast<uint32_t>(map->getChunks().size());
+  terrainDrawCommands =
+    std::make_shared<Vugl::IndirectBuffer>(vuglContext.createIndirectBuffer(numChunks));
+  if (terrainDrawCommands->getLastResult() != VK_SUCCESS) {
+    return false;
+  }
+  terrainDraws.reserve(numChunks);
+
   return true;
 }
 
@@ -381,14 +647,170 @@ bool BattlefieldRenderer::prepareWaterVertices() {
   return true;
 }
 
-void BattlefieldRenderer::renderObjectInstances(
-    Vugl::CommandBuffer& commandBuffer
-  , size_t frameIdx
-  , bool newMatrices
-) {
+bool BattlefieldRenderer::updateInstanceTable() {
+  TRACY(ZoneScoped);
+
+  auto& instances = battlefield.getObjectInstances();
+  auto& table = instanceTable;
+
+  bool rebuild = table.instances.size() != instances.size();
+  if (!rebuild) {
+    size_t i = 0;
+    for (auto& instance : instances) {
+      if (table.instances[i++] != instance.get()) {
+        rebuild = true;
+        break;
+      }
+    }
+  }
+
+  auto n = instances.size();
+  if (rebuild) {
+    table.instances.clear();
+    for (auto& instance : instances) {
+      table.instances.push_back(instance.get());
+    }
+
+    // NaN is never equal, all spheres get updated
+    table.positions.assign(n, glm::vec3 {std::numeric_limits<float>::quiet_NaN()});
+    table.sphereX.resize(n);
+    table.sphereY.resize(n);
+    table.sphereZ.resize(n);
+    table.radii.resize(n);
+    table.distances.resize(n);
+    table.sortKeys.resize(n);
+    table.transparent.resize(n);
+    table.rows.clear();
+
+    for (size_t i = 0; i < n; ++i) {
+      auto& instance = *table.instances[i];
+      table.rows.emplace(&instance, i);
+      table.sortKeys[i] = instanceRenderer.getSortKey(instance);
+      table.transparent[i] = instanceRenderer.isTransparent(instance);
+
+      auto sphere = instanceRenderer.getBoundingSphere(instance);
+      battlefield.setInstanceDrawBounds(instance, sphere.position, sphere.radius);
+    }
+  }
+
+  std::vector<uint32_t> moved;
+  std::vector<glm::vec3> positions;
+  for (size_t i = 0; i < n; ++i) {
+    auto& position = table.instances[i]->getPosition();
+    if (table.positions[i] != position) {
+      moved.push_back(i);
+      positions.push_back(position);
+    }
+  }
+
+  if (moved.empty()) {
+    return rebuild;
+  }
+
+  std::vector<float> heights;
+  heights.resize(positions.size());
+  battlefield.getWorldHeights(positions, heights);
+
+  for (size_t k = 0; k < moved.size(); ++k) {
+    auto i = moved[k];
+    table.positions[i] = positions[k];
+
+    auto modelMatrix = battlefield.getWorldMatrix(positions[k], 0.0f, heights[k]);
+    auto sphere = instanceRenderer.getBoundingSphere(*table.instances[i]);
+    auto worldPosition = glm::vec3 {modelMatrix * glm::vec4 {sphere.position, 1.0f}};
+
+    table.sphereX[i] = worldPosition.x;
+    table.sphereY[i] = worldPosition.y;
+    table.sphereZ[i] = worldPosition.z;
+    table.radii[i] = sphere.radius;
+
+    // for whatever moved it without telling
+    if (!rebuild) {
+      battlefield.updateInstanceBounds(*table.instances[i]);
+    }
+  }
+
+  return true;
+}
+
+void BattlefieldRenderer::cullInstanceTable(JobSystem& jobSystem) {
+  TRACY(ZoneScoped);
+
+  auto& camera = battlefield.getCamera();
+  GFX::Frustum frustum {camera};
+
+  auto& table = instanceTable;
+  table.visible.clear();
+  table.candidates.clear();
+  battlefield.getInstanceIndex().query(frustum, table.candidates);
+
+  for (auto instance : table.candidates) {
+    auto lookup = table.rows.find(instance);
+    if (lookup != table.rows.cend()) {
+      table.visible.push_back(lookup->second);
+    }
+  }
+
+  if (!table.visible.empty() && !occluderIndices.empty()) {
+    TRACY(ZoneScoped);
+
+    occlusionBuffer.begin(camera);
+    occlusionBuffer.rasterize(occluderVertices, occluderIndices);
+    occlusionBuffer.finish();
+
+    auto end =
+      std::remove_if(table.visible.begin(), table.visible.end(), [this, &table](uint32_t i) {
+        return occlusionBuffer.isSphereOccluded(
+            glm::vec3 {table.sphereX[i], table.sphereY[i], table.sphereZ[i]}
+          , table.radii[i]
+        );
+      });
+    table.visible.erase(end, table.visible.end());
+  }
+
+  opaqueDraws.clear();
+  transparentDraws.clear();
+
+  auto& cameraPosition = camera.getPosition();
+  for (auto i : table.visible) {
+    if (table.transparent[i]) {
+      table.distances[i] =
+        glm::length(cameraPosition - glm::vec3 {table.sphereX[i], table.sphereY[i], table.sphereZ[i]});
+      transparentDraws.push_back(i);
+    } else {
+      opaqueDraws.push_back(i);
+    }
+  }
+
+  // opaque draws by mesh for state changes and instancing,
+  // blended ones back to front
+  // nested in a job, where the calling worker takes part
+  std::vector<JobSystem::Job> jobs;
+  jobs.emplace_back([this, &table]() {
+    std::sort(
+        opaqueDraws.begin()
+      , opaqueDraws.end()
+      , [&table](uint32_t a, uint32_t b) {
+        return table.sortKeys[a] < table.sortKeys[b]
+          || (table.sortKeys[a] == table.sortKeys[b] && a < b);
+      }
+    );
+  });
+  jobs.emplace_back([this, &table]() {
+    std::sort(
+        transparentDraws.begin()
+      , transparentDraws.end()
+      , [&table](uint32_t a, uint32_t b) { return table.distances[a] > table.distances[b]; }
+    );
+  });
+  jobSystem.run(jobs);
+}
+
+void BattlefieldRenderer::queueObjectInstances(JobSystem& jobSystem, size_t frameIdx, bool newMatrices) {
   TRACY(ZoneScoped);
 
   instanceRenderer.beginResourceCounting();
+  instanceRenderer.updatePendingTextures();
 
   for (auto& instance : battlefield.getObjectInstances()) {
     if (!instanceRenderer.prepareInstance(*instance)) {
@@ -401,69 +823,47 @@ void BattlefieldRenderer::renderObjectInstances(
     }
   }
 
-  if (vuglContext.isDebuggingAllowed()) {
-    commandBuffer.beginDebugLabel("Objects");
-  }
-
-  instanceRenderer.bindPipeline(commandBuffer);
+  auto tableChanged = updateInstanceTable();
 
-  // TODO instance movement, check for new/deleted instances
   if (newMatrices) {
-    auto& camera = battlefield.getCamera();
-    auto& camMatrix = camera.getCameraMatrix();
-    drawChecks.clear();
-    drawChecks.reserve(battlefield.getObjectInstances().size());
-
-    GFX::Frustum frustrum {camera};
-
-    for (auto& instance : battlefield.getObjectInstances()) {
+    for (auto instance : instanceTable.instances) {
       instanceRenderer.resetFrames(*instance);
+    }
+  }
 
-      auto modelMatrix = battlefield.getWorldMatrix(instance->getPosition(), 0.0f);
+  if (newMatrices || tableChanged) {
+    cullInstanceTable(jobSystem);
+  }
 
-      auto& drawCheck = drawChecks.emplace_back();
-      drawCheck.instance = instance;
-      drawCheck.sphere = instanceRenderer.getBoundingSphere(*instance);
+  for (auto idx : opaqueDraws) {
+    queueObjectInstance(*instanceTable.instances[idx], frameIdx);
+  }
+  for (auto idx : transparentDraws) {
+    queueObjectInstance(*instanceTable.instances[idx], frameIdx);
+  }
+}
 
-      // bounding sphere to world
-      auto& sphere = drawCheck.sphere;
-      drawCheck.sphere.position = glm::vec3 {modelMatrix * glm::vec4 {sphere.position, 1.0f}};
-      drawCheck.draw = frustrum.isSphereInside(sphere.position, sphere.radius);
-      drawCheck.dist = glm::length(camera.getPosition() - sphere.position);
-    }
+void BattlefieldRenderer::renderObjectInstances(Vugl::CommandBuffer& commandBuffer, size_t part) {
+  TRACY(ZoneScoped);
 
-    std::sort(
-        drawChecks.begin()
-      , drawChecks.end()
-      , [](const DrawCheck& a, const DrawCheck& b) { return a.dist > b.dist; }
-    );
+  if (vuglContext.isDebuggingAllowed()) {
+    commandBuffer.beginDebugLabel("Objects");
   }
 
-  for (auto& dc : drawChecks) {
-    if (dc.draw) {
-      renderObjectInstance(*dc.instance, commandBuffer, frameIdx);
-    }
-  }
+  instanceRenderer.bindPipeline(commandBuffer);
+  instanceRenderer.renderQueuedInstances(commandBuffer, sunlightNormal, part, NUM_OBJECT_LISTS);
 
   if (vuglContext.isDebuggingAllowed()) {
     commandBuffer.endDebugLabel();
   }
-
-  instanceRenderer.finishResourceCounting();
 }
 
-void BattlefieldRenderer::renderObjectInstance(
+void BattlefieldRenderer::queueObjectInstance(
     Objects::Instance& instance
-  , Vugl::CommandBuffer& commandBuffer
   , size_t frameIdx
 ) {
   TRACY(ZoneScoped);
 
-  if (vuglContext.isDebuggingAllowed()) {
-    auto label = fmt::format("{}: {}", instance.getID(), instance.getBase()->name);
-    commandBuffer.beginDebugLabel(label);
-  }
-
   if (instance.needsRedraw() || instanceRenderer.needsUpdate(instance, frameIdx)) {
     auto worldMatrix =
       battlefield.getWorldMatrix(
@@ -484,23 +884,25 @@ void BattlefieldRenderer::renderObjectInstance(
       * camera.getCameraMatrix()
       * worldMatrix;
 
+    // pixels per unit at distance 1, for the LODs
+    auto viewport = vuglContext.getViewport();
+    auto lodScale =
+      std::abs(camera.getProjectionMatrix()[1][1])
+        * std::abs(viewport.height)
+        / 2.0f;
+
     instanceRenderer.updateInstance(
         instance
       , frameIdx
       , mvp
-      , camera.getPosition()
       , normalMatrix
-      , sunlightNormal
+      , lodScale
     );
 
     instance.setRedrawn();
   }
 
-  instanceRenderer.renderInstance(instance, commandBuffer);
-
-  if (vuglContext.isDebuggingAllowed()) {
-    commandBuffer.endDebugLabel();
-  }
+  instanceRenderer.queueInstance(instance);
 }
 
 void BattlefieldRenderer::renderPatches(Vugl::CommandBuffer& commandBuffer, size_t frameIdx, bool newMatrices) {
@@ -510,40 +912,33 @@ void BattlefieldRenderer::renderPatches(Vugl::CommandBuffer& commandBuffer, size
     commandBuffer.beginDebugLabel("Scorches");
   }
 
-  for (auto& scorch : battlefield.getScorches()) {
-    if (!prepareScorchData(scorch)) {
-      continue;
-    }
-  }
-
-  // TODO consider changes to scorchs set (ptrs)
-  scorchOrderData.resize(scorchData.size());
-
   auto& camera = battlefield.getCamera();
   auto map = battlefield.getMap();
 
-  GFX::Frustum frustrum {camera};
-
   commandBuffer.bindResource(*patchPipeline);
   commandBuffer.bindResource(*patchVertices);
 
+  // TODO consider changes to scorchs set (ptrs)
   if (newMatrices) {
     TRACY(ZoneScoped);
     scorchFrameIdxSet = 0;
 
-    size_t i = 0;
-    for (auto& pair : scorchData) {
-      auto& scorch = pair.second;
-      auto& drawData = scorchOrderData[i];
+    GFX::Frustum frustum {camera};
+    visibleScorches.clear();
+    battlefield.getScorchIndex().query(frustum, visibleScorches);
 
-      auto scale = scorch.radius * 6.0f; // EVAL why so much bigger than drawn
-      auto position = glm::vec3 {map->getWorldOffsetMatrix() * glm::vec4 {scorch.position, 1.0f}};
+    scorchOrderData.clear();
+    for (auto visibleScorch : visibleScorches) {
+      auto scorch = prepareScorchData(*visibleScorch);
+      if (!scorch) {
+        continue;
+      }
 
-      drawData.scorch = &scorch;
-      drawData.draw = frustrum.isSphereInside(position, scale);
-      drawData.dist = glm::length(camera.getPosition() - position);
+      auto position = glm::vec3 {map->getWorldOffsetMatrix() * glm::vec4 {scorch->position, 1.0f}};
 
-      i += 1;
+      auto& drawData = scorchOrderData.emplace_back();
+      drawData.scorch = scorch;
+      drawData.dist = glm::length(camera.getPosition() - position);
     }
 
     std::sort(
@@ -558,19 +953,12 @@ void BattlefieldRenderer::renderPatches(Vugl::CommandBuffer& commandBuffer, size
   bool needsFrameUpdate = (scorchFrameIdxSet & (1 << frameIdx)) == 0;
   auto numVertices = patchVertices->getNumVertices();
   auto camMatrix = camera.getProjectionMatrix() * camera.getCameraMatrix();
-
-  ScorchUBData ubData;
-  ubData.sunlight = sunlightNormal;
+  auto& frameArena = vuglContext.getFrameArena();
 
   for (auto& orderData : scorchOrderData) {
     TRACY(ZoneScoped);
     auto scorch = orderData.scorch;
 
-    if (!orderData.draw) {
-      i += 1;
-      continue;
-    }
-
     if (needsFrameUpdate) {
       auto scale = scorch->radius * 2.0f;
 
@@ -586,14 +974,19 @@ void BattlefieldRenderer::renderPatches(Vugl::CommandBuffer& commandBuffer, size
             glm::mat4 {1.0f}
           , glm::vec3 {scale, 1.0f, scale}
         );
+      auto& ubData = scorch->ubData;
+      ubData.sunlight = sunlightNormal;
       ubData.uv = scorch->uv;
       ubData.mvp =
         camMatrix
         * drawTranslation
         * worldMatrix
         * scaleMatrix;
+    }
 
-      scorch->uniformBuffer->writeData(ubData, frameIdx);
+    auto offset = frameArena.push(scorch->ubData, frameIdx);
+    if (!offset) {
+      break;
     }
 
     if (vuglContext.isDebuggingAllowed()) {
@@ -601,7 +994,7 @@ void BattlefieldRenderer::renderPatches(Vugl::CommandBuffer& commandBuffer, size
       commandBuffer.beginDebugLabel(label);
     }
 
-    commandBuffer.bindResource(*scorch->descriptorSet);
+    commandBuffer.bindResource(*scorchDescriptorSet, std::span<const uint32_t> {&*offset, 1});
     commandBuffer.draw([numVertices](VkCommandBuffer vkCommandBuffer, uint32_t) {
       vkCmdDraw(vkCommandBuffer, 6, 1, 0, 0);
 
@@ -639,16 +1032,76 @@ void BattlefieldRenderer::renderTerrain(Vugl::CommandBuffer& commandBuffer, size
   scene.sunlight = sunlightNormal;
   terrainUniformBuffer->writeData(scene, frameIdx);
 
-  commandBuffer.bindResource(*terrainPipeline);
-  commandBuffer.bindResource(*terrainDescriptorSet);
-  commandBuffer.bindResource(*terrainVertices);
-
   auto map = battlefield.getMap();
-  auto numIndices = map->getVertexIndices().size();
-  commandBuffer.draw([numIndices](VkCommandBuffer vkCommandBuffer, uint32_t) {
-    vkCmdDrawIndexed(vkCommandBuffer, numIndices, 1, 0, 0, 0);
-    return VK_SUCCESS;
-  });
+  auto& chunks = map->getChunks();
+  auto& chunkLevels = terrainLOD->getChunkLevels();
+  GFX::Frustum frustum {camera};
+  terrainDraws.clear();
+
+  // grid height error per unit of distance that projects to the pixel error
+  auto& settings = camera.getPerspectiveSettings();
+  auto errorPerDistance =
+    TERRAIN_PIXEL_ERROR * 2.0f * std::tan(glm::radians(settings.fovDeg) * 0.5f)
+      / (settings.height * Map::TERRAIN_HEIGHT_SCALE);
+
+  for (size_t i = 0; i < chunks.size(); ++i) {
+    auto& chunk = chunks[i];
+    auto boundsMin = glm::vec3 {terrainScaleMatrix * glm::vec4 {chunk.boundsMin, 1.0f}};
+    auto boundsMax = glm::vec3 {terrainScaleMatrix * glm::vec4 {chunk.boundsMax, 1.0f}};
+
+    if (!frustum.isBoxInside(boundsMin, boundsMax)) {
+      continue;
+    }
+
+    auto closest = glm::clamp(camera.getPosition(), boundsMin, boundsMax);
+    auto distance = glm::length(camera.getPosition() - closest);
+    auto& level = chunkLevels[i][terrainLOD->selectLevel(i, distance * errorPerDistance)];
+
+    // neighbouring chunks of one level are continuous in the index buffer
+    if (!terrainDraws.empty()) {
+      auto& last = terrainDraws.back();
+      if (last.firstIndex + last.indexCount == level.firstIndex) {
+        last.indexCount += level.numIndices;
+        continue;
+      }
+    }
+
+    auto& draw = terrainDraws.emplace_back();
+    draw.indexCount = level.numIndices;
+    draw.instanceCount = 1;
+    draw.firstIndex = level.firstIndex;
+    draw.vertexOffset = 0;
+    draw.firstInstance = 0;
+  }
+
+  if (!terrainDraws.empty()) {
+    commandBuffer.bindResource(*terrainPipeline);
+    commandBuffer.bindResource(*terrainDescriptorSet);
+    commandBuffer.bindResource(*terrainVertices);
+
+    if (vuglContext.getVkEnabledDeviceFeatures().multiDrawIndirect) {
+      auto vkBuffer = terrainDrawCommands->getBuffer(frameIdx);
+      auto numDraws = terrainDrawCommands->writeCommands(terrainDraws, frameIdx);
+
+      commandBuffer.draw([vkBuffer, numDraws](VkCommandBuffer vkCommandBuffer, uint32_t) {
+        vkCmdDrawIndexedIndirect(
+            vkCommandBuffer
+          , vkBuffer
+          , 0
+          , numDraws
+          , sizeof(VkDrawIndexedIndirectCommand)
+        );
+        return VK_SUCCESS;
+      });
+    } else {
+      commandBuffer.draw([this](VkCommandBuffer vkCommandBuffer, uint32_t) {
+        for (auto& draw : terrainDraws) {
+          vkCmdDrawIndexed(vkCommandBuffer, draw.indexCount, 1, draw.firstIndex, 0, 0);
+        }
+        return VK_SUCCESS;
+      });
+    }
+  }
 
   if (vuglContext.isDebuggingAllowed()) {
     commandBuffer.endDebugLabel();
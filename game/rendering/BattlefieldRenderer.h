@@ -3,9 +3,15 @@
 #ifndef H_GAME_BATTLEFIELD_RENDERER
 #define H_GAME_BATTLEFIELD_RENDERER
 
+#include <functional>
+#include <span>
+
 #include "../common.h"
 #include "../Config.h"
 #include "../Battlefield.h"
+#include "../JobSystem.h"
+#include "../gfx/OcclusionBuffer.h"
+#include "../gfx/TerrainLOD.h"
 #include "../gfx/TextureCache.h"
 #include "InstanceRenderer.h"
 #include "../inis/TerrainINI.h"
@@ -16,6 +22,10 @@ namespace ZH {
 
 class BattlefieldRenderer {
   public:
+    // steps done of all, the total grows once the
+    // textures of the loaded models are known
+    using Progress = std::function<void(size_t done, size_t total)>;
+
     BattlefieldRenderer(
         Vugl::Context&
       , const Config&
@@ -28,13 +38,34 @@ class BattlefieldRenderer {
     BattlefieldRenderer(const BattlefieldRenderer&) = delete;
 
     bool init(Vugl::RenderPass&);
-    void createRenderList(Vugl::CommandBuffer&, size_t, Vugl::RenderPass&);
+    // loads all models the instances may show in parallel and waits
+    // for their textures, instead of the first frames doing so
+    void prewarm(JobSystem&, const Progress& = {});
+    // records the frame's secondaries as jobs, see `getRenderLists`
+    void createRenderList(JobSystem&, size_t, Vugl::RenderPass&);
+    // recorded secondaries of the frame, in drawing order
+    std::span<const Vugl::CommandBuffer> getRenderLists(size_t frameIdx) const;
   private:
-    struct DrawCheck {
-      std::shared_ptr<Objects::Instance> instance;
-      ModelRenderer::BoundingSphere sphere;
-      float dist = 0.0f;
-      bool draw = true;
+    // terrain, scorches, objects in parts, water
+    static constexpr size_t NUM_OBJECT_LISTS = 4;
+    static constexpr size_t NUM_RENDER_LISTS = NUM_OBJECT_LISTS + 3;
+
+    // battlefield instances as arrays, world bounding spheres
+    // of the models are only updated for moved instances
+    struct InstanceTable {
+      std::vector<Objects::Instance*> instances;
+      std::vector<glm::vec3> positions;
+      std::vector<float> sphereX;
+      std::vector<float> sphereY;
+      std::vector<float> sphereZ;
+      std::vector<float> radii;
+      std::vector<float> distances;
+      std::vector<uint32_t> sortKeys;
+      std::vector<uint8_t> transparent;
+      // of the instances, candidates come from Battlefield's index
+      std::unordered_map<const Objects::Instance*, uint32_t> rows;
+      std::vector<Objects::Instance*> candidates;
+      std::vector<uint32_t> visible;
     };
 
     struct ScorchUBData {
@@ -48,18 +79,17 @@ class BattlefieldRenderer {
       glm::vec3 position;
       float radius = 1.0f;
       glm::mat4 uv;
-      std::shared_ptr<Vugl::DescriptorSet> descriptorSet;
-      std::shared_ptr<Vugl::UniformBuffer> uniformBuffer;
+      ScorchUBData ubData;
     };
 
     struct ScorchOrderData {
       ScorchData *scorch = nullptr;
-      bool draw = true;
       float dist = 0.0f;
     };
 
     Vugl::Context& vuglContext;
     GFX::TextureCache& textureCache;
+    GFX::ModelCache& modelCache;
     Battlefield& battlefield;
     InstanceRenderer instanceRenderer;
     const TerrainINI::Terrains& terrains;
@@ -67,7 +97,19 @@ class BattlefieldRenderer {
     glm::mat4 terrainScaleMatrix;
     glm::mat4 waterScaleMatrix;
 
-    std::vector<DrawCheck> drawChecks;
+    // one pool per list slot, each slot is recorded by one job only
+    std::vector<Vugl::CommandPool> commandPools;
+    // NUM_RENDER_LISTS per frame
+    std::vector<Vugl::CommandBuffer> renderLists;
+
+    InstanceTable instanceTable;
+    std::vector<uint32_t> opaqueDraws;
+    std::vector<uint32_t> transparentDraws;
+
+    // terrain blocks at their lowest height, in world space
+    GFX::OcclusionBuffer occlusionBuffer;
+    std::vector<glm::vec3> occluderVertices;
+    std::vector<uint32_t> occluderIndices;
 
     bool hasWater = false;
     std::shared_ptr<Vugl::Texture> cloudTexture;
@@ -77,16 +119,21 @@ class BattlefieldRenderer {
     std::shared_ptr<Vugl::ElementBuffer> patchVertices;
 
     std::shared_ptr<Vugl::CombinedSampler> scorchTextureSampler;
+    std::shared_ptr<Vugl::DescriptorSet> scorchDescriptorSet;
     std::unordered_map<uint64_t, ScorchData> scorchData;
     uint64_t scorchFrameIdxSet = 0;
     std::vector<ScorchOrderData> scorchOrderData;
+    std::vector<const Battlefield::ScorchData*> visibleScorches;
 
     std::shared_ptr<Vugl::DescriptorSet> terrainDescriptorSet;
+    std::shared_ptr<Vugl::IndirectBuffer> terrainDrawCommands;
+    std::shared_ptr<GFX::TerrainLOD> terrainLOD;
+    std::vector<VkDrawIndexedIndirectCommand> terrainDraws;
     std::shared_ptr<Vugl::Pipeline> terrainPipeline;
     std::shared_ptr<Vugl::UniformBuffer> terrainUniformBuffer;
     std::shared_ptr<Vugl::ElementBuffer> terrainVertices;
     std::shared_ptr<Vugl::Sampler> terrainTextureSampler;
-    std::vector<std::shared_ptr<Vugl::Texture>> terrainTextures;
+    std::shared_ptr<Vugl::Texture> terrainTextures;
 
     std::shared_ptr<Vugl::DescriptorSet> waterDescriptorSet;
     std::shared_ptr<Vugl::Pipeline> waterPipeline;
@@ -94,16 +141,22 @@ class BattlefieldRenderer {
     std::shared_ptr<Vugl::UniformBuffer> waterUniformBuffer;
     std::shared_ptr<Vugl::ElementBuffer> waterVertices;
 
+    void prepareOccluders();
     bool preparePatches(Vugl::RenderPass&);
+    bool prepareRenderLists();
     bool prepareScorches();
-    bool prepareScorchData(const Battlefield::ScorchData&);
+    ScorchData* prepareScorchData(const Battlefield::ScorchData&);
     bool prepareTerrainPipeline(Vugl::RenderPass&, const std::vector<std::string>&);
     bool prepareTerrainVertices();
     bool prepareWaterPipeline(Vugl::RenderPass&);
     bool prepareWaterVertices();
 
-    void renderObjectInstances(Vugl::CommandBuffer&, size_t frameIdx, bool);
-    void renderObjectInstance(Objects::Instance&, Vugl::CommandBuffer&, size_t frameIdx);
+    void cullInstanceTable(JobSystem&);
+    bool updateInstanceTable();
+
+    void queueObjectInstances(JobSystem&, size_t frameIdx, bool);
+    void queueObjectInstance(Objects::Instance&, size_t frameIdx);
+    void renderObjectInstances(Vugl::CommandBuffer&, size_t part);
     void renderPatches(Vugl::CommandBuffer&, size_t frameIdx, bool);
     void renderTerrain(Vugl::CommandBuffer&, size_t frameIdx);
     void renderWater(Vugl::CommandBuffer&, size_t frameIdx);
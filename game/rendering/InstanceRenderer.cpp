@@ -6,6 +6,17 @@
 
 namespace ZH {
 
+static bool isModelDraw(Objects::DrawType type) {
+  return type == Objects::DrawType::DEPENDENCY_MODEL_DRAW
+    || type == Objects::DrawType::MODEL_DRAW
+    || type == Objects::DrawType::OVERLORD_AIRCRAFT_DRAW
+    || type == Objects::DrawType::OVERLORD_TANK_DRAW
+    || type == Objects::DrawType::POLICE_CAR_DRAW
+    || type == Objects::DrawType::SUPPLY_DRAW
+    || type == Objects::DrawType::TANK_DRAW
+    || type == Objects::DrawType::TRUCK_DRAW;
+}
+
 InstanceRenderer::InstanceRenderer(
     Vugl::Context& vuglContext
   , const Config& config
@@ -22,6 +33,32 @@ void InstanceRenderer::finishResourceCounting() {
   modelRenderer.beginResourceCounting();
 }
 
+void InstanceRenderer::collectModelNames(
+    const Objects::Instance& instance
+  , std::unordered_set<std::string>& names
+) {
+  for (auto& drawMetaData : instance.getBase()->drawMetaData) {
+    if (isModelDraw(drawMetaData.type)) {
+      auto modelSpec = static_pointer_cast<const Objects::ModelDrawData>(drawMetaData.drawData);
+
+      if (!modelSpec->defaultConditionState.model.empty()) {
+        names.insert(modelSpec->defaultConditionState.model);
+      }
+
+      for (auto& conditionState : modelSpec->conditionStates) {
+        if (!conditionState.model.empty()) {
+          names.insert(conditionState.model);
+        }
+      }
+    } else if (drawMetaData.type == Objects::DrawType::TREE_DRAW) {
+      auto treeSpec = static_pointer_cast<const Objects::TreeDrawData>(drawMetaData.drawData);
+      if (!treeSpec->model.empty()) {
+        names.insert(treeSpec->model);
+      }
+    }
+  }
+}
+
 ModelRenderer::BoundingSphere InstanceRenderer::getBoundingSphere(const Objects::Instance& instance) const {
   auto lookup = drawData.find(instance.getID());
   if (lookup == drawData.cend()) {
@@ -31,6 +68,30 @@ ModelRenderer::BoundingSphere InstanceRenderer::getBoundingSphere(const Objects:
   return lookup->second.boundingSphere;
 };
 
+uint32_t InstanceRenderer::getSortKey(const Objects::Instance& instance) const {
+  auto lookup = drawData.find(instance.getID());
+  if (lookup == drawData.cend() || lookup->second.currentDrawStates.empty()) {
+    return 0;
+  }
+
+  return modelRenderer.getSortKey(lookup->second.currentDrawStates.front().modelID);
+}
+
+bool InstanceRenderer::isTransparent(const Objects::Instance& instance) const {
+  auto lookup = drawData.find(instance.getID());
+  if (lookup == drawData.cend()) {
+    return false;
+  }
+
+  for (auto& drawState : lookup->second.currentDrawStates) {
+    if (modelRenderer.isTransparent(drawState.modelID)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 bool InstanceRenderer::prepareInstance(const Objects::Instance& instance) {
   TRACY(ZoneScoped);
 
@@ -50,15 +111,7 @@ bool InstanceRenderer::prepareInstance(const Objects::Instance& instance) {
       continue;
     }
 
-    if (drawMetaData.type == Objects::DrawType::DEPENDENCY_MODEL_DRAW
-        || drawMetaData.type == Objects::DrawType::MODEL_DRAW
-        || drawMetaData.type == Objects::DrawType::OVERLORD_AIRCRAFT_DRAW
-        || drawMetaData.type == Objects::DrawType::OVERLORD_TANK_DRAW
-        || drawMetaData.type == Objects::DrawType::POLICE_CAR_DRAW
-        || drawMetaData.type == Objects::DrawType::SUPPLY_DRAW
-        || drawMetaData.type == Objects::DrawType::TANK_DRAW
-        || drawMetaData.type == Objects::DrawType::TRUCK_DRAW
-    ) {
+    if (isModelDraw(drawMetaData.type)) {
       success &= prepareModelDrawData(instance, drawMetaData.drawData, newData);
     } else if (drawMetaData.type == Objects::DrawType::TREE_DRAW) {
       success &= prepareTreeDrawData(instance, drawMetaData.drawData, newData);
@@ -209,9 +262,8 @@ void InstanceRenderer::updateInstance(
     const Objects::Instance& instance
   , size_t frameIdx
   , const glm::mat4& mvp
-  , const glm::vec3& cameraPos
   , const glm::mat4& normal
-  , const glm::vec3& sunlightNormal
+  , float lodScale
 )  {
   auto lookup = drawData.find(instance.getID());
   if (lookup == drawData.cend()) {
@@ -224,9 +276,8 @@ void InstanceRenderer::updateInstance(
         drawState.modelID
       , frameIdx
       , mvp
-      , cameraPos
       , normal
-      , sunlightNormal
+      , lodScale
     );
   }
 
@@ -242,10 +293,15 @@ void InstanceRenderer::resetFrames(const Objects::Instance& instance) {
   lookup->second.frameIdxSet = 0;
 }
 
-bool InstanceRenderer::renderInstance(
-    const Objects::Instance& instance
-  , Vugl::CommandBuffer& commandBuffer
-)  {
+void InstanceRenderer::updatePendingTextures() {
+  modelRenderer.updatePendingTextures();
+}
+
+size_t InstanceRenderer::getNumPendingTextures() const {
+  return modelRenderer.getNumPendingTextures();
+}
+
+bool InstanceRenderer::queueInstance(const Objects::Instance& instance) {
   TRACY(ZoneScoped);
 
   auto lookup = drawData.find(instance.getID());
@@ -256,10 +312,23 @@ bool InstanceRenderer::renderInstance(
   bool success = true;
   auto& drawStates = lookup->second.currentDrawStates;
   for (auto& drawState : drawStates) {
-    success &= modelRenderer.renderModel(drawState.modelID, commandBuffer);
+    success &= modelRenderer.queueModel(drawState.modelID);
   }
 
   return success;
 }
 
+bool InstanceRenderer::renderQueuedInstances(
+    Vugl::CommandBuffer& commandBuffer
+  , const glm::vec3& sunlightNormal
+  , size_t part
+  , size_t numParts
+) {
+  return modelRenderer.renderQueuedModels(commandBuffer, sunlightNormal, part, numParts);
+}
+
+void InstanceRenderer::clearQueuedInstances() {
+  modelRenderer.clearQueuedModels();
+}
+
 }
@@ -5,6 +5,7 @@
 
 #include <set>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "../common.h"
 #include "../Config.h"
@@ -31,23 +32,36 @@ class InstanceRenderer {
     void finishResourceCounting();
     void bindPipeline(Vugl::CommandBuffer&);
 
+    // every model the instance may show over its conditions
+    static void collectModelNames(const Objects::Instance&, std::unordered_set<std::string>&);
+
     ModelRenderer::BoundingSphere getBoundingSphere(const Objects::Instance&) const;
+    size_t getNumPendingTextures() const;
+    uint32_t getSortKey(const Objects::Instance&) const;
+    bool isTransparent(const Objects::Instance&) const;
 
     bool needsUpdate(const Objects::Instance&, size_t frameIdx) const;
     bool prepareInstance(const Objects::Instance&);
     bool preparePipeline(Vugl::RenderPass&);
     void resetFrames(const Objects::Instance&);
+    void updatePendingTextures();
 
     void updateInstance(
         const Objects::Instance&
       , size_t frameIdx
       , const glm::mat4& mvp
-      , const glm::vec3& cameraPos
       , const glm::mat4& normal
-      , const glm::vec3& sunlightNormal
+      , float lodScale
     );
 
-    bool renderInstance(const Objects::Instance&, Vugl::CommandBuffer&);
+    bool queueInstance(const Objects::Instance&);
+    bool renderQueuedInstances(
+        Vugl::CommandBuffer&
+      , const glm::vec3& sunlightNormal
+      , size_t part = 0
+      , size_t numParts = 1
+    );
+    void clearQueuedInstances();
   private:
     struct InstanceData {
       struct DrawState {
@@ -1,6 +1,9 @@
 // SPDX-License-Identifier: GPL-2.0
 
 #include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <unordered_set>
 
 #include "../gfx/VkExt.h"
 #include "ModelRenderer.h"
@@ -16,6 +19,7 @@ ModelRenderer::ModelRenderer(
   , config(config)
   , textureCache(textureCache)
   , modelCache(modelCache)
+  , meshPool(vuglContext)
 {}
 
 void ModelRenderer::beginResourceCounting() {
@@ -46,12 +50,17 @@ bool ModelRenderer::preparePipeline(Vugl::RenderPass& renderPass) {
   pipelineSetup.setFSCode(readFile("shaders/model.frag.spv"));
   pipelineSetup.addDynamicState(VK_DYNAMIC_STATE_CULL_MODE);
 
-  pipelineSetup.reserveUniformBuffer(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+  pipelineSetup.reserveUniformBuffer(VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, true);
   pipelineSetup.reserveCombinedSampler(VK_SHADER_STAGE_FRAGMENT_BIT);
 
+  // GFX::MeshPool::PackedVertex
   pipelineSetup.addVertexInput(VK_FORMAT_R32G32B32_SFLOAT, 0, 12, 0);
-  pipelineSetup.addVertexInput(VK_FORMAT_R32G32B32_SFLOAT, 12, 12, 0);
-  pipelineSetup.addVertexInput(VK_FORMAT_R32G32_SFLOAT, 24, 8, 0);
+  pipelineSetup.addVertexInput(VK_FORMAT_R8G8B8A8_SNORM, 12, 4, 0);
+  pipelineSetup.addVertexInput(VK_FORMAT_R16G16_SFLOAT, 16, 4, 0);
+  // ShaderData, column-wise
+  for (uint32_t i = 0; i < 8; ++i) {
+    pipelineSetup.addVertexInput(VK_FORMAT_R32G32B32A32_SFLOAT, i * 16, 16, 1, true);
+  }
 
   pipeline =
     std::make_shared<Vugl::Pipeline>(vuglContext.createPipeline(pipelineSetup, renderPass.getVkRenderPass()));
@@ -86,8 +95,12 @@ bool ModelRenderer::prepareModel(uint64_t id, const std::string& modelName) {
   renderData->numModels = models->size();
   renderData->shaderData.resize(models->size());
 
-  renderData->drawOrder.resize(models->size());
+  renderData->elementKeys.resize(models->size());
   renderData->backfaceCulling.resize(models->size());
+  renderData->transparent.resize(models->size());
+  renderData->minScreenSizes.resize(models->size());
+  renderData->maxScreenSizes.resize(models->size());
+  renderData->levels.resize(models->size(), 0);
   renderData->boundingSpheres.resize(models->size());
 
   uint32_t i = 0;
@@ -97,24 +110,19 @@ bool ModelRenderer::prepareModel(uint64_t id, const std::string& modelName) {
     hasher.feed(i);
     auto key = hasher.getHash();
 
-    auto& descriptorSet =
-      renderData->descriptorSets.emplace_back(pipeline->createDescriptorSet());
-    auto& uniformBuffer =
-      renderData->uniformBuffers.emplace_back(vuglContext.createUniformBuffer(sizeof(ShaderData)));
+    renderData->elementKeys[i] = key;
     renderData->transformations[i] = model->transformation;
     renderData->backfaceCulling[i] = model->backfaceCulling;
-
-    auto vertexLookup = vertexData.find(key);
-    if (vertexLookup == vertexData.cend()) {
-      auto modelVertices =
-        std::make_shared<Vugl::ElementBuffer>(vuglContext.createElementBuffer(0));
-
-      modelVertices->setBigIndexBuffer(true);
-      modelVertices->writeData(model->vertexData, model->vertexIndices);
-
-      vuglContext.uploadResource(*modelVertices);
-
-      vertexData.emplace(std::make_pair(key, std::move(modelVertices)));
+    renderData->transparent[i] = model->transparent;
+    renderData->anyTransparent |= model->transparent;
+    renderData->minScreenSizes[i] = model->minScreenSize;
+    renderData->maxScreenSizes[i] = model->maxScreenSize;
+
+    if (!meshes.contains(key)) {
+      auto levels = meshPool.add(*model);
+      if (!levels.empty()) {
+        meshes.emplace(key, std::move(levels));
+      }
     }
 
     // Assume the biggest radius is the one to use for everything
@@ -129,25 +137,31 @@ bool ModelRenderer::prepareModel(uint64_t id, const std::string& modelName) {
       , model->boundingSphereRadius
     };
 
-    i += 1;
-
     // EVAL per-triangle texture
     // EVAL somethings without textures
     std::string textureName {"cbsandbw.dds"};
     if (!model->textures.empty()) {
       textureName = model->textures.back();
     }
-    auto sampler = textureCache.getTextureSampler(textureName);
+    auto sampler = textureCache.requestTextureSampler(textureName);
     if (!sampler) {
-      WARN_ZH("BattlefieldRenderer", "Failed to load model texture {}", textureName);
-      return false;
+      if (!textureCache.isLoading(textureName)) {
+        WARN_ZH("BattlefieldRenderer", "Failed to load model texture {}", textureName);
+        return false;
+      }
+
+      sampler = textureCache.getPlaceholderSampler();
+      if (!sampler) {
+        return false;
+      }
+
+      renderData->pendingTextures.push_back({i, std::move(textureName)});
     }
 
-    descriptorSet.assignUniformBuffer(uniformBuffer);
-    descriptorSet.assignCombinedSampler(*sampler);
-    vuglContext.uploadResource(*sampler);
+    renderData->descriptorSets.emplace_back(createDescriptorSet(*sampler));
+    renderData->textures.emplace_back(std::move(sampler));
 
-    descriptorSet.updateDevice();
+    i += 1;
   }
 
   renderDataMap.emplace(std::make_pair(id, std::move(renderData)));
@@ -155,6 +169,48 @@ bool ModelRenderer::prepareModel(uint64_t id, const std::string& modelName) {
   return true;
 }
 
+void ModelRenderer::updatePendingTextures() {
+  TRACY(ZoneScoped);
+
+  for (auto& pair : renderDataMap) {
+    auto& renderData = *pair.second;
+    auto& pending = renderData.pendingTextures;
+
+    for (auto it = pending.begin(); it != pending.end();) {
+      auto sampler = textureCache.pollTextureSampler(it->name);
+      if (!sampler && !textureCache.isLoading(it->name)) {
+        // evicted before getting here, or failed
+        sampler = textureCache.requestTextureSampler(it->name);
+      }
+
+      if (!sampler && textureCache.isLoading(it->name)) {
+        ++it;
+        continue;
+      }
+
+      // failed ones stay with the placeholder
+      if (sampler) {
+        renderData.descriptorSets[it->model] = createDescriptorSet(*sampler);
+        renderData.textures[it->model] = std::move(sampler);
+      }
+
+      it = pending.erase(it);
+    }
+  }
+}
+
+size_t ModelRenderer::getNumPendingTextures() const {
+  std::unordered_set<std::string> names;
+
+  for (auto& pair : renderDataMap) {
+    for (auto& pending : pair.second->pendingTextures) {
+      names.insert(pending.name);
+    }
+  }
+
+  return names.size();
+}
+
 void ModelRenderer::bindPipeline(Vugl::CommandBuffer& commandBuffer) {
   commandBuffer.bindResource(*pipeline);
 }
@@ -168,13 +224,30 @@ ModelRenderer::BoundingSphere ModelRenderer::getBoundingSphere(uint64_t id) cons
   return lookup->second->boundingSphere;
 }
 
+uint32_t ModelRenderer::getSortKey(uint64_t id) const {
+  auto lookup = renderDataMap.find(id);
+  if (lookup == renderDataMap.cend()) {
+    return 0;
+  }
+
+  return lookup->second->vertexKey;
+}
+
+bool ModelRenderer::isTransparent(uint64_t id) const {
+  auto lookup = renderDataMap.find(id);
+  if (lookup == renderDataMap.cend()) {
+    return false;
+  }
+
+  return lookup->second->anyTransparent;
+}
+
 void ModelRenderer::updateModel(
     uint64_t id
-  , size_t frameIdx
+  , size_t /*frameIdx*/
   , const glm::mat4& mvp
-  , const glm::vec3& cameraPos
   , const glm::mat4& normal
-  , const glm::vec3& sunlightNormal
+  , float lodScale
 ) {
   auto lookup = renderDataMap.find(id);
   if (lookup == renderDataMap.cend()) {
@@ -187,6 +260,9 @@ void ModelRenderer::updateModel(
   axisFlip[2][1] = 1.0f;
   axisFlip[2][2] = 0.0f;
 
+  auto viewport = vuglContext.getViewport();
+  auto screenArea = std::abs(viewport.width * viewport.height);
+
   auto& renderData = lookup->second;
   for (size_t i = 0; i < renderData->numModels; ++i) {
     glm::mat4 transformRotation = renderData->transformations[i];
@@ -198,20 +274,40 @@ void ModelRenderer::updateModel(
       normal
         * axisFlip
         * transformRotation;
-    shaderData.sunlight = sunlightNormal;
-    renderData->uniformBuffers[i].writeData(shaderData, frameIdx);
-    renderData->drawOrder[i] =
-      std::make_pair(i, glm::length(cameraPos - renderData->boundingSpheres[i].position));
-  }
 
-  std::sort(
-      renderData->drawOrder.begin()
-    , renderData->drawOrder.end()
-    , [](const OrderPair& a, const OrderPair& b) { return a.second > b.second; }
-  );
+    // up close or behind the camera in full
+    auto& level = renderData->levels[i];
+    level = 0;
+
+    auto& boundingSphere = renderData->boundingSpheres[i];
+    auto distance = (mvp * axisFlip * glm::vec4 {boundingSphere.position, 1.0f}).w;
+    if (distance <= 0.0f) {
+      continue;
+    }
+
+    auto pixelsPerUnit = lodScale / distance;
+    auto radius = boundingSphere.radius * pixelsPerUnit;
+    auto screenSize = std::numbers::pi_v<float> * radius * radius / screenArea;
+    if (screenSize < renderData->minScreenSizes[i] || screenSize >= renderData->maxScreenSizes[i]) {
+      level = HIDDEN_LEVEL;
+      continue;
+    }
+
+    // the coarsest one still looking the same
+    auto meshLookup = meshes.find(renderData->elementKeys[i]);
+    if (meshLookup == meshes.cend()) {
+      continue;
+    }
+
+    auto& levels = meshLookup->second;
+    while (level + 1u < levels.size()
+        && levels[level + 1].error * pixelsPerUnit <= config.modelLODPixelError) {
+      level += 1;
+    }
+  }
 }
 
-bool ModelRenderer::renderModel(uint64_t id, Vugl::CommandBuffer& commandBuffer) {
+bool ModelRenderer::queueModel(uint64_t id) {
   TRACY(ZoneScoped);
 
   auto renderDataLookup = renderDataMap.find(id);
@@ -222,26 +318,163 @@ bool ModelRenderer::renderModel(uint64_t id, Vugl::CommandBuffer& commandBuffer)
   auto& renderData = renderDataLookup->second;
   renderData->decreaseMiss();
 
-  for (auto& pair : renderData->drawOrder) {
-    auto i = pair.first;
-    MurmurHash3_32 hasher;
-    hasher.feed(renderData->vertexKey);
-    hasher.feed(i);
-    auto key = hasher.getHash();
-
-    auto elementBufferLookup = vertexData.find(key);
-    if (elementBufferLookup == vertexData.cend()) {
+  for (size_t i = 0; i < renderData->numModels; ++i) {
+    auto level = renderData->levels[i];
+    if (level == HIDDEN_LEVEL) {
       continue;
     }
-    auto& elementBuffer = elementBufferLookup->second;
 
-    commandBuffer.bindResource(renderData->descriptorSets[i]);
-    commandBuffer.bindResource(*elementBuffer);
+    auto elementKey = renderData->elementKeys[i];
+    auto key = (static_cast<uint64_t>(elementKey) << 8) | level;
+    auto transparent = renderData->transparent[i];
+
+    Batch* batch = nullptr;
+    if (transparent) {
+      if (numTransparentBatches > 0 && transparentBatches[numTransparentBatches - 1].key == key) {
+        batch = &transparentBatches[numTransparentBatches - 1];
+      }
+    } else {
+      auto batchLookup = opaqueBatchIndices.find(key);
+      if (batchLookup != opaqueBatchIndices.cend()) {
+        batch = &opaqueBatches[batchLookup->second];
+      }
+    }
+
+    if (!batch) {
+      auto meshLookup = meshes.find(elementKey);
+      if (meshLookup == meshes.cend() || level >= meshLookup->second.size()) {
+        continue;
+      }
+
+      auto& batches = transparent ? transparentBatches : opaqueBatches;
+      auto& numBatches = transparent ? numTransparentBatches : numOpaqueBatches;
+      if (numBatches == batches.size()) {
+        batches.emplace_back();
+      }
+
+      if (!transparent) {
+        opaqueBatchIndices.emplace(key, numBatches);
+      }
+
+      batch = &batches[numBatches];
+      batch->key = key;
+      batch->mesh = meshLookup->second[level];
+      batch->descriptorSet = renderData->descriptorSets[i].get();
+      batch->backfaceCulling = renderData->backfaceCulling[i];
+      numBatches += 1;
+    }
+
+    batch->instances.push_back(renderData->shaderData[i]);
+  }
+
+  return true;
+}
+
+bool ModelRenderer::renderQueuedModels(
+    Vugl::CommandBuffer& commandBuffer
+  , const glm::vec3& sunlightNormal
+  , size_t part
+  , size_t numParts
+) {
+  TRACY(ZoneScoped);
+
+  // opaque batches first, then the transparent ones
+  auto numBatches = numOpaqueBatches + numTransparentBatches;
+  auto begin = numBatches * part / numParts;
+  auto end = numBatches * (part + 1) / numParts;
+  if (begin == end) {
+    return true;
+  }
+
+  auto& frameArena = vuglContext.getFrameArena();
+
+  SceneData sceneData;
+  sceneData.sunlight = sunlightNormal;
+  auto sceneOffset = frameArena.push(sceneData, commandBuffer.getFrameIndex());
+  if (!sceneOffset) {
+    return false;
+  }
+
+  return
+    renderBatches(
+        commandBuffer
+      , opaqueBatches
+      , std::min(begin, numOpaqueBatches)
+      , std::min(end, numOpaqueBatches)
+      , *sceneOffset
+    )
+    && renderBatches(
+        commandBuffer
+      , transparentBatches
+      , std::max(begin, numOpaqueBatches) - numOpaqueBatches
+      , std::max(end, numOpaqueBatches) - numOpaqueBatches
+      , *sceneOffset
+    );
+}
+
+void ModelRenderer::clearQueuedModels() {
+  for (size_t b = 0; b < numOpaqueBatches; ++b) {
+    opaqueBatches[b].instances.clear();
+  }
+  for (size_t b = 0; b < numTransparentBatches; ++b) {
+    transparentBatches[b].instances.clear();
+  }
+  numOpaqueBatches = 0;
+  numTransparentBatches = 0;
+  opaqueBatchIndices.clear();
+}
+
+std::shared_ptr<Vugl::DescriptorSet> ModelRenderer::createDescriptorSet(Vugl::CombinedSampler& sampler) {
+  // sub-meshes of the same texture share a set
+  auto descriptorSet = pipeline->createDescriptorSet();
+  descriptorSet.assignFrameArena(vuglContext.getFrameArena(), sizeof(SceneData));
+  descriptorSet.assignCombinedSampler(sampler);
+  vuglContext.uploadResource(sampler);
+
+  return vuglContext.shareDescriptorSet(std::move(descriptorSet));
+}
+
+bool ModelRenderer::renderBatches(
+    Vugl::CommandBuffer& commandBuffer
+  , std::vector<Batch>& batches
+  , size_t begin
+  , size_t end
+  , uint32_t sceneOffset
+) {
+  auto& frameArena = vuglContext.getFrameArena();
+  auto frameIdx = commandBuffer.getFrameIndex();
+  auto vkInstanceBuffer = frameArena.getBuffers()[frameIdx];
+
+  // mostly one pool for everything, and sets shared by texture
+  Vugl::ElementPool* boundPool = nullptr;
+  Vugl::DescriptorSet* boundDescriptorSet = nullptr;
+
+  for (size_t b = begin; b < end; ++b) {
+    auto& batch = batches[b];
+
+    auto instanceOffset = frameArena.push(std::span<const ShaderData> {batch.instances}, frameIdx);
+    if (!instanceOffset) {
+      return false;
+    }
+
+    if (batch.descriptorSet != boundDescriptorSet) {
+      commandBuffer.bindResource(*batch.descriptorSet, std::span<const uint32_t> {&sceneOffset, 1});
+      boundDescriptorSet = batch.descriptorSet;
+    }
+    if (batch.mesh.pool != boundPool) {
+      commandBuffer.bindResource(*batch.mesh.pool);
+      boundPool = batch.mesh.pool;
+    }
+
+    auto mesh = batch.mesh;
+    auto numInstances = static_cast<uint32_t>(batch.instances.size());
+    auto backfaceCulling = batch.backfaceCulling;
+    VkDeviceSize vkInstanceOffset = *instanceOffset;
 
-    auto numIndices = elementBuffer->getNumIndices();
-    commandBuffer.draw([numIndices, &renderData, i](VkCommandBuffer vkCommandBuffer, uint32_t) {
-      pVkCmdSetCullModeEXT(vkCommandBuffer, renderData->backfaceCulling[i] ? VK_CULL_MODE_BACK_BIT : VK_CULL_MODE_NONE);
-      vkCmdDrawIndexed(vkCommandBuffer, numIndices, 1, 0, 0, 0);
+    commandBuffer.draw([=](VkCommandBuffer vkCommandBuffer, uint32_t) {
+      vkCmdBindVertexBuffers(vkCommandBuffer, 1, 1, &vkInstanceBuffer, &vkInstanceOffset);
+      pVkCmdSetCullModeEXT(vkCommandBuffer, backfaceCulling ? VK_CULL_MODE_BACK_BIT : VK_CULL_MODE_NONE);
+      vkCmdDrawIndexed(vkCommandBuffer, mesh.numIndices, numInstances, mesh.firstIndex, mesh.vertexOffset, 0);
 
       return VK_SUCCESS;
     });
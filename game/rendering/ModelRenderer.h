@@ -6,6 +6,7 @@
 #include "../common.h"
 #include "../Config.h"
 #include "../gfx/FrameDisposable.h"
+#include "../gfx/MeshPool.h"
 #include "../gfx/ModelCache.h"
 #include "../gfx/TextureCache.h"
 #include "../vugl/vugl_context.h"
@@ -33,37 +34,75 @@ class ModelRenderer {
     void finishResourceCounting();
 
     bool preparePipeline(Vugl::RenderPass&);
+    // models with textures still loading are drawn with a placeholder
     bool prepareModel(uint64_t id, const std::string&);
+    // swaps in the textures that finished loading, once per frame
+    void updatePendingTextures();
+    // distinct ones over all prepared models
+    size_t getNumPendingTextures() const;
 
     void bindPipeline(Vugl::CommandBuffer&);
     BoundingSphere getBoundingSphere(uint64_t id) const;
+    // same for the same mesh and textures
+    uint32_t getSortKey(uint64_t id) const;
+    bool isTransparent(uint64_t id) const;
 
+    // also picks the LODs, lodScale is pixels per model unit
+    // at a view distance of 1
     void updateModel(
         uint64_t id
       , size_t frameIdx
       , const glm::mat4& mvp
-      , const glm::vec3& cameraPos
       , const glm::mat4& normal
+      , float lodScale
+    );
+    // collects the sub-meshes into one instanced draw per sub-mesh
+    bool queueModel(uint64_t id);
+    // records the share `part` of `numParts` of the queued batches,
+    // parts may be recorded concurrently into different buffers
+    bool renderQueuedModels(
+        Vugl::CommandBuffer&
       , const glm::vec3& sunlightNormal
+      , size_t part = 0
+      , size_t numParts = 1
     );
-    bool renderModel(uint64_t id, Vugl::CommandBuffer&);
+    void clearQueuedModels();
   private:
-    struct ShaderData {
-      alignas(16) glm::mat4 mvp;
+    // sub-meshes out of their HLOD screen size range
+    static constexpr uint8_t HIDDEN_LEVEL = 0xFF;
+
+    struct SceneData {
       alignas(16) glm::vec3 sunlight;
-      alignas(16) glm::mat4 normalMatrix;
     };
 
-    using OrderPair = std::pair<size_t, float>;
+    // per-instance vertex input
+    struct ShaderData {
+      glm::mat4 mvp;
+      glm::mat4 normalMatrix;
+    };
+
+    struct PendingTexture {
+      size_t model;
+      std::string name;
+    };
+
     struct RenderData : public GFX::FrameDisposable {
-      std::vector<Vugl::DescriptorSet> descriptorSets;
+      std::vector<std::shared_ptr<Vugl::DescriptorSet>> descriptorSets;
+      // pinned in the texture cache while drawn
+      std::vector<std::shared_ptr<Vugl::CombinedSampler>> textures;
+      std::vector<PendingTexture> pendingTextures;
       std::vector<glm::mat4> transformations;
-      std::vector<Vugl::UniformBuffer> uniformBuffers;
       std::vector<ShaderData> shaderData;
+      std::vector<uint32_t> elementKeys;
       uint32_t vertexKey = 0;
       size_t numModels = 1;
-      std::vector<OrderPair> drawOrder;
       std::vector<bool> backfaceCulling;
+      std::vector<bool> transparent;
+      std::vector<float> minScreenSizes;
+      std::vector<float> maxScreenSizes;
+      // of the meshes, per sub-mesh
+      std::vector<uint8_t> levels;
+      bool anyTransparent = false;
       std::vector<BoundingSphere> boundingSpheres;
       BoundingSphere boundingSphere;
     };
@@ -74,7 +113,35 @@ class ModelRenderer {
     GFX::ModelCache& modelCache;
     GFX::TextureCache& textureCache;
     std::unordered_map<uint64_t, std::shared_ptr<RenderData>> renderDataMap;
-    std::unordered_map<uint32_t, std::shared_ptr<Vugl::ElementBuffer>> vertexData;
+    GFX::MeshPool meshPool;
+    // the full mesh and its LODs
+    std::unordered_map<uint32_t, std::vector<GFX::MeshPool::Mesh>> meshes;
+
+    struct Batch {
+      // element key and level
+      uint64_t key = 0;
+      GFX::MeshPool::Mesh mesh;
+      Vugl::DescriptorSet* descriptorSet = nullptr;
+      bool backfaceCulling = false;
+      std::vector<ShaderData> instances;
+    };
+
+    // kept over frames to reuse the instance vectors, transparent
+    // draws only merge with the previous one to keep their order
+    std::vector<Batch> opaqueBatches;
+    std::vector<Batch> transparentBatches;
+    size_t numOpaqueBatches = 0;
+    size_t numTransparentBatches = 0;
+    std::unordered_map<uint64_t, size_t> opaqueBatchIndices;
+
+    std::shared_ptr<Vugl::DescriptorSet> createDescriptorSet(Vugl::CombinedSampler&);
+    bool renderBatches(
+        Vugl::CommandBuffer&
+      , std::vector<Batch>&
+      , size_t begin
+      , size_t end
+      , uint32_t sceneOffset
+    );
 };
 
 }
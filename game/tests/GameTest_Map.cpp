@@ -38,6 +38,61 @@ TEST(MapTest, parsing) {
   EXPECT_EQ(396900, map->getVertexData().size());
   EXPECT_EQ(595350, map->getVertexIndices().size());
 
+  auto& chunks = map->getChunks();
+  ASSERT_EQ(100, chunks.size());
+  EXPECT_EQ(32, chunks[0].size.x);
+  EXPECT_EQ(27, chunks[99].size.x);
+  EXPECT_EQ(27, chunks[99].size.y);
+  EXPECT_EQ(288, chunks[99].origin.x);
+
+  size_t numChunkIndices = 0;
+  for (auto& chunk : chunks) {
+    EXPECT_EQ(numChunkIndices, chunk.firstIndex);
+    EXPECT_LE(chunk.boundsMin.y, chunk.boundsMax.y);
+    numChunkIndices += chunk.numIndices;
+  }
+  EXPECT_EQ(595350, numChunkIndices);
+
+  EXPECT_EQ(10, map->getHeightField().getNumLevels());
+  auto& corner = map->getVertexData()[(100 * 315 + 200) * 4];
+  EXPECT_FLOAT_EQ(corner.position.y, map->getHeight(glm::vec2 {2000.0f, 1000.0f}));
+
+  // picking vs. the tessellated triangles, in grid units
+  auto& vertices = map->getVertexData();
+  auto& indices = map->getVertexIndices();
+  for (float s = 0.05f; s < 1.0f; s += 0.1f) {
+    glm::vec3 origin {3150.0f * s, 400.0f, 3150.0f * (1.0f - s)};
+    auto direction = glm::normalize(glm::vec3 {1575.0f - origin.x, -400.0f, 1575.0f - origin.z});
+
+    std::optional<float> expected;
+    glm::vec3 o {origin.x / 10.0f, origin.y, origin.z / 10.0f};
+    glm::vec3 d {direction.x / 10.0f, direction.y, direction.z / 10.0f};
+    for (size_t i = 0; i < indices.size(); i += 3) {
+      auto& a = vertices[indices[i]].position;
+      auto& b = vertices[indices[i + 1]].position;
+      auto& c = vertices[indices[i + 2]].position;
+      auto n = glm::cross(b - a, c - a);
+      if (glm::dot(n, d) == 0.0f) {
+        continue;
+      }
+
+      auto t = glm::dot(n, a - o) / glm::dot(n, d);
+      auto p = o + d * t;
+      if (t >= 0.0f
+          && glm::dot(n, glm::cross(b - a, p - a)) >= 0.0f
+          && glm::dot(n, glm::cross(c - b, p - b)) >= 0.0f
+          && glm::dot(n, glm::cross(a - c, p - c)) >= 0.0f
+          && (!expected || t < *expected)) {
+        expected = t;
+      }
+    }
+
+    auto hit = map->getHeightField().intersect(HeightField::Ray {origin, direction});
+    ASSERT_TRUE(expected);
+    ASSERT_TRUE(hit);
+    EXPECT_NEAR(*expected, *hit, 0.01f);
+  }
+
   auto& water = map->getWater();
   EXPECT_EQ(99225, water.size());
 
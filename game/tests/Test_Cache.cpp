@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include "../Cache.h"
+
+namespace ZH {
+
+TEST(Cache, getAndPut) {
+  Cache<int> unit {100};
+
+  EXPECT_FALSE(unit.get("a"));
+  unit.put("a", std::make_shared<int>(1), 10);
+
+  auto value = unit.get("a");
+  ASSERT_TRUE(value);
+  EXPECT_EQ(1, *value);
+
+  // replacing keeps a single entry
+  unit.put("a", std::make_shared<int>(2), 20);
+  EXPECT_EQ(2, *unit.get("a"));
+
+  auto stats = unit.getStats();
+  EXPECT_EQ(2, stats.hits);
+  EXPECT_EQ(1, stats.misses);
+  EXPECT_EQ(0, stats.evictions);
+  EXPECT_EQ(1, stats.entries);
+  EXPECT_EQ(20, stats.bytes);
+}
+
+TEST(Cache, evictsLeastRecentlyUsed) {
+  Cache<int> unit {30};
+
+  unit.put("a", std::make_shared<int>(1), 10);
+  unit.put("b", std::make_shared<int>(2), 10);
+  unit.put("c", std::make_shared<int>(3), 10);
+  // a is now more recent than b
+  EXPECT_TRUE(unit.get("a"));
+
+  unit.put("d", std::make_shared<int>(4), 10);
+
+  EXPECT_TRUE(unit.get("a"));
+  EXPECT_FALSE(unit.get("b"));
+  EXPECT_TRUE(unit.get("c"));
+  EXPECT_TRUE(unit.get("d"));
+
+  auto stats = unit.getStats();
+  EXPECT_EQ(1, stats.evictions);
+  EXPECT_EQ(3, stats.entries);
+  EXPECT_EQ(30, stats.bytes);
+}
+
+TEST(Cache, skipsPinnedEntries) {
+  Cache<int> unit {20};
+
+  auto pinned = std::make_shared<int>(1);
+  unit.put("a", pinned, 10);
+  unit.put("b", std::make_shared<int>(2), 10);
+  unit.put("c", std::make_shared<int>(3), 10);
+
+  // a is the oldest, but still in use
+  EXPECT_TRUE(unit.get("a"));
+  EXPECT_FALSE(unit.get("b"));
+
+  // c goes, a stays while pinned
+  unit.put("d", std::make_shared<int>(4), 10);
+  EXPECT_EQ(20, unit.getStats().bytes);
+
+  pinned.reset();
+  unit.setBudget(10);
+
+  auto stats = unit.getStats();
+  EXPECT_EQ(1, stats.entries);
+  EXPECT_EQ(10, stats.bytes);
+  EXPECT_TRUE(unit.get("d"));
+}
+
+TEST(Cache, peekIsNotCounted) {
+  Cache<int> unit {20};
+
+  EXPECT_FALSE(unit.peek("a"));
+  unit.put("a", std::make_shared<int>(1), 10);
+  unit.put("b", std::make_shared<int>(2), 10);
+
+  auto value = unit.peek("a");
+  ASSERT_TRUE(value);
+  EXPECT_EQ(1, *value);
+  value.reset();
+
+  // a stays the least recently used one
+  unit.put("c", std::make_shared<int>(3), 10);
+  EXPECT_FALSE(unit.peek("a"));
+
+  auto stats = unit.getStats();
+  EXPECT_EQ(0, stats.hits);
+  EXPECT_EQ(0, stats.misses);
+}
+
+}
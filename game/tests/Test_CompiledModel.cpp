@@ -0,0 +1,128 @@
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "../gfx/CompiledModel.h"
+
+namespace ZH::GFX {
+
+static CompiledModel::Models makeModels() {
+  auto a = std::make_shared<Model>();
+  a->vertexData = {
+      {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}}
+    , {{1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}}
+    , {{0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, 1.0f}}
+  };
+  a->vertexIndices = {0, 1, 2};
+  a->textures = {"a.tga", "b.tga"};
+  a->textureIndices = {1};
+  a->transformation[3][0] = 5.0f;
+  a->boundingBoxFrom = {0.0f, 0.0f, 0.0f};
+  a->boundingBoxTo = {1.0f, 1.0f, 0.0f};
+  a->boundingSphere = {0.5f, 0.5f, 0.0f};
+  a->boundingSphereRadius = 0.75f;
+  a->transparent = true;
+  a->lods = {{{0, 1, 2}, 0.5f}};
+  a->minScreenSize = 0.25f;
+
+  auto b = std::make_shared<Model>();
+  b->textures = {"c.tga"};
+  b->boundingBoxFrom = {};
+  b->boundingBoxTo = {};
+  b->boundingSphere = {};
+  b->backfaceCulling = false;
+
+  return {a, b};
+}
+
+static std::string compile(const CompiledModel::Models& models, uint32_t sourceHash) {
+  std::ostringstream stream;
+  EXPECT_TRUE(CompiledModel::write(stream, sourceHash, models));
+
+  return stream.str();
+}
+
+TEST(CompiledModel, roundTrip) {
+  std::istringstream stream {compile(makeModels(), 42)};
+
+  auto models = CompiledModel::read(stream, 42);
+  ASSERT_TRUE(models);
+  ASSERT_EQ(2, models->size());
+
+  auto& a = *(*models)[0];
+  ASSERT_EQ(3, a.vertexData.size());
+  EXPECT_EQ(1.0f, a.vertexData[1].position.x);
+  EXPECT_EQ(1.0f, a.vertexData[2].uv.y);
+  EXPECT_EQ((std::vector<uint32_t> {0, 1, 2}), a.vertexIndices);
+  EXPECT_EQ((std::vector<std::string> {"a.tga", "b.tga"}), a.textures);
+  EXPECT_EQ((std::vector<uint32_t> {1}), a.textureIndices);
+  EXPECT_EQ(5.0f, a.transformation[3][0]);
+  EXPECT_EQ(1.0f, a.boundingBoxTo.y);
+  EXPECT_EQ(0.75f, a.boundingSphereRadius);
+  EXPECT_TRUE(a.backfaceCulling);
+  EXPECT_TRUE(a.transparent);
+  EXPECT_EQ(0.25f, a.minScreenSize);
+  EXPECT_EQ(std::numeric_limits<float>::max(), a.maxScreenSize);
+  ASSERT_EQ(1, a.lods.size());
+  EXPECT_EQ((std::vector<uint32_t> {0, 1, 2}), a.lods[0].vertexIndices);
+  EXPECT_EQ(0.5f, a.lods[0].error);
+
+  auto& b = *(*models)[1];
+  EXPECT_TRUE(b.vertexData.empty());
+  EXPECT_EQ((std::vector<std::string> {"c.tga"}), b.textures);
+  EXPECT_FALSE(b.backfaceCulling);
+  EXPECT_FALSE(b.transparent);
+  EXPECT_TRUE(b.lods.empty());
+}
+
+TEST(CompiledModel, arraysAreAligned) {
+  std::istringstream stream {compile(makeModels(), 42)};
+
+  auto header = CompiledModel::readHeader(stream);
+  ASSERT_TRUE(header);
+  EXPECT_EQ(2, header->numModels);
+  EXPECT_EQ(3, header->numTextures);
+  EXPECT_EQ(1, header->numLODs);
+  EXPECT_EQ(stream.str().size(), header->size);
+
+  auto records = CompiledModel::readRecords(stream, *header);
+  ASSERT_EQ(2, records.size());
+  for (auto& record : records) {
+    EXPECT_EQ(0, record.vertexOffset % 16);
+    EXPECT_EQ(0, record.indexOffset % 16);
+    EXPECT_EQ(0, record.textureIndexOffset % 16);
+  }
+  EXPECT_EQ(1, records[0].numLODs);
+  EXPECT_EQ(0, records[1].numLODs);
+}
+
+TEST(CompiledModel, rejectsOtherSource) {
+  std::istringstream stream {compile(makeModels(), 42)};
+
+  EXPECT_FALSE(CompiledModel::read(stream, 43));
+}
+
+TEST(CompiledModel, rejectsOtherVersion) {
+  auto data = compile(makeModels(), 42);
+  data[4] += 1;
+  std::istringstream stream {data};
+
+  EXPECT_FALSE(CompiledModel::read(stream, 42));
+}
+
+TEST(CompiledModel, rejectsBrokenFiles) {
+  auto data = compile(makeModels(), 42);
+
+  auto noMagic = data;
+  noMagic[0] = 'X';
+  std::istringstream noMagicStream {noMagic};
+  EXPECT_FALSE(CompiledModel::read(noMagicStream, 42));
+
+  std::istringstream truncatedStream {data.substr(0, data.size() - 1)};
+  EXPECT_FALSE(CompiledModel::read(truncatedStream, 42));
+
+  std::istringstream emptyStream {""};
+  EXPECT_FALSE(CompiledModel::read(emptyStream, 42));
+}
+
+}
@@ -1,4 +1,5 @@
 #include <fstream>
+#include <random>
 
 #include <gtest/gtest.h>
 
@@ -48,4 +49,67 @@ TEST(DDSFileTest, parsingDXT5) {
   EXPECT_EQ(0xFFF8FC00, u32data[12]);
 }
 
+TEST(DDSFileTest, keepingDXT1Blocks) {
+  std::ifstream stream {"tests/resources/DDSFile/dxt1.dds", std::ios::binary};
+  DDSFile unit {stream, true};
+
+  auto dds = unit.getTexture();
+  ASSERT_TRUE(dds);
+
+  auto size = dds->getSize();
+  EXPECT_EQ(2, size.x);
+  EXPECT_EQ(8, size.y);
+
+  EXPECT_EQ(GFX::HostTexture::Format::BC1, dds->getFormat());
+
+  std::ifstream raw {"tests/resources/DDSFile/dxt1.dds", std::ios::binary};
+  raw.seekg(128);
+  std::vector<char> blocks(16);
+  raw.read(blocks.data(), blocks.size());
+
+  EXPECT_EQ(blocks, dds->getData());
+}
+
+TEST(DDSFileTest, keepingDXT5Blocks) {
+  std::ifstream stream {"tests/resources/DDSFile/dxt5.dds", std::ios::binary};
+  DDSFile unit {stream, true};
+
+  auto dds = unit.getTexture();
+  ASSERT_TRUE(dds);
+
+  EXPECT_EQ(GFX::HostTexture::Format::BC3, dds->getFormat());
+
+  std::ifstream raw {"tests/resources/DDSFile/dxt5.dds", std::ios::binary};
+  raw.seekg(128);
+  std::vector<char> blocks(32);
+  raw.read(blocks.data(), blocks.size());
+
+  EXPECT_EQ(blocks, dds->getData());
+}
+
+TEST(DDSFileTest, vectorizedDecoding) {
+  std::mt19937 random {42};
+  std::uniform_int_distribution<int> byte {0, 255};
+
+  for (auto dxt5 : {false, true}) {
+    for (auto size : {Size {1, 1}, Size {2, 8}, Size {13, 7}, Size {68, 40}, Size {256, 160}}) {
+      std::vector<char> blocks(((size.x + 3) / 4) * ((size.y + 3) / 4) * (dxt5 ? 16 : 8));
+      for (auto& b : blocks) {
+        b = byte(random);
+      }
+
+      std::vector<char> expected(size.x * size.y * 4, 0);
+      std::vector<char> result(size.x * size.y * 4, 0);
+
+      auto expectedAlpha =
+        DDSFile::decodeBlocks(blocks.data(), size, dxt5, expected.data(), DDSFile::Decoder::SCALAR);
+      auto resultAlpha =
+        DDSFile::decodeBlocks(blocks.data(), size, dxt5, result.data(), DDSFile::Decoder::VECTORIZED);
+
+      EXPECT_EQ(expected, result) << size.x << "x" << size.y << " " << dxt5;
+      EXPECT_EQ(expectedAlpha, resultAlpha);
+    }
+  }
+}
+
 }
@@ -124,6 +124,61 @@ TEST(Frustum, isSphereInsideOffset) {
   ));
 }
 
+TEST(Frustum, isBoxInside) {
+  GFX::Camera cam;
+  cam.reposition(
+      glm::vec3 {0.0f, 0.0f, 0.0f}
+    , glm::vec3 {1.0f, 0.0f, 0.0f}
+    , glm::vec3 {0.0f, 1.0f, 0.0f}
+  );
+  cam.setPerspectiveProjection({
+      .near = 0.1f
+    , .far  = 10.0f
+    , .fovDeg = 90.0f
+    , .width = 1.0f
+    , .height = 1.0f
+  });
+
+  GFX::Frustum unit {cam};
+
+  // fully inside
+  EXPECT_TRUE(unit.isBoxInside(
+      glm::vec3 {2.0f, -0.5f, -0.5f}
+    , glm::vec3 {3.0f, 0.5f, 0.5f}
+  ));
+  // enclosing the frustum
+  EXPECT_TRUE(unit.isBoxInside(
+      glm::vec3 {-20.0f, -20.0f, -20.0f}
+    , glm::vec3 {20.0f, 20.0f, 20.0f}
+  ));
+  // crossing
+  EXPECT_TRUE(unit.isBoxInside(
+      glm::vec3 {-2.0f, -0.5f, -0.5f}
+    , glm::vec3 {2.0f, 0.5f, 0.5f}
+  ));
+  EXPECT_TRUE(unit.isBoxInside(
+      glm::vec3 {4.0f, 0.0f, 4.0f}
+    , glm::vec3 {6.0f, 1.0f, 8.0f}
+  ));
+  // fully outside
+  EXPECT_FALSE(unit.isBoxInside(
+      glm::vec3 {-3.0f, -0.5f, -0.5f}
+    , glm::vec3 {-1.0f, 0.5f, 0.5f}
+  ));
+  EXPECT_FALSE(unit.isBoxInside(
+      glm::vec3 {11.0f, -0.5f, -0.5f}
+    , glm::vec3 {12.0f, 0.5f, 0.5f}
+  ));
+  EXPECT_FALSE(unit.isBoxInside(
+      glm::vec3 {4.0f, 0.0f, 6.0f}
+    , glm::vec3 {5.0f, 1.0f, 8.0f}
+  ));
+  EXPECT_FALSE(unit.isBoxInside(
+      glm::vec3 {4.0f, -8.0f, 0.0f}
+    , glm::vec3 {5.0f, -6.0f, 1.0f}
+  ));
+}
+
 TEST(Frustum, replayCase1) {
   GFX::Camera cam;
   glm::vec2 size {315, 315};
@@ -172,4 +227,44 @@ TEST(Frustum, replayCase2) {
   ));
 }
 
+TEST(Frustum, areSpheresInside) {
+  GFX::Camera cam;
+  cam.reposition(
+      glm::vec3 {0.0f, 0.0f, 0.0f}
+    , glm::vec3 {1.0f, 0.0f, 0.0f}
+    , glm::vec3 {0.0f, 1.0f, 0.0f}
+  );
+  cam.setPerspectiveProjection({
+      .near = 0.1f
+    , .far  = 10.0f
+    , .fovDeg = 90.0f
+    , .width = 1.0f
+    , .height = 1.0f
+  });
+
+  GFX::Frustum unit {cam};
+
+  // odd count for the scalar tail
+  std::vector<float> xs, ys, zs, radii;
+  for (size_t i = 0; i < 103; ++i) {
+    xs.push_back(-3.0f + (i % 17) * 0.97f);
+    ys.push_back(-6.0f + (i % 13) * 1.03f);
+    zs.push_back(-6.0f + (i % 11) * 1.21f);
+    radii.push_back(0.25f + (i % 5) * 0.4f);
+  }
+
+  std::vector<uint8_t> inside(xs.size(), 2);
+  unit.areSpheresInside(xs, ys, zs, radii, inside);
+
+  size_t numInside = 0;
+  for (size_t i = 0; i < xs.size(); ++i) {
+    auto expected = unit.isSphereInside(glm::vec3 {xs[i], ys[i], zs[i]}, radii[i]);
+    EXPECT_EQ(expected ? 1 : 0, inside[i]) << i;
+    numInside += inside[i];
+  }
+
+  EXPECT_GT(numInside, 0);
+  EXPECT_LT(numInside, xs.size());
+}
+
 }
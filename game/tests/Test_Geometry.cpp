@@ -39,4 +39,85 @@ TEST(Geometry, getPointsInPolygon) {
   EXPECT_EQ(0, result[15]);
 }
 
+TEST(Geometry, getPolygonSpansConcave) {
+  // U shape, open at the top
+  std::vector<glm::ivec2> polygon {{
+      {0, 0}
+    , {6, 0}
+    , {6, 5}
+    , {4, 5}
+    , {4, 2}
+    , {2, 2}
+    , {2, 5}
+    , {0, 5}
+  }};
+
+  Size size {8, 8};
+  auto spans = getPolygonSpans(size, polygon, glm::mat4 {1.0f});
+
+  for (int32_t y = 0; y < 8; ++y) {
+    for (int32_t x = 0; x < 8; ++x) {
+      bool expected = x <= 6 && y <= 5;
+      if (y > 2 && x > 2 && x < 4) {
+        expected = false;
+      }
+
+      EXPECT_EQ(expected, isPointInSpans(spans, Point {x, y})) << x << "," << y;
+    }
+  }
+
+  // rows 3 to 5 are split by the notch
+  EXPECT_EQ(3 + 3 * 2, spans.size());
+  EXPECT_EQ(0, spans[3].x0);
+  EXPECT_EQ(3, spans[3].x1);
+  EXPECT_EQ(4, spans[4].x0);
+  EXPECT_EQ(7, spans[4].x1);
+}
+
+TEST(Geometry, getPolygonSpansFillRule) {
+  // pentagram, the center is enclosed twice
+  std::vector<glm::vec2> star {{
+      {10.0f,  0.0f}
+    , {16.0f, 19.0f}
+    , { 0.0f,  7.0f}
+    , {20.0f,  7.0f}
+    , { 4.0f, 19.0f}
+  }};
+
+  Size size {24, 24};
+  auto evenOdd = getPolygonSpans(size, star, glm::mat4 {1.0f}, FillRule::EVEN_ODD);
+  auto nonZero = getPolygonSpans(size, star, glm::mat4 {1.0f}, FillRule::NON_ZERO);
+
+  EXPECT_FALSE(isPointInSpans(evenOdd, Point {10, 11}));
+  EXPECT_TRUE(isPointInSpans(nonZero, Point {10, 11}));
+
+  // tips
+  EXPECT_TRUE(isPointInSpans(evenOdd, Point {10, 1}));
+  EXPECT_TRUE(isPointInSpans(nonZero, Point {10, 1}));
+  EXPECT_TRUE(isPointInSpans(nonZero, Point {10, 0}));
+  EXPECT_FALSE(isPointInSpans(nonZero, Point {9, 0}));
+  EXPECT_TRUE(isPointInSpans(nonZero, Point {4, 19}));
+  EXPECT_FALSE(isPointInSpans(nonZero, Point {10, 19}));
+  EXPECT_FALSE(isPointInSpans(nonZero, Point {23, 23}));
+}
+
+TEST(Geometry, getPolygonSpansClipped) {
+  std::vector<glm::ivec2> polygon {{
+      {-5, -5}
+    , {20, -5}
+    , {20,  2}
+    , {-5,  2}
+  }};
+
+  Size size {4, 4};
+  auto spans = getPolygonSpans(size, polygon, glm::mat4 {1.0f});
+
+  ASSERT_EQ(3, spans.size());
+  for (int32_t y = 0; y < 3; ++y) {
+    EXPECT_EQ(y, spans[y].y);
+    EXPECT_EQ(0, spans[y].x0);
+    EXPECT_EQ(4, spans[y].x1);
+  }
+}
+
 }
@@ -0,0 +1,262 @@
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "../HeightField.h"
+
+namespace ZH {
+
+// brute-force reference: plane through the corners of the triangle hit
+static float referenceHeight(
+    const glm::vec4& h
+  , bool flipped
+  , float fx
+  , float fy
+) {
+  auto plane = [fx, fy](glm::vec3 a, glm::vec3 b, glm::vec3 c) {
+    auto n = glm::cross(b - a, c - a);
+    return a.y - (n.x * (fx - a.x) + n.z * (fy - a.z)) / n.y;
+  };
+
+  glm::vec3 c0 {0.0f, h[0], 0.0f};
+  glm::vec3 c1 {1.0f, h[1], 0.0f};
+  glm::vec3 c2 {0.0f, h[2], 1.0f};
+  glm::vec3 c3 {1.0f, h[3], 1.0f};
+
+  if (flipped) {
+    return fx + fy < 1.0f ? plane(c0, c1, c2) : plane(c1, c3, c2);
+  } else {
+    return fx > fy ? plane(c0, c1, c3) : plane(c0, c3, c2);
+  }
+}
+
+static HeightField createField(
+    Size size
+  , std::vector<glm::vec4>& heights
+  , std::vector<uint8_t>& flips
+) {
+  heights.resize(size.x * size.y);
+  flips.resize(size.x * size.y);
+
+  for (uint32_t y = 0; y < size.y; ++y) {
+    for (uint32_t x = 0; x < size.x; ++x) {
+      auto i = y * size.x + x;
+      heights[i] =
+        glm::vec4 {
+            (x * 7 + y * 3) % 11
+          , (x * 5 + y * 13) % 17
+          , (x * 3 + y * 2) % 5
+          , (x + y * 11) % 23
+        };
+      flips[i] = (x + y) % 3 == 0;
+    }
+  }
+
+  auto heightsCopy = heights;
+  auto flipsCopy = flips;
+
+  return HeightField {size, 10.0f, std::move(heightsCopy), std::move(flipsCopy)};
+}
+
+TEST(HeightField, getHeight) {
+  std::vector<glm::vec4> heights;
+  std::vector<uint8_t> flips;
+  auto field = createField(Size {5, 4}, heights, flips);
+
+  for (uint32_t y = 0; y < 4; ++y) {
+    for (uint32_t x = 0; x < 5; ++x) {
+      auto i = y * 5 + x;
+
+      for (float fy = 0.05f; fy < 1.0f; fy += 0.15f) {
+        for (float fx = 0.05f; fx < 1.0f; fx += 0.15f) {
+          EXPECT_NEAR(
+              referenceHeight(heights[i], flips[i], fx, fy)
+            , field.getHeight(glm::vec2 {(x + fx) * 10.0f, (y + fy) * 10.0f})
+            , 0.001f
+          );
+        }
+      }
+    }
+  }
+
+  // corners and clamping outside
+  EXPECT_FLOAT_EQ(heights[0][0], field.getHeight(glm::vec2 {0.0f, 0.0f}));
+  EXPECT_FLOAT_EQ(heights[0][0], field.getHeight(glm::vec2 {-20.0f, -5.0f}));
+  EXPECT_FLOAT_EQ(heights[19][3], field.getHeight(glm::vec2 {50.0f, 40.0f}));
+  EXPECT_FLOAT_EQ(heights[19][3], field.getHeight(glm::vec2 {500.0f, 400.0f}));
+}
+
+TEST(HeightField, getHeights) {
+  std::vector<glm::vec4> heights;
+  std::vector<uint8_t> flips;
+  auto field = createField(Size {9, 7}, heights, flips);
+
+  std::vector<glm::vec2> positions;
+  for (float y = -3.0f; y < 75.0f; y += 2.3f) {
+    for (float x = -3.0f; x < 95.0f; x += 3.7f) {
+      positions.emplace_back(x, y);
+    }
+  }
+  // remainder for the scalar path
+  positions.emplace_back(12.5f, 61.0f);
+
+  std::vector<float> result;
+  result.resize(positions.size());
+  field.getHeights(positions, result);
+
+  for (size_t i = 0; i < positions.size(); ++i) {
+    EXPECT_NEAR(field.getHeight(positions[i]), result[i], 0.0001f);
+  }
+}
+
+TEST(HeightField, getHeightRange) {
+  std::vector<glm::vec4> heights;
+  std::vector<uint8_t> flips;
+  auto field = createField(Size {37, 21}, heights, flips);
+
+  EXPECT_EQ(7, field.getNumLevels());
+
+  auto bruteForce = [&heights](Point min, Point max) {
+    float low = 1000.0f, high = -1000.0f;
+    for (int32_t y = min.y; y < max.y; ++y) {
+      for (int32_t x = min.x; x < max.x; ++x) {
+        for (uint8_t i = 0; i < 4; ++i) {
+          low = std::min(low, heights[y * 37 + x][i]);
+          high = std::max(high, heights[y * 37 + x][i]);
+        }
+      }
+    }
+
+    return std::make_pair(low, high);
+  };
+
+  std::vector<std::pair<Point, Point>> areas {
+      {Point {0, 0}, Point {37, 21}}
+    , {Point {0, 0}, Point {1, 1}}
+    , {Point {3, 5}, Point {9, 6}}
+    , {Point {32, 16}, Point {37, 21}}
+    , {Point {11, 2}, Point {29, 19}}
+  };
+
+  for (auto& area : areas) {
+    auto exact = bruteForce(area.first, area.second);
+    auto range = field.getTileHeightRange(area.first, area.second);
+
+    // conservative
+    EXPECT_LE(range.first, exact.first);
+    EXPECT_GE(range.second, exact.second);
+  }
+
+  EXPECT_EQ(
+      bruteForce(Point {0, 0}, Point {37, 21})
+    , field.getTileHeightRange(Point {0, 0}, Point {37, 21})
+  );
+  EXPECT_EQ(
+      bruteForce(Point {16, 0}, Point {32, 16})
+    , field.getTileHeightRange(Point {16, 0}, Point {32, 16})
+  );
+  EXPECT_EQ(
+      bruteForce(Point {4, 6}, Point {5, 7})
+    , field.getTileHeightRange(Point {4, 6}, Point {5, 7})
+  );
+
+  // game units, touching the edges of tiles 1,1 to 2,2
+  auto range = field.getHeightRange(glm::vec2 {12.0f, 12.0f}, glm::vec2 {28.0f, 28.0f});
+  auto exact = bruteForce(Point {1, 1}, Point {3, 3});
+  EXPECT_LE(range.first, exact.first);
+  EXPECT_GE(range.second, exact.second);
+}
+
+TEST(HeightField, intersect) {
+  std::vector<glm::vec4> heights;
+  std::vector<uint8_t> flips;
+  Size size {23, 19};
+  auto field = createField(size, heights, flips);
+
+  // brute force over both triangles of every tile, in game units
+  auto bruteForce = [&](const HeightField::Ray& ray) -> std::optional<float> {
+    std::optional<float> closest;
+
+    for (uint32_t y = 0; y < size.y; ++y) {
+      for (uint32_t x = 0; x < size.x; ++x) {
+        auto i = y * size.x + x;
+        glm::vec3 c[4] {
+            {x * 10.0f,       heights[i][0], y * 10.0f}
+          , {(x + 1) * 10.0f, heights[i][1], y * 10.0f}
+          , {x * 10.0f,       heights[i][2], (y + 1) * 10.0f}
+          , {(x + 1) * 10.0f, heights[i][3], (y + 1) * 10.0f}
+        };
+        std::array<std::array<uint8_t, 3>, 2> triangles =
+          flips[i]
+            ? std::array<std::array<uint8_t, 3>, 2> {{{0, 1, 2}, {2, 1, 3}}}
+            : std::array<std::array<uint8_t, 3>, 2> {{{0, 1, 3}, {0, 3, 2}}};
+
+        for (auto& tri : triangles) {
+          auto n = glm::cross(c[tri[1]] - c[tri[0]], c[tri[2]] - c[tri[0]]);
+          auto denom = glm::dot(n, ray.direction);
+          if (denom == 0.0f) {
+            continue;
+          }
+
+          auto t = glm::dot(n, c[tri[0]] - ray.origin) / denom;
+          if (t < 0.0f) {
+            continue;
+          }
+
+          auto p = ray.origin + ray.direction * t;
+          bool inside = true;
+          for (uint8_t e = 0; e < 3; ++e) {
+            auto& a = c[tri[e]];
+            auto& b = c[tri[(e + 1) % 3]];
+            auto side = glm::dot(n, glm::cross(b - a, p - a));
+            inside &= side >= 0.0f;
+          }
+
+          if (inside && (!closest || t < *closest)) {
+            closest = t;
+          }
+        }
+      }
+    }
+
+    return closest;
+  };
+
+  std::mt19937 random {42};
+  std::uniform_real_distribution<float> ground {-20.0f, 250.0f};
+  std::uniform_real_distribution<float> sky {30.0f, 80.0f};
+
+  std::vector<HeightField::Ray> rays;
+  for (size_t i = 0; i < 400; ++i) {
+    glm::vec3 from {ground(random), sky(random), ground(random)};
+    glm::vec3 to {ground(random), -5.0f, ground(random)};
+    rays.push_back(HeightField::Ray {from, glm::normalize(to - from)});
+  }
+
+  // grazing and outward rays
+  rays.push_back(HeightField::Ray {glm::vec3 {-50.0f, 10.0f, 95.0f}, glm::vec3 {1.0f, 0.0f, 0.0f}});
+  rays.push_back(HeightField::Ray {glm::vec3 {115.0f, 5.0f, 95.0f}, glm::vec3 {0.0f, -1.0f, 0.0f}});
+  rays.push_back(HeightField::Ray {glm::vec3 {115.0f, 50.0f, 95.0f}, glm::vec3 {0.0f, 1.0f, 0.0f}});
+  rays.push_back(HeightField::Ray {glm::vec3 {-10.0f, 50.0f, -10.0f}, glm::vec3 {-1.0f, -1.0f, 0.0f}});
+
+  std::vector<std::optional<float>> results;
+  results.resize(rays.size());
+  field.intersect(rays, results);
+
+  size_t numHits = 0;
+  for (size_t i = 0; i < rays.size(); ++i) {
+    auto expected = bruteForce(rays[i]);
+    ASSERT_EQ(expected.has_value(), results[i].has_value()) << "ray " << i;
+
+    if (expected) {
+      EXPECT_NEAR(*expected, *results[i], 0.01f) << "ray " << i;
+      numHits += 1;
+    }
+  }
+
+  EXPECT_GT(numHits, 200);
+  EXPECT_FALSE(results[rays.size() - 1]);
+  EXPECT_FALSE(results[rays.size() - 2]);
+}
+
+}
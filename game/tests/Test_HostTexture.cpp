@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include "../gfx/HostTexture.h"
+
+namespace ZH {
+
+TEST(HostTexture, generateMipLevels) {
+  // 3x2 to 1x1, the box covers the first two columns only
+  std::vector<char> data {
+      0, 0, 0, 0,    40, 40, 40, 40,   (char)200, 0, 0, (char)255
+    , 0, 0, 0, 0,    40, 40, 40, 40,   (char)200, 0, 0, (char)255
+  };
+
+  GFX::HostTexture unit {{3, 2}, GFX::HostTexture::Format::RGBA8888, std::move(data)};
+  unit.generateMipLevels();
+
+  auto& levels = unit.getMipLevels();
+  ASSERT_EQ(2, levels.size());
+  EXPECT_EQ(Size(3, 2), levels[0].size);
+  EXPECT_EQ(0, levels[0].offset);
+  EXPECT_EQ(Size(1, 1), levels[1].size);
+  EXPECT_EQ(24, levels[1].offset);
+
+  auto& result = unit.getData();
+  ASSERT_EQ(28, result.size());
+  EXPECT_EQ(20, static_cast<uint8_t>(result[24]));
+  EXPECT_EQ(20, static_cast<uint8_t>(result[27]));
+}
+
+TEST(HostTexture, generateMipLevelsChain) {
+  std::vector<char> data(16 * 4 * 4, 100);
+
+  GFX::HostTexture unit {{16, 4}, GFX::HostTexture::Format::BGRA8888, std::move(data)};
+  unit.generateMipLevels();
+
+  auto& levels = unit.getMipLevels();
+  ASSERT_EQ(5, levels.size());
+  EXPECT_EQ(Size(8, 2), levels[1].size);
+  EXPECT_EQ(Size(4, 1), levels[2].size);
+  EXPECT_EQ(Size(2, 1), levels[3].size);
+  EXPECT_EQ(Size(1, 1), levels[4].size);
+
+  auto& result = unit.getData();
+  ASSERT_EQ((64 + 16 + 4 + 2 + 1) * 4, result.size());
+  for (auto c : result) {
+    EXPECT_EQ(100, c);
+  }
+}
+
+TEST(HostTexture, keepsCompressedLevels) {
+  GFX::HostTexture unit {{4, 4}, GFX::HostTexture::Format::BC1, std::vector<char>(8)};
+  unit.generateMipLevels();
+
+  EXPECT_EQ(1, unit.getMipLevels().size());
+  EXPECT_EQ(8, unit.getData().size());
+}
+
+TEST(HostTexture, resampled) {
+  // 2x1 black and white upscaled to 4x1
+  std::vector<char> data {0, 0, 0, 0, (char)255, (char)255, (char)255, (char)255};
+
+  GFX::HostTexture unit {{2, 1}, GFX::HostTexture::Format::BGRA8888, std::move(data)};
+  unit.generateMipLevels();
+
+  auto result = unit.resampled({4, 1});
+  ASSERT_TRUE(result);
+  EXPECT_EQ(Size(4, 1), result->getSize());
+  EXPECT_EQ(1, result->getMipLevels().size());
+
+  auto& resultData = result->getData();
+  ASSERT_EQ(16, resultData.size());
+  EXPECT_EQ(0, static_cast<uint8_t>(resultData[0]));
+  EXPECT_EQ(64, static_cast<uint8_t>(resultData[4]));
+  EXPECT_EQ(191, static_cast<uint8_t>(resultData[8]));
+  EXPECT_EQ(255, static_cast<uint8_t>(resultData[12]));
+
+  GFX::HostTexture compressed {{4, 4}, GFX::HostTexture::Format::BC1, std::vector<char>(8)};
+  EXPECT_FALSE(compressed.resampled({8, 8}));
+}
+
+}
@@ -0,0 +1,60 @@
+#include <atomic>
+
+#include <gtest/gtest.h>
+
+#include "../JobSystem.h"
+
+namespace ZH {
+
+TEST(JobSystem, runAll) {
+  JobSystem unit {3};
+  EXPECT_EQ(3, unit.getNumWorkers());
+
+  std::vector<int> results(64, 0);
+  std::vector<JobSystem::Job> jobs;
+  for (size_t i = 0; i < results.size(); ++i) {
+    jobs.emplace_back([&results, i]() { results[i] = i * 2; });
+  }
+
+  for (size_t round = 0; round < 10; ++round) {
+    std::fill(results.begin(), results.end(), -1);
+    unit.run(jobs);
+
+    for (size_t i = 0; i < results.size(); ++i) {
+      EXPECT_EQ(i * 2, results[i]);
+    }
+  }
+}
+
+TEST(JobSystem, runNested) {
+  JobSystem unit {2};
+
+  std::atomic<size_t> numRuns = 0;
+  std::vector<JobSystem::Job> jobs;
+  for (size_t i = 0; i < 4; ++i) {
+    jobs.emplace_back([&unit, &numRuns]() {
+      std::vector<JobSystem::Job> inner;
+      for (size_t j = 0; j < 4; ++j) {
+        inner.emplace_back([&numRuns]() { numRuns += 1; });
+      }
+      unit.run(inner);
+    });
+  }
+
+  unit.run(jobs);
+  EXPECT_EQ(16, numRuns);
+}
+
+TEST(JobSystem, runWithoutWorkers) {
+  JobSystem unit {0};
+
+  size_t numRuns = 0;
+  std::vector<JobSystem::Job> jobs;
+  jobs.emplace_back([&numRuns]() { numRuns += 1; });
+  jobs.emplace_back([&numRuns]() { numRuns += 1; });
+
+  unit.run(jobs);
+  EXPECT_EQ(2, numRuns);
+}
+
+}
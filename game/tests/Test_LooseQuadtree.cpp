@@ -0,0 +1,138 @@
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "../LooseQuadtree.h"
+
+namespace ZH {
+
+struct Sphere {
+  glm::vec3 center;
+  float radius;
+};
+
+static std::vector<Sphere> randomSpheres(size_t count, std::mt19937& rng) {
+  // some outside of the indexed area as well
+  std::uniform_real_distribution<float> pos {-100.0f, 1100.0f};
+  std::uniform_real_distribution<float> height {-20.0f, 80.0f};
+  std::uniform_real_distribution<float> radius {0.0f, 40.0f};
+
+  std::vector<Sphere> spheres;
+  for (size_t i = 0; i < count; ++i) {
+    spheres.push_back({glm::vec3 {pos(rng), height(rng), pos(rng)}, radius(rng)});
+  }
+
+  return spheres;
+}
+
+static std::vector<uint32_t> sorted(std::vector<uint32_t> values) {
+  std::sort(values.begin(), values.end());
+  return values;
+}
+
+TEST(LooseQuadtree, queryRadius) {
+  std::mt19937 rng {1};
+  auto spheres = randomSpheres(500, rng);
+
+  LooseQuadtree<uint32_t> unit {glm::vec2 {0.0f}, glm::vec2 {1000.0f}, 20.0f};
+  std::vector<LooseQuadtree<uint32_t>::Handle> handles;
+  for (uint32_t i = 0; i < spheres.size(); ++i) {
+    handles.push_back(unit.insert(i, spheres[i].center, spheres[i].radius));
+  }
+
+  // move some, drop some
+  auto moved = randomSpheres(100, rng);
+  for (uint32_t i = 0; i < moved.size(); ++i) {
+    spheres[i * 3] = moved[i];
+    unit.update(handles[i * 3], moved[i].center, moved[i].radius);
+  }
+
+  std::vector<bool> removed(spheres.size(), false);
+  for (uint32_t i = 1; i < spheres.size(); i += 7) {
+    unit.remove(handles[i]);
+    removed[i] = true;
+  }
+
+  EXPECT_EQ(spheres.size() - 72, unit.getSize());
+
+  for (auto& probe : randomSpheres(50, rng)) {
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < spheres.size(); ++i) {
+      if (!removed[i]
+          && glm::length(probe.center - spheres[i].center) <= probe.radius * 3.0f + spheres[i].radius
+      ) {
+        expected.push_back(i);
+      }
+    }
+
+    std::vector<uint32_t> results;
+    unit.query(probe.center, probe.radius * 3.0f, results);
+    EXPECT_EQ(expected, sorted(results));
+  }
+}
+
+TEST(LooseQuadtree, queryFrustum) {
+  std::mt19937 rng {2};
+  auto spheres = randomSpheres(500, rng);
+
+  LooseQuadtree<uint32_t> unit {glm::vec2 {0.0f}, glm::vec2 {1000.0f}, 20.0f};
+  for (uint32_t i = 0; i < spheres.size(); ++i) {
+    unit.insert(i, spheres[i].center, spheres[i].radius);
+  }
+
+  GFX::Camera cam;
+  cam.reposition(
+      glm::vec3 {100.0f, 300.0f, 100.0f}
+    , glm::vec3 {400.0f, 0.0f, 300.0f}
+    , glm::vec3 {0.0f, -1.0f, 0.0f}
+  );
+  cam.setPerspectiveProjection({
+      .near = 1.0f
+    , .far  = 800.0f
+    , .fovDeg = 60.0f
+    , .width = 1600.0f
+    , .height = 900.0f
+  });
+
+  GFX::Frustum frustum {cam};
+
+  std::vector<uint32_t> expected;
+  for (uint32_t i = 0; i < spheres.size(); ++i) {
+    if (frustum.isSphereInside(spheres[i].center, spheres[i].radius)) {
+      expected.push_back(i);
+    }
+  }
+
+  std::vector<uint32_t> results;
+  unit.query(frustum, results);
+
+  EXPECT_FALSE(expected.empty());
+  EXPECT_LT(expected.size(), spheres.size());
+  EXPECT_EQ(expected, sorted(results));
+}
+
+TEST(LooseQuadtree, intersect) {
+  LooseQuadtree<uint32_t> unit {glm::vec2 {0.0f}, glm::vec2 {1000.0f}, 20.0f};
+  unit.insert(0, glm::vec3 {100.0f, 0.0f, 100.0f}, 5.0f);
+  unit.insert(1, glm::vec3 {300.0f, 0.0f, 100.0f}, 50.0f);
+  unit.insert(2, glm::vec3 {200.0f, 0.0f, 100.0f}, 5.0f);
+  // off the ray
+  unit.insert(3, glm::vec3 {200.0f, 0.0f, 120.0f}, 5.0f);
+  // behind the origin
+  unit.insert(4, glm::vec3 {20.0f, 0.0f, 100.0f}, 5.0f);
+  // outside of the area
+  unit.insert(5, glm::vec3 {1500.0f, 0.0f, 100.0f}, 5.0f);
+
+  std::vector<LooseQuadtree<uint32_t>::Hit> hits;
+  unit.intersect(glm::vec3 {50.0f, 0.0f, 100.0f}, glm::vec3 {2.0f, 0.0f, 0.0f}, hits);
+
+  ASSERT_EQ(4, hits.size());
+  EXPECT_EQ(0, hits[0].value);
+  EXPECT_FLOAT_EQ(45.0f, hits[0].distance);
+  EXPECT_EQ(2, hits[1].value);
+  EXPECT_EQ(1, hits[2].value);
+  EXPECT_FLOAT_EQ(200.0f, hits[2].distance);
+  EXPECT_EQ(5, hits[3].value);
+}
+
+}
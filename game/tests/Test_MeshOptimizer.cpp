@@ -0,0 +1,84 @@
+#include <algorithm>
+
+#include <gtest/gtest.h>
+
+#include "../gfx/MeshOptimizer.h"
+
+namespace ZH::GFX {
+
+// row by row, the worst case for small caches
+static std::vector<uint32_t> makeGrid(uint32_t size) {
+  std::vector<uint32_t> indices;
+
+  for (uint32_t y = 0; y < size; ++y) {
+    for (uint32_t x = 0; x < size; ++x) {
+      auto v = y * (size + 1) + x;
+      indices.insert(indices.end(), {v, v + 1, v + size + 1});
+      indices.insert(indices.end(), {v + 1, v + size + 2, v + size + 1});
+    }
+  }
+
+  return indices;
+}
+
+static std::vector<uint32_t> reorder(const std::vector<uint32_t>& indices, const std::vector<uint32_t>& order) {
+  std::vector<uint32_t> reordered;
+  for (auto t : order) {
+    reordered.insert(reordered.end(), indices.begin() + t * 3, indices.begin() + t * 3 + 3);
+  }
+
+  return reordered;
+}
+
+TEST(MeshOptimizer, vertexCacheOrder) {
+  auto indices = makeGrid(64);
+  auto numVertices = 65 * 65;
+
+  auto order = getVertexCacheOrder(indices, numVertices);
+  ASSERT_EQ(indices.size() / 3, order.size());
+
+  auto sorted = order;
+  std::sort(sorted.begin(), sorted.end());
+  for (uint32_t i = 0; i < sorted.size(); ++i) {
+    ASSERT_EQ(i, sorted[i]);
+  }
+
+  auto before = getAverageCacheMissRatio(indices);
+  auto after = getAverageCacheMissRatio(reorder(indices, order));
+  EXPECT_GT(before, 0.95f);
+  EXPECT_LT(after, 0.8f);
+}
+
+TEST(MeshOptimizer, vertexCacheOrderDegenerate) {
+  std::vector<uint32_t> indices {0, 0, 1, 1, 2, 3, 2, 2, 2, 0, 1, 2};
+
+  auto order = getVertexCacheOrder(indices, 4);
+  ASSERT_EQ(4, order.size());
+
+  std::sort(order.begin(), order.end());
+  EXPECT_EQ((std::vector<uint32_t> {0, 1, 2, 3}), order);
+}
+
+TEST(MeshOptimizer, vertexCacheOrderOutOfRange) {
+  std::vector<uint32_t> indices {0, 1, 2, 2, 1, 5};
+
+  EXPECT_EQ((std::vector<uint32_t> {0, 1}), getVertexCacheOrder(indices, 4));
+}
+
+TEST(MeshOptimizer, vertexFetchRemap) {
+  std::vector<uint32_t> indices {3, 1, 4, 4, 1, 0};
+
+  auto remap = getVertexFetchRemap(indices, 6);
+  EXPECT_EQ((std::vector<uint32_t> {3, 1, 4, 0, 2, 5}), remap);
+}
+
+TEST(MeshOptimizer, averageCacheMissRatio) {
+  EXPECT_EQ(0.0f, getAverageCacheMissRatio({}));
+  EXPECT_EQ(3.0f, getAverageCacheMissRatio({0, 1, 2, 3, 4, 5}));
+  EXPECT_EQ(2.0f, getAverageCacheMissRatio({0, 1, 2, 2, 1, 3}, 3));
+  EXPECT_EQ(2.0f, getAverageCacheMissRatio({0, 1, 2, 3, 1, 2}, 3));
+  // 0 drops out of a FIFO cache of 3 before its second use, then 1
+  EXPECT_EQ(3.0f, getAverageCacheMissRatio({0, 1, 2, 3, 0, 1}, 3));
+}
+
+}
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include "../gfx/MeshSimplifier.h"
+
+namespace ZH::GFX {
+
+// unit square in xy, with height from the callback
+template <typename F>
+static void makeGrid(
+    uint32_t size
+  , F height
+  , std::vector<glm::vec3>& positions
+  , std::vector<uint32_t>& indices
+) {
+  for (uint32_t y = 0; y <= size; ++y) {
+    for (uint32_t x = 0; x <= size; ++x) {
+      positions.emplace_back(x / float(size), y / float(size), height(x, y));
+    }
+  }
+
+  for (uint32_t y = 0; y < size; ++y) {
+    for (uint32_t x = 0; x < size; ++x) {
+      auto v = y * (size + 1) + x;
+      indices.insert(indices.end(), {v, v + 1, v + size + 1});
+      indices.insert(indices.end(), {v + 1, v + size + 2, v + size + 1});
+    }
+  }
+}
+
+static float getArea(const std::vector<glm::vec3>& positions, const std::vector<uint32_t>& indices) {
+  float area = 0.0f;
+  for (size_t t = 0; t < indices.size(); t += 3) {
+    auto& a = positions[indices[t]];
+    auto& b = positions[indices[t + 1]];
+    auto& c = positions[indices[t + 2]];
+    area += glm::length(glm::cross(b - a, c - a)) / 2.0f;
+  }
+
+  return area;
+}
+
+TEST(MeshSimplifier, flatGrid) {
+  std::vector<glm::vec3> positions;
+  std::vector<uint32_t> indices;
+  makeGrid(32, [](uint32_t, uint32_t) { return 0.0f; }, positions, indices);
+
+  auto result = simplifyMesh(positions, indices, indices.size() / 4);
+  EXPECT_LE(result.indices.size(), indices.size() / 4);
+  EXPECT_GT(result.indices.size(), 0);
+  EXPECT_EQ(0, result.indices.size() % 3);
+  EXPECT_NEAR(0.0f, result.error, 1e-4f);
+
+  // nothing turned over or folded, and the border stayed
+  EXPECT_NEAR(1.0f, getArea(positions, result.indices), 1e-4f);
+
+  for (size_t t = 0; t < result.indices.size(); t += 3) {
+    auto a = result.indices[t];
+    auto b = result.indices[t + 1];
+    auto c = result.indices[t + 2];
+    ASSERT_LT(std::max({a, b, c}), positions.size());
+    ASSERT_TRUE(a != b && b != c && a != c);
+  }
+}
+
+TEST(MeshSimplifier, maxError) {
+  std::vector<glm::vec3> positions;
+  std::vector<uint32_t> indices;
+  makeGrid(
+      32
+    , [](uint32_t x, uint32_t y) { return 0.05f * std::sin(x * 0.5f) * std::cos(y * 0.5f); }
+    , positions
+    , indices
+  );
+
+  auto coarse = simplifyMesh(positions, indices, 0);
+  EXPECT_LT(coarse.indices.size(), indices.size() / 4);
+  EXPECT_GT(coarse.error, 0.01f);
+
+  auto fine = simplifyMesh(positions, indices, 0, 0.01f);
+  EXPECT_LE(fine.error, 0.01f);
+  EXPECT_LT(fine.indices.size(), indices.size());
+  EXPECT_GT(fine.indices.size(), coarse.indices.size());
+}
+
+TEST(MeshSimplifier, keepsSeams) {
+  std::vector<glm::vec3> positions;
+  std::vector<uint32_t> indices;
+  makeGrid(16, [](uint32_t, uint32_t) { return 0.0f; }, positions, indices);
+
+  // the middle column split in two, as for different UVs
+  std::set<uint32_t> seam;
+  for (uint32_t y = 0; y <= 16; ++y) {
+    auto v = y * 17 + 8;
+    auto copy = static_cast<uint32_t>(positions.size());
+    positions.push_back(positions[v]);
+    seam.insert(v);
+    seam.insert(copy);
+
+    for (size_t t = 0; t < indices.size(); t += 3) {
+      bool right = false;
+      for (size_t j = 0; j < 3; ++j) {
+        right |= positions[indices[t + j]].x > 0.5f;
+      }
+
+      for (size_t j = 0; right && j < 3; ++j) {
+        if (indices[t + j] == v) {
+          indices[t + j] = copy;
+        }
+      }
+    }
+  }
+
+  auto result = simplifyMesh(positions, indices, 0);
+  EXPECT_LT(result.indices.size(), indices.size() / 2);
+
+  std::set<uint32_t> used {result.indices.cbegin(), result.indices.cend()};
+  for (auto v : seam) {
+    EXPECT_TRUE(used.contains(v));
+  }
+  EXPECT_NEAR(1.0f, getArea(positions, result.indices), 1e-4f);
+}
+
+TEST(MeshSimplifier, brokenIndices) {
+  std::vector<glm::vec3> positions {{0.0f, 0.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}};
+  std::vector<uint32_t> indices {0, 1, 3};
+
+  auto result = simplifyMesh(positions, indices, 0);
+  EXPECT_EQ(indices, result.indices);
+  EXPECT_EQ(0.0f, result.error);
+}
+
+}
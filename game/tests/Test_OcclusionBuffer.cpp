@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include "../gfx/OcclusionBuffer.h"
+
+namespace ZH {
+
+static GFX::Camera getCamera() {
+  GFX::Camera cam;
+  cam.reposition(
+      glm::vec3 {0.0f, 0.0f, 0.0f}
+    , glm::vec3 {1.0f, 0.0f, 0.0f}
+    , glm::vec3 {0.0f, 1.0f, 0.0f}
+  );
+  cam.setPerspectiveProjection({
+      .near = 0.1f
+    , .far  = 100.0f
+    , .fovDeg = 90.0f
+    , .width = 1.0f
+    , .height = 1.0f
+  });
+
+  return cam;
+}
+
+// wall facing the camera at x = 5, covering z from -10 to 0
+static const std::vector<glm::vec3> WALL_VERTICES {
+    {5.0f, -10.0f, -10.0f}
+  , {5.0f, -10.0f, 0.0f}
+  , {5.0f, 10.0f, 0.0f}
+  , {5.0f, 10.0f, -10.0f}
+};
+static const std::vector<uint32_t> WALL_INDICES {0, 1, 2, 0, 2, 3};
+
+TEST(OcclusionBuffer, rasterize) {
+  GFX::OcclusionBuffer unit {64, 64};
+  unit.begin(getCamera());
+  unit.rasterize(WALL_VERTICES, WALL_INDICES);
+  unit.finish();
+
+  size_t numCovered = 0;
+  for (uint32_t y = 0; y < 64; ++y) {
+    for (uint32_t x = 0; x < 64; ++x) {
+      auto depth = unit.getDepth(x, y);
+      if (depth < 1000.0f) {
+        EXPECT_FLOAT_EQ(5.0f, depth);
+        numCovered += 1;
+      }
+    }
+  }
+
+  // half of the view
+  EXPECT_EQ(64 * 32, numCovered);
+}
+
+TEST(OcclusionBuffer, isSphereOccluded) {
+  GFX::OcclusionBuffer unit {64, 64};
+  unit.begin(getCamera());
+  unit.rasterize(WALL_VERTICES, WALL_INDICES);
+  unit.finish();
+
+  // behind the wall
+  EXPECT_TRUE(unit.isSphereOccluded(glm::vec3 {10.0f, 0.0f, -4.0f}, 1.0f));
+  EXPECT_TRUE(unit.isSphereOccluded(glm::vec3 {50.0f, 2.0f, -30.0f}, 3.0f));
+  // in front of the wall
+  EXPECT_FALSE(unit.isSphereOccluded(glm::vec3 {3.0f, 0.0f, -2.0f}, 1.0f));
+  // reaching through the wall
+  EXPECT_FALSE(unit.isSphereOccluded(glm::vec3 {6.0f, 0.0f, -4.0f}, 2.0f));
+  // beside the wall
+  EXPECT_FALSE(unit.isSphereOccluded(glm::vec3 {10.0f, 0.0f, 4.0f}, 1.0f));
+  // partially behind
+  EXPECT_FALSE(unit.isSphereOccluded(glm::vec3 {10.0f, 0.0f, 0.0f}, 1.0f));
+  // around the camera
+  EXPECT_FALSE(unit.isSphereOccluded(glm::vec3 {0.0f, 0.0f, 0.0f}, 1.0f));
+}
+
+TEST(OcclusionBuffer, nearPlane) {
+  GFX::OcclusionBuffer unit {64, 64};
+  unit.begin(getCamera());
+
+  // crossing the camera plane, left out
+  std::vector<glm::vec3> vertices {
+      {-1.0f, -10.0f, -10.0f}
+    , {5.0f, -10.0f, 10.0f}
+    , {5.0f, 10.0f, 10.0f}
+  };
+  std::vector<uint32_t> indices {0, 1, 2};
+  unit.rasterize(vertices, indices);
+  unit.finish();
+
+  EXPECT_FALSE(unit.isSphereOccluded(glm::vec3 {20.0f, 0.0f, 0.0f}, 1.0f));
+}
+
+TEST(OcclusionBuffer, emptyIsNeverOccluded) {
+  GFX::OcclusionBuffer unit {64, 64};
+  unit.begin(getCamera());
+  unit.finish();
+
+  EXPECT_FALSE(unit.isSphereOccluded(glm::vec3 {50.0f, 0.0f, 0.0f}, 1.0f));
+}
+
+}
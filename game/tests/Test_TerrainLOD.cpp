@@ -0,0 +1,180 @@
+#include <functional>
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include "../gfx/TerrainLOD.h"
+
+namespace ZH {
+
+struct TestTerrain {
+  Size size;
+  std::vector<Map::VertexData> vertices;
+  std::vector<uint32_t> indices;
+  std::vector<Map::TerrainChunk> chunks;
+};
+
+// same layout as Map::tesselateHeightMap, without flips
+static TestTerrain createTerrain(
+    Size size
+  , std::function<float(uint32_t, uint32_t)> height
+) {
+  TestTerrain terrain;
+  terrain.size = size;
+  terrain.vertices.resize(size.x * size.y * 4);
+  terrain.indices.resize(size.x * size.y * 6);
+
+  auto chunksX = (size.x + Map::CHUNK_SIZE - 1) / Map::CHUNK_SIZE;
+  auto chunksY = (size.y + Map::CHUNK_SIZE - 1) / Map::CHUNK_SIZE;
+  uint32_t firstIndex = 0;
+
+  for (uint32_t cy = 0; cy < chunksY; ++cy) {
+    for (uint32_t cx = 0; cx < chunksX; ++cx) {
+      auto& chunk = terrain.chunks.emplace_back();
+      chunk.origin = Point {cx * Map::CHUNK_SIZE, cy * Map::CHUNK_SIZE};
+      chunk.size =
+        Size {
+            std::min(Map::CHUNK_SIZE, size.x - chunk.origin.x)
+          , std::min(Map::CHUNK_SIZE, size.y - chunk.origin.y)
+        };
+      chunk.firstIndex = firstIndex;
+      chunk.numIndices = chunk.size.x * chunk.size.y * 6;
+      firstIndex += chunk.numIndices;
+    }
+  }
+
+  for (uint32_t y = 0; y < size.y; ++y) {
+    for (uint32_t x = 0; x < size.x; ++x) {
+      uint32_t baseIdx = (y * size.x + x) * 4;
+
+      for (uint32_t i = 0; i < 4; ++i) {
+        auto gx = x + (i & 1);
+        auto gy = y + (i >> 1);
+        auto& vertex = terrain.vertices[baseIdx + i];
+
+        vertex.position = glm::vec3 {gx, height(gx, gy), gy};
+        vertex.uv = glm::vec2 {gx / 16.0f, gy / 16.0f};
+        vertex.textureIdx = 0;
+        vertex.textureIdx2 = 0;
+        vertex.uvAlpha = 0.0f;
+      }
+
+      auto& chunk = terrain.chunks[(y / Map::CHUNK_SIZE) * chunksX + x / Map::CHUNK_SIZE];
+      auto indexIdx =
+        chunk.firstIndex
+          + ((y - chunk.origin.y) * chunk.size.x + (x - chunk.origin.x)) * 6;
+
+      terrain.indices[indexIdx] = baseIdx;
+      terrain.indices[indexIdx + 1] = baseIdx + 1;
+      terrain.indices[indexIdx + 2] = baseIdx + 3;
+      terrain.indices[indexIdx + 3] = baseIdx;
+      terrain.indices[indexIdx + 4] = baseIdx + 3;
+      terrain.indices[indexIdx + 5] = baseIdx + 2;
+    }
+  }
+
+  return terrain;
+}
+
+TEST(TerrainLOD, flatChunks) {
+  auto terrain = createTerrain({64, 64}, [](uint32_t, uint32_t) { return 0.0f; });
+  GFX::TerrainLOD unit {terrain.size, terrain.vertices, terrain.indices, terrain.chunks};
+
+  auto& levels = unit.getChunkLevels();
+  ASSERT_EQ(4, levels.size());
+
+  for (auto& chunkLevels : levels) {
+    EXPECT_EQ(32 * 32 * 6, chunkLevels[0].numIndices);
+    EXPECT_EQ(8 * 8 * 16 * 3, chunkLevels[1].numIndices);
+    EXPECT_EQ(128 * 3, chunkLevels[4].numIndices);
+    EXPECT_FLOAT_EQ(0.0f, chunkLevels[4].error);
+  }
+
+  EXPECT_EQ(4, unit.selectLevel(0, 0.0f));
+}
+
+TEST(TerrainLOD, blendTileSplitsBlocks) {
+  auto terrain = createTerrain({64, 64}, [](uint32_t, uint32_t) { return 0.0f; });
+  auto baseIdx = (5 * 64 + 5) * 4;
+  for (uint32_t i = 0; i < 4; ++i) {
+    terrain.vertices[baseIdx + i].uvAlpha = 1.0f;
+  }
+
+  GFX::TerrainLOD unit {terrain.size, terrain.vertices, terrain.indices, terrain.chunks};
+
+  auto& levels = unit.getChunkLevels();
+  // 3 16-fans, 3 8-fans, 3 4-fans, 16 tiles
+  EXPECT_EQ((3 * 64 + 3 * 32 + 3 * 16 + 16 * 2) * 3, levels[0][4].numIndices);
+  EXPECT_EQ(128 * 3, levels[1][4].numIndices);
+
+  // the blend tile keeps its own triangles
+  std::set<uint32_t> used {
+      unit.getIndices().cbegin() + levels[0][4].firstIndex
+    , unit.getIndices().cbegin() + levels[0][4].firstIndex + levels[0][4].numIndices
+  };
+  for (uint32_t i = 0; i < 4; ++i) {
+    EXPECT_TRUE(used.contains(baseIdx + i));
+  }
+}
+
+TEST(TerrainLOD, errorOfSlopes) {
+  auto terrain = createTerrain({32, 32}, [](uint32_t x, uint32_t y) {
+    return x * 0.25f + y * 0.5f;
+  });
+  GFX::TerrainLOD unit {terrain.size, terrain.vertices, terrain.indices, terrain.chunks};
+
+  auto& levels = unit.getChunkLevels()[0];
+  EXPECT_NEAR(0.0f, levels[4].error, 0.001f);
+  EXPECT_EQ(4, unit.selectLevel(0, 0.001f));
+}
+
+TEST(TerrainLOD, errorOfBumps) {
+  auto terrain = createTerrain({32, 32}, [](uint32_t x, uint32_t y) {
+    return (x == 16 && y == 16) ? 5.0f : 0.0f;
+  });
+  GFX::TerrainLOD unit {terrain.size, terrain.vertices, terrain.indices, terrain.chunks};
+
+  auto& levels = unit.getChunkLevels()[0];
+  EXPECT_FLOAT_EQ(0.0f, levels[0].error);
+  EXPECT_FLOAT_EQ(2.5f, levels[1].error);
+  EXPECT_LE(levels[3].error, levels[4].error);
+  EXPECT_LT(4.0f, levels[4].error);
+
+  EXPECT_EQ(0, unit.selectLevel(0, 1.0f));
+  EXPECT_EQ(4, unit.selectLevel(0, 5.0f));
+}
+
+TEST(TerrainLOD, keepsChunkBorders) {
+  auto terrain = createTerrain({40, 40}, [](uint32_t x, uint32_t y) {
+    return static_cast<float>((x * 7 + y * 13) % 3);
+  });
+  GFX::TerrainLOD unit {terrain.size, terrain.vertices, terrain.indices, terrain.chunks};
+
+  auto& indices = unit.getIndices();
+  auto& levels = unit.getChunkLevels();
+
+  for (size_t c = 0; c < terrain.chunks.size(); ++c) {
+    auto& chunk = terrain.chunks[c];
+
+    for (auto& level : levels[c]) {
+      std::set<std::pair<uint32_t, uint32_t>> used;
+      for (uint32_t i = level.firstIndex; i < level.firstIndex + level.numIndices; ++i) {
+        auto& position = terrain.vertices[indices[i]].position;
+        used.emplace(position.x, position.z);
+      }
+
+      for (uint32_t i = 0; i <= chunk.size.x; ++i) {
+        EXPECT_TRUE(used.contains({chunk.origin.x + i, chunk.origin.y}));
+        EXPECT_TRUE(used.contains({chunk.origin.x + i, chunk.origin.y + chunk.size.y}));
+      }
+      for (uint32_t i = 0; i <= chunk.size.y; ++i) {
+        EXPECT_TRUE(used.contains({chunk.origin.x, chunk.origin.y + i}));
+        EXPECT_TRUE(used.contains({chunk.origin.x + chunk.size.x, chunk.origin.y + i}));
+      }
+    }
+  }
+
+  EXPECT_LT(levels[0][4].numIndices, levels[0][0].numIndices / 8);
+}
+
+}
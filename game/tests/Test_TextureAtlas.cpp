@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include "../gfx/TextureAtlas.h"
+
+namespace ZH {
+
+static std::shared_ptr<GFX::HostTexture> createTexture(Size size, char seed) {
+  std::vector<char> data(size.x * size.y * 4);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>(seed + i / 4);
+  }
+
+  return std::make_shared<GFX::HostTexture>(size, GFX::HostTexture::Format::BGRA8888, std::move(data));
+}
+
+static bool overlaps(const GFX::TextureAtlas::Region& a, const GFX::TextureAtlas::Region& b) {
+  return a.page == b.page
+    && a.position.x < b.position.x + static_cast<int32_t>(b.size.x)
+    && b.position.x < a.position.x + static_cast<int32_t>(a.size.x)
+    && a.position.y < b.position.y + static_cast<int32_t>(b.size.y)
+    && b.position.y < a.position.y + static_cast<int32_t>(a.size.y);
+}
+
+TEST(TextureAtlas, packing) {
+  GFX::TextureAtlas unit {{64, 64}};
+
+  auto texture = createTexture({32, 32}, 0);
+  std::vector<std::string> keys;
+  for (int i = 0; i < 12; ++i) {
+    keys.push_back(std::to_string(i));
+    EXPECT_TRUE(unit.add(keys.back(), texture, {i % 4, i / 4}, {10 + i, 20 - i}));
+  }
+
+  unit.build();
+
+  auto& pages = unit.getPages();
+  ASSERT_GE(pages.size(), 1);
+  EXPECT_LT(pages.size(), keys.size());
+
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto region = unit.getRegion(keys[i]);
+    ASSERT_TRUE(region);
+
+    auto& a = region->get();
+    EXPECT_EQ(Size(10 + i, 20 - i), a.size);
+    ASSERT_LT(a.page, pages.size());
+    auto pageSize = pages[a.page]->getSize();
+    EXPECT_GE(a.position.x, 1);
+    EXPECT_GE(a.position.y, 1);
+    EXPECT_LE(a.position.x + a.size.x + 1, pageSize.x);
+    EXPECT_LE(a.position.y + a.size.y + 1, pageSize.y);
+
+    for (size_t j = 0; j < i; ++j) {
+      EXPECT_FALSE(overlaps(a, unit.getRegion(keys[j])->get())) << i << " " << j;
+    }
+  }
+}
+
+TEST(TextureAtlas, contentsAndGutter) {
+  GFX::TextureAtlas unit {{16, 16}};
+
+  auto texture = createTexture({4, 4}, 10);
+  EXPECT_TRUE(unit.add("sub", texture, {1, 1}, {2, 2}));
+  unit.build();
+
+  auto region = unit.getRegion("sub");
+  ASSERT_TRUE(region);
+  auto& page = *unit.getPages()[region->get().page];
+  auto pageWidth = page.getSize().x;
+  auto& data = page.getData();
+
+  auto texel = [&data, pageWidth](Point p) {
+    return static_cast<uint8_t>(data[(p.y * pageWidth + p.x) * 4]);
+  };
+
+  auto p = region->get().position;
+  // source texels 5, 6, 9, 10
+  EXPECT_EQ(15, texel(p));
+  EXPECT_EQ(16, texel(p + Point {1, 0}));
+  EXPECT_EQ(19, texel(p + Point {0, 1}));
+  EXPECT_EQ(20, texel(p + Point {1, 1}));
+  // repeated border
+  EXPECT_EQ(15, texel(p + Point {-1, -1}));
+  EXPECT_EQ(16, texel(p + Point {2, -1}));
+  EXPECT_EQ(20, texel(p + Point {2, 2}));
+}
+
+TEST(TextureAtlas, oversizedAndInvalid) {
+  GFX::TextureAtlas unit {{16, 16}};
+
+  auto big = createTexture({32, 8}, 0);
+  auto small = createTexture({4, 4}, 0);
+  EXPECT_TRUE(unit.add("big", big, {0, 0}, {32, 8}));
+  EXPECT_TRUE(unit.add("small", small, {0, 0}, {4, 4}));
+  // clipped to the texture
+  EXPECT_TRUE(unit.add("clipped", small, {2, 2}, {8, 8}));
+  EXPECT_FALSE(unit.add("outside", small, {4, 0}, {2, 2}));
+
+  GFX::HostTexture compressed {{4, 4}, GFX::HostTexture::Format::BC1, std::vector<char>(8)};
+  EXPECT_FALSE(unit.add(
+      "compressed"
+    , std::make_shared<GFX::HostTexture>(std::move(compressed))
+    , {0, 0}
+    , {4, 4}
+  ));
+
+  unit.build();
+
+  auto bigRegion = unit.getRegion("big");
+  ASSERT_TRUE(bigRegion);
+  EXPECT_EQ(34, unit.getPages()[bigRegion->get().page]->getSize().x);
+  EXPECT_EQ(Size(2, 2), unit.getRegion("clipped")->get().size);
+  EXPECT_TRUE(unit.getRegion("small"));
+  EXPECT_FALSE(unit.getRegion("outside"));
+  EXPECT_FALSE(unit.getRegion("compressed"));
+}
+
+}
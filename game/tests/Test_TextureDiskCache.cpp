@@ -0,0 +1,115 @@
+#include <filesystem>
+
+#include <gtest/gtest.h>
+
+#include "../gfx/TextureDiskCache.h"
+
+namespace ZH {
+
+class TextureDiskCacheTest : public ::testing::Test {
+  protected:
+    std::filesystem::path directory;
+
+    void SetUp() override {
+      directory =
+        std::filesystem::temp_directory_path()
+          / ("zh_texture_cache_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+      std::filesystem::remove_all(directory);
+    }
+
+    void TearDown() override {
+      std::filesystem::remove_all(directory);
+    }
+
+    static GFX::HostTexture createTexture(Size size, char value) {
+      GFX::HostTexture texture {
+          size
+        , GFX::HostTexture::Format::BGRA8888
+        , std::vector<char>(size.x * size.y * 4, value)
+      };
+      texture.generateMipLevels();
+
+      return texture;
+    }
+};
+
+TEST_F(TextureDiskCacheTest, roundTrip) {
+  auto texture = createTexture({8, 4}, 7);
+
+  {
+    GFX::TextureDiskCache unit {directory, 1 << 20};
+    EXPECT_FALSE(unit.get("art\\a.tga", 1));
+
+    unit.put("art\\a.tga", 1, texture);
+    EXPECT_EQ(1, unit.getNumEntries());
+  }
+
+  // persisted through the index
+  GFX::TextureDiskCache unit {directory, 1 << 20};
+  EXPECT_EQ(1, unit.getNumEntries());
+
+  auto result = unit.get("art\\a.tga", 1);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(Size(8, 4), result->getSize());
+  EXPECT_EQ(GFX::HostTexture::Format::BGRA8888, result->getFormat());
+  EXPECT_EQ(texture.getData(), result->getData());
+
+  auto& levels = result->getMipLevels();
+  ASSERT_EQ(texture.getMipLevels().size(), levels.size());
+  for (size_t i = 0; i < levels.size(); ++i) {
+    EXPECT_EQ(texture.getMipLevels()[i].size, levels[i].size);
+    EXPECT_EQ(texture.getMipLevels()[i].offset, levels[i].offset);
+  }
+
+  // changed source or other key
+  EXPECT_FALSE(unit.get("art\\a.tga", 2));
+  EXPECT_FALSE(unit.get("art\\b.tga", 1));
+}
+
+TEST_F(TextureDiskCacheTest, evictsLeastRecentlyUsed) {
+  auto texture = createTexture({16, 16}, 1);
+
+  size_t entrySize;
+  {
+    GFX::TextureDiskCache probe {directory, 1 << 20};
+    probe.put("probe", 0, texture);
+    entrySize = probe.getDataSize();
+  }
+  std::filesystem::remove_all(directory);
+
+  GFX::TextureDiskCache unit {directory, entrySize * 3};
+  unit.put("a", 0, texture);
+  unit.put("b", 0, texture);
+  unit.put("c", 0, texture);
+  EXPECT_EQ(3, unit.getNumEntries());
+
+  // a more recent than b
+  EXPECT_TRUE(unit.get("a", 0));
+  unit.put("d", 0, texture);
+
+  EXPECT_LE(unit.getDataSize(), entrySize * 3);
+  EXPECT_TRUE(unit.get("a", 0));
+  EXPECT_FALSE(unit.get("b", 0));
+  EXPECT_TRUE(unit.get("d", 0));
+}
+
+TEST_F(TextureDiskCacheTest, corruptIndex) {
+  {
+    GFX::TextureDiskCache unit {directory, 1 << 20};
+    unit.put("a", 0, createTexture({4, 4}, 3));
+  }
+
+  {
+    std::ofstream index {directory / "textures.idx", std::ios::binary | std::ios::trunc};
+    index << "garbage";
+  }
+
+  GFX::TextureDiskCache unit {directory, 1 << 20};
+  EXPECT_EQ(0, unit.getNumEntries());
+  EXPECT_FALSE(unit.get("a", 0));
+
+  unit.put("a", 0, createTexture({4, 4}, 3));
+  EXPECT_TRUE(unit.get("a", 0));
+}
+
+}
@@ -0,0 +1,181 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "../gfx/TextureStreamer.h"
+
+namespace ZH::GFX {
+
+static std::shared_ptr<HostTexture> makeTexture(uint32_t size) {
+  return std::make_shared<HostTexture>(
+      Size {size, size}
+    , HostTexture::Format::BGRA8888
+    , std::vector<char>(size * size * 4)
+  );
+}
+
+static std::vector<TextureStreamer::Result> waitFor(
+    TextureStreamer& unit
+  , size_t numResults
+  , size_t maxBytes = SIZE_MAX
+) {
+  std::vector<TextureStreamer::Result> results;
+
+  for (size_t i = 0; i < 1000 && results.size() < numResults; ++i) {
+    for (auto& result : unit.takeFinished(maxBytes)) {
+      results.push_back(std::move(result));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds {2});
+  }
+
+  return results;
+}
+
+TEST(TextureStreamer, loadsInBackground) {
+  TextureStreamer unit {
+      [](const std::string& key) {
+        return key == "missing.tga" ? nullptr : makeTexture(4);
+      }
+    , 2
+  };
+
+  EXPECT_TRUE(unit.request("a.tga"));
+  EXPECT_TRUE(unit.request("missing.tga"));
+  EXPECT_TRUE(unit.isPending("a.tga"));
+
+  auto results = waitFor(unit, 2);
+  ASSERT_EQ(2, results.size());
+
+  for (auto& result : results) {
+    if (result.key == "a.tga") {
+      ASSERT_TRUE(result.texture);
+      EXPECT_EQ(4, result.texture->getSize().x);
+    } else {
+      EXPECT_EQ("missing.tga", result.key);
+      EXPECT_FALSE(result.texture);
+    }
+  }
+
+  EXPECT_FALSE(unit.isPending("a.tga"));
+  EXPECT_FALSE(unit.isPending("missing.tga"));
+}
+
+TEST(TextureStreamer, mergesRequests) {
+  std::atomic<size_t> numLoads = 0;
+  std::atomic<bool> release = false;
+
+  TextureStreamer unit {
+      [&](const std::string&) {
+        while (!release) {
+          std::this_thread::yield();
+        }
+        numLoads += 1;
+
+        return makeTexture(1);
+      }
+    , 2
+  };
+
+  EXPECT_TRUE(unit.request("a.tga"));
+  EXPECT_FALSE(unit.request("a.tga"));
+  EXPECT_FALSE(unit.request("a.tga"));
+  release = true;
+
+  auto results = waitFor(unit, 1);
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ(1, numLoads);
+
+  // taken, so loaded again
+  EXPECT_TRUE(unit.request("a.tga"));
+  EXPECT_EQ(1, waitFor(unit, 1).size());
+  EXPECT_EQ(2, numLoads);
+}
+
+TEST(TextureStreamer, takesWithinBudget) {
+  std::atomic<size_t> numLoads = 0;
+
+  TextureStreamer unit {
+      [&numLoads](const std::string&) {
+        numLoads += 1;
+        return makeTexture(8);
+      }
+    , 1
+  };
+
+  unit.request("a.tga");
+  unit.request("b.tga");
+  unit.request("c.tga");
+
+  // the first one is taken on its own, the others after it
+  auto first = waitFor(unit, 1, 8 * 8 * 4);
+  ASSERT_EQ(1, first.size());
+  EXPECT_EQ("a.tga", first[0].key);
+
+  auto rest = waitFor(unit, 2);
+  ASSERT_EQ(2, rest.size());
+  EXPECT_EQ("b.tga", rest[0].key);
+  EXPECT_EQ("c.tga", rest[1].key);
+  EXPECT_EQ(3, numLoads);
+}
+
+TEST(TextureStreamer, waitsForFinished) {
+  TextureStreamer unit {
+      [](const std::string&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds {10});
+        return makeTexture(1);
+      }
+    , 1
+  };
+
+  // nothing to wait for
+  unit.waitFinished();
+
+  unit.request("a.tga");
+  unit.waitFinished();
+
+  auto results = unit.takeFinished();
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ("a.tga", results[0].key);
+
+  unit.waitFinished();
+  EXPECT_TRUE(unit.takeFinished().empty());
+}
+
+TEST(TextureStreamer, stopDropsQueued) {
+  std::atomic<bool> started = false;
+  std::atomic<bool> queued = false;
+
+  TextureStreamer unit {
+      [&started, &queued, &unit](const std::string&) {
+        started = true;
+        // until stopping has dropped the queued one
+        while (!queued || unit.isPending("b.tga")) {
+          std::this_thread::yield();
+        }
+
+        return makeTexture(1);
+      }
+    , 1
+  };
+
+  unit.request("a.tga");
+  unit.request("b.tga");
+  queued = true;
+  while (!started) {
+    std::this_thread::yield();
+  }
+
+  unit.stop();
+
+  EXPECT_FALSE(unit.isPending("b.tga"));
+  EXPECT_FALSE(unit.request("c.tga"));
+
+  // the running one still finishes
+  auto results = unit.takeFinished();
+  ASSERT_EQ(1, results.size());
+  EXPECT_EQ("a.tga", results[0].key);
+}
+
+}
@@ -0,0 +1,133 @@
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+#include "../formats/W3DFile.h"
+
+namespace ZH {
+
+static std::string chunk(uint32_t type, const std::string& data, bool hasSubchunks = false) {
+  std::string result(8, '\0');
+  uint32_t size = static_cast<uint32_t>(data.size()) | (hasSubchunks ? 1u << 31 : 0u);
+  std::memcpy(result.data(), &type, 4);
+  std::memcpy(result.data() + 4, &size, 4);
+
+  return result + data;
+}
+
+static std::string u32(uint32_t value) {
+  return std::string {reinterpret_cast<const char*>(&value), 4};
+}
+
+static std::string f32(float value) {
+  return std::string {reinterpret_cast<const char*>(&value), 4};
+}
+
+static std::string name(const std::string& value, size_t size) {
+  auto result = value;
+  result.resize(size, '\0');
+  return result;
+}
+
+static std::string mesh(const std::string& container, const std::string& meshName) {
+  std::string header;
+  header += u32(0);                // version
+  header += u32(0);                // flags
+  header += name(meshName, 16);
+  header += name(container, 16);
+  header += u32(0);                // triangles
+  header += u32(0);                // vertices
+  header += std::string(28, '\0'); // material, unknown, channels
+  header += std::string(40, '\0'); // bounding box and sphere
+
+  return chunk(0x0, chunk(0x1F, header), true);
+}
+
+static std::string levelHeader(float maxScreenSize) {
+  return chunk(0x703, u32(1) + f32(maxScreenSize));
+}
+
+static std::string levelMesh(const std::string& subObject) {
+  return chunk(0x704, u32(0) + name(subObject, 32));
+}
+
+static std::shared_ptr<W3DModel> findModel(
+  const std::vector<std::shared_ptr<W3DModel>>& models
+  , const std::string& meshName
+) {
+  for (auto& model : models) {
+    if (model->name == meshName) {
+      return model;
+    }
+  }
+
+  return {};
+}
+
+TEST(W3DFileTest, assigningHLODScreenSizes) {
+  auto data =
+    mesh("BOX", "LOW")
+    + mesh("BOX", "HIGH")
+    + mesh("BOX", "SHARED")
+    + mesh("BOX", "OTHER")
+    + chunk(0x700
+      , chunk(0x701, std::string(40, '\0'))
+        + chunk(0x702, levelHeader(0.1f) + levelMesh("BOX.LOW") + levelMesh("box.shared"), true)
+        + chunk(0x702, levelHeader(2.0f) + levelMesh("BOX.HIGH") + levelMesh("BOX.SHARED"), true)
+      , true
+    );
+
+  std::istringstream stream {data};
+  W3DFile unit {stream};
+  auto models = unit.parse();
+  ASSERT_EQ(4, models.size());
+
+  auto low = findModel(models, "LOW");
+  ASSERT_TRUE(low);
+  EXPECT_FLOAT_EQ(0.0f, low->minScreenSize);
+  EXPECT_FLOAT_EQ(0.1f, low->maxScreenSize);
+
+  auto high = findModel(models, "HIGH");
+  ASSERT_TRUE(high);
+  EXPECT_FLOAT_EQ(0.1f, high->minScreenSize);
+  EXPECT_FLOAT_EQ(2.0f, high->maxScreenSize);
+
+  auto shared = findModel(models, "SHARED");
+  ASSERT_TRUE(shared);
+  EXPECT_FLOAT_EQ(0.0f, shared->minScreenSize);
+  EXPECT_FLOAT_EQ(2.0f, shared->maxScreenSize);
+
+  auto other = findModel(models, "OTHER");
+  ASSERT_TRUE(other);
+  EXPECT_FLOAT_EQ(0.0f, other->minScreenSize);
+  EXPECT_EQ(std::numeric_limits<float>::max(), other->maxScreenSize);
+}
+
+TEST(W3DFileTest, skippingShortHLODHeader) {
+  auto data =
+    mesh("BOX", "LOW")
+    + mesh("BOX", "HIGH")
+    + chunk(0x700
+      , chunk(0x702, chunk(0x703, u32(1)) + levelMesh("BOX.LOW"), true)
+        + chunk(0x702, levelHeader(2.0f) + levelMesh("BOX.HIGH"), true)
+      , true
+    );
+
+  std::istringstream stream {data};
+  W3DFile unit {stream};
+  auto models = unit.parse();
+  ASSERT_EQ(2, models.size());
+
+  auto low = findModel(models, "LOW");
+  ASSERT_TRUE(low);
+  EXPECT_FLOAT_EQ(0.0f, low->minScreenSize);
+  EXPECT_EQ(std::numeric_limits<float>::max(), low->maxScreenSize);
+
+  auto high = findModel(models, "HIGH");
+  ASSERT_TRUE(high);
+  EXPECT_FLOAT_EQ(2.0f, high->maxScreenSize);
+}
+
+}
@@ -53,8 +53,15 @@ VkImageView CombinedSampler::getVkImageView () const {
   return texture.getVkImageView();
 }
 
-VkResult CombinedSampler::recordUploadCommands (VkCommandBuffer vkCommandBuffer) {
-  return texture.recordUploadCommands(vkCommandBuffer);
+VkResult CombinedSampler::recordUploadCommands (
+    VkCommandBuffer vkCommandBuffer
+  , VkPipelineStageFlags vkDstStageFlags
+) {
+  return texture.recordUploadCommands(vkCommandBuffer, vkDstStageFlags);
+}
+
+StagingAllocation CombinedSampler::takeStagingAllocation () {
+  return texture.takeStagingAllocation();
 }
 
 }
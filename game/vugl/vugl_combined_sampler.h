@@ -31,15 +31,20 @@ class CombinedSampler : public Sampler, public UploadableResource {
     VkImage getVkImage () const;
     VkImageView getVkImageView () const;
 
-    VkResult recordUploadCommands (VkCommandBuffer vkCommandBuffer) override;
+    VkResult recordUploadCommands (
+        VkCommandBuffer vkCommandBuffer
+      , VkPipelineStageFlags vkDstStageFlags
+    ) override;
+    StagingAllocation takeStagingAllocation () override;
 
     template <typename T>
     void createTexture (
         const std::vector<T>& data
       , const VkExtent2D& extent
       , VkFormat format
+      , const std::vector<VkDeviceSize>& mipOffsets = {}
     ) {
-      texture.createTexture(data, extent, format);
+      texture.createTexture(data, extent, format, mipOffsets);
       vkLastResult = texture.getLastResult();
     }
 
@@ -13,6 +13,7 @@ CommandBuffer::CommandBuffer (CommandBuffer && other)
   , state{other.state}
   , frameIndex{other.frameIndex}
   , secondary{other.secondary}
+  , vkLastResult{other.vkLastResult}
 {
   other.vkCommandBuffer = VK_NULL_HANDLE;
   other.state = State::DESTROYED;
@@ -128,6 +129,17 @@ VkResult CommandBuffer::bindResource (BindableResource& resource) {
   return resource.recordBindCommands(vkCommandBuffer, frameIndex);
 }
 
+VkResult CommandBuffer::bindResource (
+    DescriptorSet& descriptorSet
+  , std::span<const uint32_t> dynamicOffsets
+) {
+  if (State::OPEN != state && State::COMPUTE_OPEN != state) {
+    return VK_NOT_READY;
+  }
+
+  return descriptorSet.recordBindCommands(vkCommandBuffer, frameIndex, dynamicOffsets);
+}
+
 VkResult CommandBuffer::draw (Drawer& drawer) {
   if (State::OPEN != state && State::COMPUTE_OPEN != state) {
     return VK_NOT_READY;
@@ -154,6 +166,27 @@ VkResult CommandBuffer::executeSecondary (const CommandBuffer& secondary) {
   return VK_SUCCESS;
 }
 
+VkResult CommandBuffer::executeSecondary (std::span<const CommandBuffer> secondaries) {
+  if (secondaries.empty()) {
+    return VK_SUCCESS;
+  }
+
+  std::vector<VkCommandBuffer> vkCommandBuffers;
+  vkCommandBuffers.reserve(secondaries.size());
+
+  for (auto& secondary : secondaries) {
+    vkCommandBuffers.push_back(secondary.vkCommandBuffer);
+  }
+
+  vkCmdExecuteCommands(
+      vkCommandBuffer
+    , vkCommandBuffers.size()
+    , vkCommandBuffers.data()
+  );
+
+  return VK_SUCCESS;
+}
+
 VkResult CommandBuffer::closeCommands () {
   if (State::COMPUTE_OPEN != state) {
     return VK_NOT_READY;
@@ -203,6 +236,10 @@ VkResult CommandBuffer::endDebugLabel () {
   return VK_SUCCESS;
 }
 
+size_t CommandBuffer::getFrameIndex () const {
+  return frameIndex;
+}
+
 const VkCommandBuffer& CommandBuffer::getVkCommandBuffer () const {
   return vkCommandBuffer;
 }
@@ -5,12 +5,14 @@
 
 #include <array>
 #include <functional>
+#include <span>
 #include <string>
 #include <vector>
 
 #include <vulkan/vulkan.h>
 
 #include "vugl_bindable_resource.h"
+#include "vugl_descriptor_set.h"
 #include "vugl_drawer.h"
 #include "vugl_dynamic.h"
 #include "vugl_render_pass.h"
@@ -57,15 +59,19 @@ class CommandBuffer {
       , const std::array<VkClearValue, 2>& vkClearColors
     );
     VkResult bindResource (BindableResource& resource);
+    VkResult bindResource (DescriptorSet& descriptorSet, std::span<const uint32_t> dynamicOffsets);
     VkResult draw (Drawer& drawer);
     VkResult draw (std::function<VkResult(VkCommandBuffer, uint32_t)>);
     VkResult executeSecondary (const CommandBuffer&);
+    // merges all secondaries into one execute command, in order
+    VkResult executeSecondary (std::span<const CommandBuffer>);
     VkResult closeCommands ();
     VkResult closeRendering ();
 
     VkResult beginDebugLabel(const std::string&);
     VkResult endDebugLabel();
 
+    size_t getFrameIndex () const;
     const VkCommandBuffer& getVkCommandBuffer () const;
 
     void reset ();
@@ -8,6 +8,7 @@ ComputePipeline::ComputePipeline (ComputePipeline && other)
   : vkDevice{other.vkDevice}
   , vkLastResult{other.vkLastResult}
   , resourceAllocator{other.resourceAllocator}
+  , descriptorAllocator{other.descriptorAllocator}
   , vkCS{other.vkCS}
   , vkDescriptorSetLayout{other.vkDescriptorSetLayout}
   , vkPipelineLayout{other.vkPipelineLayout}
@@ -26,9 +27,11 @@ ComputePipeline::ComputePipeline (
     const PipelineSetup& setup
   , VkDevice vkDevice
   , ResourceAllocator& resourceAllocator
+  , DescriptorAllocator& descriptorAllocator
 )
   : vkDevice{vkDevice}
   , resourceAllocator{resourceAllocator}
+  , descriptorAllocator{descriptorAllocator}
   , vkCS{VK_NULL_HANDLE}
   , vkDescriptorSetLayout{VK_NULL_HANDLE}
   , vkPipelineLayout{VK_NULL_HANDLE}
@@ -109,7 +112,7 @@ ComputePipeline::~ComputePipeline () {
 }
 
 DescriptorSet ComputePipeline::createDescriptorSet () {
-  return {vkDevice, vkPipelineLayout, vkDescriptorSetLayout, 1};
+  return {vkDevice, descriptorAllocator, vkPipelineLayout, vkDescriptorSetLayout, 1};
 }
 
 VkResult ComputePipeline::draw (VkCommandBuffer buffer, uint32_t /*i*/) {
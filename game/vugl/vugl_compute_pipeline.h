@@ -5,6 +5,7 @@
 
 #include "vugl_bindable_resource.h"
 #include "vugl_drawer.h"
+#include "vugl_descriptor_allocator.h"
 #include "vugl_descriptor_set.h"
 #include "vugl_pipeline_setup.h"
 #include "vugl_resource_allocator.h"
@@ -16,6 +17,7 @@ class ComputePipeline : public BindableResource, public Drawer {
     VkDevice vkDevice;
     VkResult vkLastResult;
     ResourceAllocator& resourceAllocator;
+    DescriptorAllocator& descriptorAllocator;
 
     VkShaderModule vkCS;
 
@@ -34,6 +36,7 @@ class ComputePipeline : public BindableResource, public Drawer {
         const PipelineSetup& setup
       , VkDevice vkDevice
       , ResourceAllocator& resourceAllocator
+      , DescriptorAllocator& descriptorAllocator
     );
     ~ComputePipeline ();
 
@@ -36,14 +36,20 @@ Context::Context (
   , vkInstance{VK_NULL_HANDLE}
   , vkPhysicalDevice{VK_NULL_HANDLE}
   , vkPhysicalDeviceProperties{}
+  , vkPhysicalDeviceFeatures{}
+  , vkEnabledDeviceFeatures{}
   , vkDevice{VK_NULL_HANDLE}
   , allocator{VK_NULL_HANDLE}
   , resourceAllocator{}
   , gfxQueueFamilyIndex{0}
   , presenterQueueFamilyIndex{0}
+  , transferQueueFamilyIndex{}
   , vkGFXQueue{VK_NULL_HANDLE}
   , vkPresenterQueue{VK_NULL_HANDLE}
+  , vkTransferQueue{VK_NULL_HANDLE}
   , primaryCommandPool{}
+  , uploadQueue{}
+  , frameArena{}
   , vkSurface{VK_NULL_HANDLE}
   , vkSurfaceCapabilities{}
   , vkSurfaceFormat{}
@@ -113,7 +119,9 @@ Context::Context (
   }
 
   this->gfxQueueFamilyIndex = gfxQueueFamilyIndexOption.value();
+  this->transferQueueFamilyIndex = findTransferQueueFamilyIndex(vkPhysicalDevice);
   vkGetPhysicalDeviceProperties(vkPhysicalDevice, &vkPhysicalDeviceProperties);
+  vkGetPhysicalDeviceFeatures(vkPhysicalDevice, &vkPhysicalDeviceFeatures);
 
   auto msaaBits =
     vkPhysicalDeviceProperties.limits.framebufferColorSampleCounts
@@ -165,6 +173,9 @@ void Context::setSurface (
 
   std::vector<VkDeviceQueueCreateInfo> vkDeviceQueueCreateInfos;
   std::set<uint32_t> queueFamilyIndices = { gfxQueueFamilyIndex, presenterQueueFamilyIndex };
+  if (transferQueueFamilyIndex) {
+    queueFamilyIndices.insert(transferQueueFamilyIndex.value());
+  }
 
   float queuePriority = 1.0f;
   for (uint32_t familyIndex : queueFamilyIndices) {
@@ -210,6 +221,7 @@ void Context::setSurface (
   if (this->vkLastResult != VK_SUCCESS) {
     return;
   }
+  this->vkEnabledDeviceFeatures = enabledFeatures;
 
   this->primaryCommandPool = std::make_unique<Vugl::CommandPool>(vkDevice, gfxQueueFamilyIndex);
 
@@ -229,10 +241,33 @@ void Context::setSurface (
     return;
   }
   this->resourceAllocator = ResourceAllocator{vkDevice, vkPhysicalDevice, allocator};
+  this->vkLastResult = resourceAllocator.createStagingRing(STAGING_RING_SIZE);
+
+  if (this->vkLastResult != VK_SUCCESS) {
+    return;
+  }
 
   vkGetDeviceQueue(vkDevice, gfxQueueFamilyIndex, 0, &(this->vkGFXQueue));
   vkGetDeviceQueue(vkDevice, presenterQueueFamilyIndex, 0, &(this->vkPresenterQueue));
 
+  if (transferQueueFamilyIndex) {
+    vkGetDeviceQueue(vkDevice, transferQueueFamilyIndex.value(), 0, &(this->vkTransferQueue));
+    resourceAllocator.setQueueFamilyIndices({gfxQueueFamilyIndex, transferQueueFamilyIndex.value()});
+
+    this->uploadQueue =
+      std::make_unique<Vugl::UploadQueue>(vkDevice, resourceAllocator, vkTransferQueue, transferQueueFamilyIndex.value(), true);
+  } else {
+    this->uploadQueue =
+      std::make_unique<Vugl::UploadQueue>(vkDevice, resourceAllocator, vkGFXQueue, gfxQueueFamilyIndex, false);
+  }
+
+  this->vkLastResult = uploadQueue->getLastResult();
+  if (this->vkLastResult != VK_SUCCESS) {
+    return;
+  }
+
+  this->descriptorAllocator = std::make_unique<Vugl::DescriptorAllocator>(vkDevice);
+
   vkGetPhysicalDeviceSurfaceCapabilitiesKHR(vkPhysicalDevice, vkSurface, &(this->vkSurfaceCapabilities));
 
   uint32_t formatsCount = 0;
@@ -268,6 +303,19 @@ void Context::setSurface (
     return;
   }
 
+  this->frameArena =
+    std::make_unique<Vugl::FrameArena>(
+        resourceAllocator
+      , vkPhysicalDeviceProperties.limits.minUniformBufferOffsetAlignment
+      , static_cast<uint32_t>(vkSwapchainImageViews.size())
+      , FRAME_ARENA_SIZE
+    );
+
+  this->vkLastResult = frameArena->getLastResult();
+  if (VK_SUCCESS != this->vkLastResult) {
+    return;
+  }
+
   VkSemaphoreCreateInfo vkSemaphoreCreateInfo = {};
   vkSemaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
@@ -386,7 +434,7 @@ void Context::createSwapchainResources () {
     }
   } else {
     for (decltype(frames)::size_type i = 0; i < imagesCount; ++i) {
-      frames.emplace_back(vkDevice, vkGFXQueue, vkPresenterQueue, vkSwapchain, i);
+      frames.emplace_back(vkDevice, vkGFXQueue, vkPresenterQueue, vkSwapchain, i, uploadQueue.get());
     }
   }
 
@@ -454,6 +502,11 @@ void Context::destroy () {
   this->vkSurface = VK_NULL_HANDLE;
 
   primaryCommandPool.reset();
+  uploadQueue.reset();
+  frameArena.reset();
+  descriptorSetCache.clear();
+  descriptorAllocator.reset();
+  resourceAllocator.destroyStagingRing();
 
   vmaDestroyAllocator(allocator);
   this->allocator = VK_NULL_HANDLE;
@@ -488,13 +541,30 @@ CommandPool Context::createCommandPool () {
 }
 
 ComputePipeline Context::createComputePipeline (const PipelineSetup& setup) {
-  return {setup, vkDevice, resourceAllocator};
+  return {setup, vkDevice, resourceAllocator, *descriptorAllocator};
 }
 
 ElementBuffer Context::createElementBuffer (uint32_t binding) {
   return {resourceAllocator, binding};
 }
 
+ElementPool Context::createElementPool (
+    uint32_t binding
+  , VkDeviceSize vertexCapacity
+  , VkDeviceSize indexCapacity
+  , bool bigIndex
+) {
+  return {resourceAllocator, binding, vertexCapacity, indexCapacity, bigIndex};
+}
+
+IndirectBuffer Context::createIndirectBuffer (uint32_t capacity) {
+  return {
+      resourceAllocator
+    , static_cast<uint32_t>(vkSwapchainImageViews.size())
+    , capacity
+  };
+}
+
 Pipeline Context::createPipeline (
     const PipelineSetup& setup
   , VkRenderPass renderPass
@@ -502,6 +572,7 @@ Pipeline Context::createPipeline (
   return {
       setup
     , vkDevice
+    , *descriptorAllocator
     , static_cast<uint32_t>(vkSwapchainImageViews.size())
     , renderPass
   };
@@ -578,6 +649,10 @@ VkExtent2D Context::getExtent () const {
   return vkSwapchainExtent;
 }
 
+FrameArena& Context::getFrameArena () {
+  return *frameArena;
+}
+
 VkInstance Context::getInstance () const {
   return vkInstance;
 }
@@ -595,6 +670,7 @@ Frame& Context::getNextFrame () {
 
   auto& frame = frames[imageIndex];
   frame.setFrameLockHandles(vkSubmitFences[imageIndex], vkImageAvailableSemaphores[currentFrame]);
+  frameArena->reset(imageIndex);
 
   this->currentFrame = (currentFrame + 1) % vkSwapchainImageViews.size();
 
@@ -628,6 +704,14 @@ std::optional<uint32_t> Context::findGFXQueueFamilyIndex (VkPhysicalDevice vkPhy
   return std::nullopt;
 }
 
+const VkPhysicalDeviceFeatures& Context::getVkEnabledDeviceFeatures () const {
+  return vkEnabledDeviceFeatures;
+}
+
+const VkPhysicalDeviceFeatures& Context::getVkPhysicalDeviceFeatures () const {
+  return vkPhysicalDeviceFeatures;
+}
+
 const VkPhysicalDeviceProperties& Context::getVkPhysicalDeviceProperties () const {
   return vkPhysicalDeviceProperties;
 }
@@ -648,6 +732,35 @@ bool Context::isDebuggingAllowed() const {
   return debuggingAllowed;
 }
 
+bool Context::isFormatSampleable (VkFormat vkFormat) const {
+  VkFormatProperties vkFormatProperties = {};
+  vkGetPhysicalDeviceFormatProperties(vkPhysicalDevice, vkFormat, &vkFormatProperties);
+
+  return vkFormatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT;
+}
+
+std::optional<uint32_t> Context::findTransferQueueFamilyIndex (VkPhysicalDevice vkPhysicalDevice) const {
+  uint32_t count = 0;
+
+  vkGetPhysicalDeviceQueueFamilyProperties(vkPhysicalDevice, &count, nullptr);
+  std::vector<VkQueueFamilyProperties> queueFamilies{count};
+  vkGetPhysicalDeviceQueueFamilyProperties(vkPhysicalDevice, &count, queueFamilies.data());
+
+  // DMA engines only, uploads run alongside rendering
+  uint32_t i = 0;
+  for (const auto& queueFamily : queueFamilies) {
+    if ((queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT)
+        && !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))
+    ) {
+      return {i};
+    }
+
+    i += 1;
+  }
+
+  return std::nullopt;
+}
+
 std::optional<uint32_t> Context::findPresenterQueueFamilyIndex (
     VkPhysicalDevice vkPhysicalDevice
   , VkSurfaceKHR vkSurface
@@ -705,45 +818,25 @@ VkPhysicalDevice Context::pickSuitableVkPhysicalDevice (
   return VK_NULL_HANDLE;
 }
 
-bool Context::uploadResource (UploadableResource& resource) {
-  std::lock_guard lock {uploadMutex};
-
-  auto vuglCommandBuffer = createCommandBuffer(0);
-  if (vuglCommandBuffer.getLastResult() != VK_SUCCESS) {
-    return false;
-  }
-
-  VkCommandBuffer buffer = vuglCommandBuffer.getVkCommandBuffer();
-  VkCommandBufferBeginInfo vkCmdBufferBeginInfo = {};
-  vkCmdBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-  vkCmdBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-  vkBeginCommandBuffer(buffer, &vkCmdBufferBeginInfo);
-  resource.recordUploadCommands(buffer);
-  vkEndCommandBuffer(buffer);
-
-  submitToGPUQueue(buffer);
-
-  return true;
+std::shared_ptr<DescriptorSet> Context::shareDescriptorSet (DescriptorSet&& descriptorSet) {
+  return descriptorSetCache.share(std::move(descriptorSet));
 }
 
-bool Context::submitToGPUQueue (VkCommandBuffer& buffer) {
-  VkSubmitInfo vkSubmitInfo = {};
-  vkSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  vkSubmitInfo.commandBufferCount = 1;
-  vkSubmitInfo.pCommandBuffers = &buffer;
+bool Context::uploadResource (UploadableResource& resource) {
+  return uploadQueue->enqueue(resource) == VK_SUCCESS;
+}
 
-  auto result = vkQueueSubmit(vkGFXQueue, 1, &vkSubmitInfo, VK_NULL_HANDLE);
-  if (result != VK_SUCCESS) {
-    return false;
+void Context::flushUploads () {
+  if (uploadQueue) {
+    uploadQueue->flush();
+    uploadQueue->releaseFinished();
   }
-
-  vkQueueWaitIdle(vkGFXQueue);
-
-  return true;
 }
 
 void Context::waitForIdle () {
+  if (uploadQueue) {
+    uploadQueue->flush();
+  }
   vkDeviceWaitIdle(vkDevice);
 }
 
@@ -4,7 +4,7 @@
 #define H_VUGL
 
 #include <cstdint>
-#include <mutex>
+#include <memory>
 #include <optional>
 #include <vector>
 
@@ -15,13 +15,19 @@
 #include "vugl_combined_sampler.h"
 #include "vugl_command_pool.h"
 #include "vugl_compute_pipeline.h"
+#include "vugl_descriptor_allocator.h"
+#include "vugl_descriptor_set_cache.h"
 #include "vugl_dynamic.h"
 #include "vugl_element_buffer.h"
+#include "vugl_element_pool.h"
 #include "vugl_frame.h"
+#include "vugl_frame_arena.h"
+#include "vugl_indirect_buffer.h"
 #include "vugl_pipeline.h"
 #include "vugl_resource_allocator.h"
 #include "vugl_texture.h"
 #include "vugl_uniform_buffer.h"
+#include "vugl_upload_queue.h"
 #include "vugl_uploadable_resource.h"
 
 #define CHECK_VK_RESULT(expr) \
@@ -44,6 +50,9 @@ class Context {
 
     using array_index_t = uint8_t;
 
+    static constexpr VkDeviceSize FRAME_ARENA_SIZE = 8 * 1024 * 1024;
+    static constexpr VkDeviceSize STAGING_RING_SIZE = 64 * 1024 * 1024;
+
   private:
     enum class DynStateUpdate {
       NONE, VIEWPORT, SCISSOR, BLENDING, LINE_WIDTH
@@ -57,15 +66,23 @@ class Context {
     VkInstance vkInstance;
     VkPhysicalDevice vkPhysicalDevice;
     VkPhysicalDeviceProperties vkPhysicalDeviceProperties;
+    VkPhysicalDeviceFeatures vkPhysicalDeviceFeatures;
+    VkPhysicalDeviceFeatures vkEnabledDeviceFeatures;
     VkDevice vkDevice;
     VmaAllocator allocator;
     ResourceAllocator resourceAllocator;
 
     uint32_t gfxQueueFamilyIndex;
     uint32_t presenterQueueFamilyIndex;
+    std::optional<uint32_t> transferQueueFamilyIndex;
     VkQueue vkGFXQueue;
     VkQueue vkPresenterQueue;
+    VkQueue vkTransferQueue;
     std::unique_ptr<Vugl::CommandPool> primaryCommandPool;
+    std::unique_ptr<Vugl::UploadQueue> uploadQueue;
+    std::unique_ptr<Vugl::FrameArena> frameArena;
+    std::unique_ptr<Vugl::DescriptorAllocator> descriptorAllocator;
+    DescriptorSetCache descriptorSetCache;
 
     VkSurfaceKHR vkSurface;
     VkSurfaceCapabilitiesKHR vkSurfaceCapabilities;
@@ -87,7 +104,6 @@ class Context {
     VkClearDepthStencilValue vkClearDepthStencilValue;
 
     uint32_t currentFrame;
-    std::mutex uploadMutex;
 
     void createSwapchainResources ();
 
@@ -99,13 +115,12 @@ class Context {
         VkPhysicalDevice vkPhysicalDevice
       , VkSurfaceKHR vkSurface
     ) const;
+    std::optional<uint32_t> findTransferQueueFamilyIndex (VkPhysicalDevice vkPhysicalDevice) const;
 
     VkPhysicalDevice pickSuitableVkPhysicalDevice (
         const std::vector<VkPhysicalDevice>& physicalDevices
       , const std::vector<const char*>& vkDeviceExtensionsList
     ) const;
-
-    bool submitToGPUQueue (VkCommandBuffer& buffer);
   public:
     Context ();
     Context (
@@ -125,6 +140,13 @@ class Context {
     CommandPool createCommandPool ();
     ComputePipeline createComputePipeline (const PipelineSetup&);
     ElementBuffer createElementBuffer (uint32_t binding);
+    ElementPool createElementPool (
+        uint32_t binding
+      , VkDeviceSize vertexCapacity
+      , VkDeviceSize indexCapacity
+      , bool bigIndex
+    );
+    IndirectBuffer createIndirectBuffer (uint32_t capacity);
     Pipeline createPipeline (const PipelineSetup&, VkRenderPass renderPass);
     RenderPass createRenderPass (const RenderPassSetup&);
     CombinedSampler createCombinedSampler ();
@@ -139,16 +161,25 @@ class Context {
     VkDevice getDevice () const;
     Error getError () const;
     VkExtent2D getExtent ()  const;
+    // reset for the image of getNextFrame
+    FrameArena& getFrameArena ();
     VkInstance getInstance () const;
     Frame& getNextFrame ();
     const std::vector<VkImage>& getSwapchainImages () const;
     const std::vector<VkImageView>& getSwapchainImageViews () const;
+    const VkPhysicalDeviceFeatures& getVkEnabledDeviceFeatures () const;
+    const VkPhysicalDeviceFeatures& getVkPhysicalDeviceFeatures () const;
     const VkPhysicalDeviceProperties& getVkPhysicalDeviceProperties () const;
     VkSampleCountFlagBits getVkSamplingFlag () const;
     VkViewport getViewport () const;
     const VkSurfaceFormatKHR& getVkSurfaceFormat () const;
 
     bool isDebuggingAllowed() const;
+    // optimal tiling, usable as a sampled texture
+    bool isFormatSampleable (VkFormat vkFormat) const;
+
+    // for sets of resources only, such as samplers and textures
+    std::shared_ptr<DescriptorSet> shareDescriptorSet (DescriptorSet&& descriptorSet);
 
     void setSurface (
         VkSurfaceKHR vkSurface
@@ -158,7 +189,11 @@ class Context {
       , void *deviceFeaturesNext
     );
 
+    // batched, visible to the next submitted frame
     bool uploadResource (UploadableResource& resource);
+    // submits what is batched and frees the staging memory of uploads
+    // done on the device, for loading without presenting frames
+    void flushUploads ();
     void waitForIdle ();
 };
 
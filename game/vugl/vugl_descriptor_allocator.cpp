@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <algorithm>
+
+#include "vugl_descriptor_allocator.h"
+
+namespace Vugl {
+
+// average descriptors per set a page is sized for
+static const std::vector<VkDescriptorPoolSize> PAGE_RATIOS {
+    {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1}
+  , {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1}
+  , {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1}
+  , {VK_DESCRIPTOR_TYPE_SAMPLER, 1}
+  , {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 2}
+  , {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1}
+};
+
+DescriptorAllocator::DescriptorAllocator (VkDevice vkDevice)
+  : vkDevice{vkDevice}
+{}
+
+DescriptorAllocator::~DescriptorAllocator () {
+  destroy();
+}
+
+VkResult DescriptorAllocator::allocate (
+    VkDescriptorSetLayout vkDescriptorSetLayout
+  , const std::vector<VkDescriptorPoolSize>& setSizes
+  , std::vector<VkDescriptorSet>& sets
+) {
+  std::lock_guard lock {mutex};
+
+  uint32_t numReused = 0;
+  auto lookup = freeSets.find(vkDescriptorSetLayout);
+  if (lookup != freeSets.end()) {
+    auto& available = lookup->second;
+    numReused = std::min(available.size(), sets.size());
+
+    std::copy(available.end() - numReused, available.end(), sets.begin());
+    available.resize(available.size() - numReused);
+  }
+
+  uint32_t numMissing = sets.size() - numReused;
+  if (numMissing == 0) {
+    return VK_SUCCESS;
+  }
+
+  auto result = VK_ERROR_OUT_OF_POOL_MEMORY;
+  if (!pages.empty()) {
+    result = allocateFromPage(vkDescriptorSetLayout, sets.data() + numReused, numMissing);
+  }
+
+  if (VK_ERROR_OUT_OF_POOL_MEMORY == result || VK_ERROR_FRAGMENTED_POOL == result) {
+    result = createPage(setSizes, numMissing);
+    if (VK_SUCCESS == result) {
+      result = allocateFromPage(vkDescriptorSetLayout, sets.data() + numReused, numMissing);
+    }
+  }
+
+  if (VK_SUCCESS != result) {
+    freeSets[vkDescriptorSetLayout].insert(
+        freeSets[vkDescriptorSetLayout].end()
+      , sets.begin()
+      , sets.begin() + numReused
+    );
+    sets.clear();
+  }
+
+  return result;
+}
+
+void DescriptorAllocator::destroy () {
+  std::lock_guard lock {mutex};
+
+  for (auto page : pages) {
+    vkDestroyDescriptorPool(vkDevice, page, nullptr);
+  }
+
+  pages.clear();
+  freeSets.clear();
+}
+
+void DescriptorAllocator::free (
+    VkDescriptorSetLayout vkDescriptorSetLayout
+  , std::vector<VkDescriptorSet>& sets
+) {
+  std::lock_guard lock {mutex};
+
+  auto& available = freeSets[vkDescriptorSetLayout];
+  available.insert(available.end(), sets.begin(), sets.end());
+
+  sets.clear();
+}
+
+VkResult DescriptorAllocator::allocateFromPage (
+    VkDescriptorSetLayout vkDescriptorSetLayout
+  , VkDescriptorSet* sets
+  , uint32_t numSets
+) {
+  std::vector<VkDescriptorSetLayout> vkDescSetLayouts {numSets, vkDescriptorSetLayout};
+
+  VkDescriptorSetAllocateInfo vkDescSetAllocInfo = {};
+  vkDescSetAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+  vkDescSetAllocInfo.descriptorPool = pages.back();
+  vkDescSetAllocInfo.descriptorSetCount = numSets;
+  vkDescSetAllocInfo.pSetLayouts = vkDescSetLayouts.data();
+
+  return vkAllocateDescriptorSets(vkDevice, &vkDescSetAllocInfo, sets);
+}
+
+VkResult DescriptorAllocator::createPage (
+    const std::vector<VkDescriptorPoolSize>& setSizes
+  , uint32_t numSets
+) {
+  auto poolSizes = PAGE_RATIOS;
+  for (auto& poolSize : poolSizes) {
+    poolSize.descriptorCount *= SETS_PER_PAGE;
+  }
+
+  // oversized sets still need to fit into a fresh page
+  for (auto& setSize : setSizes) {
+    auto lookup =
+      std::find_if(poolSizes.begin(), poolSizes.end(), [&setSize](auto& poolSize) {
+        return poolSize.type == setSize.type;
+      });
+
+    if (lookup == poolSizes.end()) {
+      poolSizes.push_back({setSize.type, setSize.descriptorCount * numSets});
+    } else {
+      lookup->descriptorCount = std::max(lookup->descriptorCount, setSize.descriptorCount * numSets);
+    }
+  }
+
+  VkDescriptorPoolCreateInfo vkDescPoolCreateInfo = {};
+  vkDescPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+  vkDescPoolCreateInfo.poolSizeCount = poolSizes.size();
+  vkDescPoolCreateInfo.pPoolSizes = poolSizes.data();
+  vkDescPoolCreateInfo.maxSets = std::max(SETS_PER_PAGE, numSets);
+
+  VkDescriptorPool vkDescriptorPool = VK_NULL_HANDLE;
+  auto result = vkCreateDescriptorPool(vkDevice, &vkDescPoolCreateInfo, nullptr, &vkDescriptorPool);
+  if (VK_SUCCESS != result) {
+    return result;
+  }
+
+  pages.push_back(vkDescriptorPool);
+
+  return VK_SUCCESS;
+}
+
+}
@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_VUGL_DESCRIPTOR_ALLOCATOR
+#define H_VUGL_DESCRIPTOR_ALLOCATOR
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace Vugl {
+
+// Hands out descriptor sets from shared pool pages, adding a page
+// once the last one is exhausted. Released sets are kept per layout
+// and reused as they are, pools are never reset.
+class DescriptorAllocator {
+  public:
+    static constexpr uint32_t SETS_PER_PAGE = 256;
+
+    DescriptorAllocator (VkDevice vkDevice);
+    ~DescriptorAllocator ();
+
+    DescriptorAllocator (const DescriptorAllocator&) = delete;
+    DescriptorAllocator (DescriptorAllocator &&) = delete;
+    DescriptorAllocator& operator= (const DescriptorAllocator&) = delete;
+    DescriptorAllocator& operator= (DescriptorAllocator&&) = delete;
+
+    // fills all of sets, setSizes being the descriptors of one set
+    VkResult allocate (
+        VkDescriptorSetLayout vkDescriptorSetLayout
+      , const std::vector<VkDescriptorPoolSize>& setSizes
+      , std::vector<VkDescriptorSet>& sets
+    );
+    void destroy ();
+    void free (VkDescriptorSetLayout vkDescriptorSetLayout, std::vector<VkDescriptorSet>& sets);
+
+  private:
+    VkDevice vkDevice;
+    std::vector<VkDescriptorPool> pages;
+    std::unordered_map<VkDescriptorSetLayout, std::vector<VkDescriptorSet>> freeSets;
+    std::mutex mutex;
+
+    VkResult allocateFromPage (
+        VkDescriptorSetLayout vkDescriptorSetLayout
+      , VkDescriptorSet* sets
+      , uint32_t numSets
+    );
+    VkResult createPage (const std::vector<VkDescriptorPoolSize>& setSizes, uint32_t numSets);
+};
+
+}
+
+#endif
@@ -8,17 +8,19 @@ namespace Vugl {
 
 DescriptorSet::DescriptorSet (
     VkDevice vkDevice
+  , DescriptorAllocator& descriptorAllocator
   , VkPipelineLayout vkPipelineLayout
   , VkDescriptorSetLayout vkDescriptorSetLayout
   , uint32_t numSwapchainImages
 ) : vkDevice{vkDevice}
+  , descriptorAllocator{descriptorAllocator}
   , vkPipelineLayout{vkPipelineLayout}
   , vkDescriptorSetLayout{vkDescriptorSetLayout}
   , numSwapchainImages{numSwapchainImages}
   , vkPipelineBindPoint{VK_PIPELINE_BIND_POINT_GRAPHICS}
   , vkLastResult{VK_SUCCESS}
-  , vkDescriptorPool{VK_NULL_HANDLE}
   , vkDescriptorSets{}
+  , assignedArenas{}
   , assignedCombinedSamplers{}
   , assignedSamplers{}
   , assignedStorageImages{}
@@ -31,21 +33,23 @@ DescriptorSet::DescriptorSet (
 
 DescriptorSet::DescriptorSet (DescriptorSet && other)
   : vkDevice{other.vkDevice}
+  , descriptorAllocator{other.descriptorAllocator}
   , vkPipelineLayout{other.vkPipelineLayout}
   , vkDescriptorSetLayout{other.vkDescriptorSetLayout}
   , numSwapchainImages{other.numSwapchainImages}
   , vkPipelineBindPoint{other.vkPipelineBindPoint}
   , vkLastResult{other.vkLastResult}
-  , vkDescriptorPool{other.vkDescriptorPool}
   , vkDescriptorSets{std::move(other.vkDescriptorSets)}
+  , assignedArenas{std::move(other.assignedArenas)}
   , assignedCombinedSamplers{std::move(other.assignedCombinedSamplers)}
   , assignedSamplers{std::move(other.assignedSamplers)}
   , assignedStorageImages{std::move(other.assignedStorageImages)}
   , assignedTextures{std::move(other.assignedTextures)}
   , assignedUniformBuffers{std::move(other.assignedUniformBuffers)}
   , bindings{std::move(other.bindings)}
+  , textureGrouping{std::move(other.textureGrouping)}
 {
-  other.vkDescriptorPool = VK_NULL_HANDLE;
+  other.vkDescriptorSets.clear();
 }
 
 DescriptorSet::~DescriptorSet () {
@@ -53,13 +57,11 @@ DescriptorSet::~DescriptorSet () {
 }
 
 void DescriptorSet::destroy () {
-  if (VK_NULL_HANDLE != vkDescriptorPool) {
-    vkResetDescriptorPool(vkDevice, vkDescriptorPool, 0);
+  if (!vkDescriptorSets.empty()) {
+    descriptorAllocator.free(vkDescriptorSetLayout, vkDescriptorSets);
   }
 
-  vkDestroyDescriptorPool(vkDevice, vkDescriptorPool, nullptr);
-  this->vkDescriptorPool = VK_NULL_HANDLE;
-
+  assignedArenas.clear();
   assignedCombinedSamplers.clear();
   bindings.resize(0);
 }
@@ -69,6 +71,11 @@ void DescriptorSet::assignCombinedSampler (const CombinedSampler& sampler) {
   bindings.emplace_back(DescriptorType::COMBINED_SAMPLER, assignedCombinedSamplers.size() - 1);
 }
 
+void DescriptorSet::assignFrameArena (const FrameArena& arena, VkDeviceSize range) {
+  assignedArenas.emplace_back(std::cref(arena), range);
+  bindings.emplace_back(DescriptorType::ARENA_UBO, assignedArenas.size() - 1);
+}
+
 void DescriptorSet::assignSampler (const Sampler& sampler) {
   assignedSamplers.emplace_back(std::cref(sampler));
   bindings.emplace_back(DescriptorType::SAMPLER, assignedSamplers.size() - 1);
@@ -103,6 +110,37 @@ void DescriptorSet::assignUniformBuffer (const UniformBuffer& uniformBuffer, boo
   }
 }
 
+std::vector<uintptr_t> DescriptorSet::getIdentity () const {
+  std::vector<uintptr_t> identity;
+
+  for (auto& binding : bindings) {
+    identity.push_back(static_cast<uintptr_t>(std::get<0>(binding)));
+    identity.push_back(std::get<1>(binding));
+  }
+
+  for (auto& arena : assignedArenas) {
+    identity.push_back(reinterpret_cast<uintptr_t>(&arena.first.get()));
+    identity.push_back(arena.second);
+  }
+  for (auto& sampler : assignedCombinedSamplers) {
+    identity.push_back(reinterpret_cast<uintptr_t>(&sampler.get()));
+  }
+  for (auto& sampler : assignedSamplers) {
+    identity.push_back(reinterpret_cast<uintptr_t>(&sampler.get()));
+  }
+  for (auto& image : assignedStorageImages) {
+    identity.push_back(reinterpret_cast<uintptr_t>(&image.get()));
+  }
+  for (auto& texture : assignedTextures) {
+    identity.push_back(reinterpret_cast<uintptr_t>(&texture.get()));
+  }
+  for (auto& uniformBuffer : assignedUniformBuffers) {
+    identity.push_back(reinterpret_cast<uintptr_t>(&uniformBuffer.get()));
+  }
+
+  return identity;
+}
+
 VkResult DescriptorSet::getLastResult () const {
   return vkLastResult;
 }
@@ -111,7 +149,19 @@ VkDescriptorSet DescriptorSet::getVkDescriptorSet (size_t index) const {
   return vkDescriptorSets[index];
 }
 
+VkDescriptorSetLayout DescriptorSet::getVkDescriptorSetLayout () const {
+  return vkDescriptorSetLayout;
+}
+
 VkResult DescriptorSet::recordBindCommands (VkCommandBuffer vkCommandBuffer, uint32_t i) {
+  return recordBindCommands(vkCommandBuffer, i, std::span<const uint32_t> {});
+}
+
+VkResult DescriptorSet::recordBindCommands (
+    VkCommandBuffer vkCommandBuffer
+  , uint32_t i
+  , std::span<const uint32_t> dynamicOffsets
+) {
   vkCmdBindDescriptorSets(
       vkCommandBuffer
     , vkPipelineBindPoint
@@ -119,8 +169,8 @@ VkResult DescriptorSet::recordBindCommands (VkCommandBuffer vkCommandBuffer, uin
     , 0
     , 1
     , &vkDescriptorSets[i]
-    , 0
-    , nullptr
+    , dynamicOffsets.size()
+    , dynamicOffsets.data()
   );
 
   return VK_SUCCESS;
@@ -139,88 +189,44 @@ void DescriptorSet::updateDevice () {
       numUBOs += assignedUniformBuffers[std::get<1>(binding)].get().getNumOfDescriptors();
     } else if (std::get<0>(binding) == DescriptorType::DYNAMIC_UBO) {
       numDynamicUBOs += assignedUniformBuffers[std::get<1>(binding)].get().getNumOfDescriptors();
+    } else if (std::get<0>(binding) == DescriptorType::ARENA_UBO) {
+      numDynamicUBOs += 1;
     }
   }
 
-  if (VK_NULL_HANDLE == vkDescriptorPool) {
-    std::vector<VkDescriptorPoolSize> poolSizes{};
+  if (vkDescriptorSets.empty()) {
+    std::vector<VkDescriptorPoolSize> setSizes{};
 
     if (assignedCombinedSamplers.size() > 0) {
-      poolSizes.resize(poolSizes.size() + 1);
-      auto& vkSamplerDescPoolSize = poolSizes[poolSizes.size() - 1];
-      vkSamplerDescPoolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-      vkSamplerDescPoolSize.descriptorCount = numSwapchainImages * (assignedCombinedSamplers.size());
+      setSizes.push_back({VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<uint32_t>(assignedCombinedSamplers.size())});
     }
 
     if (numUBOs > 0) {
-      poolSizes.resize(poolSizes.size() + 1);
-      auto& vkDescPoolSize = poolSizes[poolSizes.size() - 1];
-      vkDescPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-      vkDescPoolSize.descriptorCount = numSwapchainImages * numUBOs;
+      setSizes.push_back({VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, numUBOs});
     }
 
     if (numDynamicUBOs > 0) {
-      poolSizes.resize(poolSizes.size() + 1);
-      auto& vkDescPoolSize = poolSizes[poolSizes.size() - 1];
-      vkDescPoolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
-      vkDescPoolSize.descriptorCount = numSwapchainImages * numDynamicUBOs;
+      setSizes.push_back({VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, numDynamicUBOs});
     }
 
     if (assignedSamplers.size() > 0) {
-      poolSizes.resize(poolSizes.size() + 1);
-      auto& vkSamplerDescPoolSize = poolSizes[poolSizes.size() - 1];
-      vkSamplerDescPoolSize.type = VK_DESCRIPTOR_TYPE_SAMPLER;
-      vkSamplerDescPoolSize.descriptorCount = numSwapchainImages * (assignedSamplers.size());
+      setSizes.push_back({VK_DESCRIPTOR_TYPE_SAMPLER, static_cast<uint32_t>(assignedSamplers.size())});
     }
 
     if (assignedTextures.size() > 0) {
-      poolSizes.resize(poolSizes.size() + 1);
-      auto& vkDescPoolSize = poolSizes[poolSizes.size() - 1];
-      vkDescPoolSize.type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
-      vkDescPoolSize.descriptorCount = numSwapchainImages * assignedTextures.size();
+      setSizes.push_back({VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, static_cast<uint32_t>(assignedTextures.size())});
     }
 
     if (assignedStorageImages.size() > 0) {
-      poolSizes.resize(poolSizes.size() + 1);
-      auto& vkDescPoolSize = poolSizes[poolSizes.size() - 1];
-      vkDescPoolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-      vkDescPoolSize.descriptorCount = numSwapchainImages * assignedStorageImages.size();
-    }
-
-    VkDescriptorPoolCreateInfo vkDescPoolCreateInfo = {};
-    vkDescPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    vkDescPoolCreateInfo.poolSizeCount = poolSizes.size();
-    vkDescPoolCreateInfo.pPoolSizes = poolSizes.data();
-    vkDescPoolCreateInfo.maxSets = numSwapchainImages;
-
-    this->vkLastResult =
-      vkCreateDescriptorPool(
-          vkDevice
-        , &vkDescPoolCreateInfo
-        , nullptr
-        , &(this->vkDescriptorPool)
-      );
-    if (VK_SUCCESS != vkLastResult) {
-      return;
+      setSizes.push_back({VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, static_cast<uint32_t>(assignedStorageImages.size())});
     }
 
-    std::vector<VkDescriptorSetLayout> vkDescSetLayouts {
-        numSwapchainImages
-      , vkDescriptorSetLayout
-    };
-
-    VkDescriptorSetAllocateInfo vkDescSetAllocInfo = {};
-    vkDescSetAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    vkDescSetAllocInfo.descriptorPool = vkDescriptorPool;
-    vkDescSetAllocInfo.descriptorSetCount = numSwapchainImages;
-    vkDescSetAllocInfo.pSetLayouts = vkDescSetLayouts.data();
-
     vkDescriptorSets.resize(numSwapchainImages);
     this->vkLastResult =
-      vkAllocateDescriptorSets(
-          vkDevice
-        , &vkDescSetAllocInfo
-        , vkDescriptorSets.data()
+      descriptorAllocator.allocate(
+          vkDescriptorSetLayout
+        , setSizes
+        , vkDescriptorSets
       );
     if (VK_SUCCESS != vkLastResult) {
       return;
@@ -359,6 +365,24 @@ void DescriptorSet::updateDevice () {
         vkDescriptor.pImageInfo = VK_NULL_HANDLE;
 
         iBuffers += uniformBuffer.getNumOfDescriptors();
+      } else if (std::get<0>(binding) == DescriptorType::ARENA_UBO) {
+        auto& assignedArena = assignedArenas[std::get<1>(binding)];
+
+        auto& vkDescBufferInfo = bufferDescriptors[iBuffers];
+        vkDescBufferInfo.buffer = assignedArena.first.get().getBuffers()[i];
+        vkDescBufferInfo.offset = 0;
+        vkDescBufferInfo.range = assignedArena.second;
+
+        vkDescriptor.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        vkDescriptor.dstSet = vkDescriptorSets[i];
+        vkDescriptor.dstBinding = j;
+        vkDescriptor.dstArrayElement = 0;
+        vkDescriptor.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        vkDescriptor.descriptorCount = 1;
+        vkDescriptor.pBufferInfo = &vkDescBufferInfo;
+        vkDescriptor.pImageInfo = VK_NULL_HANDLE;
+
+        iBuffers += 1;
       }
 
       j += 1;
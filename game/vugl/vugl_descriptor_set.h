@@ -3,8 +3,10 @@
 #ifndef H_VUGL_DESCRIPTOR_SET
 #define H_VUGL_DESCRIPTOR_SET
 
+#include <cstdint>
 #include <optional>
 #include <set>
+#include <span>
 #include <tuple>
 #include <unordered_map>
 #include <vector>
@@ -13,6 +15,8 @@
 
 #include "vugl_bindable_resource.h"
 #include "vugl_combined_sampler.h"
+#include "vugl_descriptor_allocator.h"
+#include "vugl_frame_arena.h"
 #include "vugl_texture.h"
 #include "vugl_uniform_buffer.h"
 
@@ -27,20 +31,22 @@ class DescriptorSet : public BindableResource {
       , STORAGE_IMAGE
       , UBO
       , DYNAMIC_UBO
+      , ARENA_UBO
       , NULL_SAMPLER
     };
     using BindingInfo = std::tuple<DescriptorType, size_t>;
 
     VkDevice vkDevice;
+    DescriptorAllocator& descriptorAllocator;
     VkDescriptorSetLayout vkDescriptorSetLayout;
     VkPipelineLayout vkPipelineLayout;
     uint32_t numSwapchainImages;
     VkPipelineBindPoint vkPipelineBindPoint;
     VkResult vkLastResult;
 
-    VkDescriptorPool vkDescriptorPool;
     std::vector<VkDescriptorSet> vkDescriptorSets;
 
+    std::vector<std::pair<std::reference_wrapper<const FrameArena>, VkDeviceSize>> assignedArenas;
     std::vector<std::reference_wrapper<const CombinedSampler>> assignedCombinedSamplers;
     std::vector<std::reference_wrapper<const Sampler>> assignedSamplers;
     std::vector<std::reference_wrapper<const Texture>> assignedStorageImages;
@@ -57,6 +63,7 @@ class DescriptorSet : public BindableResource {
     DescriptorSet (DescriptorSet &&);
     DescriptorSet (
         VkDevice vkDevice
+      , DescriptorAllocator& descriptorAllocator
       , VkPipelineLayout vkPipelineLayout
       , VkDescriptorSetLayout vkDescriptorSetLayout
       , uint32_t numSwapchainImages
@@ -64,15 +71,25 @@ class DescriptorSet : public BindableResource {
     ~DescriptorSet ();
 
     void assignCombinedSampler (const CombinedSampler&);
+    // dynamic UBO of range bytes, offset given when binding
+    void assignFrameArena (const FrameArena&, VkDeviceSize range);
     void assignSampler (const Sampler&);
     void assignStorageImage (const Texture&);
     void assignTexture (const Texture&, std::optional<uint32_t> binding = {});
     void assignUniformBuffer (const UniformBuffer&, bool dynamic = false);
 
     void destroy ();
+    // assigned resources by address, equal for sets of equal contents
+    std::vector<uintptr_t> getIdentity () const;
     VkResult getLastResult () const;
     VkDescriptorSet getVkDescriptorSet (size_t index) const;
+    VkDescriptorSetLayout getVkDescriptorSetLayout () const;
     VkResult recordBindCommands (VkCommandBuffer vkCommandBuffer, uint32_t i) override;
+    VkResult recordBindCommands (
+        VkCommandBuffer vkCommandBuffer
+      , uint32_t i
+      , std::span<const uint32_t> dynamicOffsets
+    );
     void setPipelineBindPoint (VkPipelineBindPoint bindPoint);
     void updateDevice ();
 };
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include "vugl_descriptor_set_cache.h"
+
+namespace Vugl {
+
+void DescriptorSetCache::clear () {
+  std::lock_guard lock {mutex};
+
+  sets.clear();
+  this->numInsertsSincePrune = 0;
+}
+
+std::shared_ptr<DescriptorSet> DescriptorSetCache::share (DescriptorSet&& descriptorSet) {
+  std::lock_guard lock {mutex};
+
+  Key key {descriptorSet.getVkDescriptorSetLayout(), descriptorSet.getIdentity()};
+
+  auto lookup = sets.find(key);
+  if (lookup != sets.end()) {
+    auto shared = lookup->second.lock();
+    if (shared) {
+      return shared;
+    }
+  }
+
+  auto shared = std::make_shared<DescriptorSet>(std::move(descriptorSet));
+  shared->updateDevice();
+  if (VK_SUCCESS != shared->getLastResult()) {
+    return shared;
+  }
+
+  sets.insert_or_assign(std::move(key), shared);
+
+  this->numInsertsSincePrune += 1;
+  if (numInsertsSincePrune >= sets.size() / 2) {
+    prune();
+  }
+
+  return shared;
+}
+
+void DescriptorSetCache::prune () {
+  std::erase_if(sets, [](auto& pair) {
+    return pair.second.expired();
+  });
+
+  this->numInsertsSincePrune = 0;
+}
+
+}
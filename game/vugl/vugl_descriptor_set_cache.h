@@ -0,0 +1,46 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_VUGL_DESCRIPTOR_SET_CACHE
+#define H_VUGL_DESCRIPTOR_SET_CACHE
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vugl_descriptor_set.h"
+
+namespace Vugl {
+
+// Shares sets by layout and assigned resources as long as anyone
+// holds on to them, for sets not rewritten after updateDevice.
+class DescriptorSetCache {
+  public:
+    DescriptorSetCache () = default;
+
+    DescriptorSetCache (const DescriptorSetCache&) = delete;
+    DescriptorSetCache (DescriptorSetCache &&) = delete;
+    DescriptorSetCache& operator= (const DescriptorSetCache&) = delete;
+    DescriptorSetCache& operator= (DescriptorSetCache&&) = delete;
+
+    void clear ();
+    // an equal set in use, otherwise descriptorSet after updateDevice
+    std::shared_ptr<DescriptorSet> share (DescriptorSet&& descriptorSet);
+
+  private:
+    using Key = std::pair<VkDescriptorSetLayout, std::vector<uintptr_t>>;
+
+    std::map<Key, std::weak_ptr<DescriptorSet>> sets;
+    size_t numInsertsSincePrune = 0;
+    std::mutex mutex;
+
+    void prune ();
+};
+
+}
+
+#endif
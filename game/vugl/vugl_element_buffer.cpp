@@ -13,11 +13,11 @@ ElementBuffer::ElementBuffer (
   , numVertices{0}
   , numIndices{0}
   , vkLastResult{VK_SUCCESS}
-  , vkStagingBuffer{VK_NULL_HANDLE}
+  , staging{}
   , vkBuffer{VK_NULL_HANDLE}
-  , vkStagingVBSize{0}
-  , vkStagingIBSize{0}
-  , vmaStagingAllocation{VK_NULL_HANDLE}
+  , vkBufferSize{0}
+  , vkVBSize{0}
+  , vkIBSize{0}
   , vmaAllocation{VK_NULL_HANDLE}
 {}
 
@@ -28,16 +28,15 @@ ElementBuffer::ElementBuffer (ElementBuffer && other)
   , numVertices{other.numVertices}
   , numIndices{other.numIndices}
   , vkLastResult{other.vkLastResult}
-  , vkStagingBuffer{other.vkStagingBuffer}
+  , staging{other.staging}
   , vkBuffer{other.vkBuffer}
-  , vkStagingVBSize{other.vkStagingVBSize}
-  , vkStagingIBSize{other.vkStagingIBSize}
-  , vmaStagingAllocation{other.vmaStagingAllocation}
+  , vkBufferSize{other.vkBufferSize}
+  , vkVBSize{other.vkVBSize}
+  , vkIBSize{other.vkIBSize}
   , vmaAllocation{other.vmaAllocation}
 {
-  other.vkStagingBuffer = VK_NULL_HANDLE;
+  other.staging = StagingAllocation {};
   other.vkBuffer = VK_NULL_HANDLE;
-  other.vmaStagingAllocation = VK_NULL_HANDLE;
   other.vmaAllocation = VK_NULL_HANDLE;
 }
 
@@ -51,17 +50,14 @@ void ElementBuffer::destroy () {
 }
 
 void ElementBuffer::deleteGPUData () {
-  resourceAllocator.destroyVkBuffer(vkBuffer, vmaAllocation);
+  resourceAllocator.retireVkBuffer(vkBuffer, vmaAllocation);
   this->vkBuffer = VK_NULL_HANDLE;
+  this->vkBufferSize = 0;
   this->vmaAllocation = VK_NULL_HANDLE;
 }
 
 void ElementBuffer::deleteHostData () {
-  resourceAllocator.destroyVkBuffer(vkStagingBuffer, vmaStagingAllocation);
-  this->vkStagingBuffer = VK_NULL_HANDLE;
-  this->vmaStagingAllocation = VK_NULL_HANDLE;
-  this->vkStagingVBSize = 0;
-  this->vkStagingIBSize = 0;
+  resourceAllocator.releaseStaging(staging);
 }
 
 VkResult ElementBuffer::getLastResult () const {
@@ -80,11 +76,11 @@ VkResult ElementBuffer::recordBindCommands (VkCommandBuffer vkCommandBuffer, uin
   VkDeviceSize offset = 0;
   vkCmdBindVertexBuffers(vkCommandBuffer, binding, 1, &vkBuffer, &offset);
 
-  if (vkStagingIBSize > 0) {
+  if (vkIBSize > 0) {
     vkCmdBindIndexBuffer(
         vkCommandBuffer
       , vkBuffer
-      , vkStagingVBSize
+      , vkVBSize
       , bigIndex ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16
     );
   }
@@ -92,11 +88,30 @@ VkResult ElementBuffer::recordBindCommands (VkCommandBuffer vkCommandBuffer, uin
   return VK_SUCCESS;
 }
 
-VkResult ElementBuffer::recordUploadCommands (VkCommandBuffer vkCommandBuffer) {
+VkResult ElementBuffer::recordUploadCommands (
+    VkCommandBuffer vkCommandBuffer
+  , VkPipelineStageFlags /*vkDstStageFlags*/
+) {
+  // resident already
+  if (VK_NULL_HANDLE == staging.vkBuffer) {
+    return VK_SUCCESS;
+  }
+
+  auto vkDataSize = vkVBSize + vkIBSize;
+  if (vkDataSize == 0) {
+    return VK_SUCCESS;
+  }
+
+  // retired, as it may still be bound in recorded frames or be
+  // the target of earlier copies, it lives until this batch is done
+  if (VK_NULL_HANDLE != vkBuffer && vkBufferSize < vkDataSize) {
+    deleteGPUData();
+  }
+
   if (VK_NULL_HANDLE == vkBuffer) {
     this->vkLastResult =
       resourceAllocator.createVkBuffer(
-          vkStagingVBSize + vkStagingIBSize
+          vkDataSize
         , BufferType::VERTEX_BUFFER
         , vkBuffer
         , vmaAllocation
@@ -105,14 +120,15 @@ VkResult ElementBuffer::recordUploadCommands (VkCommandBuffer vkCommandBuffer) {
     if (VK_SUCCESS != vkLastResult) {
       return vkLastResult;
     }
+    this->vkBufferSize = vkDataSize;
   }
 
   VkBufferCopy vkBufferCopy = {};
-  vkBufferCopy.srcOffset = 0;
+  vkBufferCopy.srcOffset = staging.offset;
   vkBufferCopy.dstOffset = 0;
-  vkBufferCopy.size = vkStagingVBSize + vkStagingIBSize;
+  vkBufferCopy.size = vkDataSize;
 
-  vkCmdCopyBuffer(vkCommandBuffer, vkStagingBuffer, vkBuffer, 1, &vkBufferCopy);
+  vkCmdCopyBuffer(vkCommandBuffer, staging.vkBuffer, vkBuffer, 1, &vkBufferCopy);
 
   return VK_SUCCESS;
 }
@@ -121,4 +137,11 @@ void ElementBuffer::setBigIndexBuffer (bool big) {
   bigIndex = big;
 }
 
+StagingAllocation ElementBuffer::takeStagingAllocation () {
+  auto taken = staging;
+  this->staging = StagingAllocation {};
+
+  return taken;
+}
+
 };
@@ -25,11 +25,11 @@ class ElementBuffer
     size_t numVertices;
     size_t numIndices;
 
-    VkBuffer vkStagingBuffer;
+    StagingAllocation staging;
     VkBuffer vkBuffer;
-    VkDeviceSize vkStagingVBSize;
-    VkDeviceSize vkStagingIBSize;
-    VmaAllocation vmaStagingAllocation;
+    VkDeviceSize vkBufferSize;
+    VkDeviceSize vkVBSize;
+    VkDeviceSize vkIBSize;
     VmaAllocation vmaAllocation;
 
   public:
@@ -50,7 +50,11 @@ class ElementBuffer
     size_t getNumVertices () const;
 
     VkResult recordBindCommands (VkCommandBuffer vkCommandBuffer, uint32_t i) override;
-    VkResult recordUploadCommands (VkCommandBuffer vkCommandBuffer) override;
+    VkResult recordUploadCommands (
+        VkCommandBuffer vkCommandBuffer
+      , VkPipelineStageFlags vkDstStageFlags
+    ) override;
+    StagingAllocation takeStagingAllocation () override;
 
     void setBigIndexBuffer(bool);
 
@@ -58,24 +62,17 @@ class ElementBuffer
     void writeData (const std::vector<T>& vertexData, const std::vector<U>& indexData) {
       this->numVertices = vertexData.size();
       this->numIndices = indexData.size();
-      this->vkStagingVBSize = sizeof(T) * vertexData.size();
-      this->vkStagingIBSize = sizeof(U) * indexData.size();
-
-      if (VK_NULL_HANDLE == vkStagingBuffer) {
-        this->vkLastResult =
-          resourceAllocator.createVkBuffer(
-              vkStagingVBSize + vkStagingIBSize
-            , BufferType::VERTEX_BUFFER_FOR_UPLOAD
-            , vkStagingBuffer
-            , vmaStagingAllocation
-          );
-      }
+      this->vkVBSize = sizeof(T) * vertexData.size();
+      this->vkIBSize = sizeof(U) * indexData.size();
+
+      resourceAllocator.releaseStaging(staging);
+      this->vkLastResult = resourceAllocator.allocateStaging(vkVBSize + vkIBSize, staging);
 
       if (VK_SUCCESS != vkLastResult) {
         return;
       }
 
-      void *mappedData = resourceAllocator.mapMemory(vmaStagingAllocation);
+      void *mappedData = staging.mappedData;
       std::uninitialized_copy(vertexData.cbegin(), vertexData.cend(), static_cast<T*>(mappedData));
       std::uninitialized_copy(
           indexData.cbegin()
@@ -83,7 +80,7 @@ class ElementBuffer
         , reinterpret_cast<U*>(static_cast<T*>(mappedData) + vertexData.size())
       );
 
-      resourceAllocator.unmapMemory(vmaStagingAllocation);
+      resourceAllocator.flushStaging(staging);
     }
 };
 
@@ -0,0 +1,187 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <cstring>
+
+#include "vugl_element_pool.h"
+
+namespace Vugl {
+
+ElementPool::ElementPool (
+    ResourceAllocator& allocator
+  , uint32_t binding
+  , VkDeviceSize vertexCapacity
+  , VkDeviceSize indexCapacity
+  , bool bigIndex
+) : vkLastResult{VK_SUCCESS}
+  , resourceAllocator{allocator}
+  , binding{binding}
+  , bigIndex{bigIndex}
+  , staging{}
+  , vkBuffer{VK_NULL_HANDLE}
+  , vkVBCapacity{vertexCapacity}
+  , vkIBCapacity{indexCapacity}
+  , vmaAllocation{VK_NULL_HANDLE}
+  , vkVBOffset{0}
+  , vkVBSize{0}
+  , vkIBOffset{0}
+  , vkIBSize{0}
+{}
+
+ElementPool::ElementPool (ElementPool && other)
+  : vkLastResult{other.vkLastResult}
+  , resourceAllocator{other.resourceAllocator}
+  , binding{other.binding}
+  , bigIndex{other.bigIndex}
+  , staging{other.staging}
+  , vkBuffer{other.vkBuffer}
+  , vkVBCapacity{other.vkVBCapacity}
+  , vkIBCapacity{other.vkIBCapacity}
+  , vmaAllocation{other.vmaAllocation}
+  , vkVBOffset{other.vkVBOffset}
+  , vkVBSize{other.vkVBSize}
+  , vkIBOffset{other.vkIBOffset}
+  , vkIBSize{other.vkIBSize}
+{
+  other.staging = StagingAllocation {};
+  other.vkBuffer = VK_NULL_HANDLE;
+  other.vmaAllocation = VK_NULL_HANDLE;
+}
+
+ElementPool::~ElementPool () {
+  destroy();
+}
+
+void ElementPool::destroy () {
+  deleteHostData();
+  deleteGPUData();
+}
+
+void ElementPool::deleteGPUData () {
+  resourceAllocator.retireVkBuffer(vkBuffer, vmaAllocation);
+  this->vkBuffer = VK_NULL_HANDLE;
+  this->vmaAllocation = VK_NULL_HANDLE;
+}
+
+void ElementPool::deleteHostData () {
+  resourceAllocator.releaseStaging(staging);
+}
+
+VkResult ElementPool::getLastResult () const {
+  return vkLastResult;
+}
+
+VkDeviceSize ElementPool::getIndexCapacity () const {
+  return vkIBCapacity;
+}
+
+VkDeviceSize ElementPool::getVertexCapacity () const {
+  return vkVBCapacity;
+}
+
+bool ElementPool::isBigIndex () const {
+  return bigIndex;
+}
+
+VkResult ElementPool::recordBindCommands (VkCommandBuffer vkCommandBuffer, uint32_t /*i*/) {
+  VkDeviceSize offset = 0;
+  vkCmdBindVertexBuffers(vkCommandBuffer, binding, 1, &vkBuffer, &offset);
+  vkCmdBindIndexBuffer(
+      vkCommandBuffer
+    , vkBuffer
+    , vkVBCapacity
+    , bigIndex ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16
+  );
+
+  return VK_SUCCESS;
+}
+
+VkResult ElementPool::recordUploadCommands (
+    VkCommandBuffer vkCommandBuffer
+  , VkPipelineStageFlags /*vkDstStageFlags*/
+) {
+  // nothing written since the last upload
+  if (VK_NULL_HANDLE == staging.vkBuffer) {
+    return VK_SUCCESS;
+  }
+
+  if (VK_NULL_HANDLE == vkBuffer) {
+    this->vkLastResult =
+      resourceAllocator.createVkBuffer(
+          vkVBCapacity + vkIBCapacity
+        , BufferType::VERTEX_BUFFER
+        , vkBuffer
+        , vmaAllocation
+      );
+
+    if (VK_SUCCESS != vkLastResult) {
+      return vkLastResult;
+    }
+  }
+
+  VkBufferCopy vkBufferCopies[2] = {};
+  uint32_t numCopies = 0;
+
+  if (vkVBSize > 0) {
+    vkBufferCopies[numCopies].srcOffset = staging.offset;
+    vkBufferCopies[numCopies].dstOffset = vkVBOffset;
+    vkBufferCopies[numCopies].size = vkVBSize;
+    numCopies += 1;
+  }
+
+  if (vkIBSize > 0) {
+    vkBufferCopies[numCopies].srcOffset = staging.offset + vkVBSize;
+    vkBufferCopies[numCopies].dstOffset = vkVBCapacity + vkIBOffset;
+    vkBufferCopies[numCopies].size = vkIBSize;
+    numCopies += 1;
+  }
+
+  if (numCopies > 0) {
+    vkCmdCopyBuffer(vkCommandBuffer, staging.vkBuffer, vkBuffer, numCopies, vkBufferCopies);
+  }
+
+  return VK_SUCCESS;
+}
+
+StagingAllocation ElementPool::takeStagingAllocation () {
+  auto taken = staging;
+  this->staging = StagingAllocation {};
+
+  return taken;
+}
+
+VkResult ElementPool::write (
+    VkDeviceSize vertexOffset
+  , const void* vertexData
+  , VkDeviceSize vertexSize
+  , VkDeviceSize indexOffset
+  , const void* indexData
+  , VkDeviceSize indexSize
+) {
+  if (VK_NULL_HANDLE != staging.vkBuffer
+      || vertexOffset + vertexSize > vkVBCapacity
+      || indexOffset + indexSize > vkIBCapacity
+  ) {
+    this->vkLastResult = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    return vkLastResult;
+  }
+
+  this->vkLastResult = resourceAllocator.allocateStaging(vertexSize + indexSize, staging);
+  if (VK_SUCCESS != vkLastResult) {
+    return vkLastResult;
+  }
+
+  auto mappedData = static_cast<char*>(staging.mappedData);
+  std::memcpy(mappedData, vertexData, vertexSize);
+  std::memcpy(mappedData + vertexSize, indexData, indexSize);
+
+  resourceAllocator.flushStaging(staging);
+
+  this->vkVBOffset = vertexOffset;
+  this->vkVBSize = vertexSize;
+  this->vkIBOffset = indexOffset;
+  this->vkIBSize = indexSize;
+
+  return VK_SUCCESS;
+}
+
+}
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_VUGL_ELEMENT_POOL
+#define H_VUGL_ELEMENT_POOL
+
+#include <vulkan/vulkan.h>
+
+#include "vugl_bindable_resource.h"
+#include "vugl_uploadable_resource.h"
+#include "vugl_resource_allocator.h"
+
+namespace Vugl {
+
+// Vertices and indices of many meshes in one buffer of fixed capacity,
+// written range by range. Bound once, meshes are drawn by offsets.
+// Each write has to be enqueued for upload before the next one.
+class ElementPool
+  : public UploadableResource
+  , public BindableResource
+{
+  private:
+    VkResult vkLastResult;
+    ResourceAllocator& resourceAllocator;
+    uint32_t binding;
+    bool bigIndex;
+
+    StagingAllocation staging;
+    VkBuffer vkBuffer;
+    VkDeviceSize vkVBCapacity;
+    VkDeviceSize vkIBCapacity;
+    VmaAllocation vmaAllocation;
+
+    VkDeviceSize vkVBOffset;
+    VkDeviceSize vkVBSize;
+    VkDeviceSize vkIBOffset;
+    VkDeviceSize vkIBSize;
+
+  public:
+    ElementPool (const ElementPool&) = delete;
+    ElementPool& operator= (const ElementPool&) = delete;
+    ElementPool& operator= (ElementPool&&) = delete;
+
+    ElementPool (ElementPool &&);
+    ElementPool (
+        ResourceAllocator& allocator
+      , uint32_t binding
+      , VkDeviceSize vertexCapacity
+      , VkDeviceSize indexCapacity
+      , bool bigIndex
+    );
+    ~ElementPool ();
+
+    void deleteHostData () override;
+    void deleteGPUData () override;
+    void destroy ();
+
+    VkResult getLastResult () const;
+    VkDeviceSize getIndexCapacity () const;
+    VkDeviceSize getVertexCapacity () const;
+    bool isBigIndex () const;
+
+    VkResult recordBindCommands (VkCommandBuffer vkCommandBuffer, uint32_t i) override;
+    VkResult recordUploadCommands (
+        VkCommandBuffer vkCommandBuffer
+      , VkPipelineStageFlags vkDstStageFlags
+    ) override;
+    StagingAllocation takeStagingAllocation () override;
+
+    // byte offsets into the vertex and the index range
+    VkResult write (
+        VkDeviceSize vertexOffset
+      , const void* vertexData
+      , VkDeviceSize vertexSize
+      , VkDeviceSize indexOffset
+      , const void* indexData
+      , VkDeviceSize indexSize
+    );
+};
+
+}
+
+#endif
@@ -10,6 +10,7 @@ Frame::Frame (
   , VkQueue vkPresenterQueue
   , VkSwapchainKHR vkSwapchain
   , uint32_t swapchainImageIndex
+  , UploadQueue *uploadQueue
 )
   : vkDevice{vkDevice}
   , vkGFXQueue{vkGFXQueue}
@@ -19,6 +20,7 @@ Frame::Frame (
   , vkImageAvailableSemaphore{VK_NULL_HANDLE}
   , vkRenderDoneSemaphore{VK_NULL_HANDLE}
   , swapchainImageIndex{swapchainImageIndex}
+  , uploadQueue{uploadQueue}
   , lastResult{VK_SUCCESS}
 {
   VkSemaphoreCreateInfo vkSemaphoreCreateInfo = {};
@@ -37,6 +39,7 @@ Frame::Frame (Frame && other)
   , vkImageAvailableSemaphore{other.vkImageAvailableSemaphore}
   , vkRenderDoneSemaphore{other.vkRenderDoneSemaphore}
   , swapchainImageIndex{other.swapchainImageIndex}
+  , uploadQueue{other.uploadQueue}
   , lastResult{other.lastResult}
 {
   other.vkRenderDoneSemaphore = VK_NULL_HANDLE;
@@ -69,13 +72,22 @@ void Frame::setSwapchain (VkSwapchainKHR vkSwapchain) {
 }
 
 void Frame::submitAndPresent (const CommandBuffer& commandBuffer) {
-  VkPipelineStageFlags vkPipelineStageFlags[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+  std::vector<VkSemaphore> vkWaitSemaphores {vkImageAvailableSemaphore};
+  std::vector<VkPipelineStageFlags> vkPipelineStageFlags {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+
+  // pending uploads may be read anywhere in this frame
+  if (uploadQueue != nullptr) {
+    for (auto vkSemaphore : uploadQueue->takeWaitSemaphores()) {
+      vkWaitSemaphores.push_back(vkSemaphore);
+      vkPipelineStageFlags.push_back(VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+    }
+  }
 
   VkSubmitInfo vkSubmitInfo = {};
   vkSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-  vkSubmitInfo.waitSemaphoreCount = 1;
-  vkSubmitInfo.pWaitSemaphores = &vkImageAvailableSemaphore;
-  vkSubmitInfo.pWaitDstStageMask = vkPipelineStageFlags;
+  vkSubmitInfo.waitSemaphoreCount = vkWaitSemaphores.size();
+  vkSubmitInfo.pWaitSemaphores = vkWaitSemaphores.data();
+  vkSubmitInfo.pWaitDstStageMask = vkPipelineStageFlags.data();
   vkSubmitInfo.commandBufferCount = 1;
   vkSubmitInfo.pCommandBuffers = &commandBuffer.getVkCommandBuffer();
   vkSubmitInfo.signalSemaphoreCount = 1;
@@ -105,6 +117,10 @@ void Frame::submitAndPresent (const CommandBuffer& commandBuffer) {
   vkQueuePresentKHR(vkPresenterQueue, &vkPresentInfo);
 
   vkWaitForFences(vkDevice, 1, &vkSubmitFence, VK_TRUE, UINT64_MAX);
+
+  if (uploadQueue != nullptr) {
+    uploadQueue->recycle();
+  }
 }
 
 }
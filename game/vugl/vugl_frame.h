@@ -3,9 +3,12 @@
 #ifndef H_VUGL_FRAME
 #define H_VUGL_FRAME
 
+#include <vector>
+
 #include <vulkan/vulkan.h>
 
 #include "vugl_command_buffer.h"
+#include "vugl_upload_queue.h"
 
 namespace Vugl {
 
@@ -19,6 +22,7 @@ class Frame {
     VkSemaphore vkImageAvailableSemaphore;
     VkSemaphore vkRenderDoneSemaphore;
     uint32_t swapchainImageIndex;
+    UploadQueue *uploadQueue;
 
     VkResult lastResult;
 
@@ -34,6 +38,7 @@ class Frame {
       , VkQueue vkPresenterQueue
       , VkSwapchainKHR vkSwapchain
       , uint32_t swapchainImageIndex
+      , UploadQueue *uploadQueue
     );
     ~Frame ();
 
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include "vugl_frame_arena.h"
+
+namespace Vugl {
+
+FrameArena::FrameArena (
+    ResourceAllocator& resourceAllocator
+  , VkDeviceSize uboAlignment
+  , uint32_t numBuffers
+  , VkDeviceSize capacity
+) : allocator{resourceAllocator}
+  , alignment{uboAlignment}
+  , capacity{capacity}
+  , vkLastResult{VK_SUCCESS}
+  , buffers{numBuffers, VK_NULL_HANDLE}
+  , bufferAllocations{numBuffers, VK_NULL_HANDLE}
+  , mappedData{numBuffers, nullptr}
+  , heads{std::make_unique<std::atomic<VkDeviceSize>[]>(numBuffers)}
+{
+  for (uint32_t i = 0; i < numBuffers; ++i) {
+    this->vkLastResult =
+      allocator.createVkBuffer(
+          capacity
+        , BufferType::UNIFORM_VERTEX_BUFFER_HOST_COHERENT
+        , buffers[i]
+        , bufferAllocations[i]
+      );
+
+    if (VK_SUCCESS != vkLastResult) {
+      return;
+    }
+
+    this->mappedData[i] = static_cast<uint8_t*>(allocator.mapMemory(bufferAllocations[i]));
+    heads[i] = 0;
+  }
+}
+
+FrameArena::~FrameArena () {
+  destroy();
+}
+
+void FrameArena::destroy () {
+  for (decltype(buffers)::size_type i = 0; i < buffers.size(); ++i) {
+    if (nullptr != mappedData[i]) {
+      allocator.unmapMemory(bufferAllocations[i]);
+    }
+    allocator.destroyVkBuffer(buffers[i], bufferAllocations[i]);
+  }
+  buffers.resize(0);
+  bufferAllocations.resize(0);
+  mappedData.resize(0);
+}
+
+const std::vector<VkBuffer>& FrameArena::getBuffers () const {
+  return buffers;
+}
+
+VkDeviceSize FrameArena::getCapacity () const {
+  return capacity;
+}
+
+VkResult FrameArena::getLastResult () const {
+  return vkLastResult;
+}
+
+void FrameArena::reset (uint32_t i) {
+  heads[i] = 0;
+}
+
+std::optional<uint32_t> FrameArena::allocate (VkDeviceSize size, uint32_t i) {
+  auto alignedSize = size;
+  if (size % alignment > 0) {
+    alignedSize += alignment - (size % alignment);
+  }
+
+  auto offset = heads[i].fetch_add(alignedSize, std::memory_order_relaxed);
+  if (offset + alignedSize > capacity) {
+    return {};
+  }
+
+  return static_cast<uint32_t>(offset);
+}
+
+}
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_VUGL_FRAME_ARENA
+#define H_VUGL_FRAME_ARENA
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vk_mem_alloc.h"
+#include "vugl_resource_allocator.h"
+
+namespace Vugl {
+
+// Persistently mapped uniform memory per swapchain image, handed out
+// linearly during a frame and bound by dynamic offsets. Also usable
+// as per-instance vertex input.
+class FrameArena {
+  private:
+    ResourceAllocator& allocator;
+    VkDeviceSize alignment;
+    VkDeviceSize capacity;
+    VkResult vkLastResult;
+    std::vector<VkBuffer> buffers;
+    std::vector<VmaAllocation> bufferAllocations;
+    std::vector<uint8_t*> mappedData;
+    std::unique_ptr<std::atomic<VkDeviceSize>[]> heads;
+
+    std::optional<uint32_t> allocate (VkDeviceSize size, uint32_t i);
+
+  public:
+    FrameArena (const FrameArena&) = delete;
+    FrameArena (FrameArena &&) = delete;
+    FrameArena& operator= (const FrameArena&) = delete;
+    FrameArena& operator= (FrameArena&&) = delete;
+
+    FrameArena (
+        ResourceAllocator& allocator
+      , VkDeviceSize uboAlignment
+      , uint32_t numBuffers
+      , VkDeviceSize capacity
+    );
+    ~FrameArena ();
+
+    void destroy ();
+
+    const std::vector<VkBuffer>& getBuffers () const;
+    VkDeviceSize getCapacity () const;
+    VkResult getLastResult () const;
+    void reset (uint32_t i);
+
+    // dynamic offset of the copy, none if the frame ran out of memory
+    template <typename T>
+    std::optional<uint32_t> push (const T& data, uint32_t i) {
+      auto offset = allocate(sizeof(T), i);
+      if (offset) {
+        std::memcpy(mappedData[i] + *offset, &data, sizeof(T));
+      }
+
+      return offset;
+    }
+
+    template <typename T>
+    std::optional<uint32_t> push (std::span<const T> data, uint32_t i) {
+      auto offset = allocate(data.size_bytes(), i);
+      if (offset) {
+        std::memcpy(mappedData[i] + *offset, data.data(), data.size_bytes());
+      }
+
+      return offset;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <algorithm>
+
+#include "vugl_indirect_buffer.h"
+
+namespace Vugl {
+
+IndirectBuffer::IndirectBuffer (IndirectBuffer && other)
+  : allocator{other.allocator}
+  , vkLastResult{other.vkLastResult}
+  , capacity{other.capacity}
+  , buffers{std::move(other.buffers)}
+  , bufferAllocations{std::move(other.bufferAllocations)}
+  , mappedCommands{std::move(other.mappedCommands)}
+{}
+
+IndirectBuffer::IndirectBuffer (
+    ResourceAllocator& resourceAllocator
+  , uint32_t numBuffers
+  , uint32_t capacity
+) : allocator{resourceAllocator}
+  , vkLastResult{VK_SUCCESS}
+  , capacity{capacity}
+  , buffers{numBuffers, VK_NULL_HANDLE}
+  , bufferAllocations{numBuffers, VK_NULL_HANDLE}
+  , mappedCommands{numBuffers, nullptr}
+{
+  for (uint32_t i = 0; i < numBuffers; ++i) {
+    this->vkLastResult =
+      allocator.createVkBuffer(
+          sizeof(VkDrawIndexedIndirectCommand) * std::max(capacity, 1u)
+        , BufferType::INDIRECT_BUFFER_HOST_COHERENT
+        , buffers[i]
+        , bufferAllocations[i]
+      );
+
+    if (VK_SUCCESS != vkLastResult) {
+      return;
+    }
+
+    // stays mapped for the lifetime, rewritten every frame
+    mappedCommands[i] =
+      static_cast<VkDrawIndexedIndirectCommand*>(allocator.mapMemory(bufferAllocations[i]));
+  }
+}
+
+IndirectBuffer::~IndirectBuffer () {
+  destroy();
+}
+
+void IndirectBuffer::destroy () {
+  for (decltype(buffers)::size_type i = 0; i < buffers.size(); ++i) {
+    if (mappedCommands[i] != nullptr) {
+      allocator.unmapMemory(bufferAllocations[i]);
+    }
+    allocator.destroyVkBuffer(buffers[i], bufferAllocations[i]);
+  }
+  buffers.resize(0);
+  bufferAllocations.resize(0);
+  mappedCommands.resize(0);
+}
+
+VkBuffer IndirectBuffer::getBuffer (uint32_t i) const {
+  return buffers[i];
+}
+
+uint32_t IndirectBuffer::getCapacity () const {
+  return capacity;
+}
+
+VkResult IndirectBuffer::getLastResult () const {
+  return vkLastResult;
+}
+
+uint32_t IndirectBuffer::writeCommands (
+    const std::vector<VkDrawIndexedIndirectCommand>& commands
+  , uint32_t i
+) {
+  uint32_t numCommands = std::min(static_cast<uint32_t>(commands.size()), capacity);
+  std::copy(commands.cbegin(), commands.cbegin() + numCommands, mappedCommands[i]);
+
+  return numCommands;
+}
+
+}
@@ -0,0 +1,48 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_VUGL_INDIRECT_BUFFER
+#define H_VUGL_INDIRECT_BUFFER
+
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vk_mem_alloc.h"
+#include "vugl_resource_allocator.h"
+
+namespace Vugl {
+
+class IndirectBuffer {
+  private:
+    ResourceAllocator& allocator;
+    VkResult vkLastResult;
+    uint32_t capacity;
+    std::vector<VkBuffer> buffers;
+    std::vector<VmaAllocation> bufferAllocations;
+    std::vector<VkDrawIndexedIndirectCommand*> mappedCommands;
+
+  public:
+    IndirectBuffer (const IndirectBuffer&) = delete;
+    IndirectBuffer& operator= (const IndirectBuffer&) = delete;
+    IndirectBuffer& operator= (IndirectBuffer&&) = delete;
+
+    IndirectBuffer (IndirectBuffer &&);
+    IndirectBuffer (
+        ResourceAllocator& allocator
+      , uint32_t numBuffers
+      , uint32_t capacity
+    );
+    ~IndirectBuffer ();
+
+    void destroy ();
+
+    VkBuffer getBuffer (uint32_t i) const;
+    uint32_t getCapacity () const;
+    VkResult getLastResult () const;
+
+    uint32_t writeCommands (const std::vector<VkDrawIndexedIndirectCommand>& commands, uint32_t i);
+};
+
+}
+
+#endif
@@ -9,6 +9,7 @@ namespace Vugl {
 
 Pipeline::Pipeline (Pipeline && other)
   : vkDevice{other.vkDevice}
+  , descriptorAllocator{other.descriptorAllocator}
   , vkLastResult{other.vkLastResult}
   , vkVS{other.vkVS}
   , vkFS{other.vkFS}
@@ -31,10 +32,12 @@ Pipeline::Pipeline (Pipeline && other)
 Pipeline::Pipeline (
     const PipelineSetup& setup
   , VkDevice vkDevice
+  , DescriptorAllocator& descriptorAllocator
   , uint32_t numSwapchainImages
   , VkRenderPass vkRenderPass
 )
   : vkDevice{vkDevice}
+  , descriptorAllocator{descriptorAllocator}
   , vkLastResult{VK_SUCCESS}
   , vkVS{VK_NULL_HANDLE}
   , vkFS{VK_NULL_HANDLE}
@@ -167,7 +170,7 @@ Pipeline::~Pipeline () {
 }
 
 DescriptorSet Pipeline::createDescriptorSet () {
-  return {vkDevice, vkPipelineLayout, vkDescriptorSetLayout, numSwapchainImages};
+  return {vkDevice, descriptorAllocator, vkPipelineLayout, vkDescriptorSetLayout, numSwapchainImages};
 }
 
 void Pipeline::destroy () {
@@ -7,6 +7,7 @@
 
 #include "vk_mem_alloc.h"
 #include "vugl_bindable_resource.h"
+#include "vugl_descriptor_allocator.h"
 #include "vugl_descriptor_set.h"
 #include "vugl_pipeline_setup.h"
 #include "vugl_resource_allocator.h"
@@ -16,6 +17,7 @@ namespace Vugl {
 class Pipeline : public BindableResource {
   private:
     VkDevice vkDevice;
+    DescriptorAllocator& descriptorAllocator;
     VkResult vkLastResult;
 
     VkShaderModule vkVS;
@@ -41,6 +43,7 @@ class Pipeline : public BindableResource {
     Pipeline (
         const PipelineSetup& setup
       , VkDevice vkDevice
+      , DescriptorAllocator& descriptorAllocator
       , uint32_t numSwapchainImages
       , VkRenderPass vkRenderPass
     );
@@ -1,6 +1,9 @@
 // SPDX-License-Identifier: GPL-2.0
 
+#include <algorithm>
+
 #include "vugl_resource_allocator.h"
+#include "vugl_upload_queue.h"
 
 namespace Vugl {
 
@@ -8,6 +11,7 @@ ResourceAllocator::ResourceAllocator ()
   : vkDevice{VK_NULL_HANDLE}
   , vkPhysicalDevice{VK_NULL_HANDLE}
   , allocator{VK_NULL_HANDLE}
+  , uploadQueue{nullptr}
 {}
 
 ResourceAllocator::ResourceAllocator (
@@ -17,8 +21,63 @@ ResourceAllocator::ResourceAllocator (
 ) : vkDevice{vkDevice}
   , vkPhysicalDevice{vkPhysicalDevice}
   , allocator{allocator}
+  , uploadQueue{nullptr}
 {}
 
+VkResult ResourceAllocator::allocateStaging (
+    VkDeviceSize size
+  , StagingAllocation& allocation
+) {
+  if (stagingRing && stagingRing->allocate(size, allocation)) {
+    return VK_SUCCESS;
+  }
+
+  VkBufferCreateInfo vkBufferCreateInfo = {};
+  vkBufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  vkBufferCreateInfo.size = std::max(size, StagingRing::ALIGNMENT);
+  vkBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+  vkBufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  VmaAllocationCreateInfo allocationCreateInfo = {};
+  allocationCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
+  allocationCreateInfo.flags =
+    VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
+      | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+  VmaAllocationInfo allocationInfo = {};
+  auto result =
+    vmaCreateBuffer(
+        allocator
+      , &vkBufferCreateInfo
+      , &allocationCreateInfo
+      , &allocation.vkBuffer
+      , &allocation.vmaAllocation
+      , &allocationInfo
+    );
+  if (VK_SUCCESS != result) {
+    allocation = StagingAllocation {};
+    return result;
+  }
+
+  allocation.offset = 0;
+  allocation.size = size;
+  allocation.mappedData = allocationInfo.pMappedData;
+  allocation.ringOffset = 0;
+
+  return VK_SUCCESS;
+}
+
+VkResult ResourceAllocator::createStagingRing (VkDeviceSize capacity) {
+  this->stagingRing = std::make_unique<StagingRing>(allocator, capacity);
+
+  auto result = stagingRing->getLastResult();
+  if (VK_SUCCESS != result) {
+    stagingRing.reset();
+  }
+
+  return result;
+}
+
 VkResult ResourceAllocator::createVkBuffer (
     VkDeviceSize size
   , BufferType bufferType
@@ -43,11 +102,24 @@ VkResult ResourceAllocator::createVkBuffer (
       vkBufferCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
       allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
       break;
+    case BufferType::UNIFORM_VERTEX_BUFFER_HOST_COHERENT:
+      vkBufferCreateInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+      allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+      break;
+    case BufferType::INDIRECT_BUFFER_HOST_COHERENT:
+      vkBufferCreateInfo.usage = VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT;
+      allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
+      break;
     case BufferType::VERTEX_BUFFER:
       vkBufferCreateInfo.usage =
         VK_BUFFER_USAGE_TRANSFER_DST_BIT
           | VK_BUFFER_USAGE_INDEX_BUFFER_BIT
           | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+      if (queueFamilyIndices.size() > 1) {
+        vkBufferCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        vkBufferCreateInfo.queueFamilyIndexCount = queueFamilyIndices.size();
+        vkBufferCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+      }
       break;
   }
 
@@ -70,6 +142,8 @@ VkResult ResourceAllocator::createVkImage (
   , ImageType imageType
   , VkImage& vkImage
   , VmaAllocation& vmaAllocation
+  , uint32_t mipLevels
+  , uint32_t arrayLayers
 ) {
   VkImageCreateInfo vkImageCreateInfo = {};
   vkImageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
@@ -77,8 +151,8 @@ VkResult ResourceAllocator::createVkImage (
   vkImageCreateInfo.extent.width = extent.width;
   vkImageCreateInfo.extent.height = extent.height;
   vkImageCreateInfo.extent.depth = 1;
-  vkImageCreateInfo.mipLevels = 1;
-  vkImageCreateInfo.arrayLayers = 1;
+  vkImageCreateInfo.mipLevels = mipLevels;
+  vkImageCreateInfo.arrayLayers = arrayLayers;
   vkImageCreateInfo.format = vkFormat;
   vkImageCreateInfo.tiling = vkImgTiling;
   vkImageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
@@ -101,6 +175,11 @@ VkResult ResourceAllocator::createVkImage (
     case ImageType::TEXTURE:
       vkImageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
       allocationCreateInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+      if (queueFamilyIndices.size() > 1) {
+        vkImageCreateInfo.sharingMode = VK_SHARING_MODE_CONCURRENT;
+        vkImageCreateInfo.queueFamilyIndexCount = queueFamilyIndices.size();
+        vkImageCreateInfo.pQueueFamilyIndices = queueFamilyIndices.data();
+      }
       break;
   }
 
@@ -115,6 +194,10 @@ VkResult ResourceAllocator::createVkImage (
     );
 }
 
+void ResourceAllocator::destroyStagingRing () {
+  stagingRing.reset();
+}
+
 void ResourceAllocator::destroyVkBuffer (VkBuffer vkBuffer, VmaAllocation vmaAllocation) {
   vmaDestroyBuffer(allocator, vkBuffer, vmaAllocation);
 }
@@ -123,6 +206,22 @@ void ResourceAllocator::destroyVkImage (VkImage vkImage, VmaAllocation vmaAlloca
   vmaDestroyImage(allocator, vkImage, vmaAllocation);
 }
 
+void ResourceAllocator::destroyRetired (const RetiredResource& resource) {
+  if (VK_NULL_HANDLE != resource.vkBuffer) {
+    vmaDestroyBuffer(allocator, resource.vkBuffer, resource.vmaAllocation);
+  } else if (VK_NULL_HANDLE != resource.vkImage) {
+    vmaDestroyImage(allocator, resource.vkImage, resource.vmaAllocation);
+  }
+}
+
+void ResourceAllocator::flushStaging (const StagingAllocation& allocation) {
+  if (VK_NULL_HANDLE != allocation.vmaAllocation) {
+    vmaFlushAllocation(allocator, allocation.vmaAllocation, 0, allocation.size);
+  } else if (stagingRing && VK_NULL_HANDLE != allocation.vkBuffer) {
+    stagingRing->flush(allocation);
+  }
+}
+
 void* ResourceAllocator::mapMemory (VmaAllocation vmaAllocation) {
   void *mappedData = nullptr;
 
@@ -131,6 +230,52 @@ void* ResourceAllocator::mapMemory (VmaAllocation vmaAllocation) {
   return mappedData;
 }
 
+void ResourceAllocator::releaseStaging (StagingAllocation& allocation) {
+  if (VK_NULL_HANDLE != allocation.vmaAllocation) {
+    vmaDestroyBuffer(allocator, allocation.vkBuffer, allocation.vmaAllocation);
+  } else if (stagingRing && VK_NULL_HANDLE != allocation.vkBuffer) {
+    stagingRing->release(allocation);
+  }
+
+  allocation = StagingAllocation {};
+}
+
+void ResourceAllocator::retire (const RetiredResource& resource) {
+  if (uploadQueue == nullptr || !uploadQueue->retire(resource)) {
+    destroyRetired(resource);
+  }
+}
+
+void ResourceAllocator::retireVkBuffer (VkBuffer vkBuffer, VmaAllocation vmaAllocation) {
+  if (VK_NULL_HANDLE == vkBuffer) {
+    return;
+  }
+
+  RetiredResource resource {};
+  resource.vkBuffer = vkBuffer;
+  resource.vmaAllocation = vmaAllocation;
+  retire(resource);
+}
+
+void ResourceAllocator::retireVkImage (VkImage vkImage, VmaAllocation vmaAllocation) {
+  if (VK_NULL_HANDLE == vkImage) {
+    return;
+  }
+
+  RetiredResource resource {};
+  resource.vkImage = vkImage;
+  resource.vmaAllocation = vmaAllocation;
+  retire(resource);
+}
+
+void ResourceAllocator::setQueueFamilyIndices (const std::vector<uint32_t>& indices) {
+  this->queueFamilyIndices = indices;
+}
+
+void ResourceAllocator::setUploadQueue (UploadQueue *queue) {
+  this->uploadQueue = queue;
+}
+
 void ResourceAllocator::unmapMemory (VmaAllocation vmaAllocation) {
   vmaUnmapMemory(allocator, vmaAllocation);
 }
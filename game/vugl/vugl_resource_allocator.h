@@ -3,16 +3,23 @@
 #ifndef H_VUGL_RESOURCE_ALLOCATOR
 #define H_VUGL_RESOURCE_ALLOCATOR
 
+#include <memory>
 #include <vector>
 
 #include <vulkan/vulkan.h>
 
 #include "vk_mem_alloc.h"
 
+#include "vugl_staging_ring.h"
+
 namespace Vugl {
 
+class UploadQueue;
+
 enum class BufferType {
-    UNIFORM_BUFFER_HOST_COHERENT
+    INDIRECT_BUFFER_HOST_COHERENT
+  , UNIFORM_BUFFER_HOST_COHERENT
+  , UNIFORM_VERTEX_BUFFER_HOST_COHERENT
   , VERTEX_BUFFER
   , VERTEX_BUFFER_FOR_UPLOAD
   , TEXTURE_BUFFER_FOR_UPLOAD
@@ -24,11 +31,23 @@ enum class ImageType {
   , TEXTURE
 };
 
+struct RetiredResource {
+  VkBuffer vkBuffer = VK_NULL_HANDLE;
+  VkImage vkImage = VK_NULL_HANDLE;
+  VmaAllocation vmaAllocation = VK_NULL_HANDLE;
+};
+
 class ResourceAllocator {
   private:
     VkDevice vkDevice;
     VkPhysicalDevice vkPhysicalDevice;
     VmaAllocator allocator;
+    // concurrent sharing of uploaded resources if more than one
+    std::vector<uint32_t> queueFamilyIndices;
+    std::unique_ptr<StagingRing> stagingRing;
+    UploadQueue *uploadQueue;
+
+    void retire (const RetiredResource& resource);
 
   public:
     ResourceAllocator ();
@@ -39,6 +58,11 @@ class ResourceAllocator {
       , VmaAllocator allocator
     );
 
+    // from the ring if any fits, a dedicated buffer otherwise
+    VkResult allocateStaging (VkDeviceSize size, StagingAllocation& allocation);
+
+    VkResult createStagingRing (VkDeviceSize capacity);
+
     VkResult createVkBuffer (
         VkDeviceSize size
       , BufferType BufferType
@@ -54,8 +78,12 @@ class ResourceAllocator {
       , ImageType imageType
       , VkImage& vkImage
       , VmaAllocation& vmaAllocation
+      , uint32_t mipLevels = 1
+      , uint32_t arrayLayers = 1
     );
 
+    void destroyStagingRing ();
+
     void destroyVkBuffer (
         VkBuffer buffer
       , VmaAllocation allocation
@@ -66,7 +94,25 @@ class ResourceAllocator {
       , VmaAllocation allocation
     );
 
+    void destroyRetired (const RetiredResource& resource);
+
+    void flushStaging (const StagingAllocation& allocation);
     void* mapMemory (VmaAllocation allocation);
+    void releaseStaging (StagingAllocation& allocation);
+
+    // like destroying, but not before uploads recorded so far are done
+    void retireVkBuffer (
+        VkBuffer buffer
+      , VmaAllocation allocation
+    );
+
+    void retireVkImage (
+        VkImage image
+      , VmaAllocation allocation
+    );
+
+    void setQueueFamilyIndices (const std::vector<uint32_t>& indices);
+    void setUploadQueue (UploadQueue *queue);
     void unmapMemory (VmaAllocation allocation);
 };
 
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <algorithm>
+
+#include "vugl_staging_ring.h"
+
+namespace Vugl {
+
+StagingRing::StagingRing (VmaAllocator allocator, VkDeviceSize capacity)
+  : allocator{allocator}
+  , vkLastResult{VK_SUCCESS}
+  , vkBuffer{VK_NULL_HANDLE}
+  , vmaAllocation{VK_NULL_HANDLE}
+  , mappedData{nullptr}
+  , capacity{capacity}
+  , head{0}
+  , tail{0}
+{
+  VkBufferCreateInfo vkBufferCreateInfo = {};
+  vkBufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+  vkBufferCreateInfo.size = capacity;
+  vkBufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+  vkBufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+  VmaAllocationCreateInfo allocationCreateInfo = {};
+  allocationCreateInfo.usage = VMA_MEMORY_USAGE_AUTO;
+  allocationCreateInfo.flags =
+    VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT
+      | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+  VmaAllocationInfo allocationInfo = {};
+  this->vkLastResult =
+    vmaCreateBuffer(
+        allocator
+      , &vkBufferCreateInfo
+      , &allocationCreateInfo
+      , &vkBuffer
+      , &vmaAllocation
+      , &allocationInfo
+    );
+
+  if (VK_SUCCESS == vkLastResult) {
+    this->mappedData = static_cast<uint8_t*>(allocationInfo.pMappedData);
+  }
+}
+
+StagingRing::~StagingRing () {
+  if (VK_NULL_HANDLE != vkBuffer) {
+    vmaDestroyBuffer(allocator, vkBuffer, vmaAllocation);
+  }
+}
+
+bool StagingRing::allocate (VkDeviceSize size, StagingAllocation& allocation) {
+  std::lock_guard lock {mutex};
+
+  if (VK_NULL_HANDLE == vkBuffer) {
+    return false;
+  }
+
+  auto alignedSize = std::max(ALIGNMENT, (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1));
+  if (alignedSize > capacity) {
+    return false;
+  }
+
+  // start over if nothing is in use
+  if (regions.empty()) {
+    this->head = 0;
+    this->tail = 0;
+  }
+
+  // no wrapping inside of a region
+  uint64_t begin = head;
+  auto position = begin % capacity;
+  if (position + alignedSize > capacity) {
+    begin += capacity - position;
+  }
+
+  if (begin + alignedSize - tail > capacity) {
+    return false;
+  }
+
+  regions.push_back(Region {begin, begin + alignedSize, false});
+  this->head = begin + alignedSize;
+
+  allocation.vkBuffer = vkBuffer;
+  allocation.offset = begin % capacity;
+  allocation.size = size;
+  allocation.mappedData = mappedData + allocation.offset;
+  allocation.vmaAllocation = VK_NULL_HANDLE;
+  allocation.ringOffset = begin;
+
+  return true;
+}
+
+void StagingRing::flush (const StagingAllocation& allocation) {
+  vmaFlushAllocation(allocator, vmaAllocation, allocation.offset, allocation.size);
+}
+
+VkResult StagingRing::getLastResult () const {
+  return vkLastResult;
+}
+
+void StagingRing::release (const StagingAllocation& allocation) {
+  std::lock_guard lock {mutex};
+
+  auto lookup =
+    std::find_if(
+        regions.begin()
+      , regions.end()
+      , [&allocation](const Region& region) { return region.begin == allocation.ringOffset; }
+    );
+  if (lookup == regions.end()) {
+    return;
+  }
+
+  lookup->released = true;
+
+  while (!regions.empty() && regions.front().released) {
+    this->tail = regions.front().end;
+    regions.pop_front();
+  }
+}
+
+}
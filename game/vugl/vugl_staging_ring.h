@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_VUGL_STAGING_RING
+#define H_VUGL_STAGING_RING
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+#include <vulkan/vulkan.h>
+
+#include "vk_mem_alloc.h"
+
+namespace Vugl {
+
+struct StagingAllocation {
+  VkBuffer vkBuffer = VK_NULL_HANDLE;
+  VkDeviceSize offset = 0;
+  VkDeviceSize size = 0;
+  void *mappedData = nullptr;
+  // only for dedicated buffers not fitting into the ring
+  VmaAllocation vmaAllocation = VK_NULL_HANDLE;
+  uint64_t ringOffset = 0;
+};
+
+// One persistently mapped host buffer, sub-allocated in order. Regions
+// are given back out of order, but only reused once all older regions
+// are released too.
+class StagingRing {
+  public:
+    static constexpr VkDeviceSize ALIGNMENT = 16;
+
+    StagingRing (VmaAllocator allocator, VkDeviceSize capacity);
+    ~StagingRing ();
+
+    StagingRing (const StagingRing&) = delete;
+    StagingRing (StagingRing &&) = delete;
+    StagingRing& operator= (const StagingRing&) = delete;
+    StagingRing& operator= (StagingRing&&) = delete;
+
+    bool allocate (VkDeviceSize size, StagingAllocation& allocation);
+    void flush (const StagingAllocation& allocation);
+    VkResult getLastResult () const;
+    void release (const StagingAllocation& allocation);
+
+  private:
+    struct Region {
+      uint64_t begin;
+      uint64_t end;
+      bool released;
+    };
+
+    VmaAllocator allocator;
+    VkResult vkLastResult;
+    VkBuffer vkBuffer;
+    VmaAllocation vmaAllocation;
+    uint8_t *mappedData;
+    VkDeviceSize capacity;
+
+    // ever growing, the position in the buffer is modulo capacity
+    uint64_t head;
+    uint64_t tail;
+    std::deque<Region> regions;
+    std::mutex mutex;
+};
+
+}
+
+#endif
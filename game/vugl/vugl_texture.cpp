@@ -1,5 +1,7 @@
 // SPDX-License-Identifier: GPL-2.0
 
+#include <algorithm>
+
 #include "vugl_texture.h"
 
 namespace Vugl {
@@ -8,15 +10,16 @@ Texture::Texture (Texture && other)
   : allocator{other.allocator}
   , vkDevice{other.vkDevice}
   , vkLastResult{other.vkLastResult}
-  , vkStagingBuffer{other.vkStagingBuffer}
-  , vmaStagingBufferAllocation{other.vmaStagingBufferAllocation}
+  , staging{other.staging}
   , vkTexture{other.vkTexture}
   , vmaTextureAllocation{other.vmaTextureAllocation}
   , vkTextureView{other.vkTextureView}
   , extent{other.extent}
+  , mipOffsets{std::move(other.mipOffsets)}
+  , numLayers{other.numLayers}
+  , layerSize{other.layerSize}
 {
-  other.vkStagingBuffer = VK_NULL_HANDLE;
-  other.vmaStagingBufferAllocation = VK_NULL_HANDLE;
+  other.staging = StagingAllocation {};
   other.vkTexture = VK_NULL_HANDLE;
   other.vmaTextureAllocation = VK_NULL_HANDLE;
   other.vkTextureView = VK_NULL_HANDLE;
@@ -26,12 +29,14 @@ Texture::Texture (VkDevice vkDevice, ResourceAllocator& allocator)
   : allocator{allocator}
   , vkDevice{vkDevice}
   , vkLastResult{VK_SUCCESS}
-  , vkStagingBuffer{VK_NULL_HANDLE}
-  , vmaStagingBufferAllocation{VK_NULL_HANDLE}
+  , staging{}
   , vkTexture{VK_NULL_HANDLE}
   , vmaTextureAllocation{VK_NULL_HANDLE}
   , vkTextureView{VK_NULL_HANDLE}
   , extent{}
+  , mipOffsets{0}
+  , numLayers{1}
+  , layerSize{0}
 {}
 
 Texture::~Texture () {
@@ -49,15 +54,13 @@ void Texture::destroy () {
 }
 
 void Texture::deleteGPUData () {
-  allocator.destroyVkImage(vkTexture, vmaTextureAllocation);
+  allocator.retireVkImage(vkTexture, vmaTextureAllocation);
   this->vkTexture = VK_NULL_HANDLE;
   this->vmaTextureAllocation = VK_NULL_HANDLE;
 }
 
 void Texture::deleteHostData () {
-  allocator.destroyVkBuffer(vkStagingBuffer, vmaStagingBufferAllocation);
-  this->vkStagingBuffer = VK_NULL_HANDLE;
-  this->vmaStagingBufferAllocation = VK_NULL_HANDLE;
+  allocator.releaseStaging(staging);
 }
 
 VkExtent2D Texture::getExtent () const {
@@ -68,6 +71,14 @@ VkResult Texture::getLastResult () const {
   return vkLastResult;
 }
 
+uint32_t Texture::getLayers () const {
+  return numLayers;
+}
+
+uint32_t Texture::getMipLevels () const {
+  return mipOffsets.size();
+}
+
 VkImage Texture::getVkImage () const {
   return vkTexture;
 }
@@ -76,10 +87,18 @@ VkImageView Texture::getVkImageView () const {
   return vkTextureView;
 }
 
-VkResult Texture::recordUploadCommands (VkCommandBuffer vkCommandBuffer) {
+VkResult Texture::recordUploadCommands (
+    VkCommandBuffer vkCommandBuffer
+  , VkPipelineStageFlags vkUploadDstStageFlags
+) {
   VkPipelineStageFlags vkSrcStageFlags;
   VkPipelineStageFlags vkDstStageFlags;
 
+  // resident already
+  if (VK_NULL_HANDLE == staging.vkBuffer) {
+    return VK_SUCCESS;
+  }
+
   VkImageMemoryBarrier vkImgMemBarrier = {};
   vkImgMemBarrier.srcAccessMask = 0;
   vkImgMemBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
@@ -95,9 +114,9 @@ VkResult Texture::recordUploadCommands (VkCommandBuffer vkCommandBuffer) {
   vkImgMemBarrier.image = vkTexture;
   vkImgMemBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
   vkImgMemBarrier.subresourceRange.baseMipLevel = 0;
-  vkImgMemBarrier.subresourceRange.levelCount = 1;
+  vkImgMemBarrier.subresourceRange.levelCount = getMipLevels();
   vkImgMemBarrier.subresourceRange.baseArrayLayer = 0;
-  vkImgMemBarrier.subresourceRange.layerCount = 1;
+  vkImgMemBarrier.subresourceRange.layerCount = numLayers;
 
   vkCmdPipelineBarrier(
       vkCommandBuffer
@@ -112,40 +131,53 @@ VkResult Texture::recordUploadCommands (VkCommandBuffer vkCommandBuffer) {
     , &vkImgMemBarrier
   );
 
-  VkBufferImageCopy vkBufferRgn = {};
-  vkBufferRgn.bufferOffset = 0;
-  vkBufferRgn.bufferRowLength = 0;
-  vkBufferRgn.bufferImageHeight = 0;
-  vkBufferRgn.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-  vkBufferRgn.imageSubresource.mipLevel = 0;
-  vkBufferRgn.imageSubresource.baseArrayLayer = 0;
-  vkBufferRgn.imageSubresource.layerCount = 1;
-  vkBufferRgn.imageOffset = { 0, 0, 0 };
-  vkBufferRgn.imageExtent = { extent.width, extent.height, 1 };
+  std::vector<VkBufferImageCopy> vkBufferRgns(mipOffsets.size() * numLayers);
+  for (uint32_t layer = 0; layer < numLayers; ++layer) {
+    for (uint32_t i = 0; i < mipOffsets.size(); ++i) {
+      auto& vkBufferRgn = vkBufferRgns[layer * mipOffsets.size() + i];
+      vkBufferRgn.bufferOffset = staging.offset + layer * layerSize + mipOffsets[i];
+      vkBufferRgn.bufferRowLength = 0;
+      vkBufferRgn.bufferImageHeight = 0;
+      vkBufferRgn.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+      vkBufferRgn.imageSubresource.mipLevel = i;
+      vkBufferRgn.imageSubresource.baseArrayLayer = layer;
+      vkBufferRgn.imageSubresource.layerCount = 1;
+      vkBufferRgn.imageOffset = { 0, 0, 0 };
+      vkBufferRgn.imageExtent = {
+          std::max(extent.width >> i, 1u)
+        , std::max(extent.height >> i, 1u)
+        , 1
+      };
+    }
+  }
 
   vkCmdCopyBufferToImage(
       vkCommandBuffer
-    , vkStagingBuffer
+    , staging.vkBuffer
     , vkTexture
     , VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL
-    , 1
-    , &vkBufferRgn
+    , vkBufferRgns.size()
+    , vkBufferRgns.data()
   );
 
   vkSrcStageFlags = VK_PIPELINE_STAGE_TRANSFER_BIT;
-  vkDstStageFlags = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+  vkDstStageFlags = vkUploadDstStageFlags;
 
   vkImgMemBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-  vkImgMemBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  // a semaphore wait makes it visible if there is no reading stage
+  vkImgMemBarrier.dstAccessMask =
+    VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT == vkUploadDstStageFlags
+      ? 0
+      : VK_ACCESS_SHADER_READ_BIT;
   vkImgMemBarrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
   vkImgMemBarrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
   vkImgMemBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
   vkImgMemBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
   vkImgMemBarrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
   vkImgMemBarrier.subresourceRange.baseMipLevel = 0;
-  vkImgMemBarrier.subresourceRange.levelCount = 1;
+  vkImgMemBarrier.subresourceRange.levelCount = getMipLevels();
   vkImgMemBarrier.subresourceRange.baseArrayLayer = 0;
-  vkImgMemBarrier.subresourceRange.layerCount = 1;
+  vkImgMemBarrier.subresourceRange.layerCount = numLayers;
 
   vkCmdPipelineBarrier(
       vkCommandBuffer
@@ -163,4 +195,11 @@ VkResult Texture::recordUploadCommands (VkCommandBuffer vkCommandBuffer) {
   return VK_SUCCESS;
 }
 
+StagingAllocation Texture::takeStagingAllocation () {
+  auto taken = staging;
+  this->staging = StagingAllocation {};
+
+  return taken;
+}
+
 }
@@ -4,6 +4,7 @@
 #define H_VUGL_TEXTURE
 
 #include <memory>
+#include <vector>
 
 #include <vulkan/vulkan.h>
 
@@ -20,9 +21,12 @@ class Texture : public UploadableResource {
     VkResult vkLastResult;
 
     VkExtent2D extent;
+    // byte offsets of each level in the uploaded data
+    std::vector<VkDeviceSize> mipOffsets;
+    uint32_t numLayers;
+    VkDeviceSize layerSize;
 
-    VkBuffer vkStagingBuffer;
-    VmaAllocation vmaStagingBufferAllocation;
+    StagingAllocation staging;
     VkImage vkTexture;
     VmaAllocation vmaTextureAllocation;
     VkImageView vkTextureView;
@@ -41,16 +45,67 @@ class Texture : public UploadableResource {
 
     VkExtent2D getExtent () const;
     VkResult getLastResult () const;
+    uint32_t getLayers () const;
+    uint32_t getMipLevels () const;
     VkImage getVkImage () const;
     VkImageView getVkImageView () const;
 
-    VkResult recordUploadCommands (VkCommandBuffer vkCommandBuffer) override;
+    VkResult recordUploadCommands (
+        VkCommandBuffer vkCommandBuffer
+      , VkPipelineStageFlags vkDstStageFlags
+    ) override;
+    StagingAllocation takeStagingAllocation () override;
 
+    // mipOffsets lists where each level starts in data, every level
+    // halving the extent of the one before, empty for just one level
     template <typename T>
     void createTexture (
         const std::vector<T>& data
       , const VkExtent2D& extent
       , VkFormat vkFormat
+      , const std::vector<VkDeviceSize>& mipOffsets = {}
+    ) {
+      createImage(data, extent, vkFormat, mipOffsets, 1, VK_IMAGE_VIEW_TYPE_2D);
+    }
+
+    // layers of equal size back to back in data, mipOffsets relative
+    // to the start of a layer
+    template <typename T>
+    void createTextureArray (
+        const std::vector<T>& data
+      , const VkExtent2D& extent
+      , VkFormat vkFormat
+      , uint32_t numLayers
+      , const std::vector<VkDeviceSize>& mipOffsets = {}
+    ) {
+      createImage(data, extent, vkFormat, mipOffsets, numLayers, VK_IMAGE_VIEW_TYPE_2D_ARRAY);
+    }
+
+    template<typename T>
+    void updateTexture (const std::vector<T>& data) {
+      VkDeviceSize vkTBSize = sizeof(T) * data.size();
+
+      if (VK_NULL_HANDLE == staging.vkBuffer || staging.size != vkTBSize) {
+        allocator.releaseStaging(staging);
+        this->vkLastResult = allocator.allocateStaging(vkTBSize, staging);
+
+        if (VK_SUCCESS != vkLastResult) {
+          return;
+        }
+      }
+
+      std::uninitialized_copy(data.cbegin(), data.cend(), static_cast<T*>(staging.mappedData));
+      allocator.flushStaging(staging);
+    }
+  private:
+    template <typename T>
+    void createImage (
+        const std::vector<T>& data
+      , const VkExtent2D& extent
+      , VkFormat vkFormat
+      , const std::vector<VkDeviceSize>& mipOffsets
+      , uint32_t numLayers
+      , VkImageViewType vkImageViewType
     ) {
       if (vkTexture != VK_NULL_HANDLE) {
         this->vkLastResult = VK_ERROR_UNKNOWN;
@@ -58,22 +113,15 @@ class Texture : public UploadableResource {
       }
 
       this->extent = extent;
-      VkDeviceSize vkTBSize = data.size();
-
-      this->vkLastResult =
-        allocator.createVkBuffer(
-            vkTBSize
-          , BufferType::TEXTURE_BUFFER_FOR_UPLOAD
-          , vkStagingBuffer
-          , vmaStagingBufferAllocation
-        );
+      this->mipOffsets = mipOffsets.empty() ? std::vector<VkDeviceSize> {0} : mipOffsets;
+      this->numLayers = numLayers;
+      this->layerSize = sizeof(T) * data.size() / numLayers;
 
+      updateTexture(data);
       if (VK_SUCCESS != vkLastResult) {
         return;
       }
 
-      updateTexture(data);
-
       this->vkLastResult =
         allocator.createVkImage(
             extent
@@ -83,6 +131,8 @@ class Texture : public UploadableResource {
           , ImageType::TEXTURE
           , vkTexture
           , vmaTextureAllocation
+          , getMipLevels()
+          , numLayers
         );
 
       if (VK_SUCCESS != vkLastResult) {
@@ -92,13 +142,13 @@ class Texture : public UploadableResource {
       VkImageViewCreateInfo vkImageViewCreateInfo = {};
       vkImageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
       vkImageViewCreateInfo.image = vkTexture;
-      vkImageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+      vkImageViewCreateInfo.viewType = vkImageViewType;
       vkImageViewCreateInfo.format = vkFormat;
       vkImageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
       vkImageViewCreateInfo.subresourceRange.baseMipLevel = 0;
-      vkImageViewCreateInfo.subresourceRange.levelCount = 1;
+      vkImageViewCreateInfo.subresourceRange.levelCount = getMipLevels();
       vkImageViewCreateInfo.subresourceRange.baseArrayLayer = 0;
-      vkImageViewCreateInfo.subresourceRange.layerCount = 1;
+      vkImageViewCreateInfo.subresourceRange.layerCount = numLayers;
 
       this->vkLastResult =
         vkCreateImageView(
@@ -108,13 +158,6 @@ class Texture : public UploadableResource {
           , &(this->vkTextureView)
         );
     }
-
-    template<typename T>
-    void updateTexture (const std::vector<T>& data) {
-      void *mappedData = allocator.mapMemory(vmaStagingBufferAllocation);
-      std::uninitialized_copy(data.cbegin(), data.cend(), reinterpret_cast<T*>(mappedData));
-      allocator.unmapMemory(vmaStagingBufferAllocation);
-    }
 };
 
 }
@@ -10,6 +10,7 @@ UniformBuffer::UniformBuffer (UniformBuffer && other)
   , alignedSize{other.alignedSize}
   , buffers{std::move(other.buffers)}
   , bufferAllocations{std::move(other.bufferAllocations)}
+  , mappedData{std::move(other.mappedData)}
   , numDescriptors{other.numDescriptors}
   , strideSize{other.strideSize}
 {}
@@ -25,6 +26,7 @@ UniformBuffer::UniformBuffer (
   , alignedSize{dataSize}
   , buffers{numBuffers, VK_NULL_HANDLE}
   , bufferAllocations{numBuffers, VK_NULL_HANDLE}
+  , mappedData{numBuffers, nullptr}
   , numDescriptors{numDescriptors}
   , strideSize{dataSize}
 {
@@ -34,12 +36,17 @@ UniformBuffer::UniformBuffer (
   }
 
   for (uint32_t i = 0; i < numBuffers; ++i) {
-    allocator.createVkBuffer(
-        alignedSize
-      , BufferType::UNIFORM_BUFFER_HOST_COHERENT
-      , buffers[i]
-      , bufferAllocations[i]
-    );
+    auto result =
+      allocator.createVkBuffer(
+          alignedSize
+        , BufferType::UNIFORM_BUFFER_HOST_COHERENT
+        , buffers[i]
+        , bufferAllocations[i]
+      );
+
+    if (VK_SUCCESS == result) {
+      this->mappedData[i] = allocator.mapMemory(bufferAllocations[i]);
+    }
   }
 }
 
@@ -49,10 +56,14 @@ UniformBuffer::~UniformBuffer() {
 
 void UniformBuffer::destroy () {
   for (decltype(buffers)::size_type i = 0; i < buffers.size(); ++i) {
+    if (nullptr != mappedData[i]) {
+      allocator.unmapMemory(bufferAllocations[i]);
+    }
     allocator.destroyVkBuffer(buffers[i], bufferAllocations[i]);
   }
   buffers.resize(0);
   bufferAllocations.resize(0);
+  mappedData.resize(0);
 }
 
 const std::vector<VkBuffer>& UniformBuffer::getBuffers () const {
@@ -20,6 +20,8 @@ class UniformBuffer {
     VkDeviceSize alignedSize;
     std::vector<VkBuffer> buffers;
     std::vector<VmaAllocation> bufferAllocations;
+    // mapped for the whole lifetime
+    std::vector<void*> mappedData;
     uint32_t numDescriptors;
     VkDeviceSize strideSize;
 
@@ -48,25 +50,19 @@ class UniformBuffer {
 
     template <typename T>
     void writeData (const T& data, uint32_t i) {
-      T *mappedData = reinterpret_cast<T*>(allocator.mapMemory(bufferAllocations[i]));
-      *mappedData = data;
-      allocator.unmapMemory(bufferAllocations[i]);
+      *reinterpret_cast<T*>(mappedData[i]) = data;
     }
 
     template <typename T, typename It>
     void writeData (It begin, It end, uint32_t i) {
-      void *mappedData = allocator.mapMemory(bufferAllocations[i]);
-
       auto it = begin;
       for (size_t j = 0; it != end; it++, j++) {
         std::uninitialized_copy(
             it
           , it + 1
-          , reinterpret_cast<T*>(static_cast<uint8_t*>(mappedData) + j * strideSize)
+          , reinterpret_cast<T*>(static_cast<uint8_t*>(mappedData[i]) + j * strideSize)
         );
       }
-
-      allocator.unmapMemory(bufferAllocations[i]);
     }
 };
 
@@ -0,0 +1,329 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include "vugl_upload_queue.h"
+
+namespace Vugl {
+
+UploadQueue::UploadQueue (
+    VkDevice vkDevice
+  , ResourceAllocator& allocator
+  , VkQueue vkQueue
+  , uint32_t queueFamilyIndex
+  , bool dedicated
+)
+  : vkDevice{vkDevice}
+  , allocator{allocator}
+  , vkQueue{vkQueue}
+  , vkLastResult{VK_SUCCESS}
+  , vkCommandPool{VK_NULL_HANDLE}
+  , dedicated{dedicated}
+{
+  VkCommandPoolCreateInfo vkCommandPoolCreateInfo = {};
+  vkCommandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+  vkCommandPoolCreateInfo.queueFamilyIndex = queueFamilyIndex;
+  vkCommandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+  this->vkLastResult =
+    vkCreateCommandPool(vkDevice, &vkCommandPoolCreateInfo, nullptr, &(this->vkCommandPool));
+
+  allocator.setUploadQueue(this);
+}
+
+UploadQueue::~UploadQueue () {
+  destroy();
+}
+
+void UploadQueue::destroy () {
+  if (VK_NULL_HANDLE == vkCommandPool) {
+    return;
+  }
+
+  waitIdle();
+  allocator.setUploadQueue(nullptr);
+
+  for (auto& batch : batches) {
+    releaseResources(batch);
+    vkDestroyFence(vkDevice, batch.vkFence, nullptr);
+    vkDestroySemaphore(vkDevice, batch.vkSemaphore, nullptr);
+  }
+  batches.clear();
+  this->recordingBatch.reset();
+  this->lastSubmittedBatch.reset();
+
+  vkDestroyCommandPool(vkDevice, vkCommandPool, nullptr);
+  this->vkCommandPool = VK_NULL_HANDLE;
+}
+
+VkResult UploadQueue::enqueue (UploadableResource& resource) {
+  std::lock_guard lock {mutex};
+
+  if (!recordingBatch) {
+    this->vkLastResult = beginBatch();
+    if (VK_SUCCESS != vkLastResult) {
+      return vkLastResult;
+    }
+  }
+
+  auto& batch = batches[*recordingBatch];
+
+  // no graphics stages on transfer queues, the semaphore wait
+  // of the frame makes the data visible instead
+  this->vkLastResult =
+    resource.recordUploadCommands(
+        batch.vkCommandBuffer
+      , dedicated
+          ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+          : VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+    );
+  if (VK_SUCCESS != vkLastResult) {
+    return vkLastResult;
+  }
+
+  auto staging = resource.takeStagingAllocation();
+  if (VK_NULL_HANDLE == staging.vkBuffer) {
+    return vkLastResult;
+  }
+
+  batch.stagings.push_back(staging);
+  batch.numResources += 1;
+  if (batch.numResources >= MAX_BATCH_RESOURCES) {
+    this->vkLastResult = submitBatch();
+  }
+
+  return vkLastResult;
+}
+
+VkResult UploadQueue::flush () {
+  std::lock_guard lock {mutex};
+
+  if (recordingBatch) {
+    this->vkLastResult = submitBatch();
+  }
+
+  return vkLastResult;
+}
+
+VkResult UploadQueue::getLastResult () const {
+  return vkLastResult;
+}
+
+bool UploadQueue::isDedicated () const {
+  return dedicated;
+}
+
+void UploadQueue::recycle () {
+  std::lock_guard lock {mutex};
+
+  releaseFinishedStagings();
+
+  for (size_t i = 0; i < batches.size(); ++i) {
+    auto& batch = batches[i];
+    if (BatchState::WAITED_ON != batch.state
+        || VK_SUCCESS != vkGetFenceStatus(vkDevice, batch.vkFence)
+    ) {
+      continue;
+    }
+
+    vkResetFences(vkDevice, 1, &batch.vkFence);
+    vkResetCommandBuffer(batch.vkCommandBuffer, 0);
+    releaseResources(batch);
+    batch.state = BatchState::FREE;
+
+    if (lastSubmittedBatch == i) {
+      this->lastSubmittedBatch.reset();
+    }
+  }
+}
+
+void UploadQueue::releaseFinished () {
+  std::lock_guard lock {mutex};
+
+  releaseFinishedStagings();
+}
+
+bool UploadQueue::retire (const RetiredResource& resource) {
+  std::lock_guard lock {mutex};
+
+  // a fence also covers everything submitted before on its queue,
+  // and batches are only recycled after the frame waiting on them
+  auto batchIdx = recordingBatch ? recordingBatch : lastSubmittedBatch;
+  if (!batchIdx) {
+    return false;
+  }
+
+  batches[*batchIdx].retired.push_back(resource);
+
+  return true;
+}
+
+std::vector<VkSemaphore> UploadQueue::takeWaitSemaphores () {
+  std::lock_guard lock {mutex};
+
+  std::vector<VkSemaphore> semaphores;
+
+  if (recordingBatch) {
+    this->vkLastResult = submitBatch();
+  }
+
+  for (auto& batch : batches) {
+    if (BatchState::SUBMITTED == batch.state) {
+      semaphores.push_back(batch.vkSemaphore);
+      batch.state = BatchState::WAITED_ON;
+    }
+  }
+
+  return semaphores;
+}
+
+void UploadQueue::waitIdle () {
+  std::lock_guard lock {mutex};
+
+  if (recordingBatch) {
+    submitBatch();
+  }
+
+  std::vector<VkFence> fences;
+  for (auto& batch : batches) {
+    if (BatchState::SUBMITTED == batch.state || BatchState::WAITED_ON == batch.state) {
+      fences.push_back(batch.vkFence);
+    }
+  }
+
+  if (!fences.empty()) {
+    vkWaitForFences(vkDevice, fences.size(), fences.data(), VK_TRUE, UINT64_MAX);
+  }
+}
+
+VkResult UploadQueue::beginBatch () {
+  // makes room in the ring while loading without frames
+  releaseFinishedStagings();
+
+  std::optional<size_t> freeBatch;
+  for (size_t i = 0; i < batches.size(); ++i) {
+    if (BatchState::FREE == batches[i].state) {
+      freeBatch = i;
+      break;
+    }
+  }
+
+  if (!freeBatch) {
+    Batch batch;
+
+    VkCommandBufferAllocateInfo vkCommandBufferAllocateInfo = {};
+    vkCommandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    vkCommandBufferAllocateInfo.commandPool = vkCommandPool;
+    vkCommandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    vkCommandBufferAllocateInfo.commandBufferCount = 1;
+
+    auto result =
+      vkAllocateCommandBuffers(vkDevice, &vkCommandBufferAllocateInfo, &batch.vkCommandBuffer);
+    if (VK_SUCCESS != result) {
+      return result;
+    }
+
+    VkFenceCreateInfo vkFenceCreateInfo = {};
+    vkFenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+    result = vkCreateFence(vkDevice, &vkFenceCreateInfo, nullptr, &batch.vkFence);
+    if (VK_SUCCESS != result) {
+      vkFreeCommandBuffers(vkDevice, vkCommandPool, 1, &batch.vkCommandBuffer);
+      return result;
+    }
+
+    VkSemaphoreCreateInfo vkSemaphoreCreateInfo = {};
+    vkSemaphoreCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+    result = vkCreateSemaphore(vkDevice, &vkSemaphoreCreateInfo, nullptr, &batch.vkSemaphore);
+    if (VK_SUCCESS != result) {
+      vkDestroyFence(vkDevice, batch.vkFence, nullptr);
+      vkFreeCommandBuffers(vkDevice, vkCommandPool, 1, &batch.vkCommandBuffer);
+      return result;
+    }
+
+    batches.push_back(batch);
+    freeBatch = batches.size() - 1;
+  }
+
+  auto& batch = batches[*freeBatch];
+
+  VkCommandBufferBeginInfo vkCmdBufferBeginInfo = {};
+  vkCmdBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  vkCmdBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+  auto result = vkBeginCommandBuffer(batch.vkCommandBuffer, &vkCmdBufferBeginInfo);
+  if (VK_SUCCESS != result) {
+    return result;
+  }
+
+  batch.state = BatchState::RECORDING;
+  this->recordingBatch = freeBatch;
+
+  return VK_SUCCESS;
+}
+
+void UploadQueue::releaseFinishedStagings () {
+  for (auto& batch : batches) {
+    if ((BatchState::SUBMITTED != batch.state && BatchState::WAITED_ON != batch.state)
+        || batch.stagings.empty()
+        || VK_SUCCESS != vkGetFenceStatus(vkDevice, batch.vkFence)
+    ) {
+      continue;
+    }
+
+    releaseStagings(batch);
+  }
+}
+
+void UploadQueue::releaseResources (Batch& batch) {
+  releaseStagings(batch);
+
+  for (auto& resource : batch.retired) {
+    allocator.destroyRetired(resource);
+  }
+
+  batch.retired.clear();
+  batch.numResources = 0;
+}
+
+void UploadQueue::releaseStagings (Batch& batch) {
+  for (auto& staging : batch.stagings) {
+    allocator.releaseStaging(staging);
+  }
+
+  batch.stagings.clear();
+}
+
+VkResult UploadQueue::submitBatch () {
+  auto& batch = batches[*recordingBatch];
+  this->recordingBatch.reset();
+
+  auto result = vkEndCommandBuffer(batch.vkCommandBuffer);
+  if (VK_SUCCESS != result) {
+    vkResetCommandBuffer(batch.vkCommandBuffer, 0);
+    releaseResources(batch);
+    batch.state = BatchState::FREE;
+    return result;
+  }
+
+  VkSubmitInfo vkSubmitInfo = {};
+  vkSubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  vkSubmitInfo.commandBufferCount = 1;
+  vkSubmitInfo.pCommandBuffers = &batch.vkCommandBuffer;
+  vkSubmitInfo.signalSemaphoreCount = 1;
+  vkSubmitInfo.pSignalSemaphores = &batch.vkSemaphore;
+
+  result = vkQueueSubmit(vkQueue, 1, &vkSubmitInfo, batch.vkFence);
+  if (VK_SUCCESS != result) {
+    vkResetCommandBuffer(batch.vkCommandBuffer, 0);
+    releaseResources(batch);
+    batch.state = BatchState::FREE;
+    return result;
+  }
+
+  batch.state = BatchState::SUBMITTED;
+  this->lastSubmittedBatch = &batch - batches.data();
+
+  return VK_SUCCESS;
+}
+
+}
@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#ifndef H_VUGL_UPLOAD_QUEUE
+#define H_VUGL_UPLOAD_QUEUE
+
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+#include "vugl_resource_allocator.h"
+#include "vugl_uploadable_resource.h"
+
+namespace Vugl {
+
+// Records uploads into batches on its own pool and submits them
+// without waiting. Each batch signals a fence, after which its staging
+// memory is released, and a semaphore for the next frame to wait on,
+// after which the batch is recycled along with resources retired while
+// it was in flight.
+class UploadQueue {
+  public:
+    static constexpr uint32_t MAX_BATCH_RESOURCES = 64;
+
+    UploadQueue (
+        VkDevice vkDevice
+      , ResourceAllocator& allocator
+      , VkQueue vkQueue
+      , uint32_t queueFamilyIndex
+      , bool dedicated
+    );
+    ~UploadQueue ();
+
+    UploadQueue (const UploadQueue&) = delete;
+    UploadQueue (UploadQueue &&) = delete;
+    UploadQueue& operator= (const UploadQueue&) = delete;
+    UploadQueue& operator= (UploadQueue&&) = delete;
+
+    void destroy ();
+    VkResult enqueue (UploadableResource& resource);
+    VkResult flush ();
+    VkResult getLastResult () const;
+    bool isDedicated () const;
+    // after the frame that waited on the semaphores has finished
+    void recycle ();
+    // stagings of batches done on the device, frames or not
+    void releaseFinished ();
+    // false if nothing is in flight to wait for
+    bool retire (const RetiredResource& resource);
+    std::vector<VkSemaphore> takeWaitSemaphores ();
+    void waitIdle ();
+
+  private:
+    enum class BatchState {
+      FREE, RECORDING, SUBMITTED, WAITED_ON
+    };
+
+    struct Batch {
+      VkCommandBuffer vkCommandBuffer = VK_NULL_HANDLE;
+      VkFence vkFence = VK_NULL_HANDLE;
+      VkSemaphore vkSemaphore = VK_NULL_HANDLE;
+      BatchState state = BatchState::FREE;
+      uint32_t numResources = 0;
+      std::vector<StagingAllocation> stagings;
+      std::vector<RetiredResource> retired;
+    };
+
+    VkDevice vkDevice;
+    ResourceAllocator& allocator;
+    VkQueue vkQueue;
+    VkResult vkLastResult;
+    VkCommandPool vkCommandPool;
+    bool dedicated;
+
+    std::vector<Batch> batches;
+    std::optional<size_t> recordingBatch;
+    std::optional<size_t> lastSubmittedBatch;
+    // uploads may retire the resources they replace
+    std::recursive_mutex mutex;
+
+    VkResult beginBatch ();
+    void releaseFinishedStagings ();
+    void releaseResources (Batch& batch);
+    void releaseStagings (Batch& batch);
+    VkResult submitBatch ();
+};
+
+}
+
+#endif
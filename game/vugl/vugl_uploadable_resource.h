@@ -5,15 +5,24 @@
 
 #include <vulkan/vulkan.h>
 
+#include "vugl_staging_ring.h"
+
 namespace Vugl {
 
 class UploadableResource {
   public:
     virtual ~UploadableResource () {};
 
-    virtual VkResult recordUploadCommands (VkCommandBuffer vkCommandBuffer) = 0;
+    // vkDstStageFlags: first stage consuming the data on the queue recording it
+    virtual VkResult recordUploadCommands (
+        VkCommandBuffer vkCommandBuffer
+      , VkPipelineStageFlags vkDstStageFlags
+    ) = 0;
     virtual void deleteGPUData () = 0;
     virtual void deleteHostData () = 0;
+    // recorded uploads hand their staging over until the copy is done,
+    // nothing is uploaded again until the data is written anew
+    virtual StagingAllocation takeStagingAllocation () = 0;
 };
 
 }
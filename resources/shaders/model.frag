@@ -5,9 +5,7 @@ layout(location = 1) in vec3 normal;
 layout(location = 0) out vec4 outColor;
 
 layout(binding = 0) uniform Scene {
-  mat4 mvpMatrix;
   vec3 sunlight;
-  mat4 normalMatrix;
 } scene;
 
 layout(binding = 1) uniform sampler2D textureSampler;
@@ -2,11 +2,11 @@
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normalIn;
 layout(location = 2) in vec2 uvIn;
+layout(location = 3) in mat4 mvpMatrix;
+layout(location = 7) in mat4 normalMatrix;
 
 layout(binding = 0) uniform Scene {
-  mat4 mvpMatrix;
   vec3 sunlight;
-  mat4 normalMatrix;
 } scene;
 
 layout(location = 0) out vec2 uvOut;
@@ -14,7 +14,7 @@ layout(location = 1) out vec3 normalOut;
 
 void main() {
   uvOut = vec2(uvIn.x, 1.0 - uvIn.y);
-  normalOut = normalize(scene.normalMatrix * vec4(normalIn, 1.0)).xyz;
+  normalOut = normalize(normalMatrix * vec4(normalIn, 1.0)).xyz;
 
-  gl_Position = scene.mvpMatrix * vec4(position, 1.0);
+  gl_Position = mvpMatrix * vec4(position, 1.0);
 }
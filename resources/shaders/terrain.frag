@@ -1,5 +1,4 @@
 #version 450
-#extension GL_EXT_nonuniform_qualifier : enable
 
 layout(location = 0) flat in uvec2 textureIdx;
 layout(location = 1) in vec2 uv;
@@ -13,16 +12,16 @@ layout(binding = 0) uniform Scene {
 } scene;
 
 layout(binding = 1) uniform sampler textureSampler;
-layout(binding = 2) uniform texture2D textures[];
+layout(binding = 2) uniform texture2DArray textures;
 layout(binding = 3) uniform texture2D cloudTexture;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-  vec4 color = texture(sampler2D(textures[nonuniformEXT(textureIdx.x)], textureSampler), uv);
+  vec4 color = texture(sampler2DArray(textures, textureSampler), vec3(uv, textureIdx.x));
   vec4 brightness = vec4(0.2 + max(0.0, dot(normal, scene.sunlight)) * 0.8);
 
-  vec4 color2 = texture(sampler2D(textures[nonuniformEXT(textureIdx.y)], textureSampler), uv);
+  vec4 color2 = texture(sampler2DArray(textures, textureSampler), vec3(uv, textureIdx.y));
 
   vec4 valueCloud = texture(sampler2D(cloudTexture, textureSampler), uvCloud);
   float cloudGray = clamp(((valueCloud.r + valueCloud.g + valueCloud.b) / 3.0) * 1.25, 0.0, 1.0);
@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: GPL-2.0
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "fmt/core.h"
+
+#include "../game/Config.h"
+#include "../game/Logger.h"
+#include "../game/ResourceLoader.h"
+#include "../game/formats/DDSFile.h"
+
+// Decodes the top level of every DXT1/DXT5 texture in TexturesZH.big
+// with both decoders and reports the throughput of decoded BGRA data.
+
+struct Texture {
+  std::vector<char> blocks;
+  ZH::Size size;
+  bool dxt5;
+};
+
+struct Result {
+  double seconds = 0.0;
+  size_t bytes = 0;
+};
+
+static Result decodeAll(
+    const std::vector<Texture>& textures
+  , std::vector<std::vector<char>>& outputs
+  , ZH::DDSFile::Decoder decoder
+  , uint32_t runs
+) {
+  Result result;
+
+  for (uint32_t run = 0; run < runs; ++run) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < textures.size(); ++i) {
+      auto& texture = textures[i];
+      ZH::DDSFile::decodeBlocks(
+          texture.blocks.data()
+        , texture.size
+        , texture.dxt5
+        , outputs[i].data()
+        , decoder
+      );
+      result.bytes += outputs[i].size();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result.seconds += elapsed.count();
+  }
+
+  return result;
+}
+
+int main(int argc, char **argv) {
+  ZH::Logger logger;
+  logger.start();
+
+  uint32_t runs = 5;
+  if (argc > 1) {
+    runs = std::max(std::stoi(argv[1]), 1);
+  }
+
+  ZH::Config config;
+  ZH::ResourceLoader texturesLoader {{"TexturesZH.big"}, config.baseDir};
+
+  std::vector<Texture> textures;
+  for (auto it = texturesLoader.findByPrefix(""); it != texturesLoader.cend(); ++it) {
+    auto& key = it.key();
+    if (!key.ends_with(".dds")) {
+      continue;
+    }
+
+    auto lookup = texturesLoader.getFileStream(key, true);
+    if (!lookup || lookup->size() < 128) {
+      continue;
+    }
+
+    std::vector<char> file;
+    file.resize(lookup->size());
+    auto stream = lookup->getStream();
+    stream.read(file.data(), file.size());
+
+    uint32_t height, width, fourCC;
+    std::memcpy(&height, file.data() + 12, 4);
+    std::memcpy(&width, file.data() + 16, 4);
+    std::memcpy(&fourCC, file.data() + 84, 4);
+
+    bool dxt5 = fourCC == 0x35545844; // 'DXT5'
+    if (!dxt5 && fourCC != 0x31545844) { // 'DXT1'
+      continue;
+    }
+
+    size_t numBytes = ((width + 3) / 4) * ((height + 3) / 4) * (dxt5 ? 16 : 8);
+    if (file.size() < 128 + numBytes) {
+      continue;
+    }
+
+    textures.push_back({
+        std::vector<char>(file.cbegin() + 128, file.cbegin() + 128 + numBytes)
+      , ZH::Size {width, height}
+      , dxt5
+    });
+  }
+
+  if (textures.empty()) {
+    std::cerr << "No DDS textures found." << std::endl;
+    return 1;
+  }
+
+  std::vector<std::vector<char>> scalarOutputs;
+  std::vector<std::vector<char>> vectorizedOutputs;
+  for (auto& texture : textures) {
+    scalarOutputs.emplace_back(texture.size.x * texture.size.y * 4, 0);
+    vectorizedOutputs.emplace_back(texture.size.x * texture.size.y * 4, 0);
+  }
+
+  auto scalar = decodeAll(textures, scalarOutputs, ZH::DDSFile::Decoder::SCALAR, runs);
+  auto vectorized = decodeAll(textures, vectorizedOutputs, ZH::DDSFile::Decoder::VECTORIZED, runs);
+
+  size_t mismatches = 0;
+  for (size_t i = 0; i < textures.size(); ++i) {
+    mismatches += scalarOutputs[i] != vectorizedOutputs[i] ? 1 : 0;
+  }
+
+  auto megabytes = [](const Result& r) { return r.bytes / (1024.0 * 1024.0) / r.seconds; };
+
+  fmt::print("{} textures, {} runs\n", textures.size(), runs);
+  fmt::print("scalar:     {:8.1f} MB/s\n", megabytes(scalar));
+  fmt::print("vectorized: {:8.1f} MB/s ({:.2f}x)\n", megabytes(vectorized), scalar.seconds / vectorized.seconds);
+  if (mismatches > 0) {
+    fmt::print("{} textures decoded differently\n", mismatches);
+    return 1;
+  }
+
+  return 0;
+}
@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: GPL-2.0
 
+#include <fstream>
 #include <istream>
 #include <iostream>
 #include <string>
@@ -7,6 +8,7 @@
 #include "fmt/core.h"
 
 #include "../game/Config.h"
+#include "../game/gfx/CompiledModel.h"
 #include "../game/Logger.h"
 #include "../game/ResourceLoader.h"
 
@@ -445,15 +447,69 @@ Result parseChunk(std::istream& stream, uint16_t depth, State& state) {
   return {totalBytes, false};
 }
 
+int dumpCompiled(const std::string& path) {
+  std::ifstream file {path, std::ios::binary};
+  if (!file) {
+    std::cerr << "File does not exist." << std::endl;
+    return 1;
+  }
+
+  auto header = ZH::GFX::CompiledModel::readHeader(file);
+  if (!header) {
+    std::cerr << "Not a compiled model of version " << ZH::GFX::CompiledModel::VERSION << "." << std::endl;
+    return 1;
+  }
+
+  dump(0, "COMPILED MODEL\n");
+  dump(1, "Version: {}\n", header->version);
+  dump(1, "Source hash: {:08X}\n", header->sourceHash);
+  dump(1, "Models: {}\n", header->numModels);
+  dump(1, "Textures: {}\n", header->numTextures);
+  dump(1, "LODs: {}\n", header->numLODs);
+  dump(1, "Size: {}\n", header->size);
+
+  auto records = ZH::GFX::CompiledModel::readRecords(file, *header);
+  if (records.size() != header->numModels) {
+    std::cerr << "Model records are broken." << std::endl;
+    return 1;
+  }
+
+  for (auto& record : records) {
+    auto& from = record.boundingBoxFrom;
+    auto& to = record.boundingBoxTo;
+    auto& sphere = record.boundingSphere;
+
+    dump(1, "MODEL\n");
+    dump(2, "Vertices: {} @ {}\n", record.numVertices, record.vertexOffset);
+    dump(2, "Indices: {} @ {}\n", record.numIndices, record.indexOffset);
+    dump(2, "Texture indices: {} @ {}\n", record.numTextureIndices, record.textureIndexOffset);
+    dump(2, "Textures: {} from {}\n", record.numTextures, record.firstTexture);
+    dump(2, "LODs: {} from {}\n", record.numLODs, record.firstLOD);
+    dump(2, "Screen size: {} - {}\n", record.minScreenSize, record.maxScreenSize);
+    dump(2, "Box: ({}, {}, {}) - ({}, {}, {})\n", from.x, from.y, from.z, to.x, to.y, to.z);
+    dump(2, "Sphere: ({}, {}, {}), {}\n", sphere.x, sphere.y, sphere.z, record.boundingSphereRadius);
+    dump(2, "Backface culling: {}\n", (record.flags & ZH::GFX::CompiledModel::FLAG_BACKFACE_CULLING) != 0);
+    dump(2, "Transparent: {}\n", (record.flags & ZH::GFX::CompiledModel::FLAG_TRANSPARENT) != 0);
+  }
+
+  return 0;
+}
+
 int main(int argc, char **argv) {
   ZH::Logger logger;
   logger.start();
 
   if (argc < 2) {
-    std::cerr << "Please supply a model name." << std::endl;
+    std::cerr << "Please supply a model name or a compiled model file." << std::endl;
     return 1;
   }
 
+  std::string name {argv[1]};
+  std::string extension {ZH::GFX::CompiledModel::EXTENSION};
+  if (name.size() > extension.size() && name.ends_with(extension)) {
+    return dumpCompiled(name);
+  }
+
   ZH::Config config;
   auto modelLoader =
     std::shared_ptr<ZH::ResourceLoader> {
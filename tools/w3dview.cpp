@@ -35,6 +35,12 @@ class Viewer {
   public:
     Viewer (ZH::Window& window) : window(window) {}
 
+    ~Viewer () {
+      if (textureCache) {
+        textureCache->stopLoading();
+      }
+    }
+
     bool init(ZH::Config& config, std::string&& modelName) {
       modelLoader =
         std::shared_ptr<ZH::ResourceLoader> {
@@ -357,6 +363,9 @@ class Viewer {
           }
         }
 
+        textureCache->update();
+        modelRenderer->updatePendingTextures();
+
         auto& frame = vuglContext.getNextFrame();
         auto frameIndex = frame.getImageIndex();
 